@@ -1,17 +1,20 @@
 /**
  * alignment.cpp - HDR+ style tile-based alignment implementation
  * 
- * Coarse-to-fine alignment using Gaussian pyramids with NEON optimization.
+ * Coarse-to-fine alignment using Gaussian pyramids with SIMD tile SAD.
  */
 
 #include "alignment.h"
-#include "neon_utils.h"
+#include "simd.h"
+#include <algorithm>
 #include <cmath>
 
 namespace ultradetail {
 
 TileAligner::TileAligner(const AlignmentParams& params)
     : params_(params)
+    , cache_(nullptr)
+    , refFrame_(0)
     , numTilesX_(0)
     , numTilesY_(0)
     , imageWidth_(0)
@@ -19,27 +22,35 @@ TileAligner::TileAligner(const AlignmentParams& params)
 }
 
 void TileAligner::setReference(const GrayImage& reference) {
-    imageWidth_ = reference.width;
-    imageHeight_ = reference.height;
+    ownCache_ = std::make_unique<FrameAnalysisCache>(params_.pyramidLevels);
+    setReference(*ownCache_, ownCache_->addFrame(reference));
+}
+
+void TileAligner::setReference(FrameAnalysisCache& cache, int frame) {
+    cache_ = &cache;
+    refFrame_ = frame;
+    imageWidth_ = cache.frame(frame).width;
+    imageHeight_ = cache.frame(frame).height;
     
     // Calculate number of tiles
     numTilesX_ = (imageWidth_ + params_.tileSize - 1) / params_.tileSize;
     numTilesY_ = (imageHeight_ + params_.tileSize - 1) / params_.tileSize;
     
-    // Build reference pyramid
-    refPyramid_.build(reference, params_.pyramidLevels);
+    // Build (or reuse) the reference pyramid
+    const int numLevels = std::min(params_.pyramidLevels, cache.pyramid(frame).numLevels());
     
     LOGD("Reference set: %dx%d, tiles: %dx%d, pyramid levels: %d",
-         imageWidth_, imageHeight_, numTilesX_, numTilesY_, refPyramid_.numLevels());
+         imageWidth_, imageHeight_, numTilesX_, numTilesY_, numLevels);
 }
 
 float TileAligner::computeTileSAD(
-    const GrayImage& ref,
-    const GrayImage& frame,
+    const GrayView& ref,
+    const GrayView& frame,
     int refX, int refY,
     int frameX, int frameY,
     int tileSize
 ) {
+    const simd::RowKernels& kernels = simd::rowKernels();
     float sad = 0.0f;
     int validPixels = 0;
     
@@ -54,49 +65,13 @@ float TileAligner::computeTileSAD(
         const float* refRow = ref.row(ry);
         const float* frameRow = frame.row(fy);
         
-#ifdef USE_NEON
-        int dx = 0;
-        float32x4_t vSad = vdupq_n_f32(0.0f);
-        
-        for (; dx + 3 < tileSize; dx += 4) {
-            int rx = refX + dx;
-            int fx = frameX + dx;
-            
-            if (rx >= 0 && rx + 3 < ref.width && fx >= 0 && fx + 3 < frame.width) {
-                float32x4_t vRef = vld1q_f32(refRow + rx);
-                float32x4_t vFrame = vld1q_f32(frameRow + fx);
-                float32x4_t vDiff = vabdq_f32(vRef, vFrame);
-                vSad = vaddq_f32(vSad, vDiff);
-                validPixels += 4;
-            }
-        }
-        
-        // Horizontal sum
-        float32x2_t vSum = vadd_f32(vget_low_f32(vSad), vget_high_f32(vSad));
-        vSum = vpadd_f32(vSum, vSum);
-        sad += vget_lane_f32(vSum, 0);
-        
-        // Handle remaining pixels
-        for (; dx < tileSize; ++dx) {
-            int rx = refX + dx;
-            int fx = frameX + dx;
-            
-            if (rx >= 0 && rx < ref.width && fx >= 0 && fx < frame.width) {
-                sad += std::abs(refRow[rx] - frameRow[fx]);
-                validPixels++;
-            }
-        }
-#else
-        for (int dx = 0; dx < tileSize; ++dx) {
-            int rx = refX + dx;
-            int fx = frameX + dx;
-            
-            if (rx >= 0 && rx < ref.width && fx >= 0 && fx < frame.width) {
-                sad += std::abs(refRow[rx] - frameRow[fx]);
-                validPixels++;
-            }
+        // Columns inside both images form one contiguous run
+        const int dx0 = std::max({0, -refX, -frameX});
+        const int dx1 = std::min({tileSize, ref.width - refX, frame.width - frameX});
+        if (dx1 > dx0) {
+            sad += kernels.sumAbsDiff(refRow + refX + dx0, frameRow + frameX + dx0, dx1 - dx0);
+            validPixels += dx1 - dx0;
         }
-#endif
     }
     
     // Normalize by number of valid pixels
@@ -104,8 +79,8 @@ float TileAligner::computeTileSAD(
 }
 
 MotionVector TileAligner::alignTile(
-    const GrayImage& ref,
-    const GrayImage& frame,
+    const GrayView& ref,
+    const GrayView& frame,
     int tileX, int tileY,
     int tileSize,
     const MotionVector& initialMotion
@@ -141,8 +116,8 @@ MotionVector TileAligner::alignTile(
 }
 
 MotionVector TileAligner::refineSubpixel(
-    const GrayImage& ref,
-    const GrayImage& frame,
+    const GrayView& ref,
+    const GrayView& frame,
     int tileX, int tileY,
     int tileSize,
     const MotionVector& integerMotion
@@ -191,30 +166,45 @@ MotionVector TileAligner::refineSubpixel(
 }
 
 FrameAlignment TileAligner::align(const GrayImage& frame) {
-    FrameAlignment result;
-    
-    if (refPyramid_.numLevels() == 0) {
+    if (!cache_) {
         LOGE("Reference not set before alignment");
-        return result;
+        return FrameAlignment();
     }
     
     // Build frame pyramid
     GaussianPyramid framePyramid;
     framePyramid.build(frame, params_.pyramidLevels);
     
-    int numLevels = std::min(refPyramid_.numLevels(), framePyramid.numLevels());
+    return alignPyramid(framePyramid);
+}
+
+FrameAlignment TileAligner::align(FrameAnalysisCache& cache, int frame) {
+    if (!cache_) {
+        LOGE("Reference not set before alignment");
+        return FrameAlignment();
+    }
+    
+    return alignPyramid(cache.pyramid(frame));
+}
+
+FrameAlignment TileAligner::alignPyramid(const GaussianPyramid& framePyramid) {
+    FrameAlignment result;
+    const GaussianPyramid& refPyramid = cache_->pyramid(refFrame_);
+    
+    int numLevels = std::min({std::max(1, params_.pyramidLevels),
+                              refPyramid.numLevels(), framePyramid.numLevels()});
     
     // Initialize motion field at coarsest level
-    int coarseTilesX = (refPyramid_.widthAt(numLevels - 1) + params_.tileSize - 1) / params_.tileSize;
-    int coarseTilesY = (refPyramid_.heightAt(numLevels - 1) + params_.tileSize - 1) / params_.tileSize;
+    int coarseTilesX = (refPyramid.widthAt(numLevels - 1) + params_.tileSize - 1) / params_.tileSize;
+    int coarseTilesY = (refPyramid.heightAt(numLevels - 1) + params_.tileSize - 1) / params_.tileSize;
     
     MotionField currentMotion(coarseTilesX, coarseTilesY);
     currentMotion.fill(MotionVector(0, 0, 0));
     
     // Coarse-to-fine alignment
     for (int level = numLevels - 1; level >= 0; --level) {
-        const GrayImage& refLevel = refPyramid_.getLevel(level);
-        const GrayImage& frameLevel = framePyramid.getLevel(level);
+        const GrayView& refLevel = refPyramid.getLevel(level);
+        const GrayView& frameLevel = framePyramid.getLevel(level);
         
         int levelTilesX = (refLevel.width + params_.tileSize - 1) / params_.tileSize;
         int levelTilesY = (refLevel.height + params_.tileSize - 1) / params_.tileSize;
@@ -9,7 +9,9 @@
 #define ULTRADETAIL_ALIGNMENT_H
 
 #include "common.h"
+#include "frame_analysis_cache.h"
 #include "pyramid.h"
+#include <memory>
 
 namespace ultradetail {
 
@@ -54,9 +56,20 @@ public:
     /**
      * Set reference frame for alignment
      * 
-     * @param reference Grayscale reference frame
+     * @param reference Grayscale reference frame; the reference pyramid
+     *                  borrows its pixels, so it must stay alive and
+     *                  unchanged until the next setReference
      */
     void setReference(const GrayImage& reference);
+    void setReference(GrayImage&& reference) = delete;
+    
+    /**
+     * Set reference frame from a shared analysis cache
+     * 
+     * @param cache Cache holding the reference (must outlive its use here)
+     * @param frame Reference frame id in the cache
+     */
+    void setReference(FrameAnalysisCache& cache, int frame);
     
     /**
      * Align a frame to the reference
@@ -66,6 +79,11 @@ public:
      */
     FrameAlignment align(const GrayImage& frame);
     
+    /**
+     * Same, with the frame pyramid taken from a shared analysis cache
+     */
+    FrameAlignment align(FrameAnalysisCache& cache, int frame);
+    
     /**
      * Apply alignment to warp an RGB image
      * 
@@ -87,18 +105,25 @@ public:
 
 private:
     AlignmentParams params_;
-    GaussianPyramid refPyramid_;
+    std::unique_ptr<FrameAnalysisCache> ownCache_;  // Holds the reference set as an image
+    FrameAnalysisCache* cache_;
+    int refFrame_;
     int numTilesX_;
     int numTilesY_;
     int imageWidth_;
     int imageHeight_;
     
+    /**
+     * Coarse-to-fine tile alignment against a frame pyramid
+     */
+    FrameAlignment alignPyramid(const GaussianPyramid& framePyramid);
+    
     /**
      * Compute motion vector for a single tile at given pyramid level
      */
     MotionVector alignTile(
-        const GrayImage& ref,
-        const GrayImage& frame,
+        const GrayView& ref,
+        const GrayView& frame,
         int tileX, int tileY,
         int tileSize,
         const MotionVector& initialMotion
@@ -108,8 +133,8 @@ private:
      * Compute SAD (Sum of Absolute Differences) for a tile
      */
     float computeTileSAD(
-        const GrayImage& ref,
-        const GrayImage& frame,
+        const GrayView& ref,
+        const GrayView& frame,
         int refX, int refY,
         int frameX, int frameY,
         int tileSize
@@ -119,8 +144,8 @@ private:
      * Refine motion to sub-pixel accuracy
      */
     MotionVector refineSubpixel(
-        const GrayImage& ref,
-        const GrayImage& frame,
+        const GrayView& ref,
+        const GrayView& frame,
         int tileX, int tileY,
         int tileSize,
         const MotionVector& integerMotion
@@ -5,7 +5,7 @@
  */
 
 #include "anisotropic_merge.h"
-#include "neon_utils.h"
+#include "thread_pool.h"
 #include <cmath>
 #include <algorithm>
 
@@ -69,21 +69,23 @@ void AnisotropicMergeProcessor::computeGradients(
     gradY.resize(width, height);
     
     // Sobel gradients
-    for (int y = 1; y < height - 1; ++y) {
-        for (int x = 1; x < width - 1; ++x) {
-            // Sobel X: [-1 0 1; -2 0 2; -1 0 1]
-            float gx = -input.at(x-1, y-1) + input.at(x+1, y-1)
-                      - 2.0f * input.at(x-1, y) + 2.0f * input.at(x+1, y)
-                      - input.at(x-1, y+1) + input.at(x+1, y+1);
-            
-            // Sobel Y: [-1 -2 -1; 0 0 0; 1 2 1]
-            float gy = -input.at(x-1, y-1) - 2.0f * input.at(x, y-1) - input.at(x+1, y-1)
-                      + input.at(x-1, y+1) + 2.0f * input.at(x, y+1) + input.at(x+1, y+1);
-            
-            gradX.at(x, y) = gx / 8.0f;  // Normalize
-            gradY.at(x, y) = gy / 8.0f;
+    ThreadPool::instance().parallelForRows(1, height - 1, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 1; x < width - 1; ++x) {
+                // Sobel X: [-1 0 1; -2 0 2; -1 0 1]
+                float gx = -input.at(x-1, y-1) + input.at(x+1, y-1)
+                          - 2.0f * input.at(x-1, y) + 2.0f * input.at(x+1, y)
+                          - input.at(x-1, y+1) + input.at(x+1, y+1);
+                
+                // Sobel Y: [-1 -2 -1; 0 0 0; 1 2 1]
+                float gy = -input.at(x-1, y-1) - 2.0f * input.at(x, y-1) - input.at(x+1, y-1)
+                          + input.at(x-1, y+1) + 2.0f * input.at(x, y+1) + input.at(x+1, y+1);
+                
+                gradX.at(x, y) = gx / 8.0f;  // Normalize
+                gradY.at(x, y) = gy / 8.0f;
+            }
         }
-    }
+    });
     
     // Handle borders (copy from adjacent)
     for (int x = 0; x < width; ++x) {
@@ -128,31 +130,33 @@ void AnisotropicMergeProcessor::integrateStructureTensor(
     for (auto& w : gaussWeights) w /= weightSum;
     
     // Compute structure tensor at each pixel
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            StructureTensor& st = tensorField.at(x, y);
-            st.Ixx = st.Ixy = st.Iyy = 0.0f;
-            
-            // Integrate over window
-            for (int dy = -halfWin; dy <= halfWin; ++dy) {
-                int sy = clamp(y + dy, 0, height - 1);
-                for (int dx = -halfWin; dx <= halfWin; ++dx) {
-                    int sx = clamp(x + dx, 0, width - 1);
-                    
-                    float gx = gradX.at(sx, sy);
-                    float gy = gradY.at(sx, sy);
-                    float w = gaussWeights[(dy + halfWin) * (2 * halfWin + 1) + (dx + halfWin)];
-                    
-                    st.Ixx += w * gx * gx;
-                    st.Ixy += w * gx * gy;
-                    st.Iyy += w * gy * gy;
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                StructureTensor& st = tensorField.at(x, y);
+                st.Ixx = st.Ixy = st.Iyy = 0.0f;
+                
+                // Integrate over window
+                for (int dy = -halfWin; dy <= halfWin; ++dy) {
+                    int sy = clamp(y + dy, 0, height - 1);
+                    for (int dx = -halfWin; dx <= halfWin; ++dx) {
+                        int sx = clamp(x + dx, 0, width - 1);
+                        
+                        float gx = gradX.at(sx, sy);
+                        float gy = gradY.at(sx, sy);
+                        float w = gaussWeights[(dy + halfWin) * (2 * halfWin + 1) + (dx + halfWin)];
+                        
+                        st.Ixx += w * gx * gx;
+                        st.Ixy += w * gx * gy;
+                        st.Iyy += w * gy * gy;
+                    }
                 }
+                
+                // Compute eigenvalues and orientation
+                st.computeEigen();
             }
-            
-            // Compute eigenvalues and orientation
-            st.computeEigen();
         }
-    }
+    });
 }
 
 StructureTensorField AnisotropicMergeProcessor::computeStructureTensors(const GrayImage& input) {
@@ -234,20 +238,22 @@ void AnisotropicMergeProcessor::filterGray(const GrayImage& input, GrayImage& ou
     output.resize(width, height);
     
     // Apply anisotropic filtering
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const StructureTensor& st = tensorField.at(x, y);
-            
-            // Build kernel based on local structure
-            AnisotropicKernel kernel;
-            if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
-                kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const StructureTensor& st = tensorField.at(x, y);
+                
+                // Build kernel based on local structure
+                AnisotropicKernel kernel;
+                if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
+                    kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
+                }
+                // else: use default isotropic kernel
+                
+                output.at(x, y) = applyKernel(input, x, y, kernel);
             }
-            // else: use default isotropic kernel
-            
-            output.at(x, y) = applyKernel(input, x, y, kernel);
         }
-    }
+    });
     
     LOGD("AnisotropicMerge: Filtered grayscale %dx%d", width, height);
 }
@@ -259,12 +265,14 @@ void AnisotropicMergeProcessor::filterRGB(const RGBImage& input, RGBImage& outpu
     // Convert to grayscale for structure analysis
     GrayImage gray;
     gray.resize(width, height);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = input.at(x, y);
-            gray.at(x, y) = 0.299f * p.r + 0.587f * p.g + 0.114f * p.b;
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const RGBPixel& p = input.at(x, y);
+                gray.at(x, y) = 0.299f * p.r + 0.587f * p.g + 0.114f * p.b;
+            }
         }
-    }
+    });
     
     // Compute structure tensors from luminance
     StructureTensorField tensorField = computeStructureTensors(gray);
@@ -272,18 +280,20 @@ void AnisotropicMergeProcessor::filterRGB(const RGBImage& input, RGBImage& outpu
     output.resize(width, height);
     
     // Apply anisotropic filtering to RGB
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const StructureTensor& st = tensorField.at(x, y);
-            
-            AnisotropicKernel kernel;
-            if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
-                kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const StructureTensor& st = tensorField.at(x, y);
+                
+                AnisotropicKernel kernel;
+                if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
+                    kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
+                }
+                
+                output.at(x, y) = applyKernelRGB(input, x, y, kernel);
             }
-            
-            output.at(x, y) = applyKernelRGB(input, x, y, kernel);
         }
-    }
+    });
     
     LOGD("AnisotropicMerge: Filtered RGB %dx%d", width, height);
 }
@@ -305,24 +315,26 @@ void AnisotropicMergeProcessor::mergeGray(
     output.resize(width, height);
     
     // Merge frames using anisotropic kernels
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const StructureTensor& st = tensorField.at(x, y);
-            
-            AnisotropicKernel kernel;
-            if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
-                kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
-            }
-            
-            // Apply kernel to each frame and average
-            float sum = 0.0f;
-            for (int f = 0; f < numFrames; ++f) {
-                sum += applyKernel(frames[f], x, y, kernel);
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const StructureTensor& st = tensorField.at(x, y);
+                
+                AnisotropicKernel kernel;
+                if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
+                    kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
+                }
+                
+                // Apply kernel to each frame and average
+                float sum = 0.0f;
+                for (int f = 0; f < numFrames; ++f) {
+                    sum += applyKernel(frames[f], x, y, kernel);
+                }
+                
+                output.at(x, y) = sum / numFrames;
             }
-            
-            output.at(x, y) = sum / numFrames;
         }
-    }
+    });
     
     LOGD("AnisotropicMerge: Merged %d grayscale frames %dx%d", numFrames, width, height);
 }
@@ -341,40 +353,44 @@ void AnisotropicMergeProcessor::mergeRGB(
     // Convert reference to grayscale for structure analysis
     GrayImage gray;
     gray.resize(width, height);
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = frames[referenceIdx].at(x, y);
-            gray.at(x, y) = 0.299f * p.r + 0.587f * p.g + 0.114f * p.b;
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const RGBPixel& p = frames[referenceIdx].at(x, y);
+                gray.at(x, y) = 0.299f * p.r + 0.587f * p.g + 0.114f * p.b;
+            }
         }
-    }
+    });
     
     StructureTensorField tensorField = computeStructureTensors(gray);
     
     output.resize(width, height);
     
     // Merge frames using anisotropic kernels
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            const StructureTensor& st = tensorField.at(x, y);
-            
-            AnisotropicKernel kernel;
-            if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
-                kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
-            }
-            
-            // Apply kernel to each frame and average
-            float sumR = 0.0f, sumG = 0.0f, sumB = 0.0f;
-            for (int f = 0; f < numFrames; ++f) {
-                RGBPixel p = applyKernelRGB(frames[f], x, y, kernel);
-                sumR += p.r;
-                sumG += p.g;
-                sumB += p.b;
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const StructureTensor& st = tensorField.at(x, y);
+                
+                AnisotropicKernel kernel;
+                if (st.lambda1 > params_.noiseThreshold && params_.adaptiveStrength) {
+                    kernel.buildFromStructure(st, params_.kernelSigma, params_.elongation);
+                }
+                
+                // Apply kernel to each frame and average
+                float sumR = 0.0f, sumG = 0.0f, sumB = 0.0f;
+                for (int f = 0; f < numFrames; ++f) {
+                    RGBPixel p = applyKernelRGB(frames[f], x, y, kernel);
+                    sumR += p.r;
+                    sumG += p.g;
+                    sumB += p.b;
+                }
+                
+                float invN = 1.0f / numFrames;
+                output.at(x, y) = RGBPixel(sumR * invN, sumG * invN, sumB * invN);
             }
-            
-            float invN = 1.0f / numFrames;
-            output.at(x, y) = RGBPixel(sumR * invN, sumG * invN, sumB * invN);
         }
-    }
+    });
     
     LOGD("AnisotropicMerge: Merged %d RGB frames %dx%d", numFrames, width, height);
 }
@@ -6,6 +6,7 @@
 
 #include "burst_processor.h"
 #include "yuv_converter.h"
+#include <algorithm>
 #include <chrono>
 
 namespace ultradetail {
@@ -56,8 +57,8 @@ void BurstProcessor::convertFrames(
         reportProgress(progressCallback, ProcessingStage::CONVERTING_YUV, progress,
                       "Converting YUV to RGB...");
         
-        yuvToRgbFloat(yuvFrames[i], rgbFrames[i]);
-        yuvToGray(yuvFrames[i], grayFrames[i]);
+        // RGB and Y-plane luma in one pass over the planes
+        yuvToRgbLuma(yuvFrames[i], &rgbFrames[i], &grayFrames[i], YUVLuma::Y_PLANE);
         
         LOGD("Converted frame %d/%d: %dx%d",
              i + 1, numFrames, rgbFrames[i].width, rgbFrames[i].height);
@@ -79,26 +80,77 @@ void BurstProcessor::alignFrames(
     alignments[referenceIndex].confidence = 1.0f;
     alignments[referenceIndex].averageMotion = 0.0f;
     
+    // Pyramids are built once per frame and shared by every aligner
+    FrameAnalysisCache analysis(std::max(params_.alignment.pyramidLevels, params_.opticalFlow.pyramidLevels));
+    for (const GrayImage& gray : grayFrames) {
+        analysis.addFrame(gray);
+    }
+    
     // Choose alignment method based on mode
     if (params_.alignmentMode == AlignmentMode::DENSE_FLOW) {
-        alignFramesDenseFlow(grayFrames, rgbFrames, alignments, referenceIndex, progressCallback);
+        alignFramesDenseFlow(analysis, rgbFrames, alignments, referenceIndex, progressCallback);
     } else {
-        alignFramesTileBased(grayFrames, rgbFrames, alignments, referenceIndex, progressCallback);
+        alignFramesTileBased(analysis, rgbFrames, alignments, referenceIndex, progressCallback);
+    }
+}
+
+void BurstProcessor::alignFrame(
+    TileAligner& aligner,
+    DenseOpticalFlow* flowEstimator,
+    FrameAnalysisCache& analysis,
+    int index,
+    RGBImage& rgb,
+    FrameAlignment& alignment
+) {
+    if (flowEstimator) {
+        // Compute dense optical flow
+        // TODO: Pass gyro homography here when available from JNI
+        GyroHomography gyroInit;  // Empty for now
+        DenseFlowResult flowResult = flowEstimator->computeFlow(analysis, index, gyroInit);
+        
+        if (flowResult.isValid) {
+            // Warp RGB frame using flow
+            RGBImage warped;
+            flowEstimator->warpImage(rgb, flowResult.flowField, warped);
+            rgb = std::move(warped);
+            
+            // Convert flow to motion field for compatibility
+            alignment.motionField = flowEstimator->flowToMotionField(
+                flowResult.flowField, params_.alignment.tileSize);
+            alignment.isValid = true;
+            alignment.averageMotion = flowResult.averageFlow;
+            alignment.confidence = flowResult.coverage;
+            analysis.release(index);
+            return;
+        }
+        
+        LOGW("Dense flow failed, falling back to tile-based");
+    }
+    
+    // Reuses the pyramid the flow estimator already built for this frame
+    alignment = aligner.align(analysis, index);
+    analysis.release(index);
+    
+    // Warp RGB frame if alignment succeeded
+    if (alignment.isValid) {
+        RGBImage warped;
+        aligner.warpImage(rgb, alignment, warped);
+        rgb = std::move(warped);
     }
 }
 
 void BurstProcessor::alignFramesTileBased(
-    const std::vector<GrayImage>& grayFrames,
+    FrameAnalysisCache& analysis,
     std::vector<RGBImage>& rgbFrames,
     std::vector<FrameAlignment>& alignments,
     int referenceIndex,
     ProgressCallback progressCallback
 ) {
-    int numFrames = static_cast<int>(grayFrames.size());
+    int numFrames = analysis.numFrames();
     
     // Create aligner with reference frame
     TileAligner aligner(params_.alignment);
-    aligner.setReference(grayFrames[referenceIndex]);
+    aligner.setReference(analysis, referenceIndex);
     
     // Align other frames
     for (int i = 0; i < numFrames && !cancelled_; ++i) {
@@ -108,14 +160,7 @@ void BurstProcessor::alignFramesTileBased(
         reportProgress(progressCallback, ProcessingStage::ALIGNING_FRAMES, progress,
                       "Aligning frames (tile-based)...");
         
-        alignments[i] = aligner.align(grayFrames[i]);
-        
-        // Warp RGB frame if alignment succeeded
-        if (alignments[i].isValid) {
-            RGBImage warped;
-            aligner.warpImage(rgbFrames[i], alignments[i], warped);
-            rgbFrames[i] = std::move(warped);
-        }
+        alignFrame(aligner, nullptr, analysis, i, rgbFrames[i], alignments[i]);
         
         LOGD("Tile-aligned frame %d/%d: motion=%.2f, confidence=%.3f",
              i + 1, numFrames, alignments[i].averageMotion, alignments[i].confidence);
@@ -123,17 +168,20 @@ void BurstProcessor::alignFramesTileBased(
 }
 
 void BurstProcessor::alignFramesDenseFlow(
-    const std::vector<GrayImage>& grayFrames,
+    FrameAnalysisCache& analysis,
     std::vector<RGBImage>& rgbFrames,
     std::vector<FrameAlignment>& alignments,
     int referenceIndex,
     ProgressCallback progressCallback
 ) {
-    int numFrames = static_cast<int>(grayFrames.size());
+    int numFrames = analysis.numFrames();
     
-    // Create dense optical flow estimator
+    // Create dense optical flow estimator, with a tile aligner as fallback;
+    // both read the same reference pyramid
     DenseOpticalFlow flowEstimator(params_.opticalFlow);
-    flowEstimator.setReference(grayFrames[referenceIndex]);
+    flowEstimator.setReference(analysis, referenceIndex);
+    TileAligner aligner(params_.alignment);
+    aligner.setReference(analysis, referenceIndex);
     
     LOGI("Using dense optical flow alignment (%d pyramid levels, window=%d)",
          params_.opticalFlow.pyramidLevels, params_.opticalFlow.windowSize);
@@ -146,43 +194,121 @@ void BurstProcessor::alignFramesDenseFlow(
         reportProgress(progressCallback, ProcessingStage::ALIGNING_FRAMES, progress,
                       "Aligning frames (dense flow)...");
         
-        // Compute dense optical flow
-        // TODO: Pass gyro homography here when available from JNI
-        GyroHomography gyroInit;  // Empty for now
-        DenseFlowResult flowResult = flowEstimator.computeFlow(grayFrames[i], gyroInit);
+        alignFrame(aligner, &flowEstimator, analysis, i, rgbFrames[i], alignments[i]);
         
-        if (flowResult.isValid) {
-            // Warp RGB frame using flow
-            RGBImage warped;
-            flowEstimator.warpImage(rgbFrames[i], flowResult.flowField, warped);
-            rgbFrames[i] = std::move(warped);
-            
-            // Convert flow to motion field for compatibility
-            MotionField motionField = flowEstimator.flowToMotionField(
-                flowResult.flowField, params_.alignment.tileSize);
-            
-            alignments[i].motionField = std::move(motionField);
-            alignments[i].isValid = true;
-            alignments[i].averageMotion = flowResult.averageFlow;
-            alignments[i].confidence = flowResult.coverage;
-            
-            LOGD("Dense-flow aligned frame %d/%d: avgFlow=%.2f, coverage=%.1f%%",
-                 i + 1, numFrames, flowResult.averageFlow, flowResult.coverage * 100.0f);
-        } else {
-            LOGW("Dense flow failed for frame %d, falling back to tile-based", i + 1);
+        LOGD("Dense-flow aligned frame %d/%d: motion=%.2f, confidence=%.3f",
+             i + 1, numFrames, alignments[i].averageMotion, alignments[i].confidence);
+    }
+}
+
+void BurstProcessor::mergeAligned(
+    const std::vector<RGBImage>& originalFrames,
+    const std::vector<RGBImage>& alignedFrames,
+    const std::vector<FrameAlignment>& alignments,
+    int refIndex,
+    BurstProcessingResult& result,
+    ProgressCallback progressCallback,
+    std::chrono::high_resolution_clock::time_point startTime
+) {
+    int numFrames = static_cast<int>(alignedFrames.size());
+    
+    // Count valid alignments
+    int validCount = 0;
+    for (const auto& align : alignments) {
+        if (align.isValid) validCount++;
+    }
+    
+    LOGD("Valid alignments: %d/%d", validCount, numFrames);
+    
+    // Check if MFSR is enabled and we have enough valid alignments
+    if (params_.enableMFSR && validCount >= 3) {
+        // Multi-Frame Super-Resolution path
+        reportProgress(progressCallback, ProcessingStage::MULTI_FRAME_SR, 0, "Applying multi-frame super-resolution...");
+        
+        try {
+            MultiFrameSR mfsr(params_.mfsr);
+            MFSRResult mfsrResult;
             
-            // Fallback to tile-based alignment
-            TileAligner aligner(params_.alignment);
-            aligner.setReference(grayFrames[referenceIndex]);
-            alignments[i] = aligner.align(grayFrames[i]);
+            // Use original (non-warped) frames for MFSR - it handles alignment internally
+            mfsr.process(originalFrames, alignments, refIndex, mfsrResult,
+                [&progressCallback](const char* msg, float progress) {
+                    if (progressCallback) {
+                        progressCallback(ProcessingStage::MULTI_FRAME_SR, progress, msg);
+                    }
+                }
+            );
             
-            if (alignments[i].isValid) {
-                RGBImage warped;
-                aligner.warpImage(rgbFrames[i], alignments[i], warped);
-                rgbFrames[i] = std::move(warped);
+            if (mfsrResult.success) {
+                result.mergedImage = std::move(mfsrResult.upscaledImage);
+                result.mfsrApplied = true;
+                result.mfsrScaleFactor = params_.mfsr.scaleFactor;
+                result.mfsrCoverage = mfsrResult.coverage;
+                result.avgSubPixelShift = mfsrResult.averageSubPixelShift;
+                
+                LOGI("MFSR applied: %dx upscale, coverage=%.1f%%, avgShift=%.3f",
+                     params_.mfsr.scaleFactor, mfsrResult.coverage * 100.0f,
+                     mfsrResult.averageSubPixelShift);
+            } else {
+                // MFSR failed, fall back to regular merge
+                LOGW("MFSR failed, falling back to regular merge");
+                FrameMerger merger(params_.merge);
+                merger.mergeWithWeights(alignedFrames, alignments, result.mergedImage);
             }
+        } catch (const std::exception& e) {
+            LOGE("MFSR exception: %s, falling back to regular merge", e.what());
+            FrameMerger merger(params_.merge);
+            merger.mergeWithWeights(alignedFrames, alignments, result.mergedImage);
+        }
+    } else {
+        // Regular merge path
+        reportProgress(progressCallback, ProcessingStage::MERGING_FRAMES, 0, "Merging frames...");
+        
+        FrameMerger merger(params_.merge);
+        
+        if (params_.merge.method == MergeMethod::FREQUENCY_DOMAIN) {
+            // Rejects misaligned content per frequency against the reference
+            merger.merge(alignedFrames, result.mergedImage, refIndex);
+        } else if (validCount >= numFrames / 2) {
+            // Use weighted merge if we have alignment info
+            merger.mergeWithWeights(alignedFrames, alignments, result.mergedImage);
+        } else {
+            // Fall back to simple merge
+            merger.merge(alignedFrames, result.mergedImage);
         }
     }
+    
+    result.numFramesUsed = numFrames;
+    
+    if (cancelled_) {
+        result.errorMessage = "Processing cancelled";
+        return;
+    }
+    
+    // Compute detail mask if requested
+    if (params_.computeDetailMask) {
+        reportProgress(progressCallback, ProcessingStage::COMPUTING_EDGES, 0, "Computing edges...");
+        
+        GrayImage luminance;
+        rgbToLuminance(result.mergedImage, luminance);
+        
+        reportProgress(progressCallback, ProcessingStage::GENERATING_MASK, 0.5f, "Generating detail mask...");
+        
+        EdgeDetector detector(params_.detailMask);
+        detector.detectDetails(luminance, result.detailMask);
+    }
+    
+    result.success = true;
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.processingTimeMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+    
+    // Store result for later retrieval
+    lastResult_ = result;
+    
+    reportProgress(progressCallback, ProcessingStage::COMPLETE, 1.0f, "Complete");
+    
+    LOGI("Burst processing complete: %.1f ms, %d frames used",
+         result.processingTimeMs, result.numFramesUsed);
 }
 
 void BurstProcessor::process(
@@ -296,106 +422,210 @@ void BurstProcessor::processRGB(
             return;
         }
         
-        // Count valid alignments
-        int validCount = 0;
-        for (const auto& align : alignments) {
-            if (align.isValid) validCount++;
-        }
-        
-        LOGD("Valid alignments: %d/%d", validCount, numFrames);
-        
-        // Check if MFSR is enabled and we have enough valid alignments
-        if (params_.enableMFSR && validCount >= 3) {
-            // Multi-Frame Super-Resolution path
-            reportProgress(progressCallback, ProcessingStage::MULTI_FRAME_SR, 0, "Applying multi-frame super-resolution...");
-            
-            try {
-                MultiFrameSR mfsr(params_.mfsr);
-                MFSRResult mfsrResult;
-                
-                // Use original (non-warped) frames for MFSR - it handles alignment internally
-                mfsr.process(frames, alignments, refIndex, mfsrResult,
-                    [&progressCallback](const char* msg, float progress) {
-                        if (progressCallback) {
-                            progressCallback(ProcessingStage::MULTI_FRAME_SR, progress, msg);
-                        }
-                    }
-                );
-                
-                if (mfsrResult.success) {
-                    result.mergedImage = std::move(mfsrResult.upscaledImage);
-                    result.mfsrApplied = true;
-                    result.mfsrScaleFactor = params_.mfsr.scaleFactor;
-                    result.mfsrCoverage = mfsrResult.coverage;
-                    result.avgSubPixelShift = mfsrResult.averageSubPixelShift;
-                    
-                    LOGI("MFSR applied: %dx upscale, coverage=%.1f%%, avgShift=%.3f",
-                         params_.mfsr.scaleFactor, mfsrResult.coverage * 100.0f,
-                         mfsrResult.averageSubPixelShift);
-                } else {
-                    // MFSR failed, fall back to regular merge
-                    LOGW("MFSR failed, falling back to regular merge");
-                    FrameMerger merger(params_.merge);
-                    merger.mergeWithWeights(alignedFrames, alignments, result.mergedImage);
-                }
-            } catch (const std::exception& e) {
-                LOGE("MFSR exception: %s, falling back to regular merge", e.what());
-                FrameMerger merger(params_.merge);
-                merger.mergeWithWeights(alignedFrames, alignments, result.mergedImage);
-            }
-        } else {
-            // Regular merge path
-            reportProgress(progressCallback, ProcessingStage::MERGING_FRAMES, 0, "Merging frames...");
-            
-            FrameMerger merger(params_.merge);
-            
-            if (validCount >= numFrames / 2) {
-                // Use weighted merge if we have alignment info
-                merger.mergeWithWeights(alignedFrames, alignments, result.mergedImage);
-            } else {
-                // Fall back to simple merge
-                merger.merge(alignedFrames, result.mergedImage);
-            }
-        }
-        
-        result.numFramesUsed = numFrames;
-        
-        if (cancelled_) {
-            result.errorMessage = "Processing cancelled";
-            return;
+        mergeAligned(frames, alignedFrames, alignments, refIndex, result, progressCallback, startTime);
+    } catch (const std::exception& e) {
+        result.errorMessage = std::string("Processing failed: ") + e.what();
+        reportProgress(progressCallback, ProcessingStage::ERROR, 0, result.errorMessage.c_str());
+        LOGE("Burst processing failed: %s", e.what());
+    }
+}
+
+bool BurstProcessor::beginBurst(int expectedFrames) {
+    if (burstOpen_) {
+        LOGE("beginBurst: a burst is already open");
+        return false;
+    }
+    if (expectedFrames < 2) {
+        LOGE("beginBurst: need at least 2 frames, got %d", expectedFrames);
+        return false;
+    }
+    
+    reset();
+    burstOpen_ = true;
+    burstExpected_ = expectedFrames;
+    burstPushed_ = 0;
+    burstWidth_ = 0;
+    burstHeight_ = 0;
+    burstReference_ = selectReferenceFrame(expectedFrames);
+    burstReferenceReady_ = false;
+    burstFrames_.assign(expectedFrames, RGBImage());
+    burstOriginals_.assign(params_.enableMFSR ? expectedFrames : 0, RGBImage());
+    burstGray_.assign(expectedFrames, GrayImage());
+    burstAnalysis_ = std::make_unique<FrameAnalysisCache>(
+        std::max(params_.alignment.pyramidLevels, params_.opticalFlow.pyramidLevels));
+    burstAlignments_.assign(expectedFrames, FrameAlignment());
+    burstWaiting_.clear();
+    burstQueue_ = std::make_unique<SerialTaskQueue>(ThreadPool::instance());
+    
+    LOGI("Incremental burst started: %d frames expected, reference %d",
+         expectedFrames, burstReference_);
+    return true;
+}
+
+bool BurstProcessor::pushFrame(const YUVFrame& frame) {
+    if (!burstOpen_) {
+        LOGE("pushFrame: no burst is open");
+        return false;
+    }
+    if (burstPushed_ >= burstExpected_) {
+        LOGE("pushFrame: burst already has %d frames", burstExpected_);
+        return false;
+    }
+    if (!frame.yPlane || !frame.uPlane || !frame.vPlane) {
+        LOGE("pushFrame: missing plane");
+        return false;
+    }
+    if (burstPushed_ == 0) {
+        burstWidth_ = frame.width;
+        burstHeight_ = frame.height;
+    } else if (frame.width != burstWidth_ || frame.height != burstHeight_) {
+        LOGE("pushFrame: frame is %dx%d, burst is %dx%d",
+             frame.width, frame.height, burstWidth_, burstHeight_);
+        return false;
+    }
+    
+    // Copy on the caller's thread so the camera image can be released right away;
+    // std::function needs a copyable task, hence the shared_ptr
+    int index = burstPushed_++;
+    auto yuv = std::make_shared<OwnedYUVFrame>(frame);
+    burstQueue_->post([this, index, yuv]() { ingestFrame(index, *yuv); });
+    return true;
+}
+
+void BurstProcessor::ingestFrame(int index, const OwnedYUVFrame& yuv) {
+    if (cancelled_) return;
+    
+    // RGB and alignment luma in one pass; the weighted luma matches processRGB
+    yuvToRgbLuma(yuv.frame(), &burstFrames_[index], &burstGray_[index], YUVLuma::RGB_WEIGHTED);
+    burstAnalysis_->setFrame(index, burstGray_[index]);
+    if (!burstOriginals_.empty()) {
+        burstOriginals_[index] = burstFrames_[index];
+    }
+    
+    if (index == burstReference_) {
+        setBurstReference(index);
+    } else if (burstReferenceReady_) {
+        alignBurstFrame(index);
+    } else {
+        burstWaiting_.push_back(index);
+    }
+}
+
+void BurstProcessor::setBurstReference(int index) {
+    burstReference_ = index;
+    
+    burstAligner_ = std::make_unique<TileAligner>(params_.alignment);
+    burstAligner_->setReference(*burstAnalysis_, index);
+    if (params_.alignmentMode == AlignmentMode::DENSE_FLOW) {
+        burstFlow_ = std::make_unique<DenseOpticalFlow>(params_.opticalFlow);
+        burstFlow_->setReference(*burstAnalysis_, index);
+    }
+    
+    // Reference frame has identity alignment
+    burstAlignments_[index].isValid = true;
+    burstAlignments_[index].confidence = 1.0f;
+    burstAlignments_[index].averageMotion = 0.0f;
+    burstReferenceReady_ = true;
+    
+    for (int waiting : burstWaiting_) {
+        if (cancelled_) break;
+        alignBurstFrame(waiting);
+    }
+    burstWaiting_.clear();
+}
+
+void BurstProcessor::alignBurstFrame(int index) {
+    if (cancelled_) return;
+    
+    alignFrame(*burstAligner_, burstFlow_.get(), *burstAnalysis_, index, burstFrames_[index],
+               burstAlignments_[index]);
+    
+    // Alignment luma is no longer needed once the frame is warped
+    // (alignFrame already dropped its analysis)
+    burstGray_[index] = GrayImage();
+    
+    LOGD("Burst frame %d aligned during capture: motion=%.2f, confidence=%.3f",
+         index, burstAlignments_[index].averageMotion, burstAlignments_[index].confidence);
+}
+
+void BurstProcessor::closeBurst() {
+    burstQueue_.reset();
+    burstOpen_ = false;
+    burstExpected_ = 0;
+    burstPushed_ = 0;
+    burstReference_ = -1;
+    burstReferenceReady_ = false;
+    burstFrames_.clear();
+    burstOriginals_.clear();
+    burstAligner_.reset();
+    burstFlow_.reset();
+    burstAnalysis_.reset();
+    burstGray_.clear();
+    burstAlignments_.clear();
+    burstWaiting_.clear();
+}
+
+void BurstProcessor::finish(
+    BurstProcessingResult& result,
+    ProgressCallback progressCallback
+) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    result = BurstProcessingResult();
+    
+    if (!burstOpen_) {
+        result.errorMessage = "No burst in progress";
+        reportProgress(progressCallback, ProcessingStage::ERROR, 0, result.errorMessage.c_str());
+        return;
+    }
+    
+    // Usually only the last frame (or none) is still being aligned here
+    reportProgress(progressCallback, ProcessingStage::ALIGNING_FRAMES, 0, "Finishing frame alignment...");
+    burstQueue_->wait();
+    
+    const int numFrames = burstPushed_;
+    if (cancelled_) {
+        result.errorMessage = "Processing cancelled";
+        closeBurst();
+        return;
+    }
+    if (numFrames < 2) {
+        result.errorMessage = "Need at least 2 frames for burst processing";
+        reportProgress(progressCallback, ProcessingStage::ERROR, 0, result.errorMessage.c_str());
+        closeBurst();
+        return;
+    }
+    
+    try {
+        // The burst ended early without its reference: fall back to the middle pushed frame
+        if (!burstReferenceReady_) {
+            int reference = selectReferenceFrame(numFrames);
+            LOGW("Reference frame %d never arrived (%d/%d pushed), using frame %d",
+                 burstReference_, numFrames, burstExpected_, reference);
+            burstWaiting_.erase(std::remove(burstWaiting_.begin(), burstWaiting_.end(), reference),
+                                burstWaiting_.end());
+            setBurstReference(reference);
         }
         
-        // Compute detail mask if requested
-        if (params_.computeDetailMask) {
-            reportProgress(progressCallback, ProcessingStage::COMPUTING_EDGES, 0, "Computing edges...");
-            
-            GrayImage luminance;
-            rgbToLuminance(result.mergedImage, luminance);
-            
-            reportProgress(progressCallback, ProcessingStage::GENERATING_MASK, 0.5f, "Generating detail mask...");
-            
-            EdgeDetector detector(params_.detailMask);
-            detector.detectDetails(luminance, result.detailMask);
+        burstFrames_.resize(numFrames);
+        burstAlignments_.resize(numFrames);
+        if (!burstOriginals_.empty()) {
+            burstOriginals_.resize(numFrames);
         }
-        
-        result.success = true;
-        
-        auto endTime = std::chrono::high_resolution_clock::now();
-        result.processingTimeMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
-        
-        // Store result for later retrieval
-        lastResult_ = result;
-        
-        reportProgress(progressCallback, ProcessingStage::COMPLETE, 1.0f, "Complete");
-        
-        LOGI("Burst processing complete: %.1f ms, %d frames used",
-             result.processingTimeMs, result.numFramesUsed);
-        
+        burstAligner_.reset();
+        burstFlow_.reset();
+        burstAnalysis_.reset();
+        burstGray_.clear();
+        
+        LOGI("Merging incremental burst: %d frames, reference %d", numFrames, burstReference_);
+        mergeAligned(burstOriginals_, burstFrames_, burstAlignments_, burstReference_,
+                     result, progressCallback, startTime);
     } catch (const std::exception& e) {
         result.errorMessage = std::string("Processing failed: ") + e.what();
         reportProgress(progressCallback, ProcessingStage::ERROR, 0, result.errorMessage.c_str());
         LOGE("Burst processing failed: %s", e.what());
     }
+    
+    closeBurst();
 }
 
 } // namespace ultradetail
@@ -11,10 +11,15 @@
 #include "common.h"
 #include "yuv_converter.h"
 #include "alignment.h"
+#include "frame_analysis_cache.h"
 #include "optical_flow.h"
 #include "merge.h"
 #include "edge_detection.h"
 #include "mfsr.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <vector>
 #include <functional>
 #include <string>
@@ -127,6 +132,45 @@ public:
         ProgressCallback progressCallback = nullptr
     );
     
+    /**
+     * Start an incremental burst
+     * 
+     * Frames are then handed over one at a time with pushFrame() while the
+     * camera is still capturing; each is converted and aligned against the
+     * reference on the shared pool as it arrives, so only the merge is left
+     * for finish(). The reference is chosen from expectedFrames exactly as
+     * process() would; frames that arrive before it wait for it.
+     * 
+     * @param expectedFrames Number of frames the caller intends to push (>= 2)
+     * @return false if a burst is already open or expectedFrames < 2
+     */
+    bool beginBurst(int expectedFrames);
+    
+    /**
+     * Add the next frame of the open burst
+     * 
+     * The planes are copied before returning, so the camera image can be
+     * released immediately. Conversion and alignment run in the background.
+     * 
+     * @return false if no burst is open, the burst is full or the size differs
+     */
+    bool pushFrame(const YUVFrame& frame);
+    
+    /**
+     * Wait for the pushed frames to be aligned, then merge them
+     * 
+     * Progress is reported from the calling thread only. If fewer frames than
+     * expected were pushed and the reference never arrived, the middle pushed
+     * frame becomes the reference. result.processingTimeMs covers this call.
+     * 
+     * @param result Output processing result
+     * @param progressCallback Optional progress callback
+     */
+    void finish(
+        BurstProcessingResult& result,
+        ProgressCallback progressCallback = nullptr
+    );
+    
     /**
      * Get current processing stage
      */
@@ -160,9 +204,82 @@ public:
 private:
     BurstProcessorParams params_;
     ProcessingStage currentStage_;
-    bool cancelled_;
+    std::atomic<bool> cancelled_;      // Also read by background ingestion
     BurstProcessingResult lastResult_;  // Store last result for retrieval
     
+    // Incremental burst state (beginBurst / pushFrame / finish). The vectors
+    // are sized by beginBurst and each slot is only touched by the ingestion
+    // queue until finish() has waited for it.
+    bool burstOpen_ = false;
+    int burstExpected_ = 0;
+    int burstPushed_ = 0;
+    int burstWidth_ = 0;
+    int burstHeight_ = 0;
+    int burstReference_ = -1;
+    bool burstReferenceReady_ = false;
+    std::vector<RGBImage> burstFrames_;         // Warped once aligned
+    std::vector<RGBImage> burstOriginals_;      // Unwarped copies, only kept for MFSR
+    std::vector<GrayImage> burstGray_;
+    std::unique_ptr<FrameAnalysisCache> burstAnalysis_;  // Pyramids of burstGray_, shared by both aligners
+    std::vector<FrameAlignment> burstAlignments_;
+    std::vector<int> burstWaiting_;             // Converted frames waiting for the reference
+    std::unique_ptr<TileAligner> burstAligner_;
+    std::unique_ptr<DenseOpticalFlow> burstFlow_;
+    std::unique_ptr<SerialTaskQueue> burstQueue_;
+    
+    /**
+     * Background step for one pushed frame: convert, then align or wait for the reference
+     */
+    void ingestFrame(int index, const OwnedYUVFrame& yuv);
+    
+    /**
+     * Prepare the aligners from the reference frame and align the frames waiting for it
+     */
+    void setBurstReference(int index);
+    
+    /**
+     * Align one converted burst frame and warp it in place
+     */
+    void alignBurstFrame(int index);
+    
+    /**
+     * Release all incremental burst state
+     */
+    void closeBurst();
+    
+    /**
+     * Align one frame to a prepared reference and warp its RGB in place
+     * 
+     * @param aligner Tile aligner holding the reference (also the dense-flow fallback)
+     * @param flowEstimator Dense flow estimator holding the reference, or nullptr for tile-based
+     * @param analysis Cache the aligners were given the reference from
+     * @param index Frame id in the cache; its analysis is released afterwards
+     */
+    void alignFrame(
+        TileAligner& aligner,
+        DenseOpticalFlow* flowEstimator,
+        FrameAnalysisCache& analysis,
+        int index,
+        RGBImage& rgb,
+        FrameAlignment& alignment
+    );
+    
+    /**
+     * Merge aligned frames and compute the detail mask (shared tail of processRGB and finish)
+     * 
+     * @param originalFrames Unwarped frames for MFSR (may be empty when MFSR is disabled)
+     * @param alignedFrames Frames warped to the reference
+     */
+    void mergeAligned(
+        const std::vector<RGBImage>& originalFrames,
+        const std::vector<RGBImage>& alignedFrames,
+        const std::vector<FrameAlignment>& alignments,
+        int refIndex,
+        BurstProcessingResult& result,
+        ProgressCallback progressCallback,
+        std::chrono::high_resolution_clock::time_point startTime
+    );
+    
     /**
      * Convert YUV frames to RGB
      */
@@ -188,7 +305,7 @@ private:
      * Align frames using tile-based method (original HDR+ style)
      */
     void alignFramesTileBased(
-        const std::vector<GrayImage>& grayFrames,
+        FrameAnalysisCache& analysis,
         std::vector<RGBImage>& rgbFrames,
         std::vector<FrameAlignment>& alignments,
         int referenceIndex,
@@ -199,7 +316,7 @@ private:
      * Align frames using dense optical flow
      */
     void alignFramesDenseFlow(
-        const std::vector<GrayImage>& grayFrames,
+        FrameAnalysisCache& analysis,
         std::vector<RGBImage>& rgbFrames,
         std::vector<FrameAlignment>& alignments,
         int referenceIndex,
@@ -13,14 +13,14 @@
 #include <algorithm>
 #include <vector>
 #include <memory>
-#include <android/log.h>
+#include "logging.h"
 
-// Logging macros
+// Logging macros (sink selected at runtime, see logging.h)
 #define LOG_TAG "UltraDetail"
-#define LOGD(...) __android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__)
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGD(...) ::ultradetail::logPrint(::ultradetail::LogLevel::DEBUG, LOG_TAG, __VA_ARGS__)
+#define LOGI(...) ::ultradetail::logPrint(::ultradetail::LogLevel::INFO, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) ::ultradetail::logPrint(::ultradetail::LogLevel::WARN, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) ::ultradetail::logPrint(::ultradetail::LogLevel::ERROR, LOG_TAG, __VA_ARGS__)
 
 // Debug/Release configuration
 // Set to 0 for release builds to disable expensive diagnostics
@@ -164,11 +164,57 @@ public:
     }
 };
 
+/**
+ * Non-owning, read-only view of pixels held elsewhere (e.g. a locked Bitmap)
+ * 
+ * The stride is in bytes so that views can wrap buffers whose row pitch is
+ * not a multiple of the pixel size. The pixels must outlive the view.
+ */
+template<typename T>
+class ImageView {
+public:
+    const T* data;
+    int width;
+    int height;
+    size_t strideBytes;
+    
+    ImageView() : data(nullptr), width(0), height(0), strideBytes(0) {}
+    
+    ImageView(const T* d, int w, int h, size_t strideBytes_)
+        : data(d), width(w), height(h), strideBytes(strideBytes_) {}
+    
+    ImageView(const ImageBuffer<T>& image)
+        : data(image.data.data()), width(image.width), height(image.height),
+          strideBytes(static_cast<size_t>(image.stride) * sizeof(T)) {}
+    
+    const T* row(int y) const {
+        return reinterpret_cast<const T*>(reinterpret_cast<const uint8_t*>(data) + y * strideBytes);
+    }
+    
+    const T& at(int x, int y) const {
+        return row(y)[x];
+    }
+    
+    bool empty() const {
+        return data == nullptr || width <= 0 || height <= 0;
+    }
+};
+
+/**
+ * 8-bit RGBA pixel (Android ARGB_8888 memory order: R, G, B, A)
+ */
+struct RGBA8Pixel {
+    uint8_t r, g, b, a;
+};
+
 // Type aliases
 using GrayImage = ImageBuffer<float>;
 using RGBImage = ImageBuffer<RGBPixel>;
 using ByteImage = ImageBuffer<uint8_t>;
 using MotionField = ImageBuffer<MotionVector>;
+using GrayView = ImageView<float>;
+using RGBView = ImageView<RGBPixel>;
+using RGBA8View = ImageView<RGBA8Pixel>;
 
 /**
  * Clamp value to range [min, max]
@@ -8,6 +8,7 @@
  */
 
 #include "deghost_enhance.h"
+#include "pyramid.h"
 #include "common.h"
 #include <algorithm>
 #include <cmath>
@@ -207,7 +208,7 @@ std::vector<DeghostEnhancer::PyramidLevel> DeghostEnhancer::buildGaussianPyramid
     // Build subsequent levels by downsampling
     for (int i = 1; i < levels; ++i) {
         PyramidLevel level;
-        level.image = downsample2x(pyramid[i - 1].image);
+        gaussianDownsample2x(pyramid[i - 1].image, level.image);
         level.width = level.image.width;
         level.height = level.image.height;
         pyramid.push_back(std::move(level));
@@ -268,43 +269,6 @@ RGBImage DeghostEnhancer::reconstructFromLaplacian(
     return result;
 }
 
-RGBImage DeghostEnhancer::downsample2x(const RGBImage& image) {
-    int newWidth = image.width / 2;
-    int newHeight = image.height / 2;
-    
-    if (newWidth < 1) newWidth = 1;
-    if (newHeight < 1) newHeight = 1;
-    
-    RGBImage result(newWidth, newHeight);
-    
-    for (int y = 0; y < newHeight; ++y) {
-        for (int x = 0; x < newWidth; ++x) {
-            int sx = x * 2;
-            int sy = y * 2;
-            
-            // 2x2 box filter
-            float r = 0, g = 0, b = 0;
-            int count = 0;
-            
-            for (int dy = 0; dy < 2; ++dy) {
-                for (int dx = 0; dx < 2; ++dx) {
-                    int px = std::min(sx + dx, image.width - 1);
-                    int py = std::min(sy + dy, image.height - 1);
-                    const RGBPixel& p = image.at(px, py);
-                    r += p.r;
-                    g += p.g;
-                    b += p.b;
-                    count++;
-                }
-            }
-            
-            result.at(x, y) = RGBPixel(r / count, g / count, b / count);
-        }
-    }
-    
-    return result;
-}
-
 RGBImage DeghostEnhancer::upsample2x(const RGBImage& image, int targetWidth, int targetHeight) {
     RGBImage result(targetWidth, targetHeight);
     
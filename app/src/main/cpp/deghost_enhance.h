@@ -186,11 +186,6 @@ private:
         const PyramidLevel& base
     );
     
-    /**
-     * Downsample image by 2x using Gaussian blur
-     */
-    RGBImage downsample2x(const RGBImage& image);
-    
     /**
      * Upsample image by 2x using bilinear interpolation
      */
@@ -5,12 +5,41 @@
  */
 
 #include "drizzle.h"
-#include "neon_utils.h"
+#include "thread_pool.h"
 #include <cmath>
 #include <algorithm>
+#include <functional>
 
 namespace ultradetail {
 
+/**
+ * Run body(iy0, iy1) over stripes of input rows on the shared thread pool.
+ *
+ * Drops from one input row land on a few neighbouring output rows, so stripes
+ * are processed in two phases (even, then odd). Stripes running concurrently
+ * are a whole stripe apart and never write the same accumulator.
+ */
+static void forEachInputStripe(
+    int inHeight,
+    int scale,
+    float dropRadius,
+    const std::function<void(int, int)>& body
+) {
+    // Output rows touched by one stripe extend dropRadius + 1 beyond it on each side
+    int haloRows = static_cast<int>(std::ceil((2.0f * dropRadius + 2.0f) / scale)) + 1;
+    int stripeRows = std::max(8, haloRows);
+    int numStripes = (inHeight + stripeRows - 1) / stripeRows;
+    
+    ThreadPool& pool = ThreadPool::instance();
+    for (int phase = 0; phase < 2; ++phase) {
+        int count = (numStripes - phase + 1) / 2;
+        pool.parallelFor(0, count, [&](int k) {
+            int iy0 = (2 * k + phase) * stripeRows;
+            body(iy0, std::min(iy0 + stripeRows, inHeight));
+        });
+    }
+}
+
 DrizzleProcessor::DrizzleProcessor(const DrizzleParams& params)
     : params_(params) {
 }
@@ -126,6 +155,8 @@ DrizzleResult DrizzleProcessor::process(
          frames.size(), inWidth, inHeight, result.outputWidth, result.outputHeight,
          scale, params_.pixfrac);
     
+    const float dropRadius = params_.pixfrac * scale * 0.5f;
+    
     // Process each frame
     for (size_t f = 0; f < frames.size(); ++f) {
         const RGBImage& frame = frames[f];
@@ -137,47 +168,59 @@ DrizzleResult DrizzleProcessor::process(
         }
         
         // Drizzle each input pixel
-        for (int iy = 0; iy < inHeight; ++iy) {
-            for (int ix = 0; ix < inWidth; ++ix) {
-                // Apply sub-pixel shift
-                float shiftedX = ix + shift.dx;
-                float shiftedY = iy + shift.dy;
-                
-                // Skip if shifted outside bounds
-                if (shiftedX < -0.5f || shiftedX >= inWidth - 0.5f ||
-                    shiftedY < -0.5f || shiftedY >= inHeight - 0.5f) {
-                    continue;
+        forEachInputStripe(inHeight, scale, dropRadius, [&](int iy0, int iy1) {
+            for (int iy = iy0; iy < iy1; ++iy) {
+                for (int ix = 0; ix < inWidth; ++ix) {
+                    // Apply sub-pixel shift
+                    float shiftedX = ix + shift.dx;
+                    float shiftedY = iy + shift.dy;
+                    
+                    // Skip if shifted outside bounds
+                    if (shiftedX < -0.5f || shiftedX >= inWidth - 0.5f ||
+                        shiftedY < -0.5f || shiftedY >= inHeight - 0.5f) {
+                        continue;
+                    }
+                    
+                    drizzlePixel(
+                        accum,
+                        result.outputWidth, result.outputHeight,
+                        shiftedX, shiftedY,
+                        frame.at(ix, iy),
+                        shift.weight
+                    );
                 }
-                
-                drizzlePixel(
-                    accum,
-                    result.outputWidth, result.outputHeight,
-                    shiftedX, shiftedY,
-                    frame.at(ix, iy),
-                    shift.weight
-                );
             }
-        }
+        });
     }
     
     // Normalize accumulators to output
     result.output.resize(result.outputWidth, result.outputHeight);
     result.weightMap.resize(result.outputWidth, result.outputHeight);
     
-    float totalCoverage = 0;
-    int coveredPixels = 0;
+    // Per-row partial sums keep the coverage statistics independent of scheduling
+    std::vector<float> rowCoverage(result.outputHeight, 0.0f);
+    std::vector<int> rowCovered(result.outputHeight, 0);
     
-    for (int y = 0; y < result.outputHeight; ++y) {
-        for (int x = 0; x < result.outputWidth; ++x) {
-            int idx = y * result.outputWidth + x;
-            result.output.at(x, y) = accum[idx].normalize();
-            result.weightMap.at(x, y) = accum[idx].sumWeight;
-            
-            if (accum[idx].sumWeight > 0) {
-                totalCoverage += accum[idx].sumWeight;
-                coveredPixels++;
+    ThreadPool::instance().parallelForRows(0, result.outputHeight, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < result.outputWidth; ++x) {
+                int idx = y * result.outputWidth + x;
+                result.output.at(x, y) = accum[idx].normalize();
+                result.weightMap.at(x, y) = accum[idx].sumWeight;
+                
+                if (accum[idx].sumWeight > 0) {
+                    rowCoverage[y] += accum[idx].sumWeight;
+                    rowCovered[y]++;
+                }
             }
         }
+    });
+    
+    float totalCoverage = 0;
+    int coveredPixels = 0;
+    for (int y = 0; y < result.outputHeight; ++y) {
+        totalCoverage += rowCoverage[y];
+        coveredPixels += rowCovered[y];
     }
     
     result.avgCoverage = coveredPixels > 0 ? totalCoverage / coveredPixels : 0;
@@ -212,54 +255,68 @@ DrizzleResult DrizzleProcessor::processGray(
     std::vector<float> accumSum(outSize, 0);
     std::vector<float> accumWeight(outSize, 0);
     
+    const float dropRadius = params_.pixfrac * scale * 0.5f;
+    
     // Process each frame
     for (size_t f = 0; f < frames.size(); ++f) {
         const GrayImage& frame = frames[f];
         const SubPixelShift& shift = shifts[f];
         
-        for (int iy = 0; iy < inHeight; ++iy) {
-            for (int ix = 0; ix < inWidth; ++ix) {
-                float shiftedX = ix + shift.dx;
-                float shiftedY = iy + shift.dy;
-                
-                if (shiftedX < -0.5f || shiftedX >= inWidth - 0.5f ||
-                    shiftedY < -0.5f || shiftedY >= inHeight - 0.5f) {
-                    continue;
+        forEachInputStripe(inHeight, scale, dropRadius, [&](int iy0, int iy1) {
+            for (int iy = iy0; iy < iy1; ++iy) {
+                for (int ix = 0; ix < inWidth; ++ix) {
+                    float shiftedX = ix + shift.dx;
+                    float shiftedY = iy + shift.dy;
+                    
+                    if (shiftedX < -0.5f || shiftedX >= inWidth - 0.5f ||
+                        shiftedY < -0.5f || shiftedY >= inHeight - 0.5f) {
+                        continue;
+                    }
+                    
+                    drizzlePixelGray(
+                        accumSum, accumWeight,
+                        result.outputWidth, result.outputHeight,
+                        shiftedX, shiftedY,
+                        frame.at(ix, iy),
+                        shift.weight
+                    );
                 }
-                
-                drizzlePixelGray(
-                    accumSum, accumWeight,
-                    result.outputWidth, result.outputHeight,
-                    shiftedX, shiftedY,
-                    frame.at(ix, iy),
-                    shift.weight
-                );
             }
-        }
+        });
     }
     
     // Convert to RGB output (grayscale)
     result.output.resize(result.outputWidth, result.outputHeight);
     result.weightMap.resize(result.outputWidth, result.outputHeight);
     
-    float totalCoverage = 0;
-    int coveredPixels = 0;
+    // Per-row partial sums keep the coverage statistics independent of scheduling
+    std::vector<float> rowCoverage(result.outputHeight, 0.0f);
+    std::vector<int> rowCovered(result.outputHeight, 0);
     
-    for (int y = 0; y < result.outputHeight; ++y) {
-        for (int x = 0; x < result.outputWidth; ++x) {
-            int idx = y * result.outputWidth + x;
-            float w = accumWeight[idx];
-            result.weightMap.at(x, y) = w;
-            
-            if (w > 0) {
-                float val = clamp(accumSum[idx] / w, 0.0f, 1.0f);
-                result.output.at(x, y) = RGBPixel(val, val, val);
-                totalCoverage += w;
-                coveredPixels++;
-            } else {
-                result.output.at(x, y) = RGBPixel(0, 0, 0);
+    ThreadPool::instance().parallelForRows(0, result.outputHeight, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < result.outputWidth; ++x) {
+                int idx = y * result.outputWidth + x;
+                float w = accumWeight[idx];
+                result.weightMap.at(x, y) = w;
+                
+                if (w > 0) {
+                    float val = clamp(accumSum[idx] / w, 0.0f, 1.0f);
+                    result.output.at(x, y) = RGBPixel(val, val, val);
+                    rowCoverage[y] += w;
+                    rowCovered[y]++;
+                } else {
+                    result.output.at(x, y) = RGBPixel(0, 0, 0);
+                }
             }
         }
+    });
+    
+    float totalCoverage = 0;
+    int coveredPixels = 0;
+    for (int y = 0; y < result.outputHeight; ++y) {
+        totalCoverage += rowCoverage[y];
+        coveredPixels += rowCovered[y];
     }
     
     result.avgCoverage = coveredPixels > 0 ? totalCoverage / coveredPixels : 0;
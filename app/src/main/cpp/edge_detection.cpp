@@ -1,12 +1,12 @@
 /**
  * edge_detection.cpp - Edge detection and detail mask implementation
  * 
- * NEON-optimized Sobel/Scharr edge detection with tile-based
+ * SIMD Sobel/Scharr edge detection with tile-based
  * detail classification.
  */
 
 #include "edge_detection.h"
-#include "neon_utils.h"
+#include "simd.h"
 #include <cmath>
 
 namespace ultradetail {
@@ -69,44 +69,7 @@ void EdgeDetector::applySobel(const GrayImage& input, GrayImage& gradX, GrayImag
         float* gxRow = gradX.row(y);
         float* gyRow = gradY.row(y);
         
-#ifdef USE_NEON
-        int x = 1;
-        for (; x + 3 < width - 1; x += 4) {
-            // Load 6 values per row for 4 output pixels
-            float32x4_t gx = neon::sobel_x_3x3(row0 + x - 1, row1 + x - 1, row2 + x - 1);
-            float32x4_t gy = neon::sobel_y_3x3(row0 + x - 1, row1 + x - 1, row2 + x - 1);
-            
-            vst1q_f32(gxRow + x, gx);
-            vst1q_f32(gyRow + x, gy);
-        }
-        
-        // Handle remaining pixels
-        for (; x < width - 1; ++x) {
-            float gx = 0, gy = 0;
-            for (int ky = -1; ky <= 1; ++ky) {
-                for (int kx = -1; kx <= 1; ++kx) {
-                    float val = input.at(x + kx, y + ky);
-                    gx += val * SOBEL_X[ky + 1][kx + 1];
-                    gy += val * SOBEL_Y[ky + 1][kx + 1];
-                }
-            }
-            gxRow[x] = gx;
-            gyRow[x] = gy;
-        }
-#else
-        for (int x = 1; x < width - 1; ++x) {
-            float gx = 0, gy = 0;
-            for (int ky = -1; ky <= 1; ++ky) {
-                for (int kx = -1; kx <= 1; ++kx) {
-                    float val = input.at(x + kx, y + ky);
-                    gx += val * SOBEL_X[ky + 1][kx + 1];
-                    gy += val * SOBEL_Y[ky + 1][kx + 1];
-                }
-            }
-            gxRow[x] = gx;
-            gyRow[x] = gy;
-        }
-#endif
+        simd::rowKernels().sobel3x3(row0 + 1, row1 + 1, row2 + 1, gxRow + 1, gyRow + 1, width - 2);
     }
     
     // Handle borders (set to zero)
@@ -211,39 +174,10 @@ void EdgeDetector::computeMagnitude(const GrayImage& gradX, const GrayImage& gra
     
     magnitude = GrayImage(width, height);
     
-#ifdef USE_NEON
+    const simd::RowKernels& kernels = simd::rowKernels();
     for (int y = 0; y < height; ++y) {
-        const float* gxRow = gradX.row(y);
-        const float* gyRow = gradY.row(y);
-        float* magRow = magnitude.row(y);
-        
-        int x = 0;
-        for (; x + 3 < width; x += 4) {
-            float32x4_t gx = vld1q_f32(gxRow + x);
-            float32x4_t gy = vld1q_f32(gyRow + x);
-            float32x4_t mag = neon::gradient_magnitude(gx, gy);
-            vst1q_f32(magRow + x, mag);
-        }
-        
-        for (; x < width; ++x) {
-            float gx = gxRow[x];
-            float gy = gyRow[x];
-            magRow[x] = std::sqrt(gx * gx + gy * gy);
-        }
-    }
-#else
-    for (int y = 0; y < height; ++y) {
-        const float* gxRow = gradX.row(y);
-        const float* gyRow = gradY.row(y);
-        float* magRow = magnitude.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            float gx = gxRow[x];
-            float gy = gyRow[x];
-            magRow[x] = std::sqrt(gx * gx + gy * gy);
-        }
+        kernels.magnitude(gradX.row(y), gradY.row(y), magnitude.row(y), width);
     }
-#endif
 }
 
 void EdgeDetector::computeEdgeMagnitude(const GrayImage& luminance, GrayImage& output) {
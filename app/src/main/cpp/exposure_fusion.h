@@ -120,26 +120,11 @@ private:
      */
     RGBImage collapsePyramid(const std::vector<RGBImage>& pyramid);
     
-    /**
-     * Downsample image by 2x with Gaussian blur
-     */
-    RGBImage downsample(const RGBImage& image);
-    
-    /**
-     * Downsample grayscale image by 2x
-     */
-    GrayImage downsampleGray(const GrayImage& image);
-    
     /**
      * Upsample image by 2x with interpolation
      */
     RGBImage upsample(const RGBImage& image, int targetWidth, int targetHeight);
     
-    /**
-     * Apply Gaussian blur
-     */
-    RGBImage gaussianBlur(const RGBImage& image, float sigma);
-    
     /**
      * Apply Gaussian blur to grayscale
      */
@@ -0,0 +1,553 @@
+/**
+ * fft.cpp - FFT engine implementation
+ */
+
+#include "fft.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#undef LOG_TAG
+#define LOG_TAG "FFT"
+
+namespace ultradetail {
+
+// Columns transformed together in the 2D column pass (8 complex = one 64-byte line)
+static const int kColumnBlock = 8;
+
+/**
+ * e^(-2*pi*i * k / n), computed in double precision
+ */
+static std::complex<float> twiddle(int k, int n) {
+    double angle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(n);
+    return std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+}
+
+// FFTPlan implementation
+
+/**
+ * Power of 2, >= 1
+ */
+static bool isPowerOf2(int n) {
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+FFTPlan::FFTPlan(int n)
+    : n_(n), leadingRadix2_(false) {
+
+    // Rounding up would have callers overrun buffers sized for n
+    if (!isPowerOf2(n)) {
+        LOGE("FFTPlan: size %d is not a power of 2, plan left empty", n);
+        n_ = 0;
+        return;
+    }
+
+    int log2n = 0;
+    while ((1 << log2n) < n) ++log2n;
+
+    // Bit-reversal permutation, stored as the swaps to perform
+    for (int i = 0; i < n; ++i) {
+        int r = 0;
+        for (int b = 0; b < log2n; ++b) {
+            r |= ((i >> b) & 1) << (log2n - 1 - b);
+        }
+        if (i < r) {
+            swaps_.emplace_back(i, r);
+        }
+    }
+
+    // Radix-4 stages combine four size-m sub-transforms into one of size 4m
+    leadingRadix2_ = (log2n & 1) != 0;
+    for (int m = leadingRadix2_ ? 2 : 1; 4 * m <= n; m *= 4) {
+        stageOffsets_.push_back(static_cast<int>(twiddles_.size()));
+        for (int p = 1; p <= 3; ++p) {
+            for (int j = 0; j < m; ++j) {
+                twiddles_.push_back(twiddle(p * j, 4 * m));
+            }
+        }
+    }
+}
+
+const FFTPlan& FFTPlan::forSize(int n) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<FFTPlan>> plans;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<FFTPlan>& plan = plans[n];
+    if (!plan) {
+        plan = std::make_unique<FFTPlan>(n);
+    }
+    return *plan;
+}
+
+/**
+ * Radix-4 DIT butterflies for one stage, j in [j0, m) of every block
+ *
+ * With a0..a3 the four consecutive size-m sub-transforms (bit-reversed order),
+ * x1 = W^2j a1, x2 = W^j a2, x3 = W^3j a3 and W = e^(-2*pi*i / 4m):
+ *   out[j]      = (a0 + x1) + (x2 + x3)
+ *   out[j + m]  = (a0 - x1) - i (x2 - x3)
+ *   out[j + 2m] = (a0 + x1) - (x2 + x3)
+ *   out[j + 3m] = (a0 - x1) + i (x2 - x3)
+ */
+static void radix4Scalar(float* d, int m, int j0, const float* w1, const float* w2, const float* w3) {
+    for (int j = j0; j < m; ++j) {
+        float* p0 = d + 2 * j;
+        float* p1 = p0 + 2 * m;
+        float* p2 = p1 + 2 * m;
+        float* p3 = p2 + 2 * m;
+
+        float x1r = w2[2 * j] * p1[0] - w2[2 * j + 1] * p1[1];
+        float x1i = w2[2 * j] * p1[1] + w2[2 * j + 1] * p1[0];
+        float x2r = w1[2 * j] * p2[0] - w1[2 * j + 1] * p2[1];
+        float x2i = w1[2 * j] * p2[1] + w1[2 * j + 1] * p2[0];
+        float x3r = w3[2 * j] * p3[0] - w3[2 * j + 1] * p3[1];
+        float x3i = w3[2 * j] * p3[1] + w3[2 * j + 1] * p3[0];
+
+        float s0r = p0[0] + x1r, s0i = p0[1] + x1i;
+        float d0r = p0[0] - x1r, d0i = p0[1] - x1i;
+        float s1r = x2r + x3r, s1i = x2i + x3i;
+        float d1r = x2r - x3r, d1i = x2i - x3i;
+
+        p0[0] = s0r + s1r;  p0[1] = s0i + s1i;
+        p2[0] = s0r - s1r;  p2[1] = s0i - s1i;
+        // -i * (d1r + i d1i) = d1i - i d1r
+        p1[0] = d0r + d1i;  p1[1] = d0i - d1r;
+        p3[0] = d0r - d1i;  p3[1] = d0i + d1r;
+    }
+}
+
+/**
+ * SIMD radix-4 butterflies: four j at a time, complex values deinterleaved
+ * into real and imaginary vectors
+ */
+static int radix4Simd(float* d, int m, const float* w1, const float* w2, const float* w3) {
+    using simd::f32x4;
+    int j = 0;
+    for (; j + 3 < m; j += 4) {
+        float* p0 = d + 2 * j;
+        float* p1 = p0 + 2 * m;
+        float* p2 = p1 + 2 * m;
+        float* p3 = p2 + 2 * m;
+
+        f32x4 a0r, a0i, a1r, a1i, a2r, a2i, a3r, a3i;
+        f32x4 t1r, t1i, t2r, t2i, t3r, t3i;
+        simd::loadDeinterleaved2(p0, a0r, a0i);
+        simd::loadDeinterleaved2(p1, a1r, a1i);
+        simd::loadDeinterleaved2(p2, a2r, a2i);
+        simd::loadDeinterleaved2(p3, a3r, a3i);
+        simd::loadDeinterleaved2(w1 + 2 * j, t1r, t1i);
+        simd::loadDeinterleaved2(w2 + 2 * j, t2r, t2i);
+        simd::loadDeinterleaved2(w3 + 2 * j, t3r, t3i);
+
+        f32x4 x1r = t2r * a1r - t2i * a1i, x1i = t2r * a1i + t2i * a1r;
+        f32x4 x2r = t1r * a2r - t1i * a2i, x2i = t1r * a2i + t1i * a2r;
+        f32x4 x3r = t3r * a3r - t3i * a3i, x3i = t3r * a3i + t3i * a3r;
+
+        f32x4 s0r = a0r + x1r, s0i = a0i + x1i;
+        f32x4 d0r = a0r - x1r, d0i = a0i - x1i;
+        f32x4 s1r = x2r + x3r, s1i = x2i + x3i;
+        f32x4 d1r = x2r - x3r, d1i = x2i - x3i;
+
+        simd::storeInterleaved2(p0, s0r + s1r, s0i + s1i);
+        simd::storeInterleaved2(p2, s0r - s1r, s0i - s1i);
+        simd::storeInterleaved2(p1, d0r + d1i, d0i - d1r);
+        simd::storeInterleaved2(p3, d0r - d1i, d0i + d1r);
+    }
+    return j;
+}
+
+void FFTPlan::transform(std::complex<float>* data) const {
+    for (const auto& s : swaps_) {
+        std::swap(data[s.first], data[s.second]);
+    }
+
+    float* d = reinterpret_cast<float*>(data);
+    const int n = n_;
+
+    // Odd log2 size: size-2 butterflies (unit twiddle) before the radix-4 stages
+    if (leadingRadix2_) {
+        for (int i = 0; i < 2 * n; i += 4) {
+            float ar = d[i], ai = d[i + 1];
+            float br = d[i + 2], bi = d[i + 3];
+            d[i] = ar + br;      d[i + 1] = ai + bi;
+            d[i + 2] = ar - br;  d[i + 3] = ai - bi;
+        }
+    }
+
+    int stage = 0;
+    for (int m = leadingRadix2_ ? 2 : 1; 4 * m <= n; m *= 4, ++stage) {
+        const float* w1 = reinterpret_cast<const float*>(twiddles_.data() + stageOffsets_[stage]);
+        const float* w2 = w1 + 2 * m;
+        const float* w3 = w2 + 2 * m;
+
+        for (int block = 0; block < n; block += 4 * m) {
+            float* blockData = d + 2 * block;
+            int j0 = radix4Simd(blockData, m, w1, w2, w3);
+            radix4Scalar(blockData, m, j0, w1, w2, w3);
+        }
+    }
+}
+
+void FFTPlan::forward(std::complex<float>* data) const {
+    transform(data);
+}
+
+void FFTPlan::inverse(std::complex<float>* data) const {
+    if (n_ == 0) return;
+
+    // IFFT(x) = conj(FFT(conj(x))) / n reuses the forward twiddles
+    const float scale = 1.0f / n_;
+    for (int i = 0; i < n_; ++i) {
+        data[i] = std::conj(data[i]);
+    }
+    transform(data);
+    for (int i = 0; i < n_; ++i) {
+        data[i] = std::complex<float>(data[i].real() * scale, -data[i].imag() * scale);
+    }
+}
+
+void FFTPlan::forwardBatch(std::complex<float>* data, int count) const {
+    for (int i = 0; i < count; ++i) {
+        forward(data + i * n_);
+    }
+}
+
+void FFTPlan::inverseBatch(std::complex<float>* data, int count) const {
+    for (int i = 0; i < count; ++i) {
+        inverse(data + i * n_);
+    }
+}
+
+// RealFFT2D implementation
+
+RealFFT2D::RealFFT2D(int size)
+    : size_(size >= 2 && isPowerOf2(size) ? size : 0),
+      rowPlan_(FFTPlan::forSize(std::max(1, size_ / 2))),
+      columnPlan_(FFTPlan::forSize(std::max(1, size_))) {
+
+    if (size_ == 0) {
+        LOGE("RealFFT2D: size %d is not a power of 2 >= 2, plan left empty", size);
+        return;
+    }
+
+    realTwiddles_.resize(size_ / 2 + 1);
+    for (int k = 0; k <= size_ / 2; ++k) {
+        realTwiddles_[k] = twiddle(k, size_);
+    }
+}
+
+const RealFFT2D& RealFFT2D::forSize(int size) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<RealFFT2D>> plans;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<RealFFT2D>& plan = plans[size];
+    if (!plan) {
+        plan = std::make_unique<RealFFT2D>(size);
+    }
+    return *plan;
+}
+
+void RealFFT2D::transformColumns(std::complex<float>* spectrum, bool inverse) const {
+    const int n = size_;
+    const int width = spectrumWidth();
+
+    // Blocked transpose: gather kColumnBlock columns into contiguous rows,
+    // transform them, and scatter back, touching whole cache lines per row
+    std::vector<std::complex<float>> block(kColumnBlock * n);
+
+    for (int c0 = 0; c0 < width; c0 += kColumnBlock) {
+        const int cols = std::min(kColumnBlock, width - c0);
+
+        for (int y = 0; y < n; ++y) {
+            const std::complex<float>* src = spectrum + y * width + c0;
+            for (int c = 0; c < cols; ++c) {
+                block[c * n + y] = src[c];
+            }
+        }
+
+        if (inverse) {
+            columnPlan_.inverseBatch(block.data(), cols);
+        } else {
+            columnPlan_.forwardBatch(block.data(), cols);
+        }
+
+        for (int y = 0; y < n; ++y) {
+            std::complex<float>* dst = spectrum + y * width + c0;
+            for (int c = 0; c < cols; ++c) {
+                dst[c] = block[c * n + y];
+            }
+        }
+    }
+}
+
+void RealFFT2D::forward(const float* input, std::complex<float>* spectrum) const {
+    if (size_ == 0) return;
+
+    const int n = size_;
+    const int h = n / 2;
+    const int width = spectrumWidth();
+
+    // Rows: pack even/odd samples as one half-length complex sequence,
+    // transform, then split into the h + 1 non-redundant bins
+    for (int y = 0; y < n; ++y) {
+        std::complex<float>* row = spectrum + y * width;
+        const float* src = input + y * n;
+        for (int k = 0; k < h; ++k) {
+            row[k] = std::complex<float>(src[2 * k], src[2 * k + 1]);
+        }
+
+        rowPlan_.forward(row);
+
+        std::complex<float> z0 = row[0];
+        row[0] = std::complex<float>(z0.real() + z0.imag(), 0.0f);
+        row[h] = std::complex<float>(z0.real() - z0.imag(), 0.0f);
+
+        for (int k = 1; k <= h / 2; ++k) {
+            std::complex<float> zk = row[k];
+            std::complex<float> zhk = std::conj(row[h - k]);
+
+            // E = (Z[k] + conj Z[h-k]) / 2, O = -i (Z[k] - conj Z[h-k]) / 2
+            std::complex<float> e = 0.5f * (zk + zhk);
+            std::complex<float> diff = zk - zhk;
+            std::complex<float> o(0.5f * diff.imag(), -0.5f * diff.real());
+            std::complex<float> wo = realTwiddles_[k] * o;
+
+            row[k] = e + wo;
+            row[h - k] = std::conj(e - wo);
+        }
+    }
+
+    transformColumns(spectrum, false);
+}
+
+void RealFFT2D::inverse(std::complex<float>* spectrum, float* output) const {
+    if (size_ == 0) return;
+
+    const int n = size_;
+    const int h = n / 2;
+    const int width = spectrumWidth();
+
+    transformColumns(spectrum, true);
+
+    // Rows: merge the h + 1 bins back into a half-length complex sequence,
+    // inverse transform, and unpack even/odd samples
+    for (int y = 0; y < n; ++y) {
+        std::complex<float>* row = spectrum + y * width;
+
+        for (int k = 0; k <= h / 2; ++k) {
+            std::complex<float> xk = row[k];
+            std::complex<float> xhk = std::conj(row[h - k]);
+
+            // E = (X[k] + conj X[h-k]) / 2, O = (X[k] - conj X[h-k]) conj(W^k) / 2
+            std::complex<float> e = 0.5f * (xk + xhk);
+            std::complex<float> o = 0.5f * (xk - xhk) * std::conj(realTwiddles_[k]);
+            std::complex<float> io(-o.imag(), o.real());
+
+            row[k] = e + io;
+            if (k > 0) {
+                row[h - k] = std::conj(e) + std::complex<float>(o.imag(), o.real());
+            }
+        }
+
+        rowPlan_.inverse(row);
+
+        float* dst = output + y * n;
+        for (int k = 0; k < h; ++k) {
+            dst[2 * k] = row[k].real();
+            dst[2 * k + 1] = row[k].imag();
+        }
+    }
+}
+
+// PlanarFFT2D implementation
+
+PlanarFFT2D::PlanarFFT2D(int size)
+    : size_(size >= 4 && isPowerOf2(size) ? size : 0), leadingRadix2_(false) {
+
+    if (size_ == 0) {
+        LOGE("PlanarFFT2D: size %d is not a power of 2 >= 4, plan left empty", size);
+        return;
+    }
+
+    int log2n = 0;
+    while ((1 << log2n) < size_) ++log2n;
+
+    for (int i = 0; i < size_; ++i) {
+        int r = 0;
+        for (int b = 0; b < log2n; ++b) {
+            r |= ((i >> b) & 1) << (log2n - 1 - b);
+        }
+        if (i < r) {
+            swaps_.emplace_back(i, r);
+        }
+    }
+
+    // Same stage layout as FFTPlan
+    leadingRadix2_ = (log2n & 1) != 0;
+    for (int m = leadingRadix2_ ? 2 : 1; 4 * m <= size_; m *= 4) {
+        stageOffsets_.push_back(static_cast<int>(twiddles_.size()));
+        for (int p = 1; p <= 3; ++p) {
+            for (int j = 0; j < m; ++j) {
+                twiddles_.push_back(twiddle(p * j, 4 * m));
+            }
+        }
+    }
+}
+
+const PlanarFFT2D& PlanarFFT2D::forSize(int size) {
+    static std::mutex mutex;
+    static std::map<int, std::unique_ptr<PlanarFFT2D>> plans;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<PlanarFFT2D>& plan = plans[size];
+    if (!plan) {
+        plan = std::make_unique<PlanarFFT2D>(size);
+    }
+    return *plan;
+}
+
+/**
+ * One radix-4 butterfly (as in radix4Scalar) on whole rows r0..r3, four
+ * columns per vector; without twiddles for j = 0, where they are all one
+ */
+template <bool kUnitTwiddles>
+static inline void planarRadix4(float* real, float* imag, int n, int r0, int r1, int r2, int r3,
+                                std::complex<float> w1, std::complex<float> w2, std::complex<float> w3) {
+    using simd::f32x4;
+    const f32x4 t1r = f32x4::splat(w2.real()), t1i = f32x4::splat(w2.imag());
+    const f32x4 t2r = f32x4::splat(w1.real()), t2i = f32x4::splat(w1.imag());
+    const f32x4 t3r = f32x4::splat(w3.real()), t3i = f32x4::splat(w3.imag());
+
+    for (int c = 0; c < n; c += 4) {
+        f32x4 a0r = f32x4::load(real + r0 + c), a0i = f32x4::load(imag + r0 + c);
+        f32x4 x1r = f32x4::load(real + r1 + c), x1i = f32x4::load(imag + r1 + c);
+        f32x4 x2r = f32x4::load(real + r2 + c), x2i = f32x4::load(imag + r2 + c);
+        f32x4 x3r = f32x4::load(real + r3 + c), x3i = f32x4::load(imag + r3 + c);
+
+        // x1 = W^2j a1, x2 = W^j a2, x3 = W^3j a3
+        if (!kUnitTwiddles) {
+            f32x4 a1r = x1r, a2r = x2r, a3r = x3r;
+            x1r = t1r * a1r - t1i * x1i;  x1i = t1r * x1i + t1i * a1r;
+            x2r = t2r * a2r - t2i * x2i;  x2i = t2r * x2i + t2i * a2r;
+            x3r = t3r * a3r - t3i * x3i;  x3i = t3r * x3i + t3i * a3r;
+        }
+
+        f32x4 s0r = a0r + x1r, s0i = a0i + x1i;
+        f32x4 d0r = a0r - x1r, d0i = a0i - x1i;
+        f32x4 s1r = x2r + x3r, s1i = x2i + x3i;
+        f32x4 d1r = x2r - x3r, d1i = x2i - x3i;
+
+        (s0r + s1r).store(real + r0 + c);  (s0i + s1i).store(imag + r0 + c);
+        (s0r - s1r).store(real + r2 + c);  (s0i - s1i).store(imag + r2 + c);
+        (d0r + d1i).store(real + r1 + c);  (d0i - d1r).store(imag + r1 + c);
+        (d0r - d1i).store(real + r3 + c);  (d0i + d1r).store(imag + r3 + c);
+    }
+}
+
+/**
+ * Size-point transforms of every column at once: the butterflies of
+ * FFTPlan::transform applied to whole rows
+ */
+void PlanarFFT2D::transformColumns(float* real, float* imag) const {
+    using simd::f32x4;
+    const int n = size_;
+
+    for (const auto& s : swaps_) {
+        std::swap_ranges(real + s.first * n, real + (s.first + 1) * n, real + s.second * n);
+        std::swap_ranges(imag + s.first * n, imag + (s.first + 1) * n, imag + s.second * n);
+    }
+
+    if (leadingRadix2_) {
+        for (int row = 0; row < n; row += 2) {
+            float* ar = real + row * n;
+            float* ai = imag + row * n;
+            float* br = ar + n;
+            float* bi = ai + n;
+            for (int c = 0; c < n; c += 4) {
+                f32x4 xr = f32x4::load(ar + c), xi = f32x4::load(ai + c);
+                f32x4 yr = f32x4::load(br + c), yi = f32x4::load(bi + c);
+                (xr + yr).store(ar + c);
+                (xi + yi).store(ai + c);
+                (xr - yr).store(br + c);
+                (xi - yi).store(bi + c);
+            }
+        }
+    }
+
+    int stage = 0;
+    for (int m = leadingRadix2_ ? 2 : 1; 4 * m <= n; m *= 4, ++stage) {
+        const std::complex<float>* w1 = twiddles_.data() + stageOffsets_[stage];
+        const std::complex<float>* w2 = w1 + m;
+        const std::complex<float>* w3 = w2 + m;
+
+        for (int block = 0; block < n; block += 4 * m) {
+            for (int j = 0; j < m; ++j) {
+                const int r0 = (block + j) * n;
+                const int r1 = r0 + m * n;
+                const int r2 = r1 + m * n;
+                const int r3 = r2 + m * n;
+                if (j == 0) {
+                    planarRadix4<true>(real, imag, n, r0, r1, r2, r3, w1[j], w2[j], w3[j]);
+                } else {
+                    planarRadix4<false>(real, imag, n, r0, r1, r2, r3, w1[j], w2[j], w3[j]);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * In-place transpose of a size x size plane, 4x4 blocks at a time
+ */
+static void transposePlane(float* plane, int n) {
+    using simd::f32x4;
+    for (int by = 0; by < n; by += 4) {
+        for (int bx = by; bx < n; bx += 4) {
+            float* a = plane + by * n + bx;
+            float* b = plane + bx * n + by;
+            f32x4 a0 = f32x4::load(a), a1 = f32x4::load(a + n);
+            f32x4 a2 = f32x4::load(a + 2 * n), a3 = f32x4::load(a + 3 * n);
+            simd::transpose4x4(a0, a1, a2, a3);
+            if (bx == by) {
+                a0.store(a); a1.store(a + n); a2.store(a + 2 * n); a3.store(a + 3 * n);
+                continue;
+            }
+            f32x4 b0 = f32x4::load(b), b1 = f32x4::load(b + n);
+            f32x4 b2 = f32x4::load(b + 2 * n), b3 = f32x4::load(b + 3 * n);
+            simd::transpose4x4(b0, b1, b2, b3);
+            a0.store(b); a1.store(b + n); a2.store(b + 2 * n); a3.store(b + 3 * n);
+            b0.store(a); b1.store(a + n); b2.store(a + 2 * n); b3.store(a + 3 * n);
+        }
+    }
+}
+
+void PlanarFFT2D::forward(float* real, float* imag) const {
+    if (size_ == 0) return;
+
+    transformColumns(real, imag);
+    transposePlane(real, size_);
+    transposePlane(imag, size_);
+    transformColumns(real, imag);
+}
+
+void PlanarFFT2D::inverse(float* real, float* imag) const {
+    if (size_ == 0) return;
+
+    // Swapping the planes conjugates up to a factor of i: the forward
+    // transform of the swapped data, swapped back, is the unnormalized
+    // inverse. The passes along kx then ky also undo the transpose.
+    forward(imag, real);
+
+    const simd::f32x4 scale = simd::f32x4::splat(1.0f / (size_ * size_));
+    for (int i = 0; i < size_ * size_; i += 4) {
+        (simd::f32x4::load(real + i) * scale).store(real + i);
+        (simd::f32x4::load(imag + i) * scale).store(imag + i);
+    }
+}
+
+} // namespace ultradetail
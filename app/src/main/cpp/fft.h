@@ -0,0 +1,172 @@
+/**
+ * fft.h - FFT engine for frequency-domain alignment and merging
+ *
+ * Power-of-2 transforms built from plan objects that hold everything that
+ * depends only on the size (bit-reversal swaps, per-stage twiddles), so a
+ * transform does no trigonometry. Plans are immutable and shared: get them
+ * through the cached forSize() accessors and call them from any thread.
+ *
+ * - FFTPlan: 1D complex transform, radix-4 stages (plus one radix-2 stage
+ *   for odd log2 sizes), SIMD butterflies (NEON, SSE or scalar, see simd.h)
+ * - RealFFT2D: 2D real-to-complex / complex-to-real transform storing only
+ *   the non-redundant half spectrum; rows use a half-length complex FFT and
+ *   columns are transformed in cache-sized blocks
+ * - PlanarFFT2D: 2D complex transform of small tiles held as separate real
+ *   and imaginary planes, SIMD across whole rows (frequency-domain merge)
+ */
+
+#ifndef ULTRADETAIL_FFT_H
+#define ULTRADETAIL_FFT_H
+
+#include "common.h"
+#include <complex>
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * 1D complex FFT plan for a power-of-2 size
+ */
+class FFTPlan {
+public:
+    /**
+     * Create a plan
+     *
+     * @param n Transform size (power of 2, >= 1); any other size gives an
+     *          empty plan (size() == 0) whose transforms do nothing
+     */
+    explicit FFTPlan(int n);
+
+    /**
+     * Get a shared plan for the given size (created on first use, thread-safe)
+     */
+    static const FFTPlan& forSize(int n);
+
+    int size() const { return n_; }
+    bool valid() const { return n_ > 0; }
+
+    /**
+     * In-place forward transform (unnormalized, e^-i sign)
+     */
+    void forward(std::complex<float>* data) const;
+
+    /**
+     * In-place inverse transform (normalized by 1/n)
+     */
+    void inverse(std::complex<float>* data) const;
+
+    /**
+     * In-place forward transforms of count sequences of size n stored contiguously
+     */
+    void forwardBatch(std::complex<float>* data, int count) const;
+
+    /**
+     * In-place inverse transforms of count contiguous sequences (normalized by 1/n)
+     */
+    void inverseBatch(std::complex<float>* data, int count) const;
+
+private:
+    int n_;
+    bool leadingRadix2_;                            // log2(n) odd: one radix-2 stage first
+    std::vector<std::pair<int, int>> swaps_;        // Bit-reversal permutation as swaps
+    std::vector<std::complex<float>> twiddles_;     // Per radix-4 stage: W^j, W^2j, W^3j blocks
+    std::vector<int> stageOffsets_;                 // Offset of each stage in twiddles_
+
+    void transform(std::complex<float>* data) const;
+};
+
+/**
+ * 2D real FFT plan for size x size images (size power of 2, >= 2)
+ *
+ * The spectrum holds size rows of spectrumWidth() = size / 2 + 1 bins; the
+ * remaining bins follow from Hermitian symmetry. Any other size gives an
+ * empty plan (size() == 0, spectrumSize() == 0) whose transforms do nothing.
+ */
+class RealFFT2D {
+public:
+    explicit RealFFT2D(int size);
+
+    /**
+     * Get a shared plan for the given size (created on first use, thread-safe)
+     */
+    static const RealFFT2D& forSize(int size);
+
+    int size() const { return size_; }
+    bool valid() const { return size_ > 0; }
+    int spectrumWidth() const { return size_ / 2 + 1; }
+    int spectrumSize() const { return size_ * spectrumWidth(); }
+
+    /**
+     * Forward transform of a size x size real image (row-major)
+     *
+     * @param input Real input, size * size values
+     * @param spectrum Output half spectrum, spectrumSize() values
+     */
+    void forward(const float* input, std::complex<float>* spectrum) const;
+
+    /**
+     * Inverse transform to a real image (normalized by 1/size^2)
+     *
+     * @param spectrum Half spectrum, spectrumSize() values (used as scratch, overwritten)
+     * @param output Real output, size * size values
+     */
+    void inverse(std::complex<float>* spectrum, float* output) const;
+
+private:
+    int size_;
+    const FFTPlan& rowPlan_;                        // size / 2 complex (packed real rows)
+    const FFTPlan& columnPlan_;                     // size complex
+    std::vector<std::complex<float>> realTwiddles_; // W_size^k for the real split, k <= size / 2
+
+    void transformColumns(std::complex<float>* spectrum, bool inverse) const;
+};
+
+/**
+ * 2D complex FFT plan for small size x size tiles in planar form: real and
+ * imaginary parts in separate row-major planes (size power of 2, >= 4)
+ *
+ * Each pass runs the radix-4 butterflies between whole rows, so the SIMD
+ * lanes span the columns and nothing is shuffled inside a pass; the two
+ * passes are joined by a 4x4-block transpose. The forward spectrum is
+ * therefore left transposed: bin (kx, ky) is at row kx, column ky. inverse()
+ * takes that layout and returns the tile in its original one. Any other
+ * size gives an empty plan (size() == 0) whose transforms do nothing.
+ */
+class PlanarFFT2D {
+public:
+    explicit PlanarFFT2D(int size);
+
+    /**
+     * Get a shared plan for the given size (created on first use, thread-safe)
+     */
+    static const PlanarFFT2D& forSize(int size);
+
+    int size() const { return size_; }
+    bool valid() const { return size_ > 0; }
+
+    /**
+     * In-place forward transform (unnormalized, e^-i sign), spectrum transposed
+     *
+     * @param real Real plane, size * size values
+     * @param imag Imaginary plane, size * size values
+     */
+    void forward(float* real, float* imag) const;
+
+    /**
+     * In-place inverse of forward() (normalized by 1/size^2)
+     */
+    void inverse(float* real, float* imag) const;
+
+private:
+    int size_;
+    bool leadingRadix2_;                            // log2(size) odd: one radix-2 stage first
+    std::vector<std::pair<int, int>> swaps_;        // Bit-reversal permutation of rows
+    std::vector<std::complex<float>> twiddles_;     // Per radix-4 stage: W^j, W^2j, W^3j blocks
+    std::vector<int> stageOffsets_;                 // Offset of each stage in twiddles_
+
+    void transformColumns(float* real, float* imag) const;
+};
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_FFT_H
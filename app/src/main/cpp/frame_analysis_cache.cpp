@@ -0,0 +1,205 @@
+/**
+ * frame_analysis_cache.cpp - Burst-scoped frame analysis implementation
+ */
+
+#include "frame_analysis_cache.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace ultradetail {
+
+/**
+ * Scharr gradients normalized by the kernel weight (32), zero on the border
+ */
+static void computeScharrGradients(const GrayView& image, FrameGradients& out) {
+    const int width = image.width;
+    const int height = image.height;
+
+    out.gradX = GrayImage(width, height);
+    out.gradY = GrayImage(width, height);
+
+    ThreadPool::instance().parallelForRows(1, height - 1, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const float* above = image.row(y - 1);
+            const float* center = image.row(y);
+            const float* below = image.row(y + 1);
+            float* gxRow = out.gradX.row(y);
+            float* gyRow = out.gradY.row(y);
+
+            for (int x = 1; x < width - 1; ++x) {
+                // [-3 0 3; -10 0 10; -3 0 3] and its transpose
+                float gx = 3.0f * (above[x + 1] - above[x - 1] + below[x + 1] - below[x - 1]) +
+                           10.0f * (center[x + 1] - center[x - 1]);
+                float gy = 3.0f * (below[x - 1] - above[x - 1] + below[x + 1] - above[x + 1]) +
+                           10.0f * (below[x] - above[x]);
+                gxRow[x] = gx / 32.0f;
+                gyRow[x] = gy / 32.0f;
+            }
+        }
+    });
+}
+
+/**
+ * Box sums of the gradient products: column sums over the window rows, then
+ * a running sum along the row
+ */
+static void computeStructureTensor(const FrameGradients& gradients, int windowSize,
+                                   StructureTensorSums& out) {
+    const GrayImage& gradX = gradients.gradX;
+    const GrayImage& gradY = gradients.gradY;
+    const int width = gradX.width;
+    const int height = gradX.height;
+    const int halfWin = windowSize / 2;
+
+    out.windowSize = windowSize;
+    out.sumIxIx = GrayImage(width, height);
+    out.sumIxIy = GrayImage(width, height);
+    out.sumIyIy = GrayImage(width, height);
+
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        std::vector<float> columns(3 * static_cast<size_t>(width));
+        float* colXX = columns.data();
+        float* colXY = colXX + width;
+        float* colYY = colXY + width;
+
+        for (int y = y0; y < y1; ++y) {
+            std::fill(columns.begin(), columns.end(), 0.0f);
+            const int rowBegin = std::max(0, y - halfWin);
+            const int rowEnd = std::min(height - 1, y + halfWin);
+            for (int sy = rowBegin; sy <= rowEnd; ++sy) {
+                const float* gx = gradX.row(sy);
+                const float* gy = gradY.row(sy);
+                for (int x = 0; x < width; ++x) {
+                    colXX[x] += gx[x] * gx[x];
+                    colXY[x] += gx[x] * gy[x];
+                    colYY[x] += gy[x] * gy[x];
+                }
+            }
+
+            float* outXX = out.sumIxIx.row(y);
+            float* outXY = out.sumIxIy.row(y);
+            float* outYY = out.sumIyIy.row(y);
+            float sumXX = 0.0f, sumXY = 0.0f, sumYY = 0.0f;
+            for (int x = 0; x < std::min(halfWin, width); ++x) {
+                sumXX += colXX[x];
+                sumXY += colXY[x];
+                sumYY += colYY[x];
+            }
+            for (int x = 0; x < width; ++x) {
+                const int enter = x + halfWin;
+                const int leave = x - halfWin - 1;
+                if (enter < width) {
+                    sumXX += colXX[enter];
+                    sumXY += colXY[enter];
+                    sumYY += colYY[enter];
+                }
+                if (leave >= 0) {
+                    sumXX -= colXX[leave];
+                    sumXY -= colXY[leave];
+                    sumYY -= colYY[leave];
+                }
+                outXX[x] = sumXX;
+                outXY[x] = sumXY;
+                outYY[x] = sumYY;
+            }
+        }
+    });
+}
+
+FrameAnalysisCache::FrameAnalysisCache(int numLevels)
+    : numLevels_(std::max(1, numLevels)) {
+}
+
+void FrameAnalysisCache::setFrame(int id, const GrayView& frame) {
+    while (numFrames() <= id) {
+        entries_.push_back(std::make_unique<Entry>());
+    }
+    entries_[id] = std::make_unique<Entry>();
+    entries_[id]->frame = frame;
+}
+
+int FrameAnalysisCache::addFrame(const GrayView& frame) {
+    const int id = numFrames();
+    setFrame(id, frame);
+    return id;
+}
+
+void FrameAnalysisCache::release(int id) {
+    if (id >= 0 && id < numFrames()) {
+        entries_[id] = std::make_unique<Entry>();
+    }
+}
+
+const GrayView& FrameAnalysisCache::frame(int id) const {
+    return entries_[id]->frame;
+}
+
+// Results are computed outside the entry lock: the thread pool may run
+// another lookup of the same frame on this thread while it waits for the
+// computation's own parallel loop. A lookup that loses the race discards its
+// copy and returns the one published first.
+
+const GaussianPyramid& FrameAnalysisCache::pyramid(int id) {
+    Entry& e = *entries_[id];
+    {
+        std::lock_guard<std::mutex> lock(e.mutex);
+        if (e.pyramid) return *e.pyramid;
+    }
+
+    auto pyramid = std::make_unique<GaussianPyramid>();
+    pyramid->build(e.frame, numLevels_);
+
+    std::lock_guard<std::mutex> lock(e.mutex);
+    if (!e.pyramid) {
+        e.gradients.resize(pyramid->numLevels());
+        e.pyramid = std::move(pyramid);
+    }
+    return *e.pyramid;
+}
+
+const FrameGradients& FrameAnalysisCache::gradients(int id, int level) {
+    Entry& e = *entries_[id];
+    const GaussianPyramid& levels = pyramid(id);
+    level = clamp(level, 0, levels.numLevels() - 1);
+    {
+        std::lock_guard<std::mutex> lock(e.mutex);
+        if (e.gradients[level]) return *e.gradients[level];
+    }
+
+    auto gradients = std::make_unique<FrameGradients>();
+    computeScharrGradients(levels.getLevel(level), *gradients);
+
+    std::lock_guard<std::mutex> lock(e.mutex);
+    if (!e.gradients[level]) {
+        e.gradients[level] = std::move(gradients);
+    }
+    return *e.gradients[level];
+}
+
+const StructureTensorSums& FrameAnalysisCache::structureTensor(int id, int level, int windowSize) {
+    Entry& e = *entries_[id];
+    level = clamp(level, 0, pyramid(id).numLevels() - 1);
+    auto find = [&]() -> const StructureTensorSums* {
+        for (const auto& tensor : e.tensors) {
+            if (tensor->level == level && tensor->windowSize == windowSize) {
+                return tensor.get();
+            }
+        }
+        return nullptr;
+    };
+    {
+        std::lock_guard<std::mutex> lock(e.mutex);
+        if (const StructureTensorSums* cached = find()) return *cached;
+    }
+
+    auto tensor = std::make_unique<StructureTensorSums>();
+    tensor->level = level;
+    computeStructureTensor(gradients(id, level), windowSize, *tensor);
+
+    std::lock_guard<std::mutex> lock(e.mutex);
+    if (const StructureTensorSums* cached = find()) return *cached;
+    e.tensors.push_back(std::move(tensor));
+    return *e.tensors.back();
+}
+
+} // namespace ultradetail
@@ -0,0 +1,126 @@
+/**
+ * frame_analysis_cache.h - Burst-scoped pyramids, gradients and structure tensors
+ *
+ * Tile alignment, dense optical flow and their fallbacks all analyse the same
+ * gray frames of a burst. The cache computes each frame's Gaussian pyramid,
+ * per-level Scharr gradients and windowed structure tensors on first use and
+ * hands out const references to every later consumer, so each is built once
+ * per frame instead of once per aligner (or, for the reference gradients,
+ * once per aligned frame).
+ */
+
+#ifndef ULTRADETAIL_FRAME_ANALYSIS_CACHE_H
+#define ULTRADETAIL_FRAME_ANALYSIS_CACHE_H
+
+#include "common.h"
+#include "pyramid.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * Scharr gradients of one pyramid level (normalized by 32, zero on the
+ * 1-pixel border)
+ */
+struct FrameGradients {
+    GrayImage gradX;
+    GrayImage gradY;
+};
+
+/**
+ * Lucas-Kanade structure tensor: products of the level's gradients summed
+ * over a windowSize x windowSize window (clipped to the image) around each pixel
+ */
+struct StructureTensorSums {
+    int level = 0;
+    int windowSize = 0;
+    GrayImage sumIxIx;
+    GrayImage sumIxIy;
+    GrayImage sumIyIy;
+};
+
+/**
+ * Lazily computed, memoized analysis of the frames (or frame crops) of one burst
+ *
+ * Frames are borrowed and must stay alive and unchanged until they are
+ * released or replaced. Registering, releasing and clearing frames is not
+ * thread-safe; the lookups are (two threads racing on the same missing
+ * result may both compute it, one copy is kept). References stay valid until
+ * the frame is released.
+ */
+class FrameAnalysisCache {
+public:
+    /**
+     * @param numLevels Pyramid levels built per frame (consumers that need
+     *                  fewer use the finest ones)
+     */
+    explicit FrameAnalysisCache(int numLevels = MAX_PYRAMID_LEVELS);
+
+    FrameAnalysisCache(const FrameAnalysisCache&) = delete;
+    FrameAnalysisCache& operator=(const FrameAnalysisCache&) = delete;
+
+    /**
+     * Register a frame under an id, dropping anything cached for that id
+     */
+    void setFrame(int id, const GrayView& frame);
+    void setFrame(int id, GrayImage&& frame) = delete;
+
+    /**
+     * Register a frame under the next free id
+     *
+     * @return Frame id
+     */
+    int addFrame(const GrayView& frame);
+    int addFrame(GrayImage&& frame) = delete;
+
+    /**
+     * Drop the frame and everything computed from it
+     */
+    void release(int id);
+
+    /**
+     * Drop all frames
+     */
+    void clear() { entries_.clear(); }
+
+    int numFrames() const { return static_cast<int>(entries_.size()); }
+    int numLevels() const { return numLevels_; }
+
+    /**
+     * Registered frame (empty view if released or never set)
+     */
+    const GrayView& frame(int id) const;
+
+    /**
+     * Gaussian pyramid of a frame
+     */
+    const GaussianPyramid& pyramid(int id);
+
+    /**
+     * Scharr gradients of a pyramid level (level is clamped to the pyramid)
+     */
+    const FrameGradients& gradients(int id, int level);
+
+    /**
+     * Structure tensor of a pyramid level for the given window size
+     */
+    const StructureTensorSums& structureTensor(int id, int level, int windowSize);
+
+private:
+    struct Entry {
+        GrayView frame;
+        std::mutex mutex;   // Guards publishing the results below
+        std::unique_ptr<GaussianPyramid> pyramid;
+        std::vector<std::unique_ptr<FrameGradients>> gradients;     // Per level
+        std::vector<std::unique_ptr<StructureTensorSums>> tensors;  // Per (level, window)
+    };
+
+    int numLevels_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_FRAME_ANALYSIS_CACHE_H
@@ -0,0 +1,79 @@
+/**
+ * frame_source.cpp - On-demand frame access implementation
+ */
+
+#include "frame_source.h"
+
+namespace ultradetail {
+
+const GrayImage& FrameSource::fullLuma(GrayImage& scratch) const {
+    read(0, 0, width(), height(), nullptr, &scratch);
+    return scratch;
+}
+
+const RGBImage& FrameSource::fullRGB(RGBImage& scratch) const {
+    read(0, 0, width(), height(), &scratch, nullptr);
+    return scratch;
+}
+
+void ImageFrameSource::read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const {
+    if (rgb) {
+        rgb->resize(w, h);
+        for (int row = 0; row < h; ++row) {
+            const RGBPixel* src = rgb_.row(y + row) + x;
+            std::copy(src, src + w, rgb->row(row));
+        }
+    }
+    if (luma) {
+        luma->resize(w, h);
+        for (int row = 0; row < h; ++row) {
+            const float* src = luma_.row(y + row) + x;
+            std::copy(src, src + w, luma->row(row));
+        }
+    }
+}
+
+void YUVFrameSource::read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const {
+    if (rgb) rgb->resize(w, h);
+    if (luma) luma->resize(w, h);
+
+    for (int row = 0; row < h; ++row) {
+        yuvRowToRgbLuma(frame_, y + row, x, w,
+                        rgb ? rgb->row(row) : nullptr,
+                        luma ? luma->row(row) : nullptr,
+                        YUVLuma::RGB_WEIGHTED);
+    }
+}
+
+void RGBA8FrameSource::read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const {
+    if (rgb) rgb->resize(w, h);
+    if (luma) luma->resize(w, h);
+
+    const bool masked = !mask_.empty();
+    const float maskRange = 1.0f - maskFloor_;
+
+    for (int row = 0; row < h; ++row) {
+        const RGBA8Pixel* src = pixels_.row(y + row) + x;
+        const float* maskRow = masked ? mask_.row(y + row) + x : nullptr;
+        RGBPixel* rgbRow = rgb ? rgb->row(row) : nullptr;
+        float* lumaRow = luma ? luma->row(row) : nullptr;
+
+        for (int col = 0; col < w; ++col) {
+            float r = src[col].r / 255.0f;
+            float g = src[col].g / 255.0f;
+            float b = src[col].b / 255.0f;
+
+            if (maskRow) {
+                float gain = maskFloor_ + maskRange * maskRow[col];
+                r *= gain;
+                g *= gain;
+                b *= gain;
+            }
+
+            if (rgbRow) rgbRow[col] = RGBPixel(r, g, b);
+            if (lumaRow) lumaRow[col] = 0.299f * r + 0.587f * g + 0.114f * b;
+        }
+    }
+}
+
+} // namespace ultradetail
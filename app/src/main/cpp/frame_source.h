@@ -0,0 +1,126 @@
+/**
+ * frame_source.h - On-demand access to burst frame pixels
+ *
+ * The tiled pipeline only ever reads tile-sized crops of each frame, so it
+ * pulls converted RGB and luma regions from a FrameSource instead of
+ * requiring full float copies of every frame. Sources wrap either already
+ * converted images, the raw YUV_420_888 planes from the camera, or 8-bit
+ * RGBA pixels (locked Bitmaps); the latter two are converted region by
+ * region as tiles request them.
+ */
+
+#ifndef ULTRADETAIL_FRAME_SOURCE_H
+#define ULTRADETAIL_FRAME_SOURCE_H
+
+#include "common.h"
+#include "yuv_converter.h"
+
+namespace ultradetail {
+
+/**
+ * Read-only burst frame that converts pixels on request
+ *
+ * Implementations must be safe to read from several threads at once.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+
+    /**
+     * Convert the region [x, x + w) x [y, y + h), which must lie inside the frame
+     *
+     * @param rgb Receives the RGB region (resized to w x h), or nullptr
+     * @param luma Receives the luma region (resized to w x h), or nullptr
+     */
+    virtual void read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const = 0;
+
+    /**
+     * Whole-frame luma: the resident plane if the source holds one,
+     * otherwise converted into scratch
+     */
+    virtual const GrayImage& fullLuma(GrayImage& scratch) const;
+
+    /**
+     * Whole-frame RGB: the resident image if the source holds one,
+     * otherwise converted into scratch
+     */
+    virtual const RGBImage& fullRGB(RGBImage& scratch) const;
+};
+
+/**
+ * Source over already converted RGB and grayscale images (not copied)
+ */
+class ImageFrameSource : public FrameSource {
+public:
+    ImageFrameSource(const RGBImage& rgb, const GrayImage& luma) : rgb_(rgb), luma_(luma) {}
+
+    int width() const override { return rgb_.width; }
+    int height() const override { return rgb_.height; }
+
+    void read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const override;
+
+    const GrayImage& fullLuma(GrayImage&) const override { return luma_; }
+    const RGBImage& fullRGB(RGBImage&) const override { return rgb_; }
+
+private:
+    const RGBImage& rgb_;
+    const GrayImage& luma_;
+};
+
+/**
+ * Source over YUV_420_888 planes, converted per region
+ *
+ * Uses BT.601 limited-range conversion; luma is the Rec.601 weighted sum of
+ * the converted RGB, matching the whole-frame conversion of the YUV entry
+ * points. The planes must outlive the source.
+ */
+class YUVFrameSource : public FrameSource {
+public:
+    explicit YUVFrameSource(const YUVFrame& frame) : frame_(frame) {}
+
+    int width() const override { return frame_.width; }
+    int height() const override { return frame_.height; }
+
+    void read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const override;
+
+private:
+    YUVFrame frame_;
+};
+
+/**
+ * Source over 8-bit RGBA pixels, converted per region
+ *
+ * RGB is byte / 255 and luma the Rec.601 weighted sum. An optional quality
+ * mask attenuates each pixel by floor + (1 - floor) * mask before luma is
+ * taken, so poorly aligned regions contribute less to the merge. The pixels
+ * (and mask) must outlive the source.
+ */
+class RGBA8FrameSource : public FrameSource {
+public:
+    explicit RGBA8FrameSource(const RGBA8View& pixels) : pixels_(pixels), maskFloor_(0.0f) {}
+
+    /**
+     * Attenuate by a per-pixel quality mask (same size as the frame)
+     */
+    void setQualityMask(const GrayView& mask, float floor) {
+        mask_ = mask;
+        maskFloor_ = floor;
+    }
+
+    int width() const override { return pixels_.width; }
+    int height() const override { return pixels_.height; }
+
+    void read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const override;
+
+private:
+    RGBA8View pixels_;
+    GrayView mask_;
+    float maskFloor_;
+};
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_FRAME_SOURCE_H
@@ -0,0 +1,246 @@
+/**
+ * frame_store.cpp - Resident / spill-file frame storage implementation
+ */
+
+#include "frame_store.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#undef LOG_TAG
+#define LOG_TAG "FrameStore"
+
+namespace ultradetail {
+
+static std::mutex g_spillMutex;
+static std::string g_spillDirectory;
+
+void setSpillDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(g_spillMutex);
+    g_spillDirectory = directory;
+    LOGI("Spill directory: %s", directory.empty() ? "(disabled)" : directory.c_str());
+}
+
+std::string getSpillDirectory() {
+    std::lock_guard<std::mutex> lock(g_spillMutex);
+    return g_spillDirectory;
+}
+
+/**
+ * Map a new unlinked file of the given size in the spill directory
+ *
+ * The blocks are reserved up front, so a full disk fails here instead of
+ * raising SIGBUS on a later write through the mapping.
+ */
+static void* mapSpillFile(const std::string& directory, size_t bytes) {
+    std::string path = directory + "/ultradetail_spill_XXXXXX";
+    std::vector<char> name(path.begin(), path.end());
+    name.push_back('\0');
+
+    int fd = mkstemp(name.data());
+    if (fd < 0) {
+        return nullptr;
+    }
+    unlink(name.data());
+
+    void* mapping = nullptr;
+    if (posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == 0) {
+        mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+        }
+    }
+    close(fd);
+    return mapping;
+}
+
+BackingStore::BackingStore(BackingStore&& other) noexcept
+    : resident_(std::move(other.resident_)), mapping_(other.mapping_), size_(other.size_) {
+    other.mapping_ = nullptr;
+    other.size_ = 0;
+}
+
+BackingStore& BackingStore::operator=(BackingStore&& other) noexcept {
+    if (this != &other) {
+        release();
+        resident_ = std::move(other.resident_);
+        mapping_ = other.mapping_;
+        size_ = other.size_;
+        other.mapping_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+bool BackingStore::allocate(size_t bytes, bool spill) {
+    release();
+
+    if (spill && bytes > 0) {
+        std::string directory = getSpillDirectory();
+        if (directory.empty()) {
+            LOGW("No spill directory set, keeping %.1f MB in RAM", bytes / (1024.0f * 1024.0f));
+        } else if ((mapping_ = mapSpillFile(directory, bytes)) != nullptr) {
+            size_ = bytes;
+            return true;
+        } else {
+            LOGW("Cannot create a %.1f MB spill file in %s, keeping it in RAM",
+                 bytes / (1024.0f * 1024.0f), directory.c_str());
+        }
+    }
+
+    try {
+        resident_.assign(bytes, 0);
+    } catch (const std::bad_alloc&) {
+        LOGE("Out of memory allocating %.1f MB", bytes / (1024.0f * 1024.0f));
+        resident_ = std::vector<uint8_t>();
+        return false;
+    }
+    size_ = bytes;
+    return true;
+}
+
+void BackingStore::release() {
+    if (mapping_) {
+        munmap(mapping_, size_);
+        mapping_ = nullptr;
+    }
+    resident_ = std::vector<uint8_t>();
+    size_ = 0;
+}
+
+// Block layout: Y (kBlockSize^2), then U and V (kChromaBlock^2 each)
+static constexpr int kChromaBlock = StoredYUVFrame::kBlockSize / 2;
+static constexpr size_t kBlockLumaBytes =
+    static_cast<size_t>(StoredYUVFrame::kBlockSize) * StoredYUVFrame::kBlockSize;
+static constexpr size_t kBlockChromaBytes = static_cast<size_t>(kChromaBlock) * kChromaBlock;
+static constexpr size_t kBlockBytes = kBlockLumaBytes + 2 * kBlockChromaBytes;
+
+size_t StoredYUVFrame::storageBytes(int width, int height) {
+    const size_t blocksX = (width + kBlockSize - 1) / kBlockSize;
+    const size_t blocksY = (height + kBlockSize - 1) / kBlockSize;
+    return blocksX * blocksY * kBlockBytes;
+}
+
+bool StoredYUVFrame::assign(const YUVFrame& source, bool spill) {
+    width_ = source.width;
+    height_ = source.height;
+    blocksX_ = (width_ + kBlockSize - 1) / kBlockSize;
+    blocksY_ = (height_ + kBlockSize - 1) / kBlockSize;
+
+    if (!store_.allocate(storageBytes(width_, height_), spill)) {
+        width_ = height_ = blocksX_ = blocksY_ = 0;
+        return false;
+    }
+
+    const int chromaWidth = (width_ + 1) / 2;
+    const int chromaHeight = (height_ + 1) / 2;
+    uint8_t* base = store_.data();
+
+    // Each block row is written by one worker, in source row order
+    ThreadPool::instance().parallelForRows(0, blocksY_, [&](int by0, int by1) {
+        for (int by = by0; by < by1; ++by) {
+            uint8_t* blockRow = base + static_cast<size_t>(by) * blocksX_ * kBlockBytes;
+
+            const int rows = std::min(kBlockSize, height_ - by * kBlockSize);
+            for (int r = 0; r < rows; ++r) {
+                const uint8_t* src = source.yPlane +
+                    static_cast<size_t>(by * kBlockSize + r) * source.yRowStride;
+                for (int bx = 0; bx < blocksX_; ++bx) {
+                    const int count = std::min(kBlockSize, width_ - bx * kBlockSize);
+                    std::memcpy(blockRow + bx * kBlockBytes + static_cast<size_t>(r) * kBlockSize,
+                                src + bx * kBlockSize, count);
+                }
+            }
+
+            const int chromaRows = std::min(kChromaBlock, chromaHeight - by * kChromaBlock);
+            for (int r = 0; r < chromaRows; ++r) {
+                const size_t srcOffset = static_cast<size_t>(by * kChromaBlock + r) * source.uvRowStride;
+                const uint8_t* srcU = source.uPlane + srcOffset;
+                const uint8_t* srcV = source.vPlane + srcOffset;
+                for (int bx = 0; bx < blocksX_; ++bx) {
+                    const int count = std::min(kChromaBlock, chromaWidth - bx * kChromaBlock);
+                    uint8_t* dstU = blockRow + bx * kBlockBytes + kBlockLumaBytes +
+                                    static_cast<size_t>(r) * kChromaBlock;
+                    uint8_t* dstV = dstU + kBlockChromaBytes;
+                    const size_t first = static_cast<size_t>(bx) * kChromaBlock * source.uvPixelStride;
+                    for (int i = 0; i < count; ++i) {
+                        dstU[i] = srcU[first + static_cast<size_t>(i) * source.uvPixelStride];
+                        dstV[i] = srcV[first + static_cast<size_t>(i) * source.uvPixelStride];
+                    }
+                }
+            }
+        }
+    });
+
+    return true;
+}
+
+YUVFrame StoredYUVFrame::blockFrame(int bx, int by) const {
+    const uint8_t* block = store_.data() + (static_cast<size_t>(by) * blocksX_ + bx) * kBlockBytes;
+
+    YUVFrame frame;
+    frame.yPlane = block;
+    frame.uPlane = block + kBlockLumaBytes;
+    frame.vPlane = block + kBlockLumaBytes + kBlockChromaBytes;
+    frame.yRowStride = kBlockSize;
+    frame.uvRowStride = kChromaBlock;
+    frame.uvPixelStride = 1;
+    frame.width = std::min(kBlockSize, width_ - bx * kBlockSize);
+    frame.height = std::min(kBlockSize, height_ - by * kBlockSize);
+    return frame;
+}
+
+void StoredYUVFrame::readRows(int x, int y, int w, int y0, int y1,
+                              RGBImage* rgb, GrayImage* luma) const {
+    const int bx0 = x / kBlockSize;
+    const int bx1 = (x + w - 1) / kBlockSize;
+
+    for (int row = y0; row < y1; ++row) {
+        const int by = row / kBlockSize;
+        RGBPixel* rgbRow = rgb ? rgb->row(row - y) : nullptr;
+        float* lumaRow = luma ? luma->row(row - y) : nullptr;
+
+        // Block origins are even, so block-local rows and columns keep their chroma phase
+        for (int bx = bx0; bx <= bx1; ++bx) {
+            const int start = std::max(x, bx * kBlockSize);
+            const int end = std::min(x + w, (bx + 1) * kBlockSize);
+            yuvRowToRgbLuma(blockFrame(bx, by), row - by * kBlockSize, start - bx * kBlockSize,
+                            end - start,
+                            rgbRow ? rgbRow + (start - x) : nullptr,
+                            lumaRow ? lumaRow + (start - x) : nullptr,
+                            YUVLuma::RGB_WEIGHTED);
+        }
+    }
+}
+
+void StoredYUVFrame::read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const {
+    if (rgb) rgb->resize(w, h);
+    if (luma) luma->resize(w, h);
+    if (w <= 0 || h <= 0) return;
+
+    readRows(x, y, w, y, y + h, rgb, luma);
+}
+
+const GrayImage& StoredYUVFrame::fullLuma(GrayImage& scratch) const {
+    scratch.resize(width_, height_);
+    ThreadPool::instance().parallelForRows(0, blocksY_, [&](int by0, int by1) {
+        readRows(0, 0, width_, by0 * kBlockSize, std::min(height_, by1 * kBlockSize), nullptr, &scratch);
+    });
+    return scratch;
+}
+
+const RGBImage& StoredYUVFrame::fullRGB(RGBImage& scratch) const {
+    scratch.resize(width_, height_);
+    ThreadPool::instance().parallelForRows(0, blocksY_, [&](int by0, int by1) {
+        readRows(0, 0, width_, by0 * kBlockSize, std::min(height_, by1 * kBlockSize), &scratch, nullptr);
+    });
+    return scratch;
+}
+
+} // namespace ultradetail
@@ -0,0 +1,131 @@
+/**
+ * frame_store.h - Burst frame storage in RAM or in memory-mapped spill files
+ *
+ * A full-resolution burst does not always fit in memory: twelve 50 MP
+ * YUV frames alone are ~900 MB. Frames the pipeline has to keep are stored
+ * tile-major (each block of pixels is contiguous), either resident or in an
+ * unlinked file in the spill directory that is mapped into memory. Mapped
+ * pages are file-backed, so the kernel can write them back and drop them
+ * under pressure instead of killing the process, and a tile crop touches a
+ * handful of contiguous blocks instead of one strided row per pixel row.
+ */
+
+#ifndef ULTRADETAIL_FRAME_STORE_H
+#define ULTRADETAIL_FRAME_STORE_H
+
+#include "common.h"
+#include "frame_source.h"
+#include "yuv_converter.h"
+#include <string>
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * Directory for spill files (the app cache dir); empty disables spilling
+ */
+void setSpillDirectory(const std::string& directory);
+std::string getSpillDirectory();
+
+/**
+ * Byte buffer held in RAM or in a memory-mapped spill file
+ *
+ * Spill files are unlinked as soon as they are created, so they disappear
+ * with the mapping even if the process dies. Movable, not copyable.
+ */
+class BackingStore {
+public:
+    BackingStore() : mapping_(nullptr), size_(0) {}
+    ~BackingStore() { release(); }
+
+    BackingStore(BackingStore&& other) noexcept;
+    BackingStore& operator=(BackingStore&& other) noexcept;
+    BackingStore(const BackingStore&) = delete;
+    BackingStore& operator=(const BackingStore&) = delete;
+
+    /**
+     * Allocate bytes, zero-filled
+     *
+     * @param spill Map a spill file; falls back to RAM (logged) if no spill
+     *              directory is set or the file cannot be created
+     * @return false if the memory could not be allocated at all
+     */
+    bool allocate(size_t bytes, bool spill);
+
+    void release();
+
+    uint8_t* data() { return mapping_ ? static_cast<uint8_t*>(mapping_) : resident_.data(); }
+    const uint8_t* data() const { return mapping_ ? static_cast<const uint8_t*>(mapping_) : resident_.data(); }
+    size_t size() const { return size_; }
+    bool isMapped() const { return mapping_ != nullptr; }
+
+private:
+    std::vector<uint8_t> resident_;
+    void* mapping_;
+    size_t size_;
+};
+
+/**
+ * YUV_420_888 frame stored tile-major
+ *
+ * The frame is split into kBlockSize x kBlockSize blocks; each block holds
+ * its Y samples followed by its U and V samples (planar, tightly packed), so
+ * a tile crop reads a few contiguous runs. Regions convert exactly as
+ * YUVFrameSource converts the original planes. Movable, not copyable.
+ */
+class StoredYUVFrame : public FrameSource {
+public:
+    static constexpr int kBlockSize = 128;
+
+    StoredYUVFrame() : width_(0), height_(0), blocksX_(0), blocksY_(0) {}
+
+    StoredYUVFrame(StoredYUVFrame&&) = default;
+    StoredYUVFrame& operator=(StoredYUVFrame&&) = default;
+
+    /**
+     * Bytes needed to store a frame of the given size
+     */
+    static size_t storageBytes(int width, int height);
+
+    /**
+     * Copy the planes into block storage (rows are copied in parallel)
+     *
+     * @param spill Keep the blocks in a spill file instead of RAM
+     * @return false if the storage could not be allocated
+     */
+    bool assign(const YUVFrame& source, bool spill);
+
+    bool isSpilled() const { return store_.isMapped(); }
+    size_t sizeBytes() const { return store_.size(); }
+
+    int width() const override { return width_; }
+    int height() const override { return height_; }
+
+    void read(int x, int y, int w, int h, RGBImage* rgb, GrayImage* luma) const override;
+
+    /**
+     * Whole-frame conversions run block rows in parallel on the shared pool
+     */
+    const GrayImage& fullLuma(GrayImage& scratch) const override;
+    const RGBImage& fullRGB(RGBImage& scratch) const override;
+
+private:
+    BackingStore store_;
+    int width_, height_;
+    int blocksX_, blocksY_;
+
+    /**
+     * Planes of one block, described as a frame of the block's valid size
+     */
+    YUVFrame blockFrame(int bx, int by) const;
+
+    /**
+     * Convert frame rows [y0, y1) of the region at (x, y), w pixels wide,
+     * into the already sized region outputs
+     */
+    void readRows(int x, int y, int w, int y0, int y1, RGBImage* rgb, GrayImage* luma) const;
+};
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_FRAME_STORE_H
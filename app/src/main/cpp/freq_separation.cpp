@@ -5,7 +5,7 @@
  */
 
 #include "freq_separation.h"
-#include "neon_utils.h"
+#include "simd.h"
 #include <cmath>
 #include <algorithm>
 
@@ -148,11 +148,9 @@ void FreqSeparationProcessor::applyAdaptiveBoost(
     
     boosted.resize(width, height);
     
-#ifdef USE_NEON
-    const float32x4_t vBoost = vdupq_n_f32(boost);
-    const float32x4_t vEdgeProtect = vdupq_n_f32(edgeProtect);
-    const float32x4_t vOne = vdupq_n_f32(1.0f);
-#endif
+    const simd::f32x4 vBoost = simd::f32x4::splat(boost);
+    const simd::f32x4 vEdgeProtect = simd::f32x4::splat(edgeProtect);
+    const simd::f32x4 vOne = simd::f32x4::splat(1.0f);
     
     for (int y = 0; y < height; ++y) {
         const float* hfRow = highFreq.row(y);
@@ -161,21 +159,15 @@ void FreqSeparationProcessor::applyAdaptiveBoost(
         
         int x = 0;
         
-#ifdef USE_NEON
         for (; x + 3 < width; x += 4) {
-            float32x4_t vHF = vld1q_f32(hfRow + x);
-            float32x4_t vEdge = vld1q_f32(edgeRow + x);
+            simd::f32x4 vHF = simd::f32x4::load(hfRow + x);
+            simd::f32x4 vEdge = simd::f32x4::load(edgeRow + x);
             
             // Adaptive boost: reduce boost near strong edges to prevent halos
             // effectiveBoost = boost * (1 - edgeProtection * edgeStrength)
-            float32x4_t vEdgeFactor = vmulq_f32(vEdgeProtect, vEdge);
-            float32x4_t vEffectiveBoost = vmulq_f32(vBoost, vsubq_f32(vOne, vEdgeFactor));
-            
-            // Apply boost
-            float32x4_t vBoosted = vmulq_f32(vHF, vEffectiveBoost);
-            vst1q_f32(outRow + x, vBoosted);
+            simd::f32x4 vEffectiveBoost = vBoost * (vOne - vEdgeProtect * vEdge);
+            (vHF * vEffectiveBoost).store(outRow + x);
         }
-#endif
         
         // Scalar fallback
         for (; x < width; ++x) {
@@ -0,0 +1,338 @@
+/**
+ * frequency_merge.cpp - Frequency-domain burst merge implementation
+ */
+
+#include "frequency_merge.h"
+#include "fft.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace ultradetail {
+
+// Side of the central crop the noise level is estimated on; the estimator
+// sorts every Laplacian response, which is too slow on a full frame
+static constexpr int NOISE_CROP_SIZE = 256;
+
+/**
+ * Noise standard deviation of one channel, from a central crop
+ */
+static float estimateChannelNoise(const RGBImage& image, int channel) {
+    const int cropWidth = std::min(image.width, NOISE_CROP_SIZE);
+    const int cropHeight = std::min(image.height, NOISE_CROP_SIZE);
+    if (cropWidth < 3 || cropHeight < 3) return 0.0f;
+
+    const int x0 = (image.width - cropWidth) / 2;
+    const int y0 = (image.height - cropHeight) / 2;
+    GrayImage crop(cropWidth, cropHeight);
+    for (int y = 0; y < cropHeight; ++y) {
+        const float* src = reinterpret_cast<const float*>(image.row(y0 + y) + x0);
+        float* dst = crop.row(y);
+        for (int x = 0; x < cropWidth; ++x) {
+            dst[x] = src[3 * x + channel];
+        }
+    }
+    return NoiseModel::estimateNoise(crop);
+}
+
+/**
+ * NaN / Inf test on the bit pattern (std::isfinite folds to true under -ffast-math)
+ */
+static inline bool isFiniteSample(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return (bits & 0x7f800000u) != 0x7f800000u;
+}
+
+/**
+ * One image row as three planar channel rows (length samples each, spaced
+ * stride apart), the image starting at pad and its edges repeated into the
+ * rest; non-finite samples take the value in fallback (same layout), or 0
+ * without one
+ */
+static void loadPlanarRow(const RGBPixel* row, int width, int pad, int length, int stride,
+                          const float* fallback, float* planes) {
+    using simd::f32x4;
+    float* r = planes + pad;
+    float* g = r + stride;
+    float* b = g + stride;
+    const float* src = reinterpret_cast<const float*>(row);
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        f32x4 sr, sg, sb;
+        simd::loadDeinterleaved3(src + 3 * x, sr, sg, sb);
+        if (fallback) {
+            sr = simd::replaceNonFinite(sr, f32x4::load(fallback + pad + x));
+            sg = simd::replaceNonFinite(sg, f32x4::load(fallback + stride + pad + x));
+            sb = simd::replaceNonFinite(sb, f32x4::load(fallback + 2 * stride + pad + x));
+        } else {
+            sr = simd::replaceNonFinite(sr, f32x4::zero());
+            sg = simd::replaceNonFinite(sg, f32x4::zero());
+            sb = simd::replaceNonFinite(sb, f32x4::zero());
+        }
+        sr.store(r + x);
+        sg.store(g + x);
+        sb.store(b + x);
+    }
+    for (; x < width; ++x) {
+        r[x] = isFiniteSample(row[x].r) ? row[x].r : (fallback ? fallback[pad + x] : 0.0f);
+        g[x] = isFiniteSample(row[x].g) ? row[x].g : (fallback ? fallback[stride + pad + x] : 0.0f);
+        b[x] = isFiniteSample(row[x].b) ? row[x].b : (fallback ? fallback[2 * stride + pad + x] : 0.0f);
+    }
+    for (int c = 0; c < 3; ++c) {
+        float* plane = planes + c * stride;
+        std::fill(plane, plane + pad, plane[pad]);
+        std::fill(plane + pad + width, plane + length, plane[pad + width - 1]);
+    }
+}
+
+/**
+ * Windowed differences of one frame from the reference over a tile, three
+ * planes spaced 2 * tileSize² apart
+ *
+ * @param frame First planar row of the frame's band at the tile's left edge
+ * @param reference Same position in the reference band
+ * @param stride Distance between rows of the band
+ */
+static void loadDifferences(const float* frame, const float* reference, int stride, int tileSize,
+                            const float* window, float* planes) {
+    using simd::f32x4;
+    const int area = tileSize * tileSize;
+    for (int c = 0; c < 3; ++c) {
+        for (int ty = 0; ty < tileSize; ++ty) {
+            const float* src = frame + (c * tileSize + ty) * stride;
+            const float* ref = reference + (c * tileSize + ty) * stride;
+            const float* weights = window + ty * tileSize;
+            float* dst = planes + 2 * c * area + ty * tileSize;
+            for (int tx = 0; tx < tileSize; tx += 4) {
+                (f32x4::load(weights + tx) * (f32x4::load(src + tx) - f32x4::load(ref + tx))).store(dst + tx);
+            }
+        }
+    }
+}
+
+/**
+ * dst[j] = sign * src[(size - j) mod size]: one spectrum row at negated
+ * frequencies
+ */
+static void mirrorRow(const float* src, float* dst, int size, float sign) {
+    using simd::f32x4;
+    const f32x4 scale = f32x4::splat(sign);
+    (scale * f32x4{{src[0], src[size - 1], src[size - 2], src[size - 3]}}).store(dst);
+    for (int j = 4; j < size; j += 4) {
+        (scale * simd::reverse(f32x4::load(src + size - j - 3))).store(dst + j);
+    }
+}
+
+/**
+ * Split the spectrum D of a packed pair into the two frames' spectra,
+ *
+ *     Da = (D[k] + conj D[-k]) / 2,  Db = (D[k] - conj D[-k]) / 2i,
+ *
+ * and add each, shrunk as k / (|Dx|² + k) Dx, to the merged spectrum. Both
+ * are Hermitian, so only spectrum rows 0 .. size / 2 are produced.
+ */
+static void accumulatePair(const float* real, const float* imag, int size, float k,
+                           float* mirrorReal, float* mirrorImag, float* mergedReal, float* mergedImag) {
+    using simd::f32x4;
+    const int rows = size / 2 + 1;
+    for (int r = 0; r < rows; ++r) {
+        const int source = ((size - r) & (size - 1)) * size;
+        mirrorRow(real + source, mirrorReal + r * size, size, 1.0f);
+        mirrorRow(imag + source, mirrorImag + r * size, size, 1.0f);
+    }
+
+    const f32x4 half = f32x4::splat(0.5f);
+    const f32x4 shrinkage = f32x4::splat(k);
+    for (int i = 0; i < rows * size; i += 4) {
+        const f32x4 dr = f32x4::load(real + i), di = f32x4::load(imag + i);
+        const f32x4 mr = f32x4::load(mirrorReal + i), mi = f32x4::load(mirrorImag + i);
+        const f32x4 ar = (dr + mr) * half, ai = (di - mi) * half;
+        const f32x4 br = (di + mi) * half, bi = (mr - dr) * half;
+        const f32x4 ga = shrinkage / (simd::fma(ar, ar, ai * ai) + shrinkage);
+        const f32x4 gb = shrinkage / (simd::fma(br, br, bi * bi) + shrinkage);
+        simd::fma(gb, br, simd::fma(ga, ar, f32x4::load(mergedReal + i))).store(mergedReal + i);
+        simd::fma(gb, bi, simd::fma(ga, ai, f32x4::load(mergedImag + i))).store(mergedImag + i);
+    }
+}
+
+/**
+ * Rows size / 2 + 1 .. size - 1 of a Hermitian spectrum from the others
+ */
+static void completeHermitian(float* real, float* imag, int size) {
+    for (int r = size / 2 + 1; r < size; ++r) {
+        const int source = (size - r) * size;
+        mirrorRow(real + source, real + r * size, size, 1.0f);
+        mirrorRow(imag + source, imag + r * size, size, -1.0f);
+    }
+}
+
+void mergeFrequencyDomain(
+    const std::vector<RGBImage>& frames,
+    int referenceIndex,
+    const MergeParams& params,
+    RGBImage& output
+) {
+    const int width = frames[0].width;
+    const int height = frames[0].height;
+    const int numFrames = static_cast<int>(frames.size());
+    output = RGBImage(width, height);
+    if (width == 0 || height == 0) return;
+
+    int tileSize = params.frequencyTileSize;
+    if (tileSize != 16 && tileSize != 32) {
+        LOGW("Frequency merge: unsupported tile size %d, using 16", tileSize);
+        tileSize = 16;
+    }
+    const int step = tileSize / 2;
+    const int area = tileSize * tileSize;
+
+    // Raised cosine: windows half a tile apart sum to exactly one
+    std::vector<float> profile(tileSize);
+    float windowEnergy = 0.0f;
+    for (int i = 0; i < tileSize; ++i) {
+        profile[i] = 0.5f - 0.5f * std::cos(2.0f * static_cast<float>(M_PI) * (i + 0.5f) / tileSize);
+        windowEnergy += profile[i] * profile[i];
+    }
+    std::vector<float> window(area);
+    for (int y = 0; y < tileSize; ++y) {
+        for (int x = 0; x < tileSize; ++x) {
+            window[y * tileSize + x] = profile[y] * profile[x];
+        }
+    }
+
+    // Per-bin noise variance of one windowed frame tile (unnormalized FFT):
+    // sigma² times the window energy, which is separable
+    const RGBImage& reference = frames[referenceIndex];
+    float shrinkage[3];
+    for (int c = 0; c < 3; ++c) {
+        const float sigma = estimateChannelNoise(reference, c);
+        const float binVariance = sigma * sigma * windowEnergy * windowEnergy;
+        // Floor keeps the weights defined for noise-free input (they then keep every difference)
+        shrinkage[c] = std::max(params.frequencyNoiseScale * binVariance, 1e-12f);
+    }
+
+    LOGD("Frequency merge: %dpx tiles, reference %d, noise scale %.1f",
+         tileSize, referenceIndex, params.frequencyNoiseScale);
+
+    // Non-reference frames are transformed two at a time
+    std::vector<int> others;
+    for (int f = 0; f < numFrames; ++f) {
+        if (f != referenceIndex) others.push_back(f);
+    }
+
+    // Tile origins start half a tile before the image, so every pixel lies in
+    // exactly two tiles per axis and its window weights sum to one
+    const int tilesX = (width + step - 1) / step + 1;
+    const int tilesY = (height + step - 1) / step + 1;
+    const PlanarFFT2D& fft = PlanarFFT2D::forSize(tileSize);
+    const float invFrames = 1.0f / numFrames;
+
+    // Tile rows of one parity do not overlap, so each pass runs them in parallel.
+    // The tile row's image rows are first copied out of every frame as
+    // planar channels, padded so that the edge tiles read repeated edges.
+    const int pad = step;
+    const int stride = (tilesX + 1) * step;
+    const int bandFrame = 3 * tileSize * stride;
+    for (int parity = 0; parity < 2; ++parity) {
+        const int rows = (tilesY - parity + 1) / 2;
+        ThreadPool::instance().parallelForRows(0, rows, [&](int r0, int r1) {
+            std::vector<float> band(static_cast<size_t>(numFrames) * bandFrame);
+            // Spectra: packed pairs (6 planes), mirrored spectrum (2), merged (6)
+            std::vector<float> block(14 * area);
+            float* pair = block.data();
+            float* mirror = pair + 6 * area;
+            float* merged = mirror + 2 * area;
+            float* referenceBand = band.data() + static_cast<size_t>(referenceIndex) * bandFrame;
+
+            for (int r = r0; r < r1; ++r) {
+                const int originY = (2 * r + parity) * step - step;
+                const int y0 = std::max(0, originY);
+                const int y1 = std::min(height, originY + tileSize);
+
+                for (int ty = 0; ty < tileSize; ++ty) {
+                    const int y = clamp(originY + ty, 0, height - 1);
+                    float* referenceRow = referenceBand + ty * stride;
+                    loadPlanarRow(reference.row(y), width, pad, stride, tileSize * stride, nullptr, referenceRow);
+                    for (int f : others) {
+                        loadPlanarRow(frames[f].row(y), width, pad, stride, tileSize * stride, referenceRow,
+                                      band.data() + static_cast<size_t>(f) * bandFrame + ty * stride);
+                    }
+                }
+
+                for (int t = 0; t < tilesX; ++t) {
+                    const int originX = t * step - step;
+                    const int x0 = std::max(0, originX);
+                    const int x1 = std::min(width, originX + tileSize);
+                    const float* referenceTile = referenceBand + originX + pad;
+
+                    // merged = reference + mean over frames of the shrunk differences
+                    std::fill(merged, merged + 6 * area, 0.0f);
+                    for (size_t p = 0; p < others.size(); p += 2) {
+                        // Channel c: real plane 2c (first frame), imaginary plane 2c + 1
+                        loadDifferences(band.data() + static_cast<size_t>(others[p]) * bandFrame + originX + pad,
+                                        referenceTile, stride, tileSize, window.data(), pair);
+                        if (p + 1 < others.size()) {
+                            loadDifferences(band.data() + static_cast<size_t>(others[p + 1]) * bandFrame + originX + pad,
+                                            referenceTile, stride, tileSize, window.data(), pair + area);
+                        } else {
+                            for (int c = 0; c < 3; ++c) {
+                                std::fill(pair + (2 * c + 1) * area, pair + (2 * c + 2) * area, 0.0f);
+                            }
+                        }
+                        for (int c = 0; c < 3; ++c) {
+                            float* real = pair + 2 * c * area;
+                            fft.forward(real, real + area);
+                            accumulatePair(real, real + area, tileSize, shrinkage[c], mirror, mirror + area,
+                                           merged + 2 * c * area, merged + (2 * c + 1) * area);
+                        }
+                    }
+
+                    // Back to the image: red + i green in one transform, blue alone
+                    for (int c = 0; c < 3; ++c) {
+                        completeHermitian(merged + 2 * c * area, merged + (2 * c + 1) * area, tileSize);
+                    }
+                    float* redGreen = pair;
+                    float* blue = merged + 4 * area;
+                    for (int i = 0; i < area; ++i) {
+                        redGreen[i] = merged[i] - merged[3 * area + i];
+                        redGreen[area + i] = merged[area + i] + merged[2 * area + i];
+                    }
+                    fft.inverse(redGreen, redGreen + area);
+                    fft.inverse(blue, blue + area);
+
+                    for (int y = y0; y < y1; ++y) {
+                        const int ty = y - originY;
+                        const float* refR = referenceTile + ty * stride - originX;
+                        const float* refG = refR + tileSize * stride;
+                        const float* refB = refG + tileSize * stride;
+                        const int offset = ty * tileSize - originX;
+                        RGBPixel* dst = output.row(y);
+                        for (int x = x0; x < x1; ++x) {
+                            const int i = offset + x;
+                            dst[x].r += window[i] * refR[x] + invFrames * redGreen[i];
+                            dst[x].g += window[i] * refG[x] + invFrames * redGreen[area + i];
+                            dst[x].b += window[i] * refB[x] + invFrames * blue[i];
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            RGBPixel* row = output.row(y);
+            for (int x = 0; x < width; ++x) {
+                row[x] = RGBPixel(clamp(row[x].r, 0.0f, 1.0f),
+                                  clamp(row[x].g, 0.0f, 1.0f),
+                                  clamp(row[x].b, 0.0f, 1.0f));
+            }
+        }
+    });
+}
+
+} // namespace ultradetail
@@ -0,0 +1,53 @@
+/**
+ * frequency_merge.h - HDR+ style pairwise frequency-domain burst merge
+ *
+ * The image is cut into tiles overlapping by half a tile, each weighted by
+ * a raised-cosine window (the windows of overlapping tiles sum to one).
+ * Every frame's tile is pulled towards the reference per frequency,
+ *
+ *     merged = mean over frames of Z + A (R - Z),  A = |R - Z|² / (|R - Z|² + c σ²),
+ *
+ * where σ² is the per-bin noise variance of one frame (NoiseModel estimate
+ * of the reference, scaled by the window energy) and c is
+ * MergeParams::frequencyNoiseScale. Differences at the noise level are
+ * averaged away; differences well above it (misalignment, motion) fall
+ * back to the reference. The merged tiles are transformed back and
+ * overlap-added, so robustness and denoising come from the one pass.
+ *
+ * Only the differences Z - R are transformed, two frames at a time packed
+ * as the real and imaginary parts of one PlanarFFT2D tile; each tile row is
+ * first copied out of every frame as planar channels and shared by all its
+ * tiles. Non-finite samples are replaced by the reference (by 0 in the
+ * reference itself), so one bad pixel cannot spread over a whole tile.
+ *
+ * Reference: Hasinoff et al., "Burst photography for high dynamic range and
+ * low-light imaging on mobile cameras", SIGGRAPH Asia 2016, section 5.
+ */
+
+#ifndef ULTRADETAIL_FREQUENCY_MERGE_H
+#define ULTRADETAIL_FREQUENCY_MERGE_H
+
+#include "common.h"
+#include "merge.h"
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * Merge aligned frames in the frequency domain
+ *
+ * @param frames Aligned RGB frames of equal size
+ * @param referenceIndex Frame the others are merged towards
+ * @param params Merge parameters (frequencyTileSize, frequencyNoiseScale)
+ * @param output Merged image, clamped to [0, 1]
+ */
+void mergeFrequencyDomain(
+    const std::vector<RGBImage>& frames,
+    int referenceIndex,
+    const MergeParams& params,
+    RGBImage& output
+);
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_FREQUENCY_MERGE_H
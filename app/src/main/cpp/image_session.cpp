@@ -0,0 +1,145 @@
+/**
+ * image_session.cpp - Float working image implementation
+ */
+
+#include "image_session.h"
+#include "thread_pool.h"
+#include <cmath>
+#include <utility>
+
+#undef LOG_TAG
+#define LOG_TAG "ImageSession"
+
+namespace ultradetail {
+
+void ImageSession::load(const RGBA8View& pixels) {
+    image_.resize(pixels.width, pixels.height);
+
+    ThreadPool::instance().parallelForRows(0, pixels.height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const RGBA8Pixel* src = pixels.row(y);
+            RGBPixel* dst = image_.row(y);
+            for (int x = 0; x < pixels.width; ++x) {
+                dst[x] = RGBPixel(src[x].r / 255.0f, src[x].g / 255.0f, src[x].b / 255.0f);
+            }
+        }
+    });
+}
+
+void ImageSession::applyFreqSeparation(const FreqSeparationParams& params) {
+    FreqSeparationProcessor processor(params);
+    processor.processRGB(image_, scratch_);
+    std::swap(image_, scratch_);
+}
+
+void ImageSession::applyAnisotropicFilter(const AnisotropicMergeParams& params) {
+    AnisotropicMergeProcessor processor(params);
+    processor.filterRGB(image_, scratch_);
+    std::swap(image_, scratch_);
+}
+
+int ImageSession::applyReferenceDetailTransfer(const RGBA8View& reference, float blendStrength) {
+    const int outWidth = image_.width;
+    const int outHeight = image_.height;
+    const int refWidth = reference.width;
+    const int refHeight = reference.height;
+    if (refWidth <= 0 || refHeight <= 0) {
+        return 0;
+    }
+
+    const float scaleX = static_cast<float>(outWidth) / refWidth;
+    const float scaleY = static_cast<float>(outHeight) / refHeight;
+    const int kernelRadius = 1;
+
+    int patchesTransferred = 0;
+    float totalDetailAdded = 0.0f;
+
+    // Laplacians are measured in 8-bit units so the thresholds match the
+    // Bitmap-based transfer. Rows are updated in place and in order, so each
+    // pixel sees the already transferred pixels above and to its left.
+    for (int y = kernelRadius; y < outHeight - kernelRadius; ++y) {
+        RGBPixel* outRow = image_.row(y);
+        const RGBPixel* outAbove = image_.row(y - 1);
+        const RGBPixel* outBelow = image_.row(y + 1);
+
+        for (int x = kernelRadius; x < outWidth - kernelRadius; ++x) {
+            int rx = static_cast<int>(x / scaleX);
+            int ry = static_cast<int>(y / scaleY);
+            if (rx < kernelRadius || rx >= refWidth - kernelRadius ||
+                ry < kernelRadius || ry >= refHeight - kernelRadius) {
+                continue;
+            }
+
+            const RGBA8Pixel& c = reference.at(rx, ry);
+            const RGBA8Pixel& t = reference.at(rx, ry - 1);
+            const RGBA8Pixel& b = reference.at(rx, ry + 1);
+            const RGBA8Pixel& l = reference.at(rx - 1, ry);
+            const RGBA8Pixel& r = reference.at(rx + 1, ry);
+
+            float lapR = 4.0f * c.r - t.r - b.r - l.r - r.r;
+            float lapG = 4.0f * c.g - t.g - b.g - l.g - r.g;
+            float lapB = 4.0f * c.b - t.b - b.b - l.b - r.b;
+            float lapMag = std::sqrt(lapR * lapR + lapG * lapG + lapB * lapB) / 255.0f;
+
+            // Only transfer if the reference has significant high frequency
+            if (lapMag <= 0.05f) {
+                continue;
+            }
+
+            const RGBPixel& oc = outRow[x];
+            const RGBPixel& ot = outAbove[x];
+            const RGBPixel& ob = outBelow[x];
+            const RGBPixel& ol = outRow[x - 1];
+            const RGBPixel& orr = outRow[x + 1];
+
+            float outLapR = 4.0f * oc.r - ot.r - ob.r - ol.r - orr.r;
+            float outLapG = 4.0f * oc.g - ot.g - ob.g - ol.g - orr.g;
+            float outLapB = 4.0f * oc.b - ot.b - ob.b - ol.b - orr.b;
+            float outLapMag = std::sqrt(outLapR * outLapR + outLapG * outLapG + outLapB * outLapB);
+
+            // Transfer if the reference has more detail
+            if (lapMag > outLapMag * 1.2f) {
+                // Detail spreads over more pixels at the output scale
+                float detailRatio = (lapMag - outLapMag) / (lapMag + 0.01f);
+                float adaptiveBlend = blendStrength * detailRatio / (scaleX * 255.0f);
+
+                RGBPixel& p = outRow[x];
+                p.r = clamp(p.r + adaptiveBlend * lapR, 0.0f, 1.0f);
+                p.g = clamp(p.g + adaptiveBlend * lapG, 0.0f, 1.0f);
+                p.b = clamp(p.b + adaptiveBlend * lapB, 0.0f, 1.0f);
+
+                patchesTransferred++;
+                totalDetailAdded += blendStrength * detailRatio * lapMag;
+            }
+        }
+    }
+
+    float avgDetail = patchesTransferred > 0 ? totalDetailAdded / patchesTransferred : 0.0f;
+    LOGI("Reference detail transfer: %d patches transferred, avg detail=%.4f",
+         patchesTransferred, avgDetail);
+    return patchesTransferred;
+}
+
+bool ImageSession::applyTextureSynthesis(const TileSynthConfig& config, TextureSynthResult* stats) {
+    TiledTextureSynthProcessor processor(config);
+    TextureSynthResult result = processor.synthesize(image_);
+    if (!result.success) {
+        LOGE("Texture synthesis failed");
+        return false;
+    }
+
+    std::swap(image_, result.synthesized);
+    if (stats) {
+        stats->detailMask = std::move(result.detailMask);
+        stats->avgDetailAdded = result.avgDetailAdded;
+        stats->patchesProcessed = result.patchesProcessed;
+        stats->success = true;
+    }
+    return true;
+}
+
+void ImageSession::exportTo(uint8_t* output, int outputStride, const ArgbPackOptions& options) const {
+    rgbFloatToArgb(image_, output, outputStride, options);
+}
+
+} // namespace ultradetail
@@ -0,0 +1,93 @@
+/**
+ * image_session.h - Float working image shared by chained enhancement steps
+ *
+ * The post-MFSR enhancement chain (reference detail transfer, frequency
+ * separation, anisotropic filtering, texture synthesis) used to round-trip
+ * through an 8-bit Bitmap between every step. An ImageSession imports the
+ * image once, keeps it as float RGB while the steps run in place, and packs
+ * it back to 8 bits a single time at export, so intermediate results are
+ * never quantized.
+ */
+
+#ifndef ULTRADETAIL_IMAGE_SESSION_H
+#define ULTRADETAIL_IMAGE_SESSION_H
+
+#include "common.h"
+#include "yuv_converter.h"
+#include "freq_separation.h"
+#include "anisotropic_merge.h"
+#include "texture_synthesis_tiled.h"
+
+namespace ultradetail {
+
+/**
+ * Float RGB working image with in-place enhancement operations
+ *
+ * Not thread-safe: operations on one session must be serialized by the caller.
+ */
+class ImageSession {
+public:
+    ImageSession() = default;
+
+    ImageSession(const ImageSession&) = delete;
+    ImageSession& operator=(const ImageSession&) = delete;
+
+    /**
+     * Replace the working image with 8-bit RGBA pixels
+     */
+    void load(const RGBA8View& pixels);
+
+    int width() const { return image_.width; }
+    int height() const { return image_.height; }
+    bool empty() const { return image_.empty(); }
+
+    const RGBImage& image() const { return image_; }
+
+    /**
+     * Frequency separation enhancement (see FreqSeparationProcessor)
+     */
+    void applyFreqSeparation(const FreqSeparationParams& params);
+
+    /**
+     * Edge-aware anisotropic filtering (see AnisotropicMergeProcessor)
+     */
+    void applyAnisotropicFilter(const AnisotropicMergeParams& params);
+
+    /**
+     * Transfer Laplacian detail from a lower-resolution reference frame
+     *
+     * Same rule as the Bitmap-based transfer: where the reference has
+     * stronger high frequency than the working image at the mapped
+     * position, its scaled Laplacian is added with an adaptive blend.
+     *
+     * @param reference Reference frame (e.g. the sharpest burst frame)
+     * @param blendStrength How much high frequency to transfer (0-1)
+     * @return Number of pixels that received detail
+     */
+    int applyReferenceDetailTransfer(const RGBA8View& reference, float blendStrength);
+
+    /**
+     * Tiled texture synthesis (see TiledTextureSynthProcessor)
+     *
+     * @param stats Receives the detail mask and statistics (not the image; may be nullptr)
+     * @return false if synthesis failed (the working image is unchanged)
+     */
+    bool applyTextureSynthesis(const TileSynthConfig& config, TextureSynthResult* stats = nullptr);
+
+    /**
+     * Pack the working image into 8-bit RGBA pixels
+     *
+     * @param output Destination, width() x height() pixels
+     * @param outputStride Destination row stride in bytes
+     */
+    void exportTo(uint8_t* output, int outputStride,
+                  const ArgbPackOptions& options = ArgbPackOptions()) const;
+
+private:
+    RGBImage image_;
+    RGBImage scratch_;      // Output of out-of-place processors, swapped in
+};
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_IMAGE_SESSION_H
@@ -5,7 +5,6 @@
  */
 
 #include "kalman_fusion.h"
-#include "neon_utils.h"
 #include <cmath>
 #include <algorithm>
 
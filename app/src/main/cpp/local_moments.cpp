@@ -0,0 +1,197 @@
+/**
+ * local_moments.cpp - Summed-area table local statistics implementation
+ */
+
+#include "local_moments.h"
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace ultradetail {
+
+// Output pixels per tile side; tables add the window radius on each side
+static constexpr int MOMENT_TILE_SIZE = 128;
+
+static inline void loadSample(const float* row, int x, float* out) {
+    out[0] = row[x];
+}
+
+static inline void loadSample(const RGBPixel* row, int x, float* out) {
+    out[0] = row[x].r;
+    out[1] = row[x].g;
+    out[2] = row[x].b;
+}
+
+static inline void storeSample(float* row, int x, const float* in) {
+    row[x] = in[0];
+}
+
+static inline void storeSample(RGBPixel* row, int x, const float* in) {
+    row[x] = RGBPixel(in[0], in[1], in[2]);
+}
+
+/**
+ * Fill a (w + 1) x (h + 1) table: each entry holds the sums over the
+ * rectangle above and left of it, first row and column zero
+ */
+template <int C, typename T>
+static void buildTables(const ImageView<T>& image, int x0, int y0, int w, int h, WindowBorder border,
+                        double* table) {
+    constexpr int kEntry = 2 * C;
+    const int stride = (w + 1) * kEntry;
+    std::fill(table, table + stride, 0.0);
+    if (image.width == 0 || image.height == 0) {
+        border = WindowBorder::CLIP;   // Nothing to replicate
+    }
+
+    for (int ty = 0; ty < h; ++ty) {
+        const double* above = table + static_cast<size_t>(ty) * stride;
+        double* current = table + static_cast<size_t>(ty + 1) * stride;
+        std::fill(current, current + kEntry, 0.0);
+
+        int iy = y0 + ty;
+        const bool rowInside = iy >= 0 && iy < image.height;
+        if (border == WindowBorder::REPLICATE) {
+            iy = clamp(iy, 0, image.height - 1);
+        }
+        const T* row = rowInside || border == WindowBorder::REPLICATE ? image.row(iy) : nullptr;
+
+        double run[kEntry] = {};
+        for (int tx = 0; tx < w; ++tx) {
+            int ix = x0 + tx;
+            float sample[C] = {};
+            if (border == WindowBorder::REPLICATE) {
+                loadSample(row, clamp(ix, 0, image.width - 1), sample);
+            } else if (row && ix >= 0 && ix < image.width) {
+                loadSample(row, ix, sample);
+            }
+            for (int c = 0; c < C; ++c) {
+                const double v = sample[c];
+                run[2 * c] += v;
+                run[2 * c + 1] += v * v;
+            }
+
+            const size_t entry = static_cast<size_t>(tx + 1) * kEntry;
+            for (int k = 0; k < kEntry; ++k) {
+                current[entry + k] = above[entry + k] + run[k];
+            }
+        }
+    }
+}
+
+void LocalMoments::build(const GrayView& image, int x0, int y0, int x1, int y1, WindowBorder border) {
+    channels_ = 1;
+    originX_ = x0;
+    originY_ = y0;
+    entriesPerRow_ = std::max(0, x1 - x0) + 1;
+    imageWidth_ = image.width;
+    imageHeight_ = image.height;
+    border_ = border;
+    table_.resize(static_cast<size_t>(entriesPerRow_) * (std::max(0, y1 - y0) + 1) * 2);
+    buildTables<1>(image, x0, y0, x1 - x0, std::max(0, y1 - y0), border, table_.data());
+}
+
+void LocalMoments::build(const RGBView& image, int x0, int y0, int x1, int y1, WindowBorder border) {
+    channels_ = 3;
+    originX_ = x0;
+    originY_ = y0;
+    entriesPerRow_ = std::max(0, x1 - x0) + 1;
+    imageWidth_ = image.width;
+    imageHeight_ = image.height;
+    border_ = border;
+    table_.resize(static_cast<size_t>(entriesPerRow_) * (std::max(0, y1 - y0) + 1) * 6);
+    buildTables<3>(image, x0, y0, x1 - x0, std::max(0, y1 - y0), border, table_.data());
+}
+
+void LocalMoments::meanVariance(int x0, int y0, int x1, int y1, float* mean, float* variance) const {
+    if (border_ == WindowBorder::CLIP) {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, imageWidth_);
+        y1 = std::min(y1, imageHeight_);
+    }
+
+    const int count = std::max(0, x1 - x0) * std::max(0, y1 - y0);
+    if (count == 0) {
+        for (int c = 0; c < channels_; ++c) {
+            if (mean) mean[c] = 0.0f;
+            if (variance) variance[c] = 0.0f;
+        }
+        return;
+    }
+
+    const int entry = 2 * channels_;
+    const size_t stride = static_cast<size_t>(entriesPerRow_) * entry;
+    const double* top = table_.data() + (y0 - originY_) * stride;
+    const double* bottom = table_.data() + (y1 - originY_) * stride;
+    const size_t left = static_cast<size_t>(x0 - originX_) * entry;
+    const size_t right = static_cast<size_t>(x1 - originX_) * entry;
+
+    const double invCount = 1.0 / count;
+    for (int c = 0; c < channels_; ++c) {
+        const int k = 2 * c;
+        const double sum = bottom[right + k] - bottom[left + k] - top[right + k] + top[left + k];
+        const double sumSq = bottom[right + k + 1] - bottom[left + k + 1] - top[right + k + 1] + top[left + k + 1];
+        const double m = sum * invCount;
+        if (mean) mean[c] = static_cast<float>(m);
+        if (variance) variance[c] = static_cast<float>(std::max(0.0, sumSq * invCount - m * m));
+    }
+}
+
+template <int C, typename T>
+static void computeDense(const ImageView<T>& image, int radius, WindowBorder border,
+                         ImageBuffer<T>* mean, ImageBuffer<T>* variance) {
+    const int width = image.width;
+    const int height = image.height;
+    if (mean) mean->resize(width, height);
+    if (variance) variance->resize(width, height);
+    if (width == 0 || height == 0 || (!mean && !variance)) return;
+
+    radius = std::max(0, radius);
+    const int tilesX = (width + MOMENT_TILE_SIZE - 1) / MOMENT_TILE_SIZE;
+    const int tilesY = (height + MOMENT_TILE_SIZE - 1) / MOMENT_TILE_SIZE;
+
+    // One set of tables per band of tile rows, reused across its tiles
+    ThreadPool::instance().parallelForRows(0, tilesY, [&](int ty0, int ty1) {
+        LocalMoments moments;
+        float m[C], v[C];
+        for (int ty = ty0; ty < ty1; ++ty) {
+            const int y0 = ty * MOMENT_TILE_SIZE;
+            const int y1 = std::min(height, y0 + MOMENT_TILE_SIZE);
+            for (int tx = 0; tx < tilesX; ++tx) {
+                const int x0 = tx * MOMENT_TILE_SIZE;
+                const int x1 = std::min(width, x0 + MOMENT_TILE_SIZE);
+
+                // Clipped windows never leave the image, replicated ones do
+                if (border == WindowBorder::CLIP) {
+                    moments.build(image, std::max(0, x0 - radius), std::max(0, y0 - radius),
+                                  std::min(width, x1 + radius), std::min(height, y1 + radius), border);
+                } else {
+                    moments.build(image, x0 - radius, y0 - radius, x1 + radius, y1 + radius, border);
+                }
+
+                for (int y = y0; y < y1; ++y) {
+                    T* meanRow = mean ? mean->row(y) : nullptr;
+                    T* varianceRow = variance ? variance->row(y) : nullptr;
+                    for (int x = x0; x < x1; ++x) {
+                        moments.meanVariance(x - radius, y - radius, x + radius + 1, y + radius + 1,
+                                             m, v);
+                        if (meanRow) storeSample(meanRow, x, m);
+                        if (varianceRow) storeSample(varianceRow, x, v);
+                    }
+                }
+            }
+        }
+    });
+}
+
+void computeLocalMoments(const GrayView& image, int radius, WindowBorder border,
+                         GrayImage* mean, GrayImage* variance) {
+    computeDense<1>(image, radius, border, mean, variance);
+}
+
+void computeLocalMoments(const RGBView& image, int radius, WindowBorder border,
+                         RGBImage* mean, RGBImage* variance) {
+    computeDense<3>(image, radius, border, mean, variance);
+}
+
+} // namespace ultradetail
@@ -0,0 +1,84 @@
+/**
+ * local_moments.h - Box-window mean and variance from summed-area tables
+ *
+ * Wiener filtering and texture synthesis need the mean and variance of a
+ * window around every pixel. LocalMoments keeps summed-area tables of x and
+ * x² (in double, so differences of large sums stay exact enough for small
+ * variances) for one rectangle of an image and answers any window inside it
+ * with four lookups per moment, whatever its size.
+ *
+ * Tables cover one tile at a time: computeLocalMoments() walks the image in
+ * tiles plus a window-radius margin, so memory beyond the output maps is a
+ * few tile-sized tables per pool thread rather than full-image tables.
+ */
+
+#ifndef ULTRADETAIL_LOCAL_MOMENTS_H
+#define ULTRADETAIL_LOCAL_MOMENTS_H
+
+#include "common.h"
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * What a window covers where it extends past the image
+ */
+enum class WindowBorder {
+    CLIP,       // Only the pixels inside the image
+    REPLICATE   // Nearest edge pixel, so every window has its full size
+};
+
+/**
+ * Summed-area tables of x and x² per channel over one rectangle of an image
+ */
+class LocalMoments {
+public:
+    static constexpr int MAX_CHANNELS = 3;
+
+    /**
+     * Build the tables for [x0, x1) x [y0, y1) in image coordinates
+     *
+     * The rectangle may extend past the image: with REPLICATE the outside
+     * holds the nearest edge pixel, with CLIP it is left out of every window.
+     */
+    void build(const GrayView& image, int x0, int y0, int x1, int y1, WindowBorder border);
+    void build(const RGBView& image, int x0, int y0, int x1, int y1, WindowBorder border);
+
+    int channels() const { return channels_; }
+
+    /**
+     * Mean and variance of each channel over [x0, x1) x [y0, y1)
+     *
+     * The window must lie inside the built rectangle (with CLIP, after it is
+     * clipped to the image). An empty window gives zeros.
+     *
+     * @param mean Output, channels() values (may be nullptr)
+     * @param variance Output, channels() values, never negative (may be nullptr)
+     */
+    void meanVariance(int x0, int y0, int x1, int y1, float* mean, float* variance) const;
+
+private:
+    int channels_ = 0;
+    int originX_ = 0;           // Image position of the rectangle
+    int originY_ = 0;
+    int entriesPerRow_ = 0;     // Rectangle width + 1
+    int imageWidth_ = 0;
+    int imageHeight_ = 0;
+    WindowBorder border_ = WindowBorder::CLIP;
+    std::vector<double> table_; // Per entry: sum and sum of squares of each channel
+};
+
+/**
+ * Mean and variance of the (2 * radius + 1)² window around every pixel
+ *
+ * Runs tile by tile on the thread pool; cost per pixel does not depend on
+ * the radius. Outputs are resized to the image; pass nullptr to skip one.
+ */
+void computeLocalMoments(const GrayView& image, int radius, WindowBorder border,
+                         GrayImage* mean, GrayImage* variance);
+void computeLocalMoments(const RGBView& image, int radius, WindowBorder border,
+                         RGBImage* mean, RGBImage* variance);
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_LOCAL_MOMENTS_H
@@ -0,0 +1,129 @@
+/**
+ * logging.cpp - Log sink implementation
+ */
+
+#include "logging.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#if defined(__ANDROID__)
+#include <android/log.h>
+#endif
+
+namespace ultradetail {
+
+#if defined(__ANDROID__)
+static std::atomic<int> g_sink(static_cast<int>(LogSink::LOGCAT));
+#else
+static std::atomic<int> g_sink(static_cast<int>(LogSink::STDERR));
+#endif
+static std::atomic<int> g_minLevel(static_cast<int>(LogLevel::DEBUG));
+
+static std::mutex g_ringMutex;
+static std::deque<std::string> g_ring;
+static size_t g_ringCapacity = 1024;
+
+void setLogSink(LogSink sink) {
+    g_sink.store(static_cast<int>(sink), std::memory_order_relaxed);
+}
+
+LogSink getLogSink() {
+    return static_cast<LogSink>(g_sink.load(std::memory_order_relaxed));
+}
+
+void setMinLogLevel(LogLevel level) {
+    g_minLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void setLogRingCapacity(size_t lines) {
+    std::lock_guard<std::mutex> lock(g_ringMutex);
+    g_ringCapacity = lines;
+    while (g_ring.size() > g_ringCapacity) {
+        g_ring.pop_front();
+    }
+}
+
+std::vector<std::string> logRingSnapshot(bool clear) {
+    std::lock_guard<std::mutex> lock(g_ringMutex);
+    std::vector<std::string> lines(g_ring.begin(), g_ring.end());
+    if (clear) {
+        g_ring.clear();
+    }
+    return lines;
+}
+
+static char levelLetter(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return 'D';
+        case LogLevel::INFO:  return 'I';
+        case LogLevel::WARN:  return 'W';
+        case LogLevel::ERROR: return 'E';
+    }
+    return '?';
+}
+
+void logPrint(LogLevel level, const char* tag, const char* format, ...) {
+    const LogSink sink = getLogSink();
+    if (sink == LogSink::NONE || static_cast<int>(level) < g_minLevel.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // Most messages fit on the stack; longer ones are formatted again into a string
+    char stackBuffer[512];
+    std::string heapBuffer;
+    const char* message = stackBuffer;
+
+    va_list args;
+    va_start(args, format);
+    va_list retry;
+    va_copy(retry, args);
+    int length = vsnprintf(stackBuffer, sizeof(stackBuffer), format, args);
+    if (length >= static_cast<int>(sizeof(stackBuffer))) {
+        heapBuffer.resize(static_cast<size_t>(length) + 1);
+        vsnprintf(&heapBuffer[0], heapBuffer.size(), format, retry);
+        heapBuffer.resize(static_cast<size_t>(length));
+        message = heapBuffer.c_str();
+    } else if (length < 0) {
+        message = format;
+    }
+    va_end(retry);
+    va_end(args);
+
+    switch (sink) {
+        case LogSink::LOGCAT:
+#if defined(__ANDROID__)
+            __android_log_write(static_cast<int>(level), tag, message);
+            break;
+#else
+            [[fallthrough]];
+#endif
+        case LogSink::STDERR:
+            fprintf(stderr, "%c/%s: %s\n", levelLetter(level), tag, message);
+            break;
+        case LogSink::RING_BUFFER: {
+            std::string line;
+            line.reserve(strlen(tag) + strlen(message) + 4);
+            line += levelLetter(level);
+            line += '/';
+            line += tag;
+            line += ": ";
+            line += message;
+
+            std::lock_guard<std::mutex> lock(g_ringMutex);
+            if (g_ringCapacity == 0) break;
+            if (g_ring.size() >= g_ringCapacity) {
+                g_ring.pop_front();
+            }
+            g_ring.push_back(std::move(line));
+            break;
+        }
+        case LogSink::NONE:
+            break;
+    }
+}
+
+} // namespace ultradetail
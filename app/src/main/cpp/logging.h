@@ -0,0 +1,74 @@
+/**
+ * logging.h - Log sink behind the LOGD / LOGI / LOGW / LOGE macros
+ *
+ * The pipeline code logs through common.h's macros, which call logPrint()
+ * instead of the Android logger directly, so the core library builds and
+ * runs without the NDK. Messages go to one sink chosen at runtime: logcat
+ * (Android only), stderr, or an in-memory ring buffer that tests and host
+ * tools read back. The default is logcat on Android and stderr elsewhere.
+ */
+
+#ifndef ULTRADETAIL_LOGGING_H
+#define ULTRADETAIL_LOGGING_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * Message priority (values match android_LogPriority)
+ */
+enum class LogLevel {
+    DEBUG = 3,
+    INFO = 4,
+    WARN = 5,
+    ERROR = 6
+};
+
+/**
+ * Where log messages go
+ */
+enum class LogSink {
+    LOGCAT,         // __android_log_print; stderr when built without Android
+    STDERR,         // One "L/tag: message" line per message
+    RING_BUFFER,    // Last N formatted lines kept in memory
+    NONE            // Discard
+};
+
+/**
+ * Select the sink (thread-safe; messages already in the ring buffer stay)
+ */
+void setLogSink(LogSink sink);
+LogSink getLogSink();
+
+/**
+ * Drop messages below the given level before they are formatted
+ */
+void setMinLogLevel(LogLevel level);
+
+/**
+ * Lines kept by the ring buffer sink (default 1024); older lines are dropped
+ */
+void setLogRingCapacity(size_t lines);
+
+/**
+ * Copy of the ring buffer, oldest line first
+ *
+ * @param clear Empty the buffer after copying
+ */
+std::vector<std::string> logRingSnapshot(bool clear = false);
+
+/**
+ * Format and emit one message (use the LOGx macros instead)
+ */
+void logPrint(LogLevel level, const char* tag, const char* format, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 3, 4)))
+#endif
+    ;
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_LOGGING_H
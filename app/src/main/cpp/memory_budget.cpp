@@ -0,0 +1,61 @@
+/**
+ * memory_budget.cpp - Working-set accounting implementation
+ */
+
+#include "memory_budget.h"
+#include <cstdio>
+#include <unistd.h>
+
+namespace ultradetail {
+
+void MemoryTracker::allocate(size_t bytes) {
+    size_t now = current_.fetch_add(bytes) + bytes;
+    size_t peak = peak_.load();
+    while (now > peak && !peak_.compare_exchange_weak(peak, now)) {
+    }
+}
+
+void MemoryTracker::release(size_t bytes) {
+    current_.fetch_sub(bytes);
+}
+
+void MemoryTracker::reset() {
+    current_.store(0);
+    peak_.store(0);
+}
+
+size_t currentResidentBytes() {
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+
+    unsigned long sizePages = 0, residentPages = 0;
+    int fields = fscanf(file, "%lu %lu", &sizePages, &residentPages);
+    fclose(file);
+
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (fields != 2 || pageSize <= 0) {
+        return 0;
+    }
+    return static_cast<size_t>(residentPages) * static_cast<size_t>(pageSize);
+}
+
+size_t availableSystemBytes() {
+    FILE* file = fopen("/proc/meminfo", "r");
+    if (!file) {
+        return 0;
+    }
+
+    char line[128];
+    unsigned long availableKB = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "MemAvailable: %lu kB", &availableKB) == 1) {
+            break;
+        }
+    }
+    fclose(file);
+    return static_cast<size_t>(availableKB) * 1024;
+}
+
+} // namespace ultradetail
@@ -0,0 +1,82 @@
+/**
+ * memory_budget.h - Working-set accounting for memory-bounded processing
+ *
+ * Processors register the buffers they own with a MemoryTracker while they
+ * are alive, which gives the current and peak working set without hooking
+ * the allocator. Process-wide resident memory is sampled separately.
+ */
+
+#ifndef ULTRADETAIL_MEMORY_BUDGET_H
+#define ULTRADETAIL_MEMORY_BUDGET_H
+
+#include "common.h"
+#include <atomic>
+#include <cstddef>
+
+namespace ultradetail {
+
+/**
+ * Thread-safe current / peak byte counter
+ */
+class MemoryTracker {
+public:
+    MemoryTracker() : current_(0), peak_(0) {}
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    void allocate(size_t bytes);
+    void release(size_t bytes);
+
+    /**
+     * Forget the peak (and the current count) before a new run
+     */
+    void reset();
+
+    size_t current() const { return current_.load(); }
+    size_t peak() const { return peak_.load(); }
+
+private:
+    std::atomic<size_t> current_;
+    std::atomic<size_t> peak_;
+};
+
+/**
+ * Registers bytes with a tracker for the lifetime of the scope
+ */
+class ScopedMemory {
+public:
+    ScopedMemory(MemoryTracker& tracker, size_t bytes) : tracker_(tracker), bytes_(bytes) {
+        tracker_.allocate(bytes_);
+    }
+    ~ScopedMemory() { tracker_.release(bytes_); }
+
+    ScopedMemory(const ScopedMemory&) = delete;
+    ScopedMemory& operator=(const ScopedMemory&) = delete;
+
+private:
+    MemoryTracker& tracker_;
+    size_t bytes_;
+};
+
+/**
+ * Bytes held by an image buffer
+ */
+template<typename T>
+inline size_t imageBytes(const ImageBuffer<T>& image) {
+    return image.data.capacity() * sizeof(T);
+}
+
+/**
+ * Resident set size of the process in bytes (0 if unavailable)
+ */
+size_t currentResidentBytes();
+
+/**
+ * Memory the system reports available for new allocations (0 if unavailable)
+ */
+size_t availableSystemBytes();
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_MEMORY_BUDGET_H
@@ -6,8 +6,12 @@
  */
 
 #include "merge.h"
-#include "neon_utils.h"
+#include "merge_kernels.h"
+#include "frequency_merge.h"
+#include "local_moments.h"
+#include "thread_pool.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <numeric>
 
@@ -95,7 +99,7 @@ float FrameMerger::median(std::vector<float>& values) {
     return values[n / 2];
 }
 
-void FrameMerger::merge(const std::vector<RGBImage>& frames, RGBImage& output) {
+void FrameMerger::merge(const std::vector<RGBImage>& frames, RGBImage& output, int referenceIndex) {
     if (frames.empty()) {
         output = RGBImage();
         return;
@@ -115,61 +119,91 @@ void FrameMerger::merge(const std::vector<RGBImage>& frames, RGBImage& output) {
     LOGD("Merging %d frames (%dx%d) using method %d",
          numFrames, width, height, static_cast<int>(params_.method));
     
-    // Temporary storage for pixel values
-    std::vector<float> rValues(numFrames);
-    std::vector<float> gValues(numFrames);
-    std::vector<float> bValues(numFrames);
+    if (params_.method == MergeMethod::FREQUENCY_DOMAIN) {
+        if (referenceIndex < 0 || referenceIndex >= numFrames) {
+            referenceIndex = numFrames / 2;
+        }
+        mergeFrequencyDomain(frames, referenceIndex, params_, output);
+        LOGD("Merge complete");
+        return;
+    }
     
-    for (int y = 0; y < height; ++y) {
-        RGBPixel* outRow = output.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            // Gather values from all frames
-            for (int f = 0; f < numFrames; ++f) {
-                const RGBPixel& px = frames[f].at(x, y);
-                rValues[f] = px.r;
-                gValues[f] = px.g;
-                bValues[f] = px.b;
+    // Usual burst sizes have a sorting-network kernel; larger ones fall back to
+    // the per-pixel reductions below
+    const MergeRowKernel kernel = mergeRowKernel(params_.method, numFrames);
+    if (kernel) {
+        ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+            std::vector<const RGBPixel*> rows(numFrames);
+            for (int y = y0; y < y1; ++y) {
+                for (int f = 0; f < numFrames; ++f) {
+                    rows[f] = frames[f].row(y);
+                }
+                kernel(rows.data(), output.row(y), width, params_);
             }
+        });
+    } else {
+        // Rows are independent; each band gets its own gather buffers
+        ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+            // Temporary storage for pixel values
+            std::vector<float> rValues(numFrames);
+            std::vector<float> gValues(numFrames);
+            std::vector<float> bValues(numFrames);
             
-            // Merge based on method
-            RGBPixel merged;
-            
-            switch (params_.method) {
-                case MergeMethod::AVERAGE: {
-                    float rSum = 0, gSum = 0, bSum = 0;
+            for (int y = y0; y < y1; ++y) {
+                RGBPixel* outRow = output.row(y);
+                
+                for (int x = 0; x < width; ++x) {
+                    // Gather values from all frames
                     for (int f = 0; f < numFrames; ++f) {
-                        rSum += rValues[f];
-                        gSum += gValues[f];
-                        bSum += bValues[f];
+                        const RGBPixel& px = frames[f].at(x, y);
+                        rValues[f] = px.r;
+                        gValues[f] = px.g;
+                        bValues[f] = px.b;
+                    }
+                    
+                    // Merge based on method
+                    RGBPixel merged;
+                    
+                    switch (params_.method) {
+                        case MergeMethod::AVERAGE: {
+                            float rSum = 0, gSum = 0, bSum = 0;
+                            for (int f = 0; f < numFrames; ++f) {
+                                rSum += rValues[f];
+                                gSum += gValues[f];
+                                bSum += bValues[f];
+                            }
+                            merged.r = rSum / numFrames;
+                            merged.g = gSum / numFrames;
+                            merged.b = bSum / numFrames;
+                            break;
+                        }
+                        
+                        case MergeMethod::TRIMMED_MEAN:
+                            merged.r = trimmedMean(rValues);
+                            merged.g = trimmedMean(gValues);
+                            merged.b = trimmedMean(bValues);
+                            break;
+                        
+                        case MergeMethod::M_ESTIMATOR:
+                            merged.r = huberMean(rValues);
+                            merged.g = huberMean(gValues);
+                            merged.b = huberMean(bValues);
+                            break;
+                        
+                        case MergeMethod::MEDIAN:
+                            merged.r = median(rValues);
+                            merged.g = median(gValues);
+                            merged.b = median(bValues);
+                            break;
+                        
+                        case MergeMethod::FREQUENCY_DOMAIN:
+                            break;      // Handled above
                     }
-                    merged.r = rSum / numFrames;
-                    merged.g = gSum / numFrames;
-                    merged.b = bSum / numFrames;
-                    break;
+                    
+                    outRow[x] = merged;
                 }
-                
-                case MergeMethod::TRIMMED_MEAN:
-                    merged.r = trimmedMean(rValues);
-                    merged.g = trimmedMean(gValues);
-                    merged.b = trimmedMean(bValues);
-                    break;
-                
-                case MergeMethod::M_ESTIMATOR:
-                    merged.r = huberMean(rValues);
-                    merged.g = huberMean(gValues);
-                    merged.b = huberMean(bValues);
-                    break;
-                
-                case MergeMethod::MEDIAN:
-                    merged.r = median(rValues);
-                    merged.g = median(gValues);
-                    merged.b = median(bValues);
-                    break;
             }
-            
-            outRow[x] = merged;
-        }
+        });
     }
     
     // Apply Wiener filter if enabled
@@ -231,45 +265,50 @@ void FrameMerger::mergeWithWeights(
          frameWeights[0], numFrames > 1 ? frameWeights[1] : 0.0f);
     
     // Weighted merge with NaN/Inf protection
-    int invalidPixelCount = 0;
-    for (int y = 0; y < height; ++y) {
-        RGBPixel* outRow = output.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            float sumR = 0, sumG = 0, sumB = 0;
-            float validWeightSum = 0;
+    std::atomic<int> invalidPixels(0);
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        int bandInvalid = 0;
+        for (int y = y0; y < y1; ++y) {
+            RGBPixel* outRow = output.row(y);
             
-            for (int f = 0; f < numFrames; ++f) {
-                const RGBPixel& px = frames[f].at(x, y);
-                float w = frameWeights[f];
+            for (int x = 0; x < width; ++x) {
+                float sumR = 0, sumG = 0, sumB = 0;
+                float validWeightSum = 0;
                 
-                // Skip invalid pixels from this frame
-                if (!std::isfinite(px.r) || !std::isfinite(px.g) || !std::isfinite(px.b)) {
-                    continue;
+                for (int f = 0; f < numFrames; ++f) {
+                    const RGBPixel& px = frames[f].at(x, y);
+                    float w = frameWeights[f];
+                    
+                    // Skip invalid pixels from this frame
+                    if (!std::isfinite(px.r) || !std::isfinite(px.g) || !std::isfinite(px.b)) {
+                        continue;
+                    }
+                    
+                    sumR += px.r * w;
+                    sumG += px.g * w;
+                    sumB += px.b * w;
+                    validWeightSum += w;
                 }
                 
-                sumR += px.r * w;
-                sumG += px.g * w;
-                sumB += px.b * w;
-                validWeightSum += w;
-            }
-            
-            RGBPixel merged;
-            if (validWeightSum > 0.0f) {
-                // Normalize by actual valid weight sum
-                float invWeight = 1.0f / validWeightSum;
-                merged.r = clamp(sumR * invWeight, 0.0f, 1.0f);
-                merged.g = clamp(sumG * invWeight, 0.0f, 1.0f);
-                merged.b = clamp(sumB * invWeight, 0.0f, 1.0f);
-            } else {
-                // All frames had invalid values at this pixel - use black
-                merged.r = merged.g = merged.b = 0.0f;
-                invalidPixelCount++;
+                RGBPixel merged;
+                if (validWeightSum > 0.0f) {
+                    // Normalize by actual valid weight sum
+                    float invWeight = 1.0f / validWeightSum;
+                    merged.r = clamp(sumR * invWeight, 0.0f, 1.0f);
+                    merged.g = clamp(sumG * invWeight, 0.0f, 1.0f);
+                    merged.b = clamp(sumB * invWeight, 0.0f, 1.0f);
+                } else {
+                    // All frames had invalid values at this pixel - use black
+                    merged.r = merged.g = merged.b = 0.0f;
+                    bandInvalid++;
+                }
+                
+                outRow[x] = merged;
             }
-            
-            outRow[x] = merged;
         }
-    }
+        invalidPixels += bandInvalid;
+    });
+    int invalidPixelCount = invalidPixels.load();
     
     if (invalidPixelCount > 0) {
         LOGW("Weighted merge: %d pixels had no valid input values", invalidPixelCount);
@@ -283,84 +322,42 @@ void FrameMerger::mergeWithWeights(
     }
 }
 
-float FrameMerger::estimateLocalVariance(const RGBImage& image, int x, int y, int channel) {
-    int halfWin = params_.wienerWindowSize / 2;
-    float sum = 0.0f;
-    float sumSq = 0.0f;
-    int count = 0;
-    
-    for (int dy = -halfWin; dy <= halfWin; ++dy) {
-        int py = clamp(y + dy, 0, image.height - 1);
-        for (int dx = -halfWin; dx <= halfWin; ++dx) {
-            int px = clamp(x + dx, 0, image.width - 1);
-            
-            const RGBPixel& pixel = image.at(px, py);
-            float value = channel == 0 ? pixel.r : (channel == 1 ? pixel.g : pixel.b);
-            
-            sum += value;
-            sumSq += value * value;
-            count++;
-        }
-    }
-    
-    float mean = sum / count;
-    float variance = (sumSq / count) - (mean * mean);
-    
-    return std::max(variance, 0.0f);
-}
-
 void FrameMerger::applyWienerFilter(const RGBImage& input, RGBImage& output) {
     int width = input.width;
     int height = input.height;
-    int halfWin = params_.wienerWindowSize / 2;
     float noiseVar = params_.wienerNoiseVar;
     
+    // Local mean and variance of each channel over the window, edges replicated
+    RGBImage localMean, localVar;
+    computeLocalMoments(input, params_.wienerWindowSize / 2, WindowBorder::REPLICATE, &localMean, &localVar);
+    
     output = RGBImage(width, height);
     
-    for (int y = 0; y < height; ++y) {
-        const RGBPixel* inRow = input.row(y);
-        RGBPixel* outRow = output.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& pixel = inRow[x];
-            RGBPixel filtered;
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const RGBPixel* inRow = input.row(y);
+            const RGBPixel* meanRow = localMean.row(y);
+            const RGBPixel* varRow = localVar.row(y);
+            RGBPixel* outRow = output.row(y);
             
-            // Process each channel
-            for (int c = 0; c < 3; ++c) {
-                float value = c == 0 ? pixel.r : (c == 1 ? pixel.g : pixel.b);
+            for (int x = 0; x < width; ++x) {
+                const float value[3] = {inRow[x].r, inRow[x].g, inRow[x].b};
+                const float mean[3] = {meanRow[x].r, meanRow[x].g, meanRow[x].b};
+                const float var[3] = {varRow[x].r, varRow[x].g, varRow[x].b};
+                float filtered[3];
                 
-                // Compute local mean
-                float localSum = 0.0f;
-                int count = 0;
-                
-                for (int dy = -halfWin; dy <= halfWin; ++dy) {
-                    int py = clamp(y + dy, 0, height - 1);
-                    for (int dx = -halfWin; dx <= halfWin; ++dx) {
-                        int px = clamp(x + dx, 0, width - 1);
-                        const RGBPixel& p = input.at(px, py);
-                        float v = c == 0 ? p.r : (c == 1 ? p.g : p.b);
-                        localSum += v;
-                        count++;
-                    }
+                for (int c = 0; c < 3; ++c) {
+                    // Wiener filter: output = mean + (var - noise) / var * (input - mean)
+                    float signalVar = std::max(var[c] - noiseVar, 0.0f);
+                    float wienerGain = var[c] > 1e-6f ? signalVar / var[c] : 0.0f;
+                    
+                    filtered[c] = clamp(mean[c] + wienerGain * (value[c] - mean[c]), 0.0f, 1.0f);
                 }
                 
-                float localMean = localSum / count;
-                float localVar = estimateLocalVariance(input, x, y, c);
-                
-                // Wiener filter: output = mean + (var - noise) / var * (input - mean)
-                float signalVar = std::max(localVar - noiseVar, 0.0f);
-                float wienerGain = localVar > 1e-6f ? signalVar / localVar : 0.0f;
-                
-                float filteredValue = localMean + wienerGain * (value - localMean);
-                
-                if (c == 0) filtered.r = clamp(filteredValue, 0.0f, 1.0f);
-                else if (c == 1) filtered.g = clamp(filteredValue, 0.0f, 1.0f);
-                else filtered.b = clamp(filteredValue, 0.0f, 1.0f);
+                outRow[x] = RGBPixel(filtered[0], filtered[1], filtered[2]);
             }
-            
-            outRow[x] = filtered;
         }
-    }
+    });
 }
 
 // NoiseModel implementation
@@ -417,28 +414,30 @@ void NoiseModel::computeWeights(
     
     float baseWeight = alignment.isValid ? alignment.confidence : 0.5f;
     
-    for (int y = 0; y < height; ++y) {
-        const RGBPixel* refRow = reference.row(y);
-        const RGBPixel* frameRow = frame.row(y);
-        float* weightRow = weights.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& refPx = refRow[x];
-            const RGBPixel& framePx = frameRow[x];
-            
-            // Compute color difference
-            float diffR = refPx.r - framePx.r;
-            float diffG = refPx.g - framePx.g;
-            float diffB = refPx.b - framePx.b;
-            float colorDiff = std::sqrt(diffR * diffR + diffG * diffG + diffB * diffB);
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const RGBPixel* refRow = reference.row(y);
+            const RGBPixel* frameRow = frame.row(y);
+            float* weightRow = weights.row(y);
             
-            // Weight decreases with color difference
-            // Using exponential falloff
-            float diffWeight = std::exp(-colorDiff * 10.0f);
-            
-            weightRow[x] = baseWeight * diffWeight;
+            for (int x = 0; x < width; ++x) {
+                const RGBPixel& refPx = refRow[x];
+                const RGBPixel& framePx = frameRow[x];
+                
+                // Compute color difference
+                float diffR = refPx.r - framePx.r;
+                float diffG = refPx.g - framePx.g;
+                float diffB = refPx.b - framePx.b;
+                float colorDiff = std::sqrt(diffR * diffR + diffG * diffG + diffB * diffB);
+                
+                // Weight decreases with color difference
+                // Using exponential falloff
+                float diffWeight = std::exp(-colorDiff * 10.0f);
+                
+                weightRow[x] = baseWeight * diffWeight;
+            }
         }
-    }
+    });
 }
 
 } // namespace ultradetail
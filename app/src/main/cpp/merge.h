@@ -21,7 +21,9 @@ enum class MergeMethod {
     AVERAGE,        // Simple averaging
     TRIMMED_MEAN,   // Trimmed mean (removes outliers)
     M_ESTIMATOR,    // Robust M-estimator (Huber or Tukey)
-    MEDIAN          // Median merge
+    MEDIAN,         // Median merge
+    FREQUENCY_DOMAIN // Pairwise Wiener merge of overlapping FFT tiles; about 0.2x the
+                     // speed of TRIMMED_MEAN + Wiener (1024x768, 8 frames, 16 or 32 tiles)
 };
 
 /**
@@ -34,6 +36,8 @@ struct MergeParams {
     bool applyWienerFilter = true;             // Apply Wiener denoising
     float wienerNoiseVar = WIENER_NOISE_VAR;   // Assumed noise variance
     int wienerWindowSize = 5;                  // Wiener filter window size
+    int frequencyTileSize = 16;                // FREQUENCY_DOMAIN tile size (16 or 32)
+    float frequencyNoiseScale = 8.0f;          // FREQUENCY_DOMAIN shrinkage: multiple of noise variance
 };
 
 /**
@@ -54,10 +58,14 @@ public:
     /**
      * Merge aligned frames
      * 
+     * FREQUENCY_DOMAIN denoises as it merges, so the Wiener pass is skipped
+     * for it.
+     * 
      * @param frames Vector of aligned RGB frames
      * @param output Output merged RGB image
+     * @param referenceIndex Reference frame for FREQUENCY_DOMAIN (-1: middle frame)
      */
-    void merge(const std::vector<RGBImage>& frames, RGBImage& output);
+    void merge(const std::vector<RGBImage>& frames, RGBImage& output, int referenceIndex = -1);
     
     /**
      * Merge with alignment information for weighted merging
@@ -97,11 +105,6 @@ private:
      * Compute median for a set of values
      */
     float median(std::vector<float>& values);
-    
-    /**
-     * Estimate local noise variance for Wiener filter
-     */
-    float estimateLocalVariance(const RGBImage& image, int x, int y, int channel);
 };
 
 /**
@@ -0,0 +1,282 @@
+/**
+ * merge_kernels.cpp - Sorting-network merge kernels implementation
+ */
+
+#include "merge_kernels.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace ultradetail {
+
+using simd::f32x4;
+
+// ==================== Networks ====================
+
+/**
+ * Compare-exchange: afterwards rank lo holds the smaller value
+ */
+struct Comparator {
+    int lo;
+    int hi;
+};
+
+/**
+ * Comparators in execution order
+ */
+struct ComparatorNetwork {
+    static constexpr int kCapacity = 64;   // Merge exchange uses 63 for 16 inputs
+
+    Comparator comparators[kCapacity] = {};
+    int size = 0;
+};
+
+/**
+ * Batcher's merge exchange sorting network for n inputs (Knuth, TAOCP
+ * 5.2.2, Algorithm M)
+ */
+static constexpr ComparatorNetwork mergeExchangeNetwork(int n) {
+    ComparatorNetwork network;
+    int t = 0;
+    while ((1 << t) < n) ++t;
+
+    for (int p = 1 << (t - 1); p > 0; p >>= 1) {
+        int q = 1 << (t - 1);
+        int r = 0;
+        int d = p;
+        while (true) {
+            for (int i = 0; i + d < n; ++i) {
+                if ((i & p) == r) {
+                    network.comparators[network.size++] = {i, i + d};
+                }
+            }
+            if (q == p) break;
+            d = q - p;
+            q >>= 1;
+            r = p;
+        }
+    }
+    return network;
+}
+
+/**
+ * The comparators of a sorting network that ranks first..last depend on:
+ * walking backwards, keep a comparator if it writes a rank still needed
+ */
+static constexpr ComparatorNetwork selectionNetwork(const ComparatorNetwork& sort, int first, int last) {
+    bool needed[MAX_MERGE_KERNEL_FRAMES] = {};
+    for (int rank = first; rank <= last; ++rank) {
+        needed[rank] = true;
+    }
+
+    bool keep[ComparatorNetwork::kCapacity] = {};
+    for (int i = sort.size - 1; i >= 0; --i) {
+        const Comparator& c = sort.comparators[i];
+        if (needed[c.lo] || needed[c.hi]) {
+            keep[i] = true;
+            needed[c.lo] = true;
+            needed[c.hi] = true;
+        }
+    }
+
+    ComparatorNetwork network;
+    for (int i = 0; i < sort.size; ++i) {
+        if (keep[i]) {
+            network.comparators[network.size++] = sort.comparators[i];
+        }
+    }
+    return network;
+}
+
+template <int N>
+struct Networks {
+    static constexpr ComparatorNetwork sort = mergeExchangeNetwork(N);
+    static constexpr ComparatorNetwork median = selectionNetwork(sort, (N - 1) / 2, N / 2);
+};
+
+static inline void compareExchange(f32x4& lo, f32x4& hi) {
+    const f32x4 a = lo;
+    lo = simd::min(a, hi);
+    hi = simd::max(a, hi);
+}
+
+/**
+ * Apply a network fully unrolled, so every rank stays in a register
+ */
+template <const ComparatorNetwork& Network, size_t... I>
+static inline void applyNetwork(f32x4* v, std::index_sequence<I...>) {
+    (compareExchange(v[Network.comparators[I].lo], v[Network.comparators[I].hi]), ...);
+}
+
+template <const ComparatorNetwork& Network>
+static inline void applyNetwork(f32x4* v) {
+    applyNetwork<Network>(v, std::make_index_sequence<Network.size>());
+}
+
+// ==================== Reductions ====================
+
+/**
+ * Constants of a reduction, set up once per row
+ */
+template <int N>
+struct ReductionConstants {
+    f32x4 rankWeight[N];    // Trimmed mean: 1 for kept ranks, 0 for trimmed ones
+    f32x4 keptCount;
+    f32x4 huberDelta;
+
+    explicit ReductionConstants(const MergeParams& params) {
+        // Same trim as FrameMerger::trimmedMean, keeping at least one value
+        const int trimCount = clamp(static_cast<int>(N * params.trimRatio), 0, (N - 1) / 2);
+        for (int i = 0; i < N; ++i) {
+            rankWeight[i] = f32x4::splat(i >= trimCount && i < N - trimCount ? 1.0f : 0.0f);
+        }
+        keptCount = f32x4::splat(static_cast<float>(N - 2 * trimCount));
+        huberDelta = f32x4::splat(params.huberDelta);
+    }
+};
+
+/**
+ * One channel of four pixels: v[f] holds frame f (reordered in place)
+ */
+template <int N, MergeMethod Method>
+static inline f32x4 reduce(f32x4* v, const ReductionConstants<N>& constants) {
+    if constexpr (Method == MergeMethod::AVERAGE) {
+        f32x4 sum = v[0];
+        for (int i = 1; i < N; ++i) {
+            sum = sum + v[i];
+        }
+        return sum / f32x4::splat(static_cast<float>(N));
+    } else if constexpr (Method == MergeMethod::TRIMMED_MEAN) {
+        applyNetwork<Networks<N>::sort>(v);
+        // Trimmed ranks add exactly zero, so the sum matches the scalar loop
+        f32x4 sum = f32x4::zero();
+        for (int i = 0; i < N; ++i) {
+            sum = simd::fma(v[i], constants.rankWeight[i], sum);
+        }
+        return sum / constants.keptCount;
+    } else if constexpr (Method == MergeMethod::MEDIAN) {
+        applyNetwork<Networks<N>::median>(v);
+        if constexpr (N % 2 == 0) {
+            return (v[N / 2] + v[N / 2 - 1]) * f32x4::splat(0.5f);
+        } else {
+            return v[N / 2];
+        }
+    } else {
+        // Huber M-estimate, starting from the upper median
+        f32x4 samples[N];
+        std::copy(v, v + N, samples);
+        applyNetwork<Networks<N>::median>(v);
+
+        float estimate[4];
+        float next[4];
+        float weightSum[4];
+        bool converged[4] = {false, false, false, false};
+        v[N / 2].store(estimate);
+
+        const f32x4 one = f32x4::splat(1.0f);
+        for (int iter = 0; iter < 10; ++iter) {
+            const f32x4 current = f32x4::load(estimate);
+            f32x4 weightedSumV = f32x4::zero();
+            f32x4 weightSumV = f32x4::zero();
+            for (int i = 0; i < N; ++i) {
+                // 1 within delta of the estimate, delta / |residual| beyond; a
+                // select rather than min(delta / |residual|, 1), whose 0 / 0
+                // and x / 0 lanes are undefined under -ffast-math
+                const f32x4 residual = simd::absDiff(samples[i], current);
+                f32x4 weight = simd::selectLessEqual(residual, constants.huberDelta, one,
+                                                     constants.huberDelta / residual);
+                weightedSumV = simd::fma(weight, samples[i], weightedSumV);
+                weightSumV = weightSumV + weight;
+            }
+            (weightedSumV / weightSumV).store(next);
+            weightSumV.store(weightSum);
+
+            // Lanes stop independently, exactly where the scalar loop would
+            bool allConverged = true;
+            for (int lane = 0; lane < 4; ++lane) {
+                if (converged[lane]) continue;
+                const float updated = weightSum[lane] > 0.0f ? next[lane] : estimate[lane];
+                if (std::abs(updated - estimate[lane]) < 1e-6f) {
+                    converged[lane] = true;
+                } else {
+                    estimate[lane] = updated;
+                    allConverged = false;
+                }
+            }
+            if (allConverged) break;
+        }
+        return f32x4::load(estimate);
+    }
+}
+
+/**
+ * Four pixels starting at x
+ */
+template <int N, MergeMethod Method>
+static inline void mergeGroup(const RGBPixel* const* rows, int x, const ReductionConstants<N>& constants,
+                              RGBPixel* output) {
+    f32x4 r[N], g[N], b[N];
+    for (int f = 0; f < N; ++f) {
+        simd::loadDeinterleaved3(reinterpret_cast<const float*>(rows[f] + x), r[f], g[f], b[f]);
+    }
+
+    const f32x4 mergedR = reduce<N, Method>(r, constants);
+    const f32x4 mergedG = reduce<N, Method>(g, constants);
+    const f32x4 mergedB = reduce<N, Method>(b, constants);
+    simd::storeInterleaved3(reinterpret_cast<float*>(output), mergedR, mergedG, mergedB);
+}
+
+template <int N, MergeMethod Method>
+static void mergeRow(const RGBPixel* const* rows, RGBPixel* output, int width, const MergeParams& params) {
+    const ReductionConstants<N> constants(params);
+
+    int x = 0;
+    for (; x + 4 <= width; x += 4) {
+        mergeGroup<N, Method>(rows, x, constants, output + x);
+    }
+    if (x == width) return;
+
+    // Last 1-3 pixels: pad a group with copies of the final pixel
+    RGBPixel tail[N][4];
+    const RGBPixel* tailRows[N];
+    for (int f = 0; f < N; ++f) {
+        for (int i = 0; i < 4; ++i) {
+            tail[f][i] = rows[f][std::min(x + i, width - 1)];
+        }
+        tailRows[f] = tail[f];
+    }
+    RGBPixel merged[4];
+    mergeGroup<N, Method>(tailRows, 0, constants, merged);
+    std::copy(merged, merged + (width - x), output + x);
+}
+
+// ==================== Dispatch ====================
+
+template <int N>
+static MergeRowKernel kernelFor(MergeMethod method) {
+    switch (method) {
+        case MergeMethod::AVERAGE:      return &mergeRow<N, MergeMethod::AVERAGE>;
+        case MergeMethod::TRIMMED_MEAN: return &mergeRow<N, MergeMethod::TRIMMED_MEAN>;
+        case MergeMethod::M_ESTIMATOR:  return &mergeRow<N, MergeMethod::M_ESTIMATOR>;
+        case MergeMethod::MEDIAN:       return &mergeRow<N, MergeMethod::MEDIAN>;
+        case MergeMethod::FREQUENCY_DOMAIN: break;      // Tile-based, see frequency_merge.h
+    }
+    return nullptr;
+}
+
+template <int... I>
+static MergeRowKernel selectKernel(MergeMethod method, int numFrames, std::integer_sequence<int, I...>) {
+    MergeRowKernel kernel = nullptr;
+    ((numFrames == I + 2 ? (kernel = kernelFor<I + 2>(method)) : nullptr), ...);
+    return kernel;
+}
+
+MergeRowKernel mergeRowKernel(MergeMethod method, int numFrames) {
+    if (numFrames < 2 || numFrames > MAX_MERGE_KERNEL_FRAMES) {
+        return nullptr;
+    }
+    return selectKernel(method, numFrames, std::make_integer_sequence<int, MAX_MERGE_KERNEL_FRAMES - 1>());
+}
+
+} // namespace ultradetail
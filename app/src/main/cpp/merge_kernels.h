@@ -0,0 +1,51 @@
+/**
+ * merge_kernels.h - Sorting-network merge kernels for small bursts
+ *
+ * FrameMerger::merge reduces the N aligned samples of every pixel and
+ * channel to one value. For N = 2..MAX_MERGE_KERNEL_FRAMES these kernels
+ * merge four pixels at a time: the samples of a channel are held in N
+ * vectors (one pixel per lane) and ordered by a compare-exchange network
+ * generated at compile time for that N. Trimmed mean uses a full sorting
+ * network; median and the Huber starting point only the comparators that
+ * reach the middle ranks. Nothing is allocated, and apart from the Huber
+ * convergence test no branch depends on pixel values.
+ *
+ * The estimates are those of FrameMerger's scalar reductions, up to float
+ * rounding in the Huber iterations.
+ */
+
+#ifndef ULTRADETAIL_MERGE_KERNELS_H
+#define ULTRADETAIL_MERGE_KERNELS_H
+
+#include "common.h"
+#include "merge.h"
+
+namespace ultradetail {
+
+/**
+ * Largest frame count with a specialized kernel
+ */
+constexpr int MAX_MERGE_KERNEL_FRAMES = 16;
+
+/**
+ * Merge one row
+ *
+ * @param rows The row of each frame (one pointer per frame)
+ * @param output Merged row
+ * @param width Pixels per row
+ * @param params Merge parameters (trimRatio and huberDelta are used)
+ */
+using MergeRowKernel = void (*)(const RGBPixel* const* rows, RGBPixel* output, int width,
+                                const MergeParams& params);
+
+/**
+ * Kernel for a merge method and frame count
+ *
+ * @return Kernel, or nullptr if numFrames is outside 2..MAX_MERGE_KERNEL_FRAMES
+ *         or the method is FREQUENCY_DOMAIN
+ */
+MergeRowKernel mergeRowKernel(MergeMethod method, int numFrames);
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_MERGE_KERNELS_H
@@ -5,7 +5,6 @@
  */
 
 #include "mfsr.h"
-#include "neon_utils.h"
 #include "deghost_enhance.h"
 #include <cmath>
 #include <algorithm>
@@ -0,0 +1,163 @@
+/**
+ * motion_model.cpp - Compact motion representation implementation
+ */
+
+#include "motion_model.h"
+#include <limits>
+
+namespace ultradetail {
+
+MotionModel::MotionModel()
+    : kind_(Kind::TRANSLATION), width_(0), height_(0),
+      blockSize_(0), blockCols_(0), confidence_(0.0f) {
+    for (int i = 0; i < 9; ++i) h_[i] = (i % 4 == 0) ? 1.0f : 0.0f;
+}
+
+MotionModel MotionModel::translation(int width, int height, const FlowVector& shift) {
+    MotionModel model;
+    model.kind_ = Kind::TRANSLATION;
+    model.width_ = width;
+    model.height_ = height;
+    model.shift_ = shift;
+    model.confidence_ = shift.confidence;
+    return model;
+}
+
+MotionModel MotionModel::blockGrid(int width, int height, int blockSize, std::vector<FlowVector> blocks) {
+    MotionModel model;
+    model.kind_ = Kind::BLOCK_GRID;
+    model.width_ = width;
+    model.height_ = height;
+    model.blockSize_ = std::max(1, blockSize);
+    model.blockCols_ = (width + model.blockSize_ - 1) / model.blockSize_;
+    model.blocks_ = std::move(blocks);
+
+    int blockRows = (height + model.blockSize_ - 1) / model.blockSize_;
+    if (static_cast<int>(model.blocks_.size()) != model.blockCols_ * blockRows) {
+        LOGW("MotionModel: %zu blocks for a %dx%d grid, padding with zero motion",
+             model.blocks_.size(), model.blockCols_, blockRows);
+        model.blocks_.resize(model.blockCols_ * blockRows, FlowVector(0, 0, 0));
+    }
+    return model;
+}
+
+MotionModel MotionModel::homography(int width, int height, const float matrix[9], float confidence) {
+    MotionModel model;
+    model.kind_ = Kind::HOMOGRAPHY;
+    model.width_ = width;
+    model.height_ = height;
+    for (int i = 0; i < 9; ++i) model.h_[i] = matrix[i];
+    model.confidence_ = confidence;
+    return model;
+}
+
+MotionModel MotionModel::affine(int width, int height, const float matrix[6], float confidence) {
+    const float h[9] = {
+        matrix[0], matrix[1], matrix[2],
+        matrix[3], matrix[4], matrix[5],
+        0.0f, 0.0f, 1.0f
+    };
+    return homography(width, height, h, confidence);
+}
+
+MotionModel MotionModel::dense(FlowField flow) {
+    MotionModel model;
+    model.kind_ = Kind::DENSE;
+    model.width_ = flow.width;
+    model.height_ = flow.height;
+    model.flow_ = std::move(flow);
+    return model;
+}
+
+void MotionModel::bounds(int x0, int y0, int x1, int y1,
+                         float& minDx, float& maxDx, float& minDy, float& maxDy) const {
+    minDx = minDy = std::numeric_limits<float>::max();
+    maxDx = maxDy = std::numeric_limits<float>::lowest();
+
+    auto include = [&](const FlowVector& fv) {
+        minDx = std::min(minDx, fv.dx);
+        maxDx = std::max(maxDx, fv.dx);
+        minDy = std::min(minDy, fv.dy);
+        maxDy = std::max(maxDy, fv.dy);
+    };
+
+    switch (kind_) {
+        case Kind::TRANSLATION:
+            include(shift_);
+            break;
+
+        case Kind::BLOCK_GRID:
+            for (int by = y0 / blockSize_; by <= y1 / blockSize_; ++by) {
+                for (int bx = x0 / blockSize_; bx <= x1 / blockSize_; ++bx) {
+                    include(blocks_[by * blockCols_ + bx]);
+                }
+            }
+            break;
+
+        case Kind::HOMOGRAPHY:
+        case Kind::DENSE:
+            for (int y = y0; y <= y1; ++y) {
+                for (int x = x0; x <= x1; ++x) {
+                    include(at(x, y));
+                }
+            }
+            break;
+    }
+}
+
+float MotionModel::averageMagnitude() const {
+    switch (kind_) {
+        case Kind::TRANSLATION:
+            return shift_.magnitude();
+
+        case Kind::BLOCK_GRID: {
+            // Area-weighted over (possibly partial) blocks
+            double sum = 0.0;
+            for (size_t i = 0; i < blocks_.size(); ++i) {
+                int bx = static_cast<int>(i) % blockCols_;
+                int by = static_cast<int>(i) / blockCols_;
+                int bw = std::min(blockSize_, width_ - bx * blockSize_);
+                int bh = std::min(blockSize_, height_ - by * blockSize_);
+                sum += static_cast<double>(blocks_[i].magnitude()) * bw * bh;
+            }
+            return width_ > 0 && height_ > 0 ? static_cast<float>(sum / (static_cast<double>(width_) * height_)) : 0.0f;
+        }
+
+        case Kind::HOMOGRAPHY:
+        case Kind::DENSE:
+        default: {
+            float sum = 0.0f;
+            int count = 0;
+            for (int y = 0; y < height_; y += 4) {
+                for (int x = 0; x < width_; x += 4) {
+                    sum += at(x, y).magnitude();
+                    count++;
+                }
+            }
+            return count > 0 ? sum / count : 0.0f;
+        }
+    }
+}
+
+size_t MotionModel::memoryBytes() const {
+    return sizeof(MotionModel) +
+           blocks_.capacity() * sizeof(FlowVector) +
+           flow_.data.capacity() * sizeof(FlowVector);
+}
+
+FlowField MotionModel::toFlowField() const {
+    if (kind_ == Kind::DENSE) {
+        return flow_;
+    }
+
+    FlowField field(width_, height_);
+    for (int y = 0; y < height_; ++y) {
+        FlowVector* row = field.row(y);
+        for (int x = 0; x < width_; ++x) {
+            row[x] = at(x, y);
+        }
+    }
+    return field;
+}
+
+} // namespace ultradetail
@@ -0,0 +1,140 @@
+/**
+ * motion_model.h - Compact motion representation for tile alignment
+ *
+ * Alignment of a tile crop to the reference is stored in the cheapest form
+ * that represents it exactly and evaluated per sample on demand:
+ *
+ * - TRANSLATION: one shift for the whole crop (hybrid alignment, reference frame)
+ * - BLOCK_GRID: one shift per square block (hybrid local refinement)
+ * - HOMOGRAPHY: projective / affine warp (e.g. gyro rotation)
+ * - DENSE: per-pixel flow field (dense optical flow only)
+ *
+ * Flow follows the FlowField convention: the target sample at (x, y) belongs
+ * to reference position (x - dx, y - dy).
+ */
+
+#ifndef ULTRADETAIL_MOTION_MODEL_H
+#define ULTRADETAIL_MOTION_MODEL_H
+
+#include "common.h"
+#include "optical_flow.h"  // For FlowField, FlowVector, GyroHomography
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * Motion of a tile crop relative to the reference crop
+ */
+class MotionModel {
+public:
+    enum class Kind {
+        TRANSLATION,
+        BLOCK_GRID,
+        HOMOGRAPHY,
+        DENSE
+    };
+
+    /**
+     * Zero translation with zero confidence over an empty domain
+     */
+    MotionModel();
+
+    /**
+     * Single shift for a width x height crop
+     */
+    static MotionModel translation(int width, int height, const FlowVector& shift);
+
+    /**
+     * One shift per blockSize x blockSize block, blocks row-major from (0, 0);
+     * edge blocks may be partial
+     */
+    static MotionModel blockGrid(int width, int height, int blockSize, std::vector<FlowVector> blocks);
+
+    /**
+     * Flow of a 3x3 homography (row-major): dst = H * (x, y, 1), flow = dst - (x, y)
+     */
+    static MotionModel homography(int width, int height, const float matrix[9], float confidence);
+
+    /**
+     * Flow of an affine map: dst = (a[0] x + a[1] y + a[2], a[3] x + a[4] y + a[5])
+     */
+    static MotionModel affine(int width, int height, const float matrix[6], float confidence);
+
+    /**
+     * Per-pixel flow (takes ownership)
+     */
+    static MotionModel dense(FlowField flow);
+
+    Kind kind() const { return kind_; }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    bool isTranslation() const { return kind_ == Kind::TRANSLATION; }
+
+    /**
+     * The shift of a TRANSLATION model
+     */
+    const FlowVector& shift() const { return shift_; }
+
+    /**
+     * Evaluate the flow at an integer sample position inside the domain
+     */
+    inline FlowVector at(int x, int y) const {
+        switch (kind_) {
+            case Kind::TRANSLATION:
+                return shift_;
+            case Kind::BLOCK_GRID:
+                return blocks_[(y / blockSize_) * blockCols_ + x / blockSize_];
+            case Kind::HOMOGRAPHY:
+                return evaluateHomography(static_cast<float>(x), static_cast<float>(y));
+            case Kind::DENSE:
+            default:
+                return flow_.at(x, y);
+        }
+    }
+
+    /**
+     * Flow component bounds over the inclusive rect [x0, x1] x [y0, y1]
+     *
+     * Exact for every kind (translation and block grids look at whole
+     * blocks; homography and dense flow are evaluated per sample).
+     */
+    void bounds(int x0, int y0, int x1, int y1,
+                float& minDx, float& maxDx, float& minDy, float& maxDy) const;
+
+    /**
+     * Mean flow magnitude over the domain (dense flow: sampled every 4 px)
+     */
+    float averageMagnitude() const;
+
+    /**
+     * Bytes held by the representation
+     */
+    size_t memoryBytes() const;
+
+    /**
+     * Expand to a per-pixel flow field
+     */
+    FlowField toFlowField() const;
+
+private:
+    Kind kind_;
+    int width_, height_;
+    FlowVector shift_;                  // TRANSLATION
+    int blockSize_, blockCols_;         // BLOCK_GRID
+    std::vector<FlowVector> blocks_;
+    float h_[9];                        // HOMOGRAPHY (row-major)
+    float confidence_;
+    FlowField flow_;                    // DENSE
+
+    inline FlowVector evaluateHomography(float x, float y) const {
+        float w = h_[6] * x + h_[7] * y + h_[8];
+        if (std::abs(w) < 1e-6f) w = 1.0f;
+        float dstX = (h_[0] * x + h_[1] * y + h_[2]) / w;
+        float dstY = (h_[3] * x + h_[4] * y + h_[5]) / w;
+        return FlowVector(dstX - x, dstY - y, confidence_);
+    }
+};
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_MOTION_MODEL_H
@@ -0,0 +1,1126 @@
+/**
+ * native_benchmark.cpp - On-device micro-benchmarks implementation
+ */
+
+#include "native_benchmark.h"
+#include "thread_pool.h"
+#include "phase_correlation.h"
+#include "optical_flow.h"
+#include "fft.h"
+#include "yuv_converter.h"
+#include "pyramid.h"
+#include "merge.h"
+#include "local_moments.h"
+#include "simd.h"
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <functional>
+#include <thread>
+
+#undef LOG_TAG
+#define LOG_TAG "NativeBenchmark"
+
+namespace ultradetail {
+
+// ==================== Synthetic data ====================
+
+/**
+ * Deterministic lattice hash in [0, 1]
+ */
+static float latticeNoise(int x, int y, uint32_t seed) {
+    uint32_t h = static_cast<uint32_t>(x) * 374761393u + static_cast<uint32_t>(y) * 668265263u + seed * 2246822519u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    h ^= h >> 16;
+    return static_cast<float>(h & 0xFFFFFF) / static_cast<float>(0xFFFFFF);
+}
+
+/**
+ * Bilinearly interpolated value noise with the given cell size
+ */
+static float valueNoise(float x, float y, float cell, uint32_t seed) {
+    float fx = x / cell;
+    float fy = y / cell;
+    int x0 = static_cast<int>(std::floor(fx));
+    int y0 = static_cast<int>(std::floor(fy));
+    float tx = fx - x0;
+    float ty = fy - y0;
+
+    float top = latticeNoise(x0, y0, seed) * (1.0f - tx) + latticeNoise(x0 + 1, y0, seed) * tx;
+    float bot = latticeNoise(x0, y0 + 1, seed) * (1.0f - tx) + latticeNoise(x0 + 1, y0 + 1, seed) * tx;
+    return top * (1.0f - ty) + bot * ty;
+}
+
+/**
+ * Continuous multi-octave test scene, so shifted frames can be sampled exactly
+ */
+static float syntheticScene(float x, float y) {
+    return 0.5f * valueNoise(x, y, 32.0f, 1) +
+           0.3f * valueNoise(x, y, 8.0f, 2) +
+           0.2f * valueNoise(x, y, 3.0f, 3);
+}
+
+/**
+ * Render the synthetic scene translated by (dx, dy)
+ */
+static void renderSyntheticGray(int width, int height, float dx, float dy, GrayImage& out) {
+    out.resize(width, height);
+    for (int y = 0; y < height; ++y) {
+        float* row = out.row(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = syntheticScene(x + dx, y + dy);
+        }
+    }
+}
+
+// ==================== Timing helpers ====================
+
+/**
+ * Thread counts to measure: 1, 2, 4, ... and the hardware concurrency
+ */
+static std::vector<int> scalingThreadCounts() {
+    int hw = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<int> counts;
+    for (int t = 1; t < hw; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(hw);
+    return counts;
+}
+
+/**
+ * Run numItems work items on the given number of threads and return wall time in ms
+ *
+ * Uses a dedicated pool, installed as the current pool, so nested parallel
+ * loops inside the work items are confined to the same number of threads.
+ */
+static float timeParallel(int threads, int numItems, const std::function<void(int)>& item) {
+    ThreadPool pool(std::max(0, threads - 1));
+    ScopedPool scope(pool);
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(0, numItems, item);
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+// ==================== Baseline FFT ====================
+
+/**
+ * Textbook radix-2 complex FFT (the implementation RealFFT2D replaced),
+ * kept as the benchmark baseline
+ */
+static void baselineFFT1D(std::complex<float>* data, int n, bool inverse) {
+    int j = 0;
+    for (int i = 0; i < n - 1; ++i) {
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+        int k = n >> 1;
+        while (k <= j) {
+            j -= k;
+            k >>= 1;
+        }
+        j += k;
+    }
+    
+    float sign = inverse ? 1.0f : -1.0f;
+    for (int len = 2; len <= n; len <<= 1) {
+        float angle = sign * 2.0f * M_PI / len;
+        std::complex<float> wn(std::cos(angle), std::sin(angle));
+        
+        for (int i = 0; i < n; i += len) {
+            std::complex<float> w(1.0f, 0.0f);
+            for (int jj = 0; jj < len / 2; ++jj) {
+                std::complex<float> u = data[i + jj];
+                std::complex<float> t = w * data[i + jj + len / 2];
+                data[i + jj] = u + t;
+                data[i + jj + len / 2] = u - t;
+                w *= wn;
+            }
+        }
+    }
+    
+    if (inverse) {
+        for (int i = 0; i < n; ++i) {
+            data[i] /= static_cast<float>(n);
+        }
+    }
+}
+
+static void baselineFFT2D(std::complex<float>* data, int size, bool inverse) {
+    for (int y = 0; y < size; ++y) {
+        baselineFFT1D(data + y * size, size, inverse);
+    }
+    
+    std::vector<std::complex<float>> column(size);
+    for (int x = 0; x < size; ++x) {
+        for (int y = 0; y < size; ++y) {
+            column[y] = data[y * size + x];
+        }
+        baselineFFT1D(column.data(), size, inverse);
+        for (int y = 0; y < size; ++y) {
+            data[y * size + x] = column[y];
+        }
+    }
+}
+
+// ==================== Baseline YUV conversion ====================
+
+/**
+ * Per-pixel YUV -> RGB + luma loop (the conversion the fused kernel replaced)
+ */
+static void baselineYUVToRgbLuma(const YUVFrame& yuv, RGBImage& rgb, GrayImage& luma) {
+    rgb.resize(yuv.width, yuv.height);
+    luma.resize(yuv.width, yuv.height);
+    
+    for (int y = 0; y < yuv.height; ++y) {
+        for (int x = 0; x < yuv.width; ++x) {
+            int yIdx = y * yuv.yRowStride + x;
+            int uvIdx = (y / 2) * yuv.uvRowStride + (x / 2) * yuv.uvPixelStride;
+            
+            int yVal = yuv.yPlane[yIdx] - 16;
+            int uVal = yuv.uPlane[uvIdx] - 128;
+            int vVal = yuv.vPlane[uvIdx] - 128;
+            
+            float r = clamp((1.164f * yVal + 1.596f * vVal) / 255.0f, 0.0f, 1.0f);
+            float g = clamp((1.164f * yVal - 0.813f * vVal - 0.391f * uVal) / 255.0f, 0.0f, 1.0f);
+            float b = clamp((1.164f * yVal + 2.018f * uVal) / 255.0f, 0.0f, 1.0f);
+            
+            rgb.at(x, y) = RGBPixel(r, g, b);
+            luma.at(x, y) = 0.299f * r + 0.587f * g + 0.114f * b;
+        }
+    }
+}
+
+// ==================== Plain row loops ====================
+
+/**
+ * Straight C++ loops with the semantics of simd::RowKernels (reference set)
+ */
+static float plainSumAbsDiff(const float* a, const float* b, int count) {
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        sum += std::abs(a[i] - b[i]);
+    }
+    return sum;
+}
+
+static float plainSumSquaredDiff(const float* a, const float* b, int count) {
+    float sum = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+static void plainSobel3x3(const float* row0, const float* row1, const float* row2,
+                          float* gx, float* gy, int count) {
+    for (int i = 0; i < count; ++i) {
+        gx[i] = (row0[i + 1] - row0[i - 1]) + 2.0f * (row1[i + 1] - row1[i - 1]) + (row2[i + 1] - row2[i - 1]);
+        gy[i] = (row2[i - 1] - row0[i - 1]) + 2.0f * (row2[i] - row0[i]) + (row2[i + 1] - row0[i + 1]);
+    }
+}
+
+static void plainMagnitude(const float* gx, const float* gy, float* out, int count) {
+    for (int i = 0; i < count; ++i) {
+        out[i] = std::sqrt(gx[i] * gx[i] + gy[i] * gy[i]);
+    }
+}
+
+static void plainDecimate2x(const float* src, float* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = src[2 * i];
+    }
+}
+
+static void plainConvolve5(const float* src, const float weights[5], float* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        float sum = 0.0f;
+        for (int k = 0; k < 5; ++k) {
+            sum += weights[k] * src[i + k - 2];
+        }
+        dst[i] = sum;
+    }
+}
+
+static void plainBlendRows5(const float* const rows[5], const float weights[5], float* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        float sum = 0.0f;
+        for (int k = 0; k < 5; ++k) {
+            sum += weights[k] * rows[k][i];
+        }
+        dst[i] = sum;
+    }
+}
+
+static void plainConvolve5Decimate2x(const float* src, const float weights[5], float* dst, int count) {
+    for (int i = 0; i < count; ++i) {
+        float sum = 0.0f;
+        for (int k = 0; k < 5; ++k) {
+            sum += weights[k] * src[2 * i + k - 2];
+        }
+        dst[i] = sum;
+    }
+}
+
+static const simd::RowKernels kPlainRowKernels = {
+    "plain",
+    plainSumAbsDiff,
+    plainSumSquaredDiff,
+    plainSobel3x3,
+    plainMagnitude,
+    plainDecimate2x,
+    plainConvolve5,
+    plainBlendRows5,
+    plainConvolve5Decimate2x
+};
+
+// ==================== Per-pixel merge ====================
+
+/**
+ * One channel of one pixel the way FrameMerger::merge reduced it before the
+ * sorting-network kernels
+ */
+static float perPixelReduce(std::vector<float>& values, const MergeParams& params) {
+    const int n = static_cast<int>(values.size());
+    switch (params.method) {
+        case MergeMethod::AVERAGE: {
+            float sum = 0.0f;
+            for (float v : values) sum += v;
+            return sum / n;
+        }
+        case MergeMethod::TRIMMED_MEAN: {
+            std::sort(values.begin(), values.end());
+            int trimCount = std::min(static_cast<int>(n * params.trimRatio), (n - 1) / 2);
+            float sum = 0.0f;
+            for (int i = trimCount; i < n - trimCount; ++i) sum += values[i];
+            return sum / (n - 2 * trimCount);
+        }
+        case MergeMethod::MEDIAN: {
+            std::nth_element(values.begin(), values.begin() + n / 2, values.end());
+            float upper = values[n / 2];
+            if (n % 2 != 0) return upper;
+            std::nth_element(values.begin(), values.begin() + n / 2 - 1, values.end());
+            return (upper + values[n / 2 - 1]) / 2.0f;
+        }
+        case MergeMethod::M_ESTIMATOR: {
+            std::vector<float> sorted = values;
+            std::sort(sorted.begin(), sorted.end());
+            float estimate = sorted[n / 2];
+            for (int iter = 0; iter < 10; ++iter) {
+                float weightedSum = 0.0f, weightSum = 0.0f;
+                for (float v : values) {
+                    float absRes = std::fabs(v - estimate);
+                    float weight = absRes <= params.huberDelta ? 1.0f : params.huberDelta / absRes;
+                    weightedSum += weight * v;
+                    weightSum += weight;
+                }
+                float next = weightSum > 0.0f ? weightedSum / weightSum : estimate;
+                if (std::fabs(next - estimate) < 1e-6f) break;
+                estimate = next;
+            }
+            return estimate;
+        }
+        case MergeMethod::FREQUENCY_DOMAIN:
+            break;      // Not a per-pixel reduction
+    }
+    return 0.0f;
+}
+
+/**
+ * Gather every pixel's samples into vectors and reduce each channel
+ */
+static void perPixelMerge(const std::vector<RGBImage>& frames, const MergeParams& params, RGBImage& output) {
+    const int numFrames = static_cast<int>(frames.size());
+    output.resize(frames[0].width, frames[0].height);
+    std::vector<float> r(numFrames), g(numFrames), b(numFrames);
+    for (int y = 0; y < output.height; ++y) {
+        for (int x = 0; x < output.width; ++x) {
+            for (int f = 0; f < numFrames; ++f) {
+                const RGBPixel& px = frames[f].at(x, y);
+                r[f] = px.r;
+                g[f] = px.g;
+                b[f] = px.b;
+            }
+            output.at(x, y) = RGBPixel(perPixelReduce(r, params), perPixelReduce(g, params),
+                                       perPixelReduce(b, params));
+        }
+    }
+}
+
+// ==================== Windowed statistics ====================
+
+/**
+ * Local mean and variance the way the Wiener filter computed them before the
+ * summed-area tables: every window summed pixel by pixel, edges replicated
+ */
+static void windowedMoments(const RGBImage& image, int radius, RGBImage& mean, RGBImage& variance) {
+    const int width = image.width;
+    const int height = image.height;
+    mean.resize(width, height);
+    variance.resize(width, height);
+    const float invCount = 1.0f / ((2 * radius + 1) * (2 * radius + 1));
+    
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = 0; x < width; ++x) {
+                float sum[3] = {0, 0, 0};
+                float sumSq[3] = {0, 0, 0};
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    const RGBPixel* row = image.row(clamp(y + dy, 0, height - 1));
+                    for (int dx = -radius; dx <= radius; ++dx) {
+                        const RGBPixel& p = row[clamp(x + dx, 0, width - 1)];
+                        const float v[3] = {p.r, p.g, p.b};
+                        for (int c = 0; c < 3; ++c) {
+                            sum[c] += v[c];
+                            sumSq[c] += v[c] * v[c];
+                        }
+                    }
+                }
+                float m[3], var[3];
+                for (int c = 0; c < 3; ++c) {
+                    m[c] = sum[c] * invCount;
+                    var[c] = std::max(sumSq[c] * invCount - m[c] * m[c], 0.0f);
+                }
+                mean.at(x, y) = RGBPixel(m[0], m[1], m[2]);
+                variance.at(x, y) = RGBPixel(var[0], var[1], var[2]);
+            }
+        }
+    });
+}
+
+// ==================== Report ====================
+
+std::string BenchmarkReport::format() const {
+    std::string text = title + "\n";
+    char line[160];
+    snprintf(line, sizeof(line), "%-16s %7s %10s %12s %8s\n",
+             "case", "threads", "time(ms)", unit.c_str(), "speedup");
+    text += line;
+
+    for (const auto& s : samples) {
+        snprintf(line, sizeof(line), "%-16s %7d %10.1f %12.2f %7.2fx\n",
+                 s.name.c_str(), s.threads, s.timeMs, s.throughput, s.speedup);
+        text += line;
+    }
+    return text;
+}
+
+// ==================== Benchmarks ====================
+
+BenchmarkReport runAlignmentScalingBenchmark(int tileSize, int numTiles, int numFrames) {
+    BenchmarkReport report;
+    report.title = "Tile alignment scaling (" + std::to_string(tileSize) + "px tiles, " +
+                   std::to_string(numFrames) + " frames, " + std::to_string(numTiles) + " tiles)";
+    report.unit = "tiles/s";
+
+    numFrames = std::max(2, numFrames);
+    numTiles = std::max(1, numTiles);
+
+    // Reference plus frames with sub-pixel handheld-like shifts
+    std::vector<GrayImage> frames(numFrames);
+    for (int f = 0; f < numFrames; ++f) {
+        renderSyntheticGray(tileSize, tileSize, 1.3f * f, -0.7f * f, frames[f]);
+    }
+
+    HybridAligner hybridAligner;
+    OpticalFlowParams flowParams;
+
+    struct AlignCase {
+        const char* name;
+        std::function<void(int)> alignTile;
+    };
+
+    std::vector<AlignCase> cases = {
+        { "hybrid", [&](int) {
+            for (int f = 1; f < numFrames; ++f) {
+                hybridAligner.computeMotion(frames[0], frames[f], nullptr, false);
+            }
+        }},
+        { "dense_flow", [&](int) {
+            DenseOpticalFlow flow(flowParams);
+            flow.setReference(frames[0]);
+            for (int f = 1; f < numFrames; ++f) {
+                flow.computeFlow(frames[f]);
+            }
+        }}
+    };
+
+    for (const auto& alignCase : cases) {
+        float baseThroughput = 0.0f;
+
+        for (int threads : scalingThreadCounts()) {
+            BenchmarkSample sample;
+            sample.name = alignCase.name;
+            sample.threads = threads;
+            sample.timeMs = timeParallel(threads, numTiles, alignCase.alignTile);
+            sample.throughput = sample.timeMs > 0.0f ? numTiles * 1000.0f / sample.timeMs : 0.0f;
+
+            if (threads == 1) {
+                baseThroughput = sample.throughput;
+            }
+            sample.speedup = baseThroughput > 0.0f ? sample.throughput / baseThroughput : 0.0f;
+
+            LOGI("Alignment scaling: %s threads=%d time=%.1fms %.2f tiles/s speedup=%.2fx",
+                 sample.name.c_str(), threads, sample.timeMs, sample.throughput, sample.speedup);
+            report.samples.push_back(sample);
+        }
+    }
+
+    return report;
+}
+
+BenchmarkReport runFFTBenchmark(int minIterations) {
+    BenchmarkReport report;
+    report.title = "2D FFT forward + inverse round trip (single thread)";
+    report.unit = "pairs/s";
+    
+    minIterations = std::max(1, minIterations);
+    
+    for (int size = 64; size <= 512; size *= 2) {
+        const int n = size * size;
+        const int iterations = minIterations * (512 / size) * (512 / size);
+        
+        GrayImage image;
+        renderSyntheticGray(size, size, 0.0f, 0.0f, image);
+        std::vector<float> input(n);
+        for (int y = 0; y < size; ++y) {
+            std::copy(image.row(y), image.row(y) + size, input.begin() + y * size);
+        }
+        
+        // Baseline: complex transform of the real image
+        std::vector<std::complex<float>> complexData(n);
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            for (int i = 0; i < n; ++i) {
+                complexData[i] = std::complex<float>(input[i], 0.0f);
+            }
+            baselineFFT2D(complexData.data(), size, false);
+            baselineFFT2D(complexData.data(), size, true);
+        }
+        auto end = std::chrono::steady_clock::now();
+        float baselineMs = std::chrono::duration<float, std::milli>(end - start).count();
+        
+        // Engine: real-input transform on the half spectrum
+        const RealFFT2D& fft = RealFFT2D::forSize(size);
+        std::vector<std::complex<float>> spectrum(fft.spectrumSize());
+        std::vector<float> output(n);
+        start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            fft.forward(input.data(), spectrum.data());
+            fft.inverse(spectrum.data(), output.data());
+        }
+        end = std::chrono::steady_clock::now();
+        float engineMs = std::chrono::duration<float, std::milli>(end - start).count();
+        
+        // Both round trips must reproduce the input
+        float maxError = 0.0f;
+        for (int i = 0; i < n; ++i) {
+            maxError = std::max(maxError, std::abs(output[i] - input[i]));
+            maxError = std::max(maxError, std::abs(complexData[i].real() - input[i]));
+        }
+        
+        BenchmarkSample baseline;
+        baseline.name = "radix2_" + std::to_string(size);
+        baseline.timeMs = baselineMs;
+        baseline.throughput = baselineMs > 0.0f ? iterations * 1000.0f / baselineMs : 0.0f;
+        baseline.speedup = 1.0f;
+        
+        BenchmarkSample engine;
+        engine.name = "real_fft_" + std::to_string(size);
+        engine.timeMs = engineMs;
+        engine.throughput = engineMs > 0.0f ? iterations * 1000.0f / engineMs : 0.0f;
+        engine.speedup = baseline.throughput > 0.0f ? engine.throughput / baseline.throughput : 0.0f;
+        
+        LOGI("FFT %d: radix2 %.3f ms, real_fft %.3f ms per pair (%.2fx), max round-trip error %.2e",
+             size, baselineMs / iterations, engineMs / iterations, engine.speedup, maxError);
+        report.samples.push_back(baseline);
+        report.samples.push_back(engine);
+    }
+    
+    return report;
+}
+
+BenchmarkReport runYUVIngestBenchmark(int width, int height, int iterations) {
+    BenchmarkReport report;
+    report.title = "YUV_420_888 ingestion to RGB + luma (" + std::to_string(width) + "x" +
+                   std::to_string(height) + " NV21)";
+    report.unit = "MP/s";
+    
+    width = std::max(2, width & ~1);
+    height = std::max(2, height & ~1);
+    iterations = std::max(1, iterations);
+    
+    // NV21 layout: full-resolution Y plane, interleaved V/U at half resolution
+    GrayImage scene;
+    renderSyntheticGray(width, height, 0.0f, 0.0f, scene);
+    std::vector<uint8_t> yPlane(static_cast<size_t>(width) * height);
+    std::vector<uint8_t> vuPlane(static_cast<size_t>(width) * (height / 2));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            yPlane[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(16.0f + 219.0f * scene.at(x, y));
+        }
+    }
+    for (int y = 0; y < height / 2; ++y) {
+        for (int x = 0; x < width / 2; ++x) {
+            float s = scene.at(2 * x, 2 * y);
+            vuPlane[static_cast<size_t>(y) * width + 2 * x] = static_cast<uint8_t>(96.0f + 64.0f * s);
+            vuPlane[static_cast<size_t>(y) * width + 2 * x + 1] = static_cast<uint8_t>(160.0f - 64.0f * s);
+        }
+    }
+    
+    YUVFrame frame;
+    frame.yPlane = yPlane.data();
+    frame.vPlane = vuPlane.data();
+    frame.uPlane = vuPlane.data() + 1;
+    frame.yRowStride = width;
+    frame.uvRowStride = width;
+    frame.uvPixelStride = 2;
+    frame.width = width;
+    frame.height = height;
+    
+    const float megapixels = static_cast<float>(width) * height * iterations / 1e6f;
+    RGBImage rgb;
+    GrayImage luma;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; ++it) {
+        baselineYUVToRgbLuma(frame, rgb, luma);
+    }
+    auto end = std::chrono::steady_clock::now();
+    
+    BenchmarkSample baseline;
+    baseline.name = "scalar";
+    baseline.timeMs = std::chrono::duration<float, std::milli>(end - start).count();
+    baseline.throughput = baseline.timeMs > 0.0f ? megapixels * 1000.0f / baseline.timeMs : 0.0f;
+    baseline.speedup = 1.0f;
+    report.samples.push_back(baseline);
+    LOGI("YUV ingest: scalar %.1f ms, %.1f MP/s", baseline.timeMs, baseline.throughput);
+    
+    for (int threads : scalingThreadCounts()) {
+        ThreadPool pool(std::max(0, threads - 1));
+        ScopedPool scope(pool);
+        
+        start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            yuvToRgbLuma(frame, &rgb, &luma, YUVLuma::RGB_WEIGHTED);
+        }
+        end = std::chrono::steady_clock::now();
+        
+        BenchmarkSample fused;
+        fused.name = "fused";
+        fused.threads = threads;
+        fused.timeMs = std::chrono::duration<float, std::milli>(end - start).count();
+        fused.throughput = fused.timeMs > 0.0f ? megapixels * 1000.0f / fused.timeMs : 0.0f;
+        fused.speedup = baseline.throughput > 0.0f ? fused.throughput / baseline.throughput : 0.0f;
+        
+        LOGI("YUV ingest: fused threads=%d %.1f ms, %.1f MP/s (%.2fx)",
+             threads, fused.timeMs, fused.throughput, fused.speedup);
+        report.samples.push_back(fused);
+    }
+    
+    return report;
+}
+
+BenchmarkReport runSimdKernelBenchmark(int width, int height) {
+    BenchmarkReport report;
+    report.title = "SIMD row kernels (" + std::to_string(width) + "x" + std::to_string(height) +
+                   ", dispatched: " + simd::rowKernels().name + ")";
+    report.unit = "MP/s";
+    
+    width = std::max(16, width);
+    height = std::max(8, height);
+    
+    GrayImage a, b, out1, out2;
+    renderSyntheticGray(width, height, 0.0f, 0.0f, a);
+    renderSyntheticGray(width, height, 1.5f, -0.5f, b);
+    out1.resize(width, height);
+    out2.resize(width, height);
+    const float weights[5] = {1.0f / 16.0f, 4.0f / 16.0f, 6.0f / 16.0f, 4.0f / 16.0f, 1.0f / 16.0f};
+    
+    // One pass of a kernel over the interior rows (columns 2 .. width - 3)
+    const int count = width - 4;
+    volatile float sink = 0.0f;
+    auto runKernel = [&](const simd::RowKernels& k, int kernel) {
+        float sum = 0.0f;
+        for (int y = 2; y < height - 2; ++y) {
+            const float* row = a.row(y) + 2;
+            switch (kernel) {
+                case 0: sum += k.sumAbsDiff(row, b.row(y) + 2, count); break;
+                case 1: sum += k.sumSquaredDiff(row, b.row(y) + 2, count); break;
+                case 2: k.sobel3x3(a.row(y - 1) + 2, row, a.row(y + 1) + 2, out1.row(y) + 2, out2.row(y) + 2, count); break;
+                case 3: k.magnitude(row, b.row(y) + 2, out1.row(y) + 2, count); break;
+                case 4: k.decimate2x(a.row(y), out1.row(y), width / 2); break;
+                case 5: k.convolve5(row, weights, out1.row(y) + 2, count); break;
+                case 6: k.convolve5Decimate2x(row, weights, out1.row(y), (count - 1) / 2); break;
+                default: {
+                    const float* rows[5] = {a.row(y - 2), a.row(y - 1), a.row(y), a.row(y + 1), a.row(y + 2)};
+                    k.blendRows5(rows, weights, out1.row(y), width);
+                    break;
+                }
+            }
+        }
+        sink = sink + sum;
+    };
+    
+    static const char* kKernelNames[] = {"sad", "ssd", "sobel", "magnitude", "decimate", "conv5", "conv5_decimate",
+                                         "blend5"};
+    const float megapixels = static_cast<float>(count) * (height - 4) / 1e6f;
+    
+    std::vector<const simd::RowKernels*> sets = {&kPlainRowKernels, &simd::baselineRowKernels()};
+    if (&simd::rowKernels() != &simd::baselineRowKernels()) {
+        sets.push_back(&simd::rowKernels());
+    }
+    
+    for (int kernel = 0; kernel < 8; ++kernel) {
+        float plainThroughput = 0.0f;
+        for (const simd::RowKernels* set : sets) {
+            // Best of three passes
+            float bestMs = 0.0f;
+            for (int pass = 0; pass < 3; ++pass) {
+                auto start = std::chrono::steady_clock::now();
+                runKernel(*set, kernel);
+                auto end = std::chrono::steady_clock::now();
+                float ms = std::chrono::duration<float, std::milli>(end - start).count();
+                bestMs = pass == 0 ? ms : std::min(bestMs, ms);
+            }
+            
+            BenchmarkSample sample;
+            sample.name = std::string(kKernelNames[kernel]) + "_" + set->name;
+            sample.timeMs = bestMs;
+            sample.throughput = bestMs > 0.0f ? megapixels * 1000.0f / bestMs : 0.0f;
+            if (set == &kPlainRowKernels) {
+                plainThroughput = sample.throughput;
+            }
+            sample.speedup = plainThroughput > 0.0f ? sample.throughput / plainThroughput : 0.0f;
+            
+            LOGI("SIMD %s: %.2f ms, %.1f MP/s (%.2fx)", sample.name.c_str(), sample.timeMs,
+                 sample.throughput, sample.speedup);
+            report.samples.push_back(sample);
+        }
+    }
+    
+    return report;
+}
+
+/**
+ * One pyramid level the way GaussianPyramid built it before the decimating
+ * builder: full-size horizontal blur, full-size vertical blur, then every
+ * other pixel of every other row
+ */
+static void blurThenDecimate(const GrayImage& src, GrayImage& blurredH, GrayImage& blurred, GrayImage& dst) {
+    static const float kWeights[5] = {1.0f / 16.0f, 4.0f / 16.0f, 6.0f / 16.0f, 4.0f / 16.0f, 1.0f / 16.0f};
+    const simd::RowKernels& kernels = simd::rowKernels();
+    const int width = src.width;
+    const int height = src.height;
+    blurredH.resize(width, height);
+    blurred.resize(width, height);
+    
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const float* srcRow = src.row(y);
+            float* dstRow = blurredH.row(y);
+            auto blurClamped = [&](int x) {
+                float sum = 0.0f;
+                for (int k = -2; k <= 2; ++k) {
+                    sum += srcRow[clamp(x + k, 0, width - 1)] * kWeights[k + 2];
+                }
+                dstRow[x] = sum;
+            };
+            blurClamped(0);
+            blurClamped(1);
+            kernels.convolve5(srcRow + 2, kWeights, dstRow + 2, width - 4);
+            blurClamped(width - 2);
+            blurClamped(width - 1);
+        }
+    });
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            const float* rows[5];
+            for (int k = -2; k <= 2; ++k) {
+                rows[k + 2] = blurredH.row(clamp(y + k, 0, height - 1));
+            }
+            kernels.blendRows5(rows, kWeights, blurred.row(y), width);
+        }
+    });
+    
+    dst.resize(width / 2, height / 2);
+    for (int y = 0; y < dst.height; ++y) {
+        kernels.decimate2x(blurred.row(2 * y), dst.row(y), dst.width);
+    }
+}
+
+BenchmarkReport runPyramidBenchmark(int width, int height, int iterations) {
+    BenchmarkReport report;
+    report.title = "Gaussian pyramid construction (" + std::to_string(width) + "x" +
+                   std::to_string(height) + ", " + std::to_string(MAX_PYRAMID_LEVELS) + " levels)";
+    report.unit = "MP/s";
+    
+    width = std::max(32, width);
+    height = std::max(32, height);
+    iterations = std::max(1, iterations);
+    const float megapixels = static_cast<float>(width) * height / 1e6f;
+    
+    GrayImage gray;
+    renderSyntheticGray(width, height, 0.0f, 0.0f, gray);
+    RGBImage rgb(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float v = gray.at(x, y);
+            rgb.at(x, y) = RGBPixel(v, 0.5f * v + 0.25f, 1.0f - v);
+        }
+    }
+    
+    auto timeMs = [&](const std::function<void()>& build) {
+        build();  // Warm up allocations and the thread pool
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; ++it) {
+            build();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<float, std::milli>(end - start).count();
+    };
+    
+    std::vector<GrayImage> referenceLevels(MAX_PYRAMID_LEVELS);
+    GrayImage blurredH, blurred;
+    const float referenceMs = timeMs([&] {
+        referenceLevels[0] = gray;
+        for (int i = 1; i < MAX_PYRAMID_LEVELS; ++i) {
+            blurThenDecimate(referenceLevels[i - 1], blurredH, blurred, referenceLevels[i]);
+        }
+    });
+    
+    GaussianPyramid grayPyramid;
+    const float grayMs = timeMs([&] { grayPyramid.build(gray, MAX_PYRAMID_LEVELS); });
+    
+    RGBPyramid rgbPyramid;
+    const float rgbMs = timeMs([&] { rgbPyramid.build(rgb, MAX_PYRAMID_LEVELS); });
+    
+    // Same filter in a different order: only rounding should differ
+    float maxError = 0.0f;
+    for (int i = 1; i < grayPyramid.numLevels(); ++i) {
+        const GrayView& level = grayPyramid.getLevel(i);
+        for (int y = 0; y < level.height; ++y) {
+            for (int x = 0; x < level.width; ++x) {
+                maxError = std::max(maxError, std::fabs(level.at(x, y) - referenceLevels[i].at(x, y)));
+            }
+        }
+    }
+    
+    const float referenceThroughput = referenceMs > 0.0f ? megapixels * iterations * 1000.0f / referenceMs : 0.0f;
+    const std::pair<const char*, float> cases[] = {
+        {"gray_blur_then_decimate", referenceMs},
+        {"gray_decimating", grayMs},
+        {"rgb_decimating", rgbMs}
+    };
+    for (const auto& entry : cases) {
+        BenchmarkSample sample;
+        sample.name = entry.first;
+        sample.threads = ThreadPool::instance().concurrency();
+        sample.timeMs = entry.second / iterations;
+        sample.throughput = entry.second > 0.0f ? megapixels * iterations * 1000.0f / entry.second : 0.0f;
+        sample.speedup = referenceThroughput > 0.0f ? sample.throughput / referenceThroughput : 0.0f;
+        
+        LOGI("Pyramid %s: %.2f ms per build, %.1f MP/s (%.2fx)", sample.name.c_str(), sample.timeMs,
+             sample.throughput, sample.speedup);
+        report.samples.push_back(sample);
+    }
+    LOGI("Pyramid: max difference from blur-then-decimate %.2e", maxError);
+    
+    return report;
+}
+
+BenchmarkReport runMergeBenchmark(int width, int height) {
+    BenchmarkReport report;
+    report.title = "Robust burst merge (" + std::to_string(width) + "x" + std::to_string(height) + ")";
+    report.unit = "MP/s";
+    
+    width = std::max(8, width);
+    height = std::max(8, height);
+    const float megapixels = static_cast<float>(width) * height / 1e6f;
+    
+    // Shifted scene plus per-frame noise, with an occasional outlier
+    std::vector<RGBImage> frames(16);
+    GrayImage gray;
+    for (int f = 0; f < static_cast<int>(frames.size()); ++f) {
+        renderSyntheticGray(width, height, 0.3f * f, -0.2f * f, gray);
+        frames[f].resize(width, height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                float v = gray.at(x, y) + 0.05f * (latticeNoise(x, y, 10 + f) - 0.5f);
+                if (latticeNoise(x, y, 100 + f) > 0.97f) v = 1.0f;
+                frames[f].at(x, y) = RGBPixel(v, 0.5f * v + 0.25f, 1.0f - v);
+            }
+        }
+    }
+    
+    // Single threaded: both versions split rows the same way across the pool
+    ThreadPool pool(0);
+    ScopedPool scope(pool);
+    
+    auto timeMs = [](const std::function<void()>& merge) {
+        float best = 0.0f;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto start = std::chrono::steady_clock::now();
+            merge();
+            auto end = std::chrono::steady_clock::now();
+            float ms = std::chrono::duration<float, std::milli>(end - start).count();
+            best = pass == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    };
+    
+    const std::pair<const char*, MergeMethod> methods[] = {
+        {"trim", MergeMethod::TRIMMED_MEAN},
+        {"median", MergeMethod::MEDIAN},
+        {"huber", MergeMethod::M_ESTIMATOR}
+    };
+    float maxError = 0.0f;
+    for (int numFrames : {8, 12}) {
+        const std::vector<RGBImage> burst(frames.begin(), frames.begin() + numFrames);
+        for (const auto& method : methods) {
+            MergeParams params;
+            params.method = method.second;
+            params.applyWienerFilter = false;
+            FrameMerger merger(params);
+            
+            RGBImage reference, merged;
+            const float perPixelMs = timeMs([&] { perPixelMerge(burst, params, reference); });
+            const float networkMs = timeMs([&] { merger.merge(burst, merged); });
+            
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    const RGBPixel& a = reference.at(x, y);
+                    const RGBPixel& b = merged.at(x, y);
+                    maxError = std::max({maxError, std::fabs(a.r - b.r), std::fabs(a.g - b.g),
+                                         std::fabs(a.b - b.b)});
+                }
+            }
+            
+            const std::pair<const char*, float> cases[] = {{"pixel", perPixelMs}, {"network", networkMs}};
+            for (const auto& entry : cases) {
+                BenchmarkSample sample;
+                sample.name = std::string(method.first) + std::to_string(numFrames) + "_" + entry.first;
+                sample.threads = 1;
+                sample.timeMs = entry.second;
+                sample.throughput = entry.second > 0.0f ? megapixels * 1000.0f / entry.second : 0.0f;
+                sample.speedup = entry.second > 0.0f ? perPixelMs / entry.second : 0.0f;
+                
+                LOGI("Merge %s: %.2f ms, %.1f MP/s (%.2fx)", sample.name.c_str(), sample.timeMs,
+                     sample.throughput, sample.speedup);
+                report.samples.push_back(sample);
+            }
+        }
+    }
+    LOGI("Merge: max difference from the per-pixel reductions %.2e", maxError);
+    
+    return report;
+}
+
+BenchmarkReport runLocalMomentsBenchmark(int width, int height) {
+    BenchmarkReport report;
+    report.title = "Local mean and variance (" + std::to_string(width) + "x" + std::to_string(height) + " RGB)";
+    report.unit = "MP/s";
+    
+    width = std::max(8, width);
+    height = std::max(8, height);
+    const float megapixels = static_cast<float>(width) * height / 1e6f;
+    
+    GrayImage gray;
+    renderSyntheticGray(width, height, 0.0f, 0.0f, gray);
+    RGBImage image(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float v = gray.at(x, y);
+            image.at(x, y) = RGBPixel(v, 0.5f * v + 0.25f, 1.0f - v);
+        }
+    }
+    
+    // Single threaded: both versions split rows the same way across the pool
+    ThreadPool pool(0);
+    ScopedPool scope(pool);
+    
+    auto timeMs = [](const std::function<void()>& compute) {
+        float best = 0.0f;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto start = std::chrono::steady_clock::now();
+            compute();
+            auto end = std::chrono::steady_clock::now();
+            float ms = std::chrono::duration<float, std::milli>(end - start).count();
+            best = pass == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    };
+    
+    float maxError = 0.0f;
+    for (int radius : {2, 4, 8}) {
+        RGBImage windowMean, windowVariance, tableMean, tableVariance;
+        const float windowMs = timeMs([&] { windowedMoments(image, radius, windowMean, windowVariance); });
+        const float tableMs = timeMs([&] {
+            computeLocalMoments(image, radius, WindowBorder::REPLICATE, &tableMean, &tableVariance);
+        });
+        
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const RGBPixel& a = windowVariance.at(x, y);
+                const RGBPixel& b = tableVariance.at(x, y);
+                const RGBPixel& ma = windowMean.at(x, y);
+                const RGBPixel& mb = tableMean.at(x, y);
+                maxError = std::max({maxError, std::fabs(a.r - b.r), std::fabs(a.g - b.g), std::fabs(a.b - b.b),
+                                     std::fabs(ma.r - mb.r), std::fabs(ma.g - mb.g), std::fabs(ma.b - mb.b)});
+            }
+        }
+        
+        const std::pair<const char*, float> cases[] = {{"window", windowMs}, {"tables", tableMs}};
+        for (const auto& entry : cases) {
+            BenchmarkSample sample;
+            sample.name = std::string(entry.first) + "_r" + std::to_string(radius);
+            sample.threads = 1;
+            sample.timeMs = entry.second;
+            sample.throughput = entry.second > 0.0f ? megapixels * 1000.0f / entry.second : 0.0f;
+            sample.speedup = entry.second > 0.0f ? windowMs / entry.second : 0.0f;
+            
+            LOGI("Local moments %s: %.2f ms, %.1f MP/s (%.2fx)", sample.name.c_str(), sample.timeMs,
+                 sample.throughput, sample.speedup);
+            report.samples.push_back(sample);
+        }
+    }
+    LOGI("Local moments: max difference from per-window sums %.2e", maxError);
+    
+    return report;
+}
+
+BenchmarkReport runFrequencyMergeBenchmark(int width, int height) {
+    BenchmarkReport report;
+    report.title = "Frequency-domain merge (" + std::to_string(width) + "x" + std::to_string(height) + ")";
+    report.unit = "MP/s";
+    
+    width = std::max(8, width);
+    height = std::max(8, height);
+    const float megapixels = static_cast<float>(width) * height / 1e6f;
+    
+    // Static scene plus per-frame noise; a bright square moves across every
+    // frame but the reference, so the merge has to reject it
+    const int numFrames = 8;
+    const int referenceIndex = numFrames / 2;
+    const int objectSize = std::max(4, std::min(width, height) / 8);
+    GrayImage scene;
+    renderSyntheticGray(width, height, 0.0f, 0.0f, scene);
+    std::vector<RGBImage> frames(numFrames);
+    for (int f = 0; f < numFrames; ++f) {
+        frames[f].resize(width, height);
+        const int objectX = (width - objectSize) * f / (numFrames - 1);
+        const int objectY = (height - objectSize) / 2;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                float v = scene.at(x, y);
+                if (f != referenceIndex && x >= objectX && x < objectX + objectSize &&
+                    y >= objectY && y < objectY + objectSize) {
+                    v = 1.0f;
+                }
+                const float r = v + 0.1f * (latticeNoise(x, y, 10 + 3 * f) - 0.5f);
+                const float g = 0.5f * v + 0.25f + 0.1f * (latticeNoise(x, y, 11 + 3 * f) - 0.5f);
+                const float b = 1.0f - v + 0.1f * (latticeNoise(x, y, 12 + 3 * f) - 0.5f);
+                frames[f].at(x, y) = RGBPixel(r, g, b);
+            }
+        }
+    }
+    
+    auto psnr = [&](const RGBImage& image) {
+        double sumSq = 0.0;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const float v = scene.at(x, y);
+                const RGBPixel& p = image.at(x, y);
+                const float dr = p.r - v;
+                const float dg = p.g - (0.5f * v + 0.25f);
+                const float db = p.b - (1.0f - v);
+                sumSq += dr * dr + dg * dg + db * db;
+            }
+        }
+        const double mse = sumSq / (3.0 * width * height);
+        return mse > 0.0 ? static_cast<float>(10.0 * std::log10(1.0 / mse)) : 99.0f;
+    };
+    
+    ThreadPool pool(0);
+    ScopedPool scope(pool);
+    
+    auto timeMs = [](const std::function<void()>& merge) {
+        float best = 0.0f;
+        for (int pass = 0; pass < 3; ++pass) {
+            auto start = std::chrono::steady_clock::now();
+            merge();
+            auto end = std::chrono::steady_clock::now();
+            float ms = std::chrono::duration<float, std::milli>(end - start).count();
+            best = pass == 0 ? ms : std::min(best, ms);
+        }
+        return best;
+    };
+    
+    struct Case {
+        const char* name;
+        MergeMethod method;
+        int tileSize;
+    };
+    const Case cases[] = {
+        {"trim_wiener", MergeMethod::TRIMMED_MEAN, 16},
+        {"freq16", MergeMethod::FREQUENCY_DOMAIN, 16},
+        {"freq32", MergeMethod::FREQUENCY_DOMAIN, 32}
+    };
+    LOGI("Frequency merge: noisy reference PSNR %.2f dB", psnr(frames[referenceIndex]));
+    
+    float baselineMs = 0.0f;
+    for (const Case& entry : cases) {
+        MergeParams params;
+        params.method = entry.method;
+        params.frequencyTileSize = entry.tileSize;
+        FrameMerger merger(params);
+        
+        RGBImage merged;
+        const float ms = timeMs([&] { merger.merge(frames, merged, referenceIndex); });
+        if (entry.method == MergeMethod::TRIMMED_MEAN) baselineMs = ms;
+        
+        BenchmarkSample sample;
+        sample.name = entry.name;
+        sample.threads = 1;
+        sample.timeMs = ms;
+        sample.throughput = ms > 0.0f ? megapixels * 1000.0f / ms : 0.0f;
+        sample.speedup = ms > 0.0f ? baselineMs / ms : 0.0f;
+        
+        LOGI("Frequency merge %s: %.2f ms, %.1f MP/s (%.2fx), PSNR %.2f dB", sample.name.c_str(),
+             sample.timeMs, sample.throughput, sample.speedup, psnr(merged));
+        report.samples.push_back(sample);
+    }
+    
+    return report;
+}
+
+BenchmarkReport runBenchmark(BenchmarkId id) {
+    switch (id) {
+        case BenchmarkId::ALIGNMENT_SCALING:
+            return runAlignmentScalingBenchmark();
+        case BenchmarkId::FFT:
+            return runFFTBenchmark();
+        case BenchmarkId::YUV_INGEST:
+            return runYUVIngestBenchmark();
+        case BenchmarkId::SIMD_KERNELS:
+            return runSimdKernelBenchmark();
+        case BenchmarkId::PYRAMID:
+            return runPyramidBenchmark();
+        case BenchmarkId::MERGE:
+            return runMergeBenchmark();
+        case BenchmarkId::LOCAL_MOMENTS:
+            return runLocalMomentsBenchmark();
+        case BenchmarkId::FREQUENCY_MERGE:
+            return runFrequencyMergeBenchmark();
+    }
+
+    LOGW("Unknown benchmark id %d", static_cast<int>(id));
+    return BenchmarkReport();
+}
+
+} // namespace ultradetail
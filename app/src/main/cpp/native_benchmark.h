@@ -0,0 +1,174 @@
+/**
+ * native_benchmark.h - On-device micro-benchmarks for the native pipeline
+ *
+ * Self-contained benchmarks on synthetic data, run from the app (debug tools)
+ * to measure throughput and multi-core scaling of hot pipeline stages.
+ * Results are logged and returned as a plain-text report.
+ */
+
+#ifndef ULTRADETAIL_NATIVE_BENCHMARK_H
+#define ULTRADETAIL_NATIVE_BENCHMARK_H
+
+#include "common.h"
+#include <string>
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * Benchmark identifiers (must match NativeMFSRPipeline.BENCHMARK_* in Kotlin)
+ */
+enum class BenchmarkId {
+    ALIGNMENT_SCALING = 0,      // Tile alignment throughput vs thread count
+    FFT = 1,                    // 2D FFT engine vs the textbook radix-2 transform
+    YUV_INGEST = 2,             // Fused YUV -> RGB + luma conversion vs the per-pixel loop
+    SIMD_KERNELS = 3,           // simd.h row kernels (baseline and dispatched) vs plain loops
+    PYRAMID = 4,                // Decimating pyramid builder vs blur-then-decimate
+    MERGE = 5,                  // Sorting-network merge kernels vs per-pixel sort
+    LOCAL_MOMENTS = 6,          // Summed-area table window statistics vs per-window sums
+    FREQUENCY_MERGE = 7         // Frequency-domain tile merge vs trimmed mean + Wiener
+};
+
+/**
+ * One measured benchmark case
+ */
+struct BenchmarkSample {
+    std::string name;           // Case name (e.g. "hybrid")
+    int threads;                // Threads executing the case
+    float timeMs;               // Wall-clock time
+    float throughput;           // Work units per second
+    float speedup;              // Throughput relative to the 1-thread run of the same case
+
+    BenchmarkSample() : threads(1), timeMs(0), throughput(0), speedup(1.0f) {}
+};
+
+/**
+ * Benchmark report
+ */
+struct BenchmarkReport {
+    std::string title;
+    std::string unit;           // Throughput unit (e.g. "tiles/s")
+    std::vector<BenchmarkSample> samples;
+
+    /**
+     * Format as a human-readable table
+     */
+    std::string format() const;
+};
+
+/**
+ * Measure tile alignment throughput for 1..N threads
+ *
+ * Aligns numFrames-1 synthetic shifted frames to a reference per tile, for
+ * numTiles tiles, using both the hybrid (phase correlation) and dense optical
+ * flow aligners. Thread counts double from 1 up to the hardware concurrency.
+ *
+ * @param tileSize Tile width and height in pixels
+ * @param numTiles Number of tiles aligned per measurement
+ * @param numFrames Frames per tile (including the reference)
+ */
+BenchmarkReport runAlignmentScalingBenchmark(int tileSize = 256, int numTiles = 24, int numFrames = 4);
+
+/**
+ * Measure 2D FFT throughput at 64, 128, 256 and 512
+ * 
+ * Times a forward + inverse round trip (the phase correlation workload) of
+ * RealFFT2D against the former in-place radix-2 complex transform, single
+ * threaded. Speedup is relative to radix-2 at the same size.
+ * 
+ * @param minIterations Round trips per measurement at the largest size
+ *                      (smaller sizes run proportionally more)
+ */
+BenchmarkReport runFFTBenchmark(int minIterations = 8);
+
+/**
+ * Measure YUV_420_888 ingestion throughput in megapixels per second
+ * 
+ * Converts a synthetic NV21 frame to RGB and luma with the former scalar
+ * per-pixel loop (single thread) and with the fused SIMD kernel at 1..N
+ * threads. Speedup is relative to the scalar loop.
+ * 
+ * @param width Frame width in pixels
+ * @param height Frame height in pixels
+ * @param iterations Conversions per measurement
+ */
+BenchmarkReport runYUVIngestBenchmark(int width = 4000, int height = 3000, int iterations = 4);
+
+/**
+ * Measure the runtime-dispatched SIMD row kernels in megapixels per second
+ * 
+ * Runs each simd::RowKernels kernel over a synthetic image as plain C++
+ * loops, as the compile-time backend build and, when the CPU selects a
+ * different one (AVX2 on x86), as the dispatched build. Single threaded,
+ * best of three passes; speedup is relative to the plain loops.
+ * 
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ */
+BenchmarkReport runSimdKernelBenchmark(int width = 2048, int height = 1024);
+
+/**
+ * Measure Gaussian pyramid construction in megapixels (of level 0) per second
+ * 
+ * Compares GaussianPyramid::build, which filters only the pixels each level
+ * keeps, against the previous construction: level 0 copied, then a full-size
+ * horizontal and vertical blur per level before decimating. Also times
+ * RGBPyramid::build. All cases use the thread pool; speedup is relative to
+ * blur-then-decimate.
+ * 
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @param iterations Builds per measurement
+ */
+BenchmarkReport runPyramidBenchmark(int width = 4000, int height = 3000, int iterations = 4);
+
+/**
+ * Measure robust merging in megapixels per second
+ * 
+ * Merges 8 and 12 synthetic noisy frames with trimmed mean, median and
+ * Huber through FrameMerger::merge (sorting-network kernels) and through
+ * the former per-pixel loop that sorts each pixel's samples. Single
+ * threaded, best of three passes; speedup is relative to the per-pixel loop.
+ * 
+ * @param width Frame width in pixels
+ * @param height Frame height in pixels
+ */
+BenchmarkReport runMergeBenchmark(int width = 1024, int height = 768);
+
+/**
+ * Measure local mean and variance maps in megapixels per second
+ * 
+ * Computes the per-channel mean and variance of every (2r + 1)² window
+ * (edges replicated, as the Wiener filter uses them) for r = 2, 4 and 8,
+ * summing each window pixel by pixel and with computeLocalMoments. Single
+ * threaded, best of three passes; speedup is relative to per-window sums.
+ * 
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ */
+BenchmarkReport runLocalMomentsBenchmark(int width = 1024, int height = 768);
+
+/**
+ * Measure the frequency-domain merge in megapixels per second
+ * 
+ * Merges 8 noisy frames of a static scene, with an object moving through
+ * all but the reference, using trimmed mean + Wiener filter and
+ * FREQUENCY_DOMAIN with 16 and 32 px tiles. Logs the PSNR of each result
+ * against the clean reference frame. Single threaded, best of three passes;
+ * speedup is relative to trimmed mean + Wiener.
+ * 
+ * @param width Frame width in pixels
+ * @param height Frame height in pixels
+ */
+BenchmarkReport runFrequencyMergeBenchmark(int width = 1024, int height = 768);
+
+/**
+ * Run a benchmark by id
+ *
+ * @return Report (empty title if the id is unknown)
+ */
+BenchmarkReport runBenchmark(BenchmarkId id);
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_NATIVE_BENCHMARK_H
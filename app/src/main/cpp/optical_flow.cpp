@@ -5,88 +5,35 @@
  */
 
 #include "optical_flow.h"
-#include "neon_utils.h"
 #include <cmath>
 #include <algorithm>
 
 namespace ultradetail {
 
-// Scharr kernel coefficients (more accurate than Sobel)
-static constexpr float SCHARR_X[3][3] = {
-    {-3, 0, 3},
-    {-10, 0, 10},
-    {-3, 0, 3}
-};
-
-static constexpr float SCHARR_Y[3][3] = {
-    {-3, -10, -3},
-    {0, 0, 0},
-    {3, 10, 3}
-};
-
 DenseOpticalFlow::DenseOpticalFlow(const OpticalFlowParams& params)
     : params_(params)
+    , cache_(nullptr)
+    , refFrame_(0)
     , imageWidth_(0)
     , imageHeight_(0) {
 }
 
 void DenseOpticalFlow::setReference(const GrayImage& reference) {
-    imageWidth_ = reference.width;
-    imageHeight_ = reference.height;
-    
-    // Build reference pyramid
-    refPyramid_.build(reference, params_.pyramidLevels);
-    
-    // Precompute gradients for each pyramid level
-    computeGradients(reference, refGradX_, refGradY_);
-    
-    LOGD("DenseOpticalFlow: Reference set %dx%d, %d pyramid levels",
-         imageWidth_, imageHeight_, params_.pyramidLevels);
+    ownCache_ = std::make_unique<FrameAnalysisCache>(params_.pyramidLevels);
+    setReference(*ownCache_, ownCache_->addFrame(reference));
 }
 
-void DenseOpticalFlow::computeGradients(const GrayImage& image, 
-                                        GrayImage& gradX, 
-                                        GrayImage& gradY) {
-    int width = image.width;
-    int height = image.height;
-    
-    gradX = GrayImage(width, height);
-    gradY = GrayImage(width, height);
-    
-    // Apply Scharr operator
-    for (int y = 1; y < height - 1; ++y) {
-        float* gxRow = gradX.row(y);
-        float* gyRow = gradY.row(y);
-        
-        for (int x = 1; x < width - 1; ++x) {
-            float gx = 0, gy = 0;
-            
-            for (int ky = -1; ky <= 1; ++ky) {
-                for (int kx = -1; kx <= 1; ++kx) {
-                    float val = image.at(x + kx, y + ky);
-                    gx += val * SCHARR_X[ky + 1][kx + 1];
-                    gy += val * SCHARR_Y[ky + 1][kx + 1];
-                }
-            }
-            
-            // Normalize by kernel sum (32)
-            gxRow[x] = gx / 32.0f;
-            gyRow[x] = gy / 32.0f;
-        }
-    }
+void DenseOpticalFlow::setReference(FrameAnalysisCache& cache, int frame) {
+    cache_ = &cache;
+    refFrame_ = frame;
+    imageWidth_ = cache.frame(frame).width;
+    imageHeight_ = cache.frame(frame).height;
     
-    // Zero borders
-    for (int x = 0; x < width; ++x) {
-        gradX.at(x, 0) = 0; gradX.at(x, height - 1) = 0;
-        gradY.at(x, 0) = 0; gradY.at(x, height - 1) = 0;
-    }
-    for (int y = 0; y < height; ++y) {
-        gradX.at(0, y) = 0; gradX.at(width - 1, y) = 0;
-        gradY.at(0, y) = 0; gradY.at(width - 1, y) = 0;
-    }
+    LOGD("DenseOpticalFlow: Reference set %dx%d, %d pyramid levels",
+         imageWidth_, imageHeight_, std::min(params_.pyramidLevels, cache.pyramid(frame).numLevels()));
 }
 
-float DenseOpticalFlow::sampleBilinear(const GrayImage& image, float x, float y) {
+float DenseOpticalFlow::sampleBilinear(const GrayView& image, float x, float y) {
     // Clamp to image bounds
     x = clamp(x, 0.0f, static_cast<float>(image.width - 1));
     y = clamp(y, 0.0f, static_cast<float>(image.height - 1));
@@ -111,14 +58,22 @@ float DenseOpticalFlow::sampleBilinear(const GrayImage& image, float x, float y)
 }
 
 FlowVector DenseOpticalFlow::computePixelFlow(
-    const GrayImage& ref,
-    const GrayImage& target,
-    const GrayImage& gradX,
-    const GrayImage& gradY,
+    const GrayView& ref,
+    const GrayView& target,
+    const FrameGradients& gradients,
+    const StructureTensorSums& tensor,
     int x, int y,
     const FlowVector& initialFlow
 ) {
     int halfWin = params_.windowSize / 2;
+    const GrayImage& gradX = gradients.gradX;
+    const GrayImage& gradY = gradients.gradY;
+    
+    // Window clipped to the reference interior (where gradients are defined)
+    const int winX0 = std::max(x - halfWin, 1);
+    const int winX1 = std::min(x + halfWin, ref.width - 2);
+    const int winY0 = std::max(y - halfWin, 1);
+    const int winY1 = std::min(y + halfWin, ref.height - 2);
     
     // Start with initial flow estimate
     float flowX = initialFlow.dx;
@@ -135,6 +90,11 @@ FlowVector DenseOpticalFlow::computePixelFlow(
         float sumIxIt = 0, sumIyIt = 0;
         int validPixels = 0;
         
+        // While every target sample of the window is in bounds, the gradient
+        // products are the reference's cached window sums
+        const bool windowInside = winX0 + flowX >= 0 && winX1 + flowX < target.width - 1 &&
+                                  winY0 + flowY >= 0 && winY1 + flowY < target.height - 1;
+        
         for (int wy = -halfWin; wy <= halfWin; ++wy) {
             int py = y + wy;
             if (py < 1 || py >= ref.height - 1) continue;
@@ -157,15 +117,23 @@ FlowVector DenseOpticalFlow::computePixelFlow(
                 float It = sampleBilinear(target, targetX, targetY) - ref.at(px, py);
                 
                 // Accumulate structure tensor
-                sumIxIx += Ix * Ix;
-                sumIxIy += Ix * Iy;
-                sumIyIy += Iy * Iy;
+                if (!windowInside) {
+                    sumIxIx += Ix * Ix;
+                    sumIxIy += Ix * Iy;
+                    sumIyIy += Iy * Iy;
+                }
                 sumIxIt += Ix * It;
                 sumIyIt += Iy * It;
                 validPixels++;
             }
         }
         
+        if (windowInside) {
+            sumIxIx = tensor.sumIxIx.at(x, y);
+            sumIxIy = tensor.sumIxIy.at(x, y);
+            sumIyIy = tensor.sumIyIy.at(x, y);
+        }
+        
         if (validPixels < halfWin * halfWin / 4) {
             // Not enough valid pixels
             return FlowVector(flowX, flowY, 0.0f);
@@ -213,14 +181,14 @@ FlowVector DenseOpticalFlow::computePixelFlow(
 }
 
 void DenseOpticalFlow::refineFlowLevel(
-    const GrayImage& ref,
-    const GrayImage& target,
+    const GrayView& ref,
+    const GrayView& target,
     FlowField& flow,
     int level
 ) {
-    // Compute gradients for this level
-    GrayImage gradX, gradY;
-    computeGradients(ref, gradX, gradY);
+    // Reference gradients and structure tensor for this level (shared by all targets)
+    const FrameGradients& gradients = cache_->gradients(refFrame_, level);
+    const StructureTensorSums& tensor = cache_->structureTensor(refFrame_, level, params_.windowSize);
     
     int width = flow.width;
     int height = flow.height;
@@ -237,7 +205,7 @@ void DenseOpticalFlow::refineFlowLevel(
             
             // Compute refined flow
             FlowVector refined = computePixelFlow(
-                ref, target, gradX, gradY,
+                ref, target, gradients, tensor,
                 x, y, currentFlow
             );
             
@@ -336,22 +304,44 @@ DenseFlowResult DenseOpticalFlow::computeFlow(
     const GrayImage& target,
     const GyroHomography& gyroInit
 ) {
-    DenseFlowResult result;
-    
-    if (refPyramid_.numLevels() == 0) {
+    if (!cache_) {
         LOGE("DenseOpticalFlow: Reference not set");
-        return result;
+        return DenseFlowResult();
     }
     
     // Build target pyramid
     GaussianPyramid targetPyramid;
     targetPyramid.build(target, params_.pyramidLevels);
     
+    return computeFlowFromPyramid(targetPyramid, gyroInit);
+}
+
+DenseFlowResult DenseOpticalFlow::computeFlow(
+    FrameAnalysisCache& cache,
+    int frame,
+    const GyroHomography& gyroInit
+) {
+    if (!cache_) {
+        LOGE("DenseOpticalFlow: Reference not set");
+        return DenseFlowResult();
+    }
+    
+    return computeFlowFromPyramid(cache.pyramid(frame), gyroInit);
+}
+
+DenseFlowResult DenseOpticalFlow::computeFlowFromPyramid(
+    const GaussianPyramid& targetPyramid,
+    const GyroHomography& gyroInit
+) {
+    DenseFlowResult result;
+    const GaussianPyramid& refPyramid = cache_->pyramid(refFrame_);
+    
     // Start from coarsest level
-    int numLevels = refPyramid_.numLevels();
+    int numLevels = std::min({std::max(1, params_.pyramidLevels),
+                              refPyramid.numLevels(), targetPyramid.numLevels()});
     
     // Initialize flow at coarsest level
-    const GrayImage& coarsestRef = refPyramid_.getLevel(numLevels - 1);
+    const GrayView& coarsestRef = refPyramid.getLevel(numLevels - 1);
     FlowField currentFlow(coarsestRef.width, coarsestRef.height);
     
     // Initialize with gyro if available
@@ -372,8 +362,8 @@ DenseFlowResult DenseOpticalFlow::computeFlow(
     
     // Coarse-to-fine refinement
     for (int level = numLevels - 1; level >= 0; --level) {
-        const GrayImage& refLevel = refPyramid_.getLevel(level);
-        const GrayImage& targetLevel = targetPyramid.getLevel(level);
+        const GrayView& refLevel = refPyramid.getLevel(level);
+        const GrayView& targetLevel = targetPyramid.getLevel(level);
         
         // Upsample flow if not at coarsest level
         if (level < numLevels - 1) {
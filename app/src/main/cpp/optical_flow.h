@@ -14,7 +14,9 @@
 #define ULTRADETAIL_OPTICAL_FLOW_H
 
 #include "common.h"
+#include "frame_analysis_cache.h"
 #include "pyramid.h"
+#include <memory>
 
 namespace ultradetail {
 
@@ -117,8 +119,20 @@ public:
     
     /**
      * Set reference frame
+     * 
+     * The reference pyramid borrows the frame's pixels, so it must stay
+     * alive and unchanged until the next setReference.
      */
     void setReference(const GrayImage& reference);
+    void setReference(GrayImage&& reference) = delete;
+    
+    /**
+     * Set reference frame from a shared analysis cache
+     * 
+     * The reference's pyramid, per-level gradients and structure tensors
+     * come from the cache, which must outlive this estimator's use of it.
+     */
+    void setReference(FrameAnalysisCache& cache, int frame);
     
     /**
      * Compute dense flow from reference to target frame
@@ -130,6 +144,12 @@ public:
     DenseFlowResult computeFlow(const GrayImage& target, 
                                 const GyroHomography& gyroInit = GyroHomography());
     
+    /**
+     * Same, with the target pyramid taken from a shared analysis cache
+     */
+    DenseFlowResult computeFlow(FrameAnalysisCache& cache, int frame,
+                                const GyroHomography& gyroInit = GyroHomography());
+    
     /**
      * Warp image using computed flow
      */
@@ -142,27 +162,28 @@ public:
 
 private:
     OpticalFlowParams params_;
-    GaussianPyramid refPyramid_;
+    std::unique_ptr<FrameAnalysisCache> ownCache_;  // Holds the reference set as an image
+    FrameAnalysisCache* cache_;
+    int refFrame_;
     int imageWidth_;
     int imageHeight_;
     
-    // Precomputed gradients for reference
-    GrayImage refGradX_;
-    GrayImage refGradY_;
-    
     /**
-     * Compute image gradients using Scharr operator
+     * Coarse-to-fine flow against a target pyramid
      */
-    void computeGradients(const GrayImage& image, GrayImage& gradX, GrayImage& gradY);
+    DenseFlowResult computeFlowFromPyramid(const GaussianPyramid& targetPyramid, const GyroHomography& gyroInit);
     
     /**
      * Compute flow at a single pixel using Lucas-Kanade
+     * 
+     * @param gradients Reference gradients at this level
+     * @param tensor Reference structure tensor at this level (params_.windowSize)
      */
     FlowVector computePixelFlow(
-        const GrayImage& ref,
-        const GrayImage& target,
-        const GrayImage& gradX,
-        const GrayImage& gradY,
+        const GrayView& ref,
+        const GrayView& target,
+        const FrameGradients& gradients,
+        const StructureTensorSums& tensor,
         int x, int y,
         const FlowVector& initialFlow
     );
@@ -171,8 +192,8 @@ private:
      * Refine flow at a pyramid level
      */
     void refineFlowLevel(
-        const GrayImage& ref,
-        const GrayImage& target,
+        const GrayView& ref,
+        const GrayView& target,
         FlowField& flow,
         int level
     );
@@ -185,7 +206,7 @@ private:
     /**
      * Bilinear interpolation for sub-pixel sampling
      */
-    float sampleBilinear(const GrayImage& image, float x, float y);
+    float sampleBilinear(const GrayView& image, float x, float y);
 };
 
 } // namespace ultradetail
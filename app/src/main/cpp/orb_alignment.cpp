@@ -5,7 +5,6 @@
  */
 
 #include "orb_alignment.h"
-#include "neon_utils.h"
 #include <algorithm>
 #include <random>
 #include <cmath>
@@ -5,9 +5,9 @@
  */
 
 #include "phase_correlation.h"
+#include "fft.h"
 #include <cmath>
 #include <algorithm>
-#include <android/log.h>
 
 #undef LOG_TAG
 #define LOG_TAG "PhaseCorrelation"
@@ -26,103 +26,25 @@ PhaseCorrelationAligner::PhaseCorrelationAligner(const PhaseCorrelationConfig& c
         config_.windowSize = size;
     }
     
-    // Initialize Hanning window
-    initHanningWindow(config_.windowSize);
-    
-    // Allocate FFT buffers
-    int bufferSize = config_.windowSize * config_.windowSize;
-    fftBuffer1_.resize(bufferSize);
-    fftBuffer2_.resize(bufferSize);
-    crossPowerSpectrum_.resize(bufferSize);
-    correlationSurface_.resize(bufferSize);
-    
     LOGI("PhaseCorrelationAligner initialized: windowSize=%d", config_.windowSize);
 }
 
 PhaseCorrelationAligner::~PhaseCorrelationAligner() = default;
 
-void PhaseCorrelationAligner::initHanningWindow(int size) {
-    hanningWindow_.resize(size * size);
-    
-    for (int y = 0; y < size; ++y) {
-        float wy = 0.5f * (1.0f - std::cos(2.0f * M_PI * y / (size - 1)));
-        for (int x = 0; x < size; ++x) {
-            float wx = 0.5f * (1.0f - std::cos(2.0f * M_PI * x / (size - 1)));
-            hanningWindow_[y * size + x] = wx * wy;
-        }
-    }
-}
-
-void PhaseCorrelationAligner::applyHanningWindow(const float* input, float* output, int size) {
-    for (int i = 0; i < size * size; ++i) {
-        output[i] = input[i] * hanningWindow_[i];
-    }
-}
-
-// Simple radix-2 FFT implementation
-// For production, consider using kissfft or FFTW
-void PhaseCorrelationAligner::fft1D(std::complex<float>* data, int n, bool inverse) {
-    // Bit-reversal permutation
-    int j = 0;
-    for (int i = 0; i < n - 1; ++i) {
-        if (i < j) {
-            std::swap(data[i], data[j]);
-        }
-        int k = n >> 1;
-        while (k <= j) {
-            j -= k;
-            k >>= 1;
-        }
-        j += k;
-    }
-    
-    // Cooley-Tukey FFT
-    float sign = inverse ? 1.0f : -1.0f;
-    
-    for (int len = 2; len <= n; len <<= 1) {
-        float angle = sign * 2.0f * M_PI / len;
-        std::complex<float> wn(std::cos(angle), std::sin(angle));
-        
-        for (int i = 0; i < n; i += len) {
-            std::complex<float> w(1.0f, 0.0f);
-            for (int jj = 0; jj < len / 2; ++jj) {
-                std::complex<float> u = data[i + jj];
-                std::complex<float> t = w * data[i + jj + len / 2];
-                data[i + jj] = u + t;
-                data[i + jj + len / 2] = u - t;
-                w *= wn;
-            }
-        }
-    }
+void PhaseCorrelationAligner::buildHanningWindow(int size, std::vector<float>& window) {
+    window.resize(size);
     
-    // Normalize for inverse FFT
-    if (inverse) {
-        for (int i = 0; i < n; ++i) {
-            data[i] /= static_cast<float>(n);
-        }
+    for (int i = 0; i < size; ++i) {
+        window[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (size - 1)));
     }
 }
 
-void PhaseCorrelationAligner::fft2D(std::complex<float>* data, int size, bool inverse) {
-    // Row-wise FFT
+void PhaseCorrelationAligner::applyHanningWindow(float* patch, const std::vector<float>& window, int size) {
     for (int y = 0; y < size; ++y) {
-        fft1D(data + y * size, size, inverse);
-    }
-    
-    // Column-wise FFT (transpose, FFT, transpose back)
-    std::vector<std::complex<float>> column(size);
-    for (int x = 0; x < size; ++x) {
-        // Extract column
-        for (int y = 0; y < size; ++y) {
-            column[y] = data[y * size + x];
-        }
-        
-        // FFT column
-        fft1D(column.data(), size, inverse);
-        
-        // Put back
-        for (int y = 0; y < size; ++y) {
-            data[y * size + x] = column[y];
+        float wy = window[y];
+        float* row = patch + y * size;
+        for (int x = 0; x < size; ++x) {
+            row[x] *= window[x] * wy;
         }
     }
 }
@@ -132,7 +54,7 @@ PhaseCorrelationResult PhaseCorrelationAligner::findPeak(
     int size,
     float gyroShiftX,
     float gyroShiftY
-) {
+) const {
     PhaseCorrelationResult result;
     
     // Find global maximum
@@ -237,109 +159,117 @@ void PhaseCorrelationAligner::refineSubPixel(
     }
 }
 
-PhaseCorrelationResult PhaseCorrelationAligner::computeShift(
-    const GrayImage& reference,
-    const GrayImage& target,
-    float gyroShiftX,
-    float gyroShiftY
+void PhaseCorrelationAligner::extractPatch(
+    const GrayImage& image,
+    int startX, int startY,
+    int size,
+    std::vector<float>& patch
 ) {
-    int size = config_.windowSize;
-    
-    // Sample from center of image
-    int startX = (reference.width - size) / 2;
-    int startY = (reference.height - size) / 2;
-    
-    if (startX < 0 || startY < 0 || 
-        startX + size > reference.width || startY + size > reference.height) {
-        // Image too small, use smaller window
-        size = std::min({reference.width, reference.height, target.width, target.height});
-        // Round down to power of 2
-        int newSize = 1;
-        while (newSize * 2 <= size) newSize *= 2;
-        size = newSize;
-        startX = (reference.width - size) / 2;
-        startY = (reference.height - size) / 2;
-        
-        if (size < 32) {
-            LOGW("Image too small for phase correlation");
-            return PhaseCorrelationResult();
-        }
-        
-        // Resize buffers
-        fftBuffer1_.resize(size * size);
-        fftBuffer2_.resize(size * size);
-        crossPowerSpectrum_.resize(size * size);
-        correlationSurface_.resize(size * size);
-        initHanningWindow(size);
-    }
-    
-    // Extract and window reference patch
-    std::vector<float> refPatch(size * size);
-    std::vector<float> tarPatch(size * size);
+    patch.resize(size * size);
     
     for (int y = 0; y < size; ++y) {
+        int srcY = clamp(startY + y, 0, image.height - 1);
+        const float* srcRow = image.row(srcY);
+        float* dstRow = patch.data() + y * size;
         for (int x = 0; x < size; ++x) {
-            refPatch[y * size + x] = reference.at(startX + x, startY + y);
-            tarPatch[y * size + x] = target.at(startX + x, startY + y);
+            dstRow[x] = srcRow[clamp(startX + x, 0, image.width - 1)];
         }
     }
-    
+}
+
+void PhaseCorrelationAligner::forwardSpectrum(
+    std::vector<float>& patch,
+    int size,
+    std::vector<std::complex<float>>& spectrum
+) const {
     // Apply Hanning window
     if (config_.useHanning) {
-        std::vector<float> windowedRef(size * size);
-        std::vector<float> windowedTar(size * size);
-        applyHanningWindow(refPatch.data(), windowedRef.data(), size);
-        applyHanningWindow(tarPatch.data(), windowedTar.data(), size);
-        refPatch = std::move(windowedRef);
-        tarPatch = std::move(windowedTar);
-    }
-    
-    // Convert to complex
-    for (int i = 0; i < size * size; ++i) {
-        fftBuffer1_[i] = std::complex<float>(refPatch[i], 0.0f);
-        fftBuffer2_[i] = std::complex<float>(tarPatch[i], 0.0f);
+        std::vector<float> window;
+        buildHanningWindow(size, window);
+        applyHanningWindow(patch.data(), window, size);
     }
     
-    // Forward FFT
-    fft2D(fftBuffer1_.data(), size, false);
-    fft2D(fftBuffer2_.data(), size, false);
-    
-    // Cross-power spectrum: (F1 * conj(F2)) / |F1 * conj(F2)|
-    for (int i = 0; i < size * size; ++i) {
-        std::complex<float> product = fftBuffer1_[i] * std::conj(fftBuffer2_[i]);
+    // Real-input forward FFT (half spectrum)
+    const RealFFT2D& fft = RealFFT2D::forSize(size);
+    spectrum.resize(fft.spectrumSize());
+    fft.forward(patch.data(), spectrum.data());
+}
+
+PhaseCorrelationResult PhaseCorrelationAligner::correlateSpectra(
+    const std::vector<std::complex<float>>& refSpectrum,
+    std::vector<std::complex<float>>& tarSpectrum,
+    int size,
+    float gyroShiftX,
+    float gyroShiftY
+) const {
+    const RealFFT2D& fft = RealFFT2D::forSize(size);
+    const int bins = fft.spectrumSize();
+    
+    // Cross-power spectrum: (F1 * conj(F2)) / |F1 * conj(F2)|, computed in place
+    // in the target buffer so the (possibly shared) reference stays untouched.
+    // Both inputs are real, so the half spectrum determines the whole surface.
+    std::vector<std::complex<float>>& crossPowerSpectrum = tarSpectrum;
+    for (int i = 0; i < bins; ++i) {
+        std::complex<float> product = refSpectrum[i] * std::conj(tarSpectrum[i]);
         float magnitude = std::abs(product);
         if (magnitude > 1e-10f) {
-            crossPowerSpectrum_[i] = product / magnitude;
+            crossPowerSpectrum[i] = product / magnitude;
         } else {
-            crossPowerSpectrum_[i] = std::complex<float>(0.0f, 0.0f);
+            crossPowerSpectrum[i] = std::complex<float>(0.0f, 0.0f);
         }
     }
     
-    // Inverse FFT to get correlation surface
-    fft2D(crossPowerSpectrum_.data(), size, true);
+    // Inverse FFT to get the (real) correlation surface
+    std::vector<float> correlationSurface(size * size);
+    fft.inverse(crossPowerSpectrum.data(), correlationSurface.data());
     
-    // Extract real part
-    for (int i = 0; i < size * size; ++i) {
-        correlationSurface_[i] = crossPowerSpectrum_[i].real();
+    // Find peak
+    return findPeak(correlationSurface, size, gyroShiftX, gyroShiftY);
+}
+
+void PhaseCorrelationAligner::centerWindow(int width, int height, int& x, int& y, int& size) const {
+    size = config_.windowSize;
+    if (width < size || height < size) {
+        // Image too small, use the largest power of 2 that fits
+        int newSize = 1;
+        while (newSize * 2 <= std::min(width, height)) newSize *= 2;
+        size = newSize >= 32 ? newSize : 0;
     }
+    x = (width - size) / 2;
+    y = (height - size) / 2;
+}
+
+ReferenceSpectrum PhaseCorrelationAligner::prepareReference(const GrayImage& reference) const {
+    ReferenceSpectrum ref;
     
-    // Find peak
-    PhaseCorrelationResult result = findPeak(correlationSurface_, size, gyroShiftX, gyroShiftY);
+    // Sample from center of image
+    int startX, startY, size;
+    centerWindow(reference.width, reference.height, startX, startY, size);
+    if (size == 0) {
+        LOGW("Image too small for phase correlation");
+        return ref;
+    }
     
-    LOGD("PhaseCorrelation: shift=(%.2f, %.2f), confidence=%.2f", 
-         result.shiftX, result.shiftY, result.confidence);
+    std::vector<float> patch;
+    extractPatch(reference, startX, startY, size, patch);
+    forwardSpectrum(patch, size, ref.spectrum);
     
-    return result;
+    ref.x = startX;
+    ref.y = startY;
+    ref.size = size;
+    return ref;
 }
 
-PhaseCorrelationResult PhaseCorrelationAligner::computeShiftInRegion(
+ReferenceSpectrum PhaseCorrelationAligner::prepareReferenceRegion(
     const GrayImage& reference,
-    const GrayImage& target,
     int regionX, int regionY,
-    int regionWidth, int regionHeight
-) {
-    // Extract region and compute shift
-    int size = std::min({regionWidth, regionHeight, config_.windowSize});
+    int regionWidth, int regionHeight,
+    int windowSize
+) const {
+    ReferenceSpectrum ref;
+    
+    int maxWindow = windowSize > 0 ? std::min(windowSize, config_.windowSize) : config_.windowSize;
+    int size = std::min({regionWidth, regionHeight, maxWindow});
     
     // Round down to power of 2
     int newSize = 1;
@@ -347,7 +277,7 @@ PhaseCorrelationResult PhaseCorrelationAligner::computeShiftInRegion(
     size = newSize;
     
     if (size < 32) {
-        return PhaseCorrelationResult();
+        return ref;
     }
     
     // Center the window in the region
@@ -358,67 +288,85 @@ PhaseCorrelationResult PhaseCorrelationAligner::computeShiftInRegion(
     startX = clamp(startX, 0, reference.width - size);
     startY = clamp(startY, 0, reference.height - size);
     
-    // Resize buffers if needed
-    if (static_cast<int>(fftBuffer1_.size()) != size * size) {
-        fftBuffer1_.resize(size * size);
-        fftBuffer2_.resize(size * size);
-        crossPowerSpectrum_.resize(size * size);
-        correlationSurface_.resize(size * size);
-        initHanningWindow(size);
-    }
-    
-    // Extract patches
-    std::vector<float> refPatch(size * size);
-    std::vector<float> tarPatch(size * size);
+    std::vector<float> patch;
+    extractPatch(reference, startX, startY, size, patch);
+    forwardSpectrum(patch, size, ref.spectrum);
     
-    for (int y = 0; y < size; ++y) {
-        for (int x = 0; x < size; ++x) {
-            int srcX = clamp(startX + x, 0, reference.width - 1);
-            int srcY = clamp(startY + y, 0, reference.height - 1);
-            refPatch[y * size + x] = reference.at(srcX, srcY);
-            
-            srcX = clamp(startX + x, 0, target.width - 1);
-            srcY = clamp(startY + y, 0, target.height - 1);
-            tarPatch[y * size + x] = target.at(srcX, srcY);
+    ref.x = startX;
+    ref.y = startY;
+    ref.size = size;
+    return ref;
+}
+
+std::vector<ReferenceSpectrum> PhaseCorrelationAligner::prepareReferenceGrid(
+    const GrayImage& reference,
+    int cellSize,
+    int windowSize
+) const {
+    std::vector<ReferenceSpectrum> grid;
+    if (cellSize <= 0) return grid;
+    
+    int cols = (reference.width + cellSize - 1) / cellSize;
+    int rows = (reference.height + cellSize - 1) / cellSize;
+    grid.reserve(cols * rows);
+    
+    for (int ty = 0; ty < reference.height; ty += cellSize) {
+        for (int tx = 0; tx < reference.width; tx += cellSize) {
+            int tw = std::min(cellSize, reference.width - tx);
+            int th = std::min(cellSize, reference.height - ty);
+            grid.push_back(prepareReferenceRegion(reference, tx, ty, tw, th, windowSize));
         }
     }
     
-    // Apply Hanning window
-    if (config_.useHanning) {
-        std::vector<float> windowedRef(size * size);
-        std::vector<float> windowedTar(size * size);
-        applyHanningWindow(refPatch.data(), windowedRef.data(), size);
-        applyHanningWindow(tarPatch.data(), windowedTar.data(), size);
-        refPatch = std::move(windowedRef);
-        tarPatch = std::move(windowedTar);
-    }
-    
-    // Convert to complex and compute
-    for (int i = 0; i < size * size; ++i) {
-        fftBuffer1_[i] = std::complex<float>(refPatch[i], 0.0f);
-        fftBuffer2_[i] = std::complex<float>(tarPatch[i], 0.0f);
+    return grid;
+}
+
+PhaseCorrelationResult PhaseCorrelationAligner::correlate(
+    const ReferenceSpectrum& reference,
+    const GrayImage& target,
+    float priorShiftX,
+    float priorShiftY
+) const {
+    if (!reference.isValid() || target.empty()) {
+        return PhaseCorrelationResult();
     }
     
-    fft2D(fftBuffer1_.data(), size, false);
-    fft2D(fftBuffer2_.data(), size, false);
-    
-    for (int i = 0; i < size * size; ++i) {
-        std::complex<float> product = fftBuffer1_[i] * std::conj(fftBuffer2_[i]);
-        float magnitude = std::abs(product);
-        if (magnitude > 1e-10f) {
-            crossPowerSpectrum_[i] = product / magnitude;
-        } else {
-            crossPowerSpectrum_[i] = std::complex<float>(0.0f, 0.0f);
-        }
-    }
+    // Only the target is windowed and transformed; the reference spectrum is reused
+    std::vector<float> tarPatch;
+    std::vector<std::complex<float>> tarSpectrum;
+    extractPatch(target, reference.x, reference.y, reference.size, tarPatch);
+    forwardSpectrum(tarPatch, reference.size, tarSpectrum);
     
-    fft2D(crossPowerSpectrum_.data(), size, true);
+    return correlateSpectra(reference.spectrum, tarSpectrum, reference.size, priorShiftX, priorShiftY);
+}
+
+PhaseCorrelationResult PhaseCorrelationAligner::computeShift(
+    const GrayImage& reference,
+    const GrayImage& target,
+    float gyroShiftX,
+    float gyroShiftY
+) const {
+    PhaseCorrelationResult result = correlate(prepareReference(reference), target, gyroShiftX, gyroShiftY);
     
-    for (int i = 0; i < size * size; ++i) {
-        correlationSurface_[i] = crossPowerSpectrum_[i].real();
-    }
+    LOGD("PhaseCorrelation: shift=(%.2f, %.2f), confidence=%.2f", 
+         result.shiftX, result.shiftY, result.confidence);
     
-    return findPeak(correlationSurface_, size, 0.0f, 0.0f);
+    return result;
+}
+
+PhaseCorrelationResult PhaseCorrelationAligner::computeShiftInRegion(
+    const GrayImage& reference,
+    const GrayImage& target,
+    int regionX, int regionY,
+    int regionWidth, int regionHeight,
+    int windowSize,
+    float priorShiftX,
+    float priorShiftY
+) const {
+    ReferenceSpectrum ref = prepareReferenceRegion(
+        reference, regionX, regionY, regionWidth, regionHeight, windowSize
+    );
+    return correlate(ref, target, priorShiftX, priorShiftY);
 }
 
 // HybridAligner implementation
@@ -427,14 +375,11 @@ HybridAligner::HybridAligner()
     : phaseAligner_(PhaseCorrelationConfig()) {
 }
 
-FlowField HybridAligner::computeAlignment(
+FlowVector HybridAligner::computeUniformShift(
     const GrayImage& reference,
     const GrayImage& target,
-    const GyroHomography* gyroHomography,
-    bool useLocalRefinement
-) {
-    FlowField result(reference.width, reference.height);
-    
+    const GyroHomography* gyroHomography
+) const {
     // Step 1: Get initial estimate from gyro
     float gyroShiftX = 0.0f, gyroShiftY = 0.0f;
     if (gyroHomography && gyroHomography->isValid) {
@@ -452,8 +397,66 @@ FlowField HybridAligner::computeAlignment(
         reference, target, gyroShiftX, gyroShiftY
     );
     
-    float finalShiftX, finalShiftY, confidence;
+    FlowVector shift;
+    resolveGlobalShift(pcResult, gyroHomography, gyroShiftX, gyroShiftY,
+                       shift.dx, shift.dy, shift.confidence);
+    return shift;
+}
+
+MotionModel HybridAligner::computeMotion(
+    const GrayImage& reference,
+    const GrayImage& target,
+    const GyroHomography* gyroHomography,
+    bool useLocalRefinement
+) const {
+    FlowVector globalShift = computeUniformShift(reference, target, gyroHomography);
+    
+    // Step 3: Uniform shift (or local refinement if enabled)
+    if (!useLocalRefinement) {
+        // Uniform shift - much faster than dense flow
+        return MotionModel::translation(reference.width, reference.height, globalShift);
+    }
+    
+    // Maximum allowed shift in pixels (see resolveGlobalShift)
+    const float maxAllowedShift = 30.0f;
     
+    // Local refinement using phase correlation in tiles
+    // This is still faster than dense Lucas-Kanade
+    const int tileSize = 128;
+    std::vector<FlowVector> blocks;
+    
+    for (int ty = 0; ty < reference.height; ty += tileSize) {
+        for (int tx = 0; tx < reference.width; tx += tileSize) {
+            int tw = std::min(tileSize, reference.width - tx);
+            int th = std::min(tileSize, reference.height - ty);
+            
+            PhaseCorrelationResult tileResult = phaseAligner_.computeShiftInRegion(
+                reference, target, tx, ty, tw, th
+            );
+            
+            // Check if tile shift is reasonable
+            float tileMagnitude = std::sqrt(tileResult.shiftX * tileResult.shiftX + 
+                                             tileResult.shiftY * tileResult.shiftY);
+            bool tileShiftReasonable = tileMagnitude < maxAllowedShift;
+            
+            if (tileResult.isValid && tileResult.confidence > 0.3f && tileShiftReasonable) {
+                blocks.emplace_back(tileResult.shiftX, tileResult.shiftY, tileResult.confidence);
+            } else {
+                // Use global shift for this tile (or zero if global is also bad)
+                blocks.emplace_back(globalShift.dx, globalShift.dy, globalShift.confidence * 0.5f);
+            }
+        }
+    }
+    
+    return MotionModel::blockGrid(reference.width, reference.height, tileSize, std::move(blocks));
+}
+
+void HybridAligner::resolveGlobalShift(
+    const PhaseCorrelationResult& pcResult,
+    const GyroHomography* gyroHomography,
+    float gyroShiftX, float gyroShiftY,
+    float& shiftX, float& shiftY, float& confidence
+) {
     // Maximum allowed shift in pixels - larger shifts indicate misalignment or excessive motion
     // For handheld burst capture, shifts should typically be <20 pixels
     const float maxAllowedShift = 30.0f;
@@ -469,85 +472,185 @@ FlowField HybridAligner::computeAlignment(
     
     if (pcResult.isValid && pcResult.confidence > 0.5f && pcShiftReasonable) {
         // Use phase correlation result - high confidence and reasonable magnitude
-        finalShiftX = pcResult.shiftX;
-        finalShiftY = pcResult.shiftY;
+        shiftX = pcResult.shiftX;
+        shiftY = pcResult.shiftY;
         confidence = pcResult.confidence;
         LOGD("HybridAligner: Using phase correlation = (%.2f, %.2f), conf=%.2f, mag=%.2f",
-             finalShiftX, finalShiftY, confidence, pcShiftMagnitude);
+             shiftX, shiftY, confidence, pcShiftMagnitude);
     } else if (pcResult.isValid && pcResult.confidence > 0.3f && pcShiftReasonable) {
         // Use phase correlation with moderate confidence
-        finalShiftX = pcResult.shiftX;
-        finalShiftY = pcResult.shiftY;
+        shiftX = pcResult.shiftX;
+        shiftY = pcResult.shiftY;
         confidence = pcResult.confidence * 0.8f;  // Reduce confidence slightly
         LOGD("HybridAligner: Using phase correlation (moderate) = (%.2f, %.2f), conf=%.2f, mag=%.2f",
-             finalShiftX, finalShiftY, confidence, pcShiftMagnitude);
+             shiftX, shiftY, confidence, pcShiftMagnitude);
     } else if (gyroHomography && gyroHomography->isValid && gyroShiftReasonable) {
         // Fall back to gyro if it's reasonable
-        finalShiftX = gyroShiftX;
-        finalShiftY = gyroShiftY;
+        shiftX = gyroShiftX;
+        shiftY = gyroShiftY;
         confidence = 0.4f;
         LOGD("HybridAligner: Falling back to gyro = (%.2f, %.2f), mag=%.2f", 
-             finalShiftX, finalShiftY, gyroShiftMagnitude);
+             shiftX, shiftY, gyroShiftMagnitude);
     } else {
         // Both estimates are unreasonable - use zero shift (frame likely has too much motion)
-        finalShiftX = 0.0f;
-        finalShiftY = 0.0f;
+        shiftX = 0.0f;
+        shiftY = 0.0f;
         confidence = 0.1f;  // Very low confidence signals this frame should be weighted less
         LOGW("HybridAligner: Shifts too large (pc=%.2f, gyro=%.2f), using zero shift - frame may have excessive motion",
              pcShiftMagnitude, gyroShiftMagnitude);
     }
+}
+
+void HybridAligner::globalWindow(int width, int height, int& x, int& y, int& size) const {
+    phaseAligner_.centerWindow(width, height, x, y, size);
+}
+
+GlobalAlignmentReference HybridAligner::prepareGlobalReference(
+    int width, int height,
+    const GrayImage& referenceWindow,
+    const GrayImage& referenceCoarse
+) const {
+    GlobalAlignmentReference ref;
+    ref.width = width;
+    ref.height = height;
+    ref.coarseScale = referenceCoarse.width > 0
+        ? static_cast<float>(width) / referenceCoarse.width : 1.0f;
+    ref.coarse = phaseAligner_.prepareReference(referenceCoarse);
+    // The window is the whole crop, so its spectrum is the center window's
+    if (!referenceWindow.empty()) {
+        ref.fine = phaseAligner_.prepareReferenceRegion(
+            referenceWindow, 0, 0, referenceWindow.width, referenceWindow.height, referenceWindow.width
+        );
+    }
+    return ref;
+}
+
+FrameMotionPrior HybridAligner::estimateGlobalMotion(
+    const GlobalAlignmentReference& reference,
+    const GrayImage& targetWindow,
+    const GrayImage& targetCoarse,
+    const GyroHomography* gyroHomography
+) const {
+    FrameMotionPrior prior;
+    
+    // Step 1: Gyro estimate at the image center
+    float gyroShiftX = 0.0f, gyroShiftY = 0.0f;
+    if (gyroHomography && gyroHomography->isValid) {
+        FlowVector gyroFlow = gyroHomography->getInitialFlow(reference.width / 2.0f, reference.height / 2.0f);
+        gyroShiftX = gyroFlow.dx;
+        gyroShiftY = gyroFlow.dy;
+    }
     
-    // Step 3: Fill flow field with uniform shift (or local refinement if enabled)
-    if (!useLocalRefinement) {
-        // Uniform shift - much faster than dense flow
-        for (int y = 0; y < result.height; ++y) {
-            for (int x = 0; x < result.width; ++x) {
-                result.at(x, y) = FlowVector(finalShiftX, finalShiftY, confidence);
-            }
-        }
+    // Step 2: Coarse phase correlation - the window covers a large part of the frame
+    const float scale = reference.coarseScale;
+    PhaseCorrelationResult coarse = phaseAligner_.correlate(
+        reference.coarse, targetCoarse, gyroShiftX / scale, gyroShiftY / scale
+    );
+    coarse.shiftX *= scale;
+    coarse.shiftY *= scale;
+    
+    // Step 3: Full resolution window searched around the coarse (or gyro) estimate
+    float seedX = coarse.isValid ? coarse.shiftX : gyroShiftX;
+    float seedY = coarse.isValid ? coarse.shiftY : gyroShiftY;
+    PhaseCorrelationResult fine = phaseAligner_.correlate(reference.fine, targetWindow, seedX, seedY);
+    
+    // Prefer the precise estimate; keep the coarse one if the fine window lacks texture
+    PhaseCorrelationResult pcResult = fine;
+    if (!(fine.isValid && fine.confidence > 0.3f) && coarse.isValid) {
+        pcResult = coarse;
+    }
+    
+    resolveGlobalShift(pcResult, gyroHomography, gyroShiftX, gyroShiftY,
+                       prior.shiftX, prior.shiftY, prior.confidence);
+    prior.isValid = prior.confidence > 0.1f;
+    
+    LOGD("HybridAligner: Global prior = (%.2f, %.2f), conf=%.2f (coarse=(%.2f, %.2f) x%.0f, gyro=(%.2f, %.2f))",
+         prior.shiftX, prior.shiftY, prior.confidence,
+         coarse.shiftX, coarse.shiftY, scale, gyroShiftX, gyroShiftY);
+    
+    return prior;
+}
+
+// The prior already carries the large motion, so small windows searched
+// around it are enough to pick up local residuals (parallax, rolling shutter)
+static const int kPriorRefinementWindow = 128;
+static const int kPriorRefinementCell = 128;
+
+TileAlignmentReference HybridAligner::prepareTileReference(
+    const GrayImage& reference,
+    bool useLocalRefinement
+) const {
+    TileAlignmentReference ref;
+    ref.width = reference.width;
+    ref.height = reference.height;
+    
+    if (useLocalRefinement) {
+        ref.cells = phaseAligner_.prepareReferenceGrid(reference, kPriorRefinementCell, kPriorRefinementWindow);
     } else {
-        // Local refinement using phase correlation in tiles
-        // This is still faster than dense Lucas-Kanade
-        const int tileSize = 128;
-        
-        for (int ty = 0; ty < reference.height; ty += tileSize) {
-            for (int tx = 0; tx < reference.width; tx += tileSize) {
-                int tw = std::min(tileSize, reference.width - tx);
-                int th = std::min(tileSize, reference.height - ty);
-                
-                PhaseCorrelationResult tileResult = phaseAligner_.computeShiftInRegion(
-                    reference, target, tx, ty, tw, th
-                );
-                
-                float tileShiftX, tileShiftY, tileConf;
-                
-                // Check if tile shift is reasonable
-                float tileMagnitude = std::sqrt(tileResult.shiftX * tileResult.shiftX + 
-                                                 tileResult.shiftY * tileResult.shiftY);
-                bool tileShiftReasonable = tileMagnitude < maxAllowedShift;
-                
-                if (tileResult.isValid && tileResult.confidence > 0.3f && tileShiftReasonable) {
-                    tileShiftX = tileResult.shiftX;
-                    tileShiftY = tileResult.shiftY;
-                    tileConf = tileResult.confidence;
-                } else {
-                    // Use global shift for this tile (or zero if global is also bad)
-                    tileShiftX = finalShiftX;
-                    tileShiftY = finalShiftY;
-                    tileConf = confidence * 0.5f;
-                }
-                
-                // Fill tile region
-                for (int y = ty; y < ty + th && y < result.height; ++y) {
-                    for (int x = tx; x < tx + tw && x < result.width; ++x) {
-                        result.at(x, y) = FlowVector(tileShiftX, tileShiftY, tileConf);
-                    }
-                }
-            }
-        }
+        ref.whole = phaseAligner_.prepareReferenceRegion(
+            reference, 0, 0, reference.width, reference.height, kPriorRefinementWindow
+        );
+    }
+    return ref;
+}
+
+// Residual beyond which a windowed estimate is rejected in favor of the prior
+static const float kMaxPriorResidual = 8.0f;
+
+void HybridAligner::refineWindow(
+    const ReferenceSpectrum& window,
+    const GrayImage& target,
+    const FrameMotionPrior& prior,
+    float fallbackConfidence,
+    float& shiftX, float& shiftY, float& confidence
+) const {
+    PhaseCorrelationResult local = phaseAligner_.correlate(window, target, prior.shiftX, prior.shiftY);
+    
+    float residualX = local.shiftX - prior.shiftX;
+    float residualY = local.shiftY - prior.shiftY;
+    bool nearPrior = std::sqrt(residualX * residualX + residualY * residualY) <= kMaxPriorResidual;
+    
+    if (local.isValid && local.confidence > 0.3f && nearPrior) {
+        shiftX = local.shiftX;
+        shiftY = local.shiftY;
+        confidence = std::max(local.confidence, prior.confidence);
+    } else {
+        shiftX = prior.shiftX;
+        shiftY = prior.shiftY;
+        confidence = fallbackConfidence;
+    }
+}
+
+FlowVector HybridAligner::refineUniformShift(
+    const TileAlignmentReference& reference,
+    const GrayImage& target,
+    const FrameMotionPrior& prior
+) const {
+    // One refinement window for the whole tile; fall back to the prior if the estimate is weak
+    FlowVector shift;
+    refineWindow(reference.whole, target, prior, prior.confidence, shift.dx, shift.dy, shift.confidence);
+    return shift;
+}
+
+MotionModel HybridAligner::computeMotionWithPrior(
+    const TileAlignmentReference& reference,
+    const GrayImage& target,
+    const FrameMotionPrior& prior,
+    bool useLocalRefinement
+) const {
+    if (!useLocalRefinement || reference.cells.empty()) {
+        return MotionModel::translation(reference.width, reference.height,
+                                        refineUniformShift(reference, target, prior));
     }
     
-    return result;
+    // One refined shift per 128px cell (cells are prepared row-major)
+    std::vector<FlowVector> blocks(reference.cells.size());
+    for (size_t cell = 0; cell < reference.cells.size(); ++cell) {
+        refineWindow(reference.cells[cell], target, prior, prior.confidence * 0.5f,
+                     blocks[cell].dx, blocks[cell].dy, blocks[cell].confidence);
+    }
+    
+    return MotionModel::blockGrid(reference.width, reference.height, kPriorRefinementCell, std::move(blocks));
 }
 
 } // namespace ultradetail
@@ -19,7 +19,8 @@
 #define ULTRADETAIL_PHASE_CORRELATION_H
 
 #include "common.h"
-#include "optical_flow.h"  // For FlowField, FlowVector, GyroHomography
+#include "optical_flow.h"  // For FlowVector, GyroHomography
+#include "motion_model.h"
 #include <vector>
 #include <complex>
 
@@ -39,6 +40,22 @@ struct PhaseCorrelationResult {
         : shiftX(0), shiftY(0), confidence(0), peakValue(0), isValid(false) {}
 };
 
+/**
+ * Windowed reference spectrum for one correlation window
+ * 
+ * The reference side of phase correlation is the same for every frame of a
+ * burst, so it is transformed once and correlated against any number of targets.
+ */
+struct ReferenceSpectrum {
+    int x, y;               // Window origin in the reference image
+    int size;               // Window size (power of 2, 0 = invalid)
+    std::vector<std::complex<float>> spectrum;  // Half spectrum of the windowed reference patch (see RealFFT2D)
+    
+    ReferenceSpectrum() : x(0), y(0), size(0) {}
+    
+    bool isValid() const { return size > 0; }
+};
+
 /**
  * Phase correlation configuration
  */
@@ -54,6 +71,9 @@ struct PhaseCorrelationConfig {
  * 
  * Uses FFT-based phase correlation to detect global translation between frames.
  * Much faster and more robust than dense optical flow for global shifts.
+ * 
+ * Reentrant: all FFT scratch is allocated per call, so one instance can be
+ * shared by concurrent tile workers.
  */
 class PhaseCorrelationAligner {
 public:
@@ -74,50 +94,118 @@ public:
         const GrayImage& target,
         float gyroShiftX = 0.0f,
         float gyroShiftY = 0.0f
-    );
+    ) const;
     
     /**
      * Compute shift for a specific region (tile)
+     * 
+     * @param windowSize Max FFT window (0 = config window size)
+     * @param priorShiftX Expected X shift; the peak is searched around it first
+     * @param priorShiftY Expected Y shift
      */
     PhaseCorrelationResult computeShiftInRegion(
         const GrayImage& reference,
         const GrayImage& target,
         int regionX, int regionY,
-        int regionWidth, int regionHeight
-    );
+        int regionWidth, int regionHeight,
+        int windowSize = 0,
+        float priorShiftX = 0.0f,
+        float priorShiftY = 0.0f
+    ) const;
+    
+    /**
+     * Precompute the reference spectrum of the center window used by computeShift
+     */
+    ReferenceSpectrum prepareReference(const GrayImage& reference) const;
+    
+    /**
+     * Center window prepareReference picks for a width x height image
+     * 
+     * @param size Receives the window size (0 if the image is too small)
+     */
+    void centerWindow(int width, int height, int& x, int& y, int& size) const;
+    
+    /**
+     * Precompute the reference spectrum of the window used by computeShiftInRegion
+     */
+    ReferenceSpectrum prepareReferenceRegion(
+        const GrayImage& reference,
+        int regionX, int regionY,
+        int regionWidth, int regionHeight,
+        int windowSize = 0
+    ) const;
+    
+    /**
+     * Precompute reference spectra for a grid of cellSize x cellSize regions
+     * 
+     * @return One spectrum per cell, row-major (cells too small are invalid)
+     */
+    std::vector<ReferenceSpectrum> prepareReferenceGrid(
+        const GrayImage& reference,
+        int cellSize,
+        int windowSize = 0
+    ) const;
+    
+    /**
+     * Correlate a target against a precomputed reference spectrum
+     * 
+     * Only the target window is transformed. Equivalent to computeShift /
+     * computeShiftInRegion with the same window.
+     * 
+     * @param reference Reference spectrum (from one of the prepare* calls)
+     * @param target Target grayscale image (same size as the reference image)
+     * @param priorShiftX Expected X shift; the peak is searched around it first
+     * @param priorShiftY Expected Y shift
+     */
+    PhaseCorrelationResult correlate(
+        const ReferenceSpectrum& reference,
+        const GrayImage& target,
+        float priorShiftX = 0.0f,
+        float priorShiftY = 0.0f
+    ) const;
 
 private:
     PhaseCorrelationConfig config_;
     
-    // Precomputed Hanning window
-    std::vector<float> hanningWindow_;
-    
-    // FFT buffers (reused)
-    std::vector<std::complex<float>> fftBuffer1_;
-    std::vector<std::complex<float>> fftBuffer2_;
-    std::vector<std::complex<float>> crossPowerSpectrum_;
-    std::vector<float> correlationSurface_;
+    /**
+     * Build the 1D Hanning window for a patch size (2D window is the outer product)
+     */
+    static void buildHanningWindow(int size, std::vector<float>& window);
     
     /**
-     * Initialize Hanning window
+     * Apply separable Hanning window to image patch in place
      */
-    void initHanningWindow(int size);
+    static void applyHanningWindow(float* patch, const std::vector<float>& window, int size);
     
     /**
-     * Apply Hanning window to image patch
+     * Copy a size x size patch (clamped at the image border)
      */
-    void applyHanningWindow(const float* input, float* output, int size);
+    static void extractPatch(
+        const GrayImage& image,
+        int startX, int startY,
+        int size,
+        std::vector<float>& patch
+    );
     
     /**
-     * Simple in-place 2D FFT (Cooley-Tukey radix-2)
-     * Note: For production, consider using FFTW or kissfft
+     * Window a patch in place and compute its 2D half spectrum
      */
-    void fft2D(std::complex<float>* data, int size, bool inverse);
+    void forwardSpectrum(
+        std::vector<float>& patch,
+        int size,
+        std::vector<std::complex<float>>& spectrum
+    ) const;
     
     /**
-     * 1D FFT helper
+     * Correlate two spectra and locate the peak (target spectrum is overwritten)
      */
-    void fft1D(std::complex<float>* data, int n, bool inverse);
+    PhaseCorrelationResult correlateSpectra(
+        const std::vector<std::complex<float>>& refSpectrum,
+        std::vector<std::complex<float>>& tarSpectrum,
+        int size,
+        float gyroShiftX,
+        float gyroShiftY
+    ) const;
     
     /**
      * Find peak in correlation surface with sub-pixel refinement
@@ -127,12 +215,12 @@ private:
         int size,
         float gyroShiftX,
         float gyroShiftY
-    );
+    ) const;
     
     /**
      * Sub-pixel refinement using parabolic fitting
      */
-    void refineSubPixel(
+    static void refineSubPixel(
         const std::vector<float>& surface,
         int size,
         int peakX, int peakY,
@@ -140,6 +228,44 @@ private:
     );
 };
 
+/**
+ * Global motion of one burst frame relative to the reference
+ * 
+ * Estimated once per frame before tiling and used by every tile as the
+ * starting point for its local refinement.
+ */
+struct FrameMotionPrior {
+    float shiftX;           // Global X shift (full resolution pixels)
+    float shiftY;           // Global Y shift
+    float confidence;       // Alignment confidence (0-1)
+    bool isValid;
+    
+    FrameMotionPrior() : shiftX(0), shiftY(0), confidence(0), isValid(false) {}
+};
+
+/**
+ * Reference-side state for the global alignment pre-pass (shared by all frames)
+ */
+struct GlobalAlignmentReference {
+    ReferenceSpectrum coarse;   // Center window of the downsampled reference
+    ReferenceSpectrum fine;     // Full resolution window (origin relative to globalWindow)
+    float coarseScale;          // Full resolution pixels per coarse pixel
+    int width, height;          // Full resolution reference size
+    
+    GlobalAlignmentReference() : coarseScale(1.0f), width(0), height(0) {}
+};
+
+/**
+ * Reference-side state for tile alignment (shared by all frames of a tile)
+ */
+struct TileAlignmentReference {
+    ReferenceSpectrum whole;                // Refinement window over the whole tile
+    std::vector<ReferenceSpectrum> cells;   // Local refinement grid (row-major, empty if unused)
+    int width, height;                      // Tile size
+    
+    TileAlignmentReference() : width(0), height(0) {}
+};
+
 /**
  * Hybrid Aligner: Gyro + Phase Correlation + Sparse Flow
  * 
@@ -147,6 +273,8 @@ private:
  * 1. Gyro homography for initial estimate
  * 2. Phase correlation for global shift refinement
  * 3. Sparse Lucas-Kanade only for local deformations (optional)
+ * 
+ * Stateless after construction; safe to call from multiple threads.
  */
 class HybridAligner {
 public:
@@ -158,18 +286,143 @@ public:
      * @param reference Reference frame
      * @param target Target frame
      * @param gyroHomography Gyro-based homography (optional)
-     * @param useLocalRefinement Whether to use sparse LK for local refinement
-     * @return Flow field (uniform shift or refined)
+     * @param useLocalRefinement Refine each 128px block with phase correlation
+     * @return A translation, or a 128px block grid with local refinement
      */
-    FlowField computeAlignment(
+    MotionModel computeMotion(
         const GrayImage& reference,
         const GrayImage& target,
         const GyroHomography* gyroHomography,
         bool useLocalRefinement = false
-    );
+    ) const;
+    
+    /**
+     * Estimate the single translation of target against reference
+     * 
+     * The global part of computeMotion; computeMotion(..., false) returns
+     * this shift as a translation.
+     * 
+     * @return Shift and confidence
+     */
+    FlowVector computeUniformShift(
+        const GrayImage& reference,
+        const GrayImage& target,
+        const GyroHomography* gyroHomography
+    ) const;
+    
+    /**
+     * Full resolution window the global estimate correlates
+     * 
+     * The only full resolution pixels prepareGlobalReference and
+     * estimateGlobalMotion read; callers pass this crop of each frame.
+     * 
+     * @param width Frame width
+     * @param height Frame height
+     * @param size Receives the window size (0 if the frame is too small)
+     */
+    void globalWindow(int width, int height, int& x, int& y, int& size) const;
+    
+    /**
+     * Precompute the reference spectra used by estimateGlobalMotion
+     * 
+     * @param width Full resolution reference width
+     * @param height Full resolution reference height
+     * @param referenceWindow Reference pixels of the globalWindow
+     * @param referenceCoarse Downsampled reference
+     */
+    GlobalAlignmentReference prepareGlobalReference(
+        int width, int height,
+        const GrayImage& referenceWindow,
+        const GrayImage& referenceCoarse
+    ) const;
+    
+    /**
+     * Estimate the global motion of a whole frame (pre-pass, once per frame)
+     * 
+     * Phase correlation on downsampled frames, seeded by the gyro, finds the
+     * coarse shift over a wide area; the full-resolution window, searched
+     * around that estimate, then recovers sub-pixel precision.
+     * 
+     * @param reference Prepared reference (see prepareGlobalReference)
+     * @param targetWindow Target pixels of the globalWindow
+     * @param targetCoarse Downsampled target (same pyramid level as the reference)
+     * @param gyroHomography Gyro-based homography (optional)
+     */
+    FrameMotionPrior estimateGlobalMotion(
+        const GlobalAlignmentReference& reference,
+        const GrayImage& targetWindow,
+        const GrayImage& targetCoarse,
+        const GyroHomography* gyroHomography
+    ) const;
+    
+    /**
+     * Precompute the reference spectra used by computeMotionWithPrior
+     * 
+     * @param reference Reference tile
+     * @param useLocalRefinement Also prepare the 128px local refinement grid
+     */
+    TileAlignmentReference prepareTileReference(
+        const GrayImage& reference,
+        bool useLocalRefinement = false
+    ) const;
+    
+    /**
+     * Compute tile alignment by refining a per-frame global prior
+     * 
+     * Only small-window phase correlation searched around the prior is run;
+     * estimates that stray too far from it fall back to the prior.
+     * 
+     * @param reference Prepared reference tile (see prepareTileReference)
+     * @param target Target tile
+     * @param prior Global motion of the target frame
+     * @param useLocalRefinement Refine each 128px sub-region instead of the whole tile
+     * @return A translation, or a block grid of the prepared refinement cells
+     */
+    MotionModel computeMotionWithPrior(
+        const TileAlignmentReference& reference,
+        const GrayImage& target,
+        const FrameMotionPrior& prior,
+        bool useLocalRefinement = false
+    ) const;
+    
+    /**
+     * Refine a per-frame global prior to a single tile translation
+     * 
+     * The estimate computeMotionWithPrior(..., false) returns as a
+     * translation.
+     * 
+     * @return Shift and confidence
+     */
+    FlowVector refineUniformShift(
+        const TileAlignmentReference& reference,
+        const GrayImage& target,
+        const FrameMotionPrior& prior
+    ) const;
 
 private:
     PhaseCorrelationAligner phaseAligner_;
+    
+    /**
+     * Refine the prior in one reference window, falling back to the prior
+     * (with fallbackConfidence) if the estimate is weak or strays too far
+     */
+    void refineWindow(
+        const ReferenceSpectrum& window,
+        const GrayImage& target,
+        const FrameMotionPrior& prior,
+        float fallbackConfidence,
+        float& shiftX, float& shiftY, float& confidence
+    ) const;
+    
+    /**
+     * Pick the global shift from phase correlation and gyro estimates
+     */
+    static void resolveGlobalShift(
+        const PhaseCorrelationResult& pcResult,
+        const GyroHomography* gyroHomography,
+        float gyroShiftX, float gyroShiftY,
+        float& shiftX, float& shiftY, float& confidence
+    );
 };
 
 } // namespace ultradetail
@@ -1,11 +1,12 @@
 /**
  * pyramid.cpp - Gaussian and Laplacian pyramid implementation
  * 
- * NEON-optimized multi-scale pyramid construction for alignment.
+ * Single-pass decimating pyramid construction on the SIMD row kernels.
  */
 
 #include "pyramid.h"
-#include "neon_utils.h"
+#include "simd.h"
+#include "thread_pool.h"
 
 namespace ultradetail {
 
@@ -19,271 +20,318 @@ static const float GAUSS_KERNEL[5] = {
 };
 
 /**
- * Apply 1D Gaussian blur horizontally
+ * Repeat the edge pixels of a row into two slots on the left and three on
+ * the right (convolve5Decimate2x may read one slot past its last tap)
  */
-static void gaussianBlurH(const GrayImage& src, GrayImage& dst) {
+static void padRowClamped(float* row, int width) {
+    row[-2] = row[-1] = row[0];
+    row[width] = row[width + 1] = row[width + 2] = row[width - 1];
+}
+
+void gaussianDownsample2x(const GrayView& src, float* dst, int dstStride) {
     const int width = src.width;
     const int height = src.height;
+    const int dstW = std::max(1, width / 2);
+    const int dstH = std::max(1, height / 2);
     
-    if (dst.width != width || dst.height != height) {
-        dst = GrayImage(width, height);
-    }
+    const simd::RowKernels& kernels = simd::rowKernels();
     
-    for (int y = 0; y < height; ++y) {
-        const float* srcRow = src.row(y);
-        float* dstRow = dst.row(y);
+    ThreadPool::instance().parallelForRows(0, dstH, [&](int y0, int y1) {
+        // One vertically filtered source row, padded for the horizontal taps
+        std::vector<float> blended(width + 5);
+        float* blendedRow = blended.data() + 2;
         
-        for (int x = 0; x < width; ++x) {
-            float sum = 0.0f;
-            
-            for (int k = -2; k <= 2; ++k) {
-                int sx = clamp(x + k, 0, width - 1);
-                sum += srcRow[sx] * GAUSS_KERNEL[k + 2];
+        for (int y = y0; y < y1; ++y) {
+            const float* rows[5];
+            for (int k = 0; k < 5; ++k) {
+                rows[k] = src.row(clamp(2 * y + k - 2, 0, height - 1));
             }
-            
-            dstRow[x] = sum;
+            kernels.blendRows5(rows, GAUSS_KERNEL, blendedRow, width);
+            padRowClamped(blendedRow, width);
+            kernels.convolve5Decimate2x(blendedRow, GAUSS_KERNEL,
+                                        dst + static_cast<size_t>(y) * dstStride, dstW);
         }
-    }
+    });
 }
 
-/**
- * Apply 1D Gaussian blur vertically
- */
-static void gaussianBlurV(const GrayImage& src, GrayImage& dst) {
+void gaussianDownsample2x(const RGBView& src, RGBPixel* dst, int dstStride) {
     const int width = src.width;
     const int height = src.height;
+    const int dstW = std::max(1, width / 2);
+    const int dstH = std::max(1, height / 2);
+    const int planeStride = width + 5;
     
-    if (dst.width != width || dst.height != height) {
-        dst = GrayImage(width, height);
-    }
+    const simd::RowKernels& kernels = simd::rowKernels();
     
-    for (int y = 0; y < height; ++y) {
-        float* dstRow = dst.row(y);
+    ThreadPool::instance().parallelForRows(0, dstH, [&](int y0, int y1) {
+        // The vertical taps run on the interleaved row; the horizontal taps
+        // need each channel contiguous, so the blended row is split into
+        // padded R, G and B planes and the results interleaved again
+        std::vector<float> blended(3 * static_cast<size_t>(width));
+        std::vector<float> planes(3 * static_cast<size_t>(planeStride));
+        std::vector<float> decimated(3 * static_cast<size_t>(dstW));
+        float* planeR = planes.data() + 2;
+        float* planeG = planeR + planeStride;
+        float* planeB = planeG + planeStride;
+        float* outR = decimated.data();
+        float* outG = outR + dstW;
+        float* outB = outG + dstW;
         
-        for (int x = 0; x < width; ++x) {
-            float sum = 0.0f;
+        for (int y = y0; y < y1; ++y) {
+            const float* rows[5];
+            for (int k = 0; k < 5; ++k) {
+                rows[k] = reinterpret_cast<const float*>(src.row(clamp(2 * y + k - 2, 0, height - 1)));
+            }
+            kernels.blendRows5(rows, GAUSS_KERNEL, blended.data(), 3 * width);
             
-            for (int k = -2; k <= 2; ++k) {
-                int sy = clamp(y + k, 0, height - 1);
-                sum += src.at(x, sy) * GAUSS_KERNEL[k + 2];
+            int x = 0;
+            for (; x + 4 <= width; x += 4) {
+                simd::f32x4 r, g, b;
+                simd::loadDeinterleaved3(blended.data() + 3 * x, r, g, b);
+                r.store(planeR + x);
+                g.store(planeG + x);
+                b.store(planeB + x);
+            }
+            for (; x < width; ++x) {
+                planeR[x] = blended[3 * x];
+                planeG[x] = blended[3 * x + 1];
+                planeB[x] = blended[3 * x + 2];
             }
+            padRowClamped(planeR, width);
+            padRowClamped(planeG, width);
+            padRowClamped(planeB, width);
+            
+            kernels.convolve5Decimate2x(planeR, GAUSS_KERNEL, outR, dstW);
+            kernels.convolve5Decimate2x(planeG, GAUSS_KERNEL, outG, dstW);
+            kernels.convolve5Decimate2x(planeB, GAUSS_KERNEL, outB, dstW);
             
-            dstRow[x] = sum;
+            float* dstRow = reinterpret_cast<float*>(dst + static_cast<size_t>(y) * dstStride);
+            x = 0;
+            for (; x + 4 <= dstW; x += 4) {
+                simd::storeInterleaved3(dstRow + 3 * x, simd::f32x4::load(outR + x),
+                                        simd::f32x4::load(outG + x), simd::f32x4::load(outB + x));
+            }
+            for (; x < dstW; ++x) {
+                dstRow[3 * x] = outR[x];
+                dstRow[3 * x + 1] = outG[x];
+                dstRow[3 * x + 2] = outB[x];
+            }
         }
-    }
+    });
+}
+
+void gaussianDownsample2x(const GrayView& src, GrayImage& dst) {
+    dst.resize(std::max(1, src.width / 2), std::max(1, src.height / 2));
+    gaussianDownsample2x(src, dst.data.data(), dst.stride);
+}
+
+void gaussianDownsample2x(const RGBView& src, RGBImage& dst) {
+    dst.resize(std::max(1, src.width / 2), std::max(1, src.height / 2));
+    gaussianDownsample2x(src, dst.data.data(), dst.stride);
 }
 
-void GaussianPyramid::downsample2x(const GrayImage& src, GrayImage& dst) {
-    const int dstW = src.width / 2;
-    const int dstH = src.height / 2;
+/**
+ * State of buildCoarsestLevel: the current source band, and a ring of the
+ * last five rows of each intermediate level
+ */
+struct StreamedPyramid {
+    std::vector<int> widths;                // Per level, as buildLevels sizes them
+    std::vector<int> heights;
+    const RowBandReader* read;
+    int bandRows;
+    GrayImage band;                         // Source rows [bandY, bandY + band.height)
+    int bandY = 0;
+    std::vector<std::vector<float>> rings;  // Level k row r at slot r % 5
+    std::vector<int> produced;              // Last row computed per level (-1: none)
+    std::vector<float> blended;             // Vertically filtered row, padded
     
-    if (dstW < 1 || dstH < 1) {
-        dst = GrayImage();
-        return;
+    const float* row(int level, int y) const {
+        if (level == 0) return band.row(y - bandY);
+        return rings[level].data() + static_cast<size_t>(y % 5) * widths[level];
     }
     
-    // Apply separable Gaussian blur
-    GrayImage blurredH, blurred;
-    gaussianBlurH(src, blurredH);
-    gaussianBlurV(blurredH, blurred);
-    
-    // Subsample
-    dst = GrayImage(dstW, dstH);
-    
-#ifdef USE_NEON
-    for (int y = 0; y < dstH; ++y) {
-        const float* srcRow = blurred.row(y * 2);
-        float* dstRow = dst.row(y);
-        
-        int x = 0;
-        for (; x + 3 < dstW; x += 4) {
-            // Load 8 source pixels, take every other one
-            float vals[4] = {
-                srcRow[x * 2],
-                srcRow[x * 2 + 2],
-                srcRow[x * 2 + 4],
-                srcRow[x * 2 + 6]
-            };
-            vst1q_f32(dstRow + x, vld1q_f32(vals));
+    /**
+     * Make rows [y0, y1] of a level available (y0 never moves backwards by
+     * more than the rows still held)
+     */
+    void ensure(int level, int y0, int y1) {
+        if (level == 0) {
+            if (band.height == 0 || y0 < bandY || y1 >= bandY + band.height) {
+                bandY = y0;
+                (*read)(bandY, std::min(bandRows, heights[0] - bandY), band);
+            }
+            return;
         }
-        
-        for (; x < dstW; ++x) {
-            dstRow[x] = srcRow[x * 2];
+        while (produced[level] < y1) {
+            ++produced[level];
+            computeRow(level, produced[level],
+                       rings[level].data() + static_cast<size_t>(produced[level] % 5) * widths[level]);
         }
     }
-#else
-    for (int y = 0; y < dstH; ++y) {
-        const float* srcRow = blurred.row(y * 2);
-        float* dstRow = dst.row(y);
+    
+    /**
+     * Row y of a level from the five rows of the level below, as
+     * gaussianDownsample2x computes it
+     */
+    void computeRow(int level, int y, float* dst) {
+        const int srcWidth = widths[level - 1];
+        const int srcHeight = heights[level - 1];
+        ensure(level - 1, clamp(2 * y - 2, 0, srcHeight - 1), clamp(2 * y + 2, 0, srcHeight - 1));
         
-        for (int x = 0; x < dstW; ++x) {
-            dstRow[x] = srcRow[x * 2];
+        const float* rows[5];
+        for (int k = 0; k < 5; ++k) {
+            rows[k] = row(level - 1, clamp(2 * y + k - 2, 0, srcHeight - 1));
         }
+        const simd::RowKernels& kernels = simd::rowKernels();
+        float* blendedRow = blended.data() + 2;
+        kernels.blendRows5(rows, GAUSS_KERNEL, blendedRow, srcWidth);
+        padRowClamped(blendedRow, srcWidth);
+        kernels.convolve5Decimate2x(blendedRow, GAUSS_KERNEL, dst, widths[level]);
     }
-#endif
-}
+};
 
-void GaussianPyramid::build(const GrayImage& image, int numLevels) {
-    levels_.clear();
-    levels_.reserve(numLevels);
-    
-    // Level 0 is the original image
-    levels_.push_back(image);
-    
-    // Build subsequent levels
+void buildCoarsestLevel(int width, int height, int numLevels, const RowBandReader& read,
+                        GrayImage& out, int bandRows) {
+    StreamedPyramid pyramid;
+    pyramid.widths.push_back(width);
+    pyramid.heights.push_back(height);
     for (int i = 1; i < numLevels; ++i) {
-        GrayImage downsampled;
-        downsample2x(levels_[i - 1], downsampled);
-        
-        if (downsampled.empty() || downsampled.width < 4 || downsampled.height < 4) {
+        const int levelW = pyramid.widths.back() / 2;
+        const int levelH = pyramid.heights.back() / 2;
+        if (levelW < 4 || levelH < 4) {
             break;
         }
-        
-        levels_.push_back(std::move(downsampled));
+        pyramid.widths.push_back(levelW);
+        pyramid.heights.push_back(levelH);
     }
     
-    LOGD("Built Gaussian pyramid with %d levels", static_cast<int>(levels_.size()));
-}
-
-const GrayImage& GaussianPyramid::getLevel(int level) const {
-    return levels_[clamp(level, 0, static_cast<int>(levels_.size()) - 1)];
-}
-
-// RGB Pyramid implementation
-
-static void gaussianBlurH_RGB(const RGBImage& src, RGBImage& dst) {
-    const int width = src.width;
-    const int height = src.height;
+    const int last = static_cast<int>(pyramid.widths.size()) - 1;
+    if (last == 0) {
+        // The source is its own coarsest level
+        read(0, height, out);
+        return;
+    }
     
-    if (dst.width != width || dst.height != height) {
-        dst = RGBImage(width, height);
+    pyramid.read = &read;
+    pyramid.bandRows = std::max(5, bandRows);
+    pyramid.rings.resize(last);
+    pyramid.produced.assign(last, -1);
+    for (int level = 1; level < last; ++level) {
+        pyramid.rings[level].resize(5 * static_cast<size_t>(pyramid.widths[level]));
     }
+    pyramid.blended.resize(width + 5);
     
-    for (int y = 0; y < height; ++y) {
-        const RGBPixel* srcRow = src.row(y);
-        RGBPixel* dstRow = dst.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            RGBPixel sum;
-            
-            for (int k = -2; k <= 2; ++k) {
-                int sx = clamp(x + k, 0, width - 1);
-                float w = GAUSS_KERNEL[k + 2];
-                sum.r += srcRow[sx].r * w;
-                sum.g += srcRow[sx].g * w;
-                sum.b += srcRow[sx].b * w;
-            }
-            
-            dstRow[x] = sum;
-        }
+    out.resize(pyramid.widths[last], pyramid.heights[last]);
+    for (int y = 0; y < out.height; ++y) {
+        pyramid.computeRow(last, y, out.row(y));
     }
 }
 
-static void gaussianBlurV_RGB(const RGBImage& src, RGBImage& dst) {
-    const int width = src.width;
-    const int height = src.height;
+/**
+ * Build the level views: levels[0] borrows the image, the rest are laid out
+ * in the arena. Stops before a level narrower or shorter than 4 pixels.
+ */
+template<typename T>
+static void buildLevels(const ImageView<T>& image, int numLevels,
+                        std::vector<ImageView<T>>& levels, std::vector<T>& arena) {
+    levels.clear();
+    levels.push_back(image);
     
-    if (dst.width != width || dst.height != height) {
-        dst = RGBImage(width, height);
+    // Size every level first so the arena is allocated once
+    std::vector<size_t> offsets;
+    size_t arenaSize = 0;
+    int width = image.width;
+    int height = image.height;
+    for (int i = 1; i < numLevels; ++i) {
+        width /= 2;
+        height /= 2;
+        if (width < 4 || height < 4) {
+            break;
+        }
+        offsets.push_back(arenaSize);
+        arenaSize += static_cast<size_t>(width) * height;
+    }
+    if (arena.size() < arenaSize) {
+        arena.resize(arenaSize);
     }
     
-    for (int y = 0; y < height; ++y) {
-        RGBPixel* dstRow = dst.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            RGBPixel sum;
-            
-            for (int k = -2; k <= 2; ++k) {
-                int sy = clamp(y + k, 0, height - 1);
-                float w = GAUSS_KERNEL[k + 2];
-                const RGBPixel& px = src.at(x, sy);
-                sum.r += px.r * w;
-                sum.g += px.g * w;
-                sum.b += px.b * w;
-            }
-            
-            dstRow[x] = sum;
-        }
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        const ImageView<T>& prev = levels.back();
+        T* pixels = arena.data() + offsets[i];
+        const int levelW = prev.width / 2;
+        gaussianDownsample2x(prev, pixels, levelW);
+        levels.emplace_back(pixels, levelW, prev.height / 2, static_cast<size_t>(levelW) * sizeof(T));
     }
 }
 
-void RGBPyramid::downsample2x(const RGBImage& src, RGBImage& dst) {
-    const int dstW = src.width / 2;
-    const int dstH = src.height / 2;
-    
-    if (dstW < 1 || dstH < 1) {
-        dst = RGBImage();
-        return;
-    }
-    
-    RGBImage blurredH, blurred;
-    gaussianBlurH_RGB(src, blurredH);
-    gaussianBlurV_RGB(blurredH, blurred);
-    
-    dst = RGBImage(dstW, dstH);
-    
-    for (int y = 0; y < dstH; ++y) {
-        const RGBPixel* srcRow = blurred.row(y * 2);
-        RGBPixel* dstRow = dst.row(y);
-        
-        for (int x = 0; x < dstW; ++x) {
-            dstRow[x] = srcRow[x * 2];
-        }
+template<typename T>
+static void copyView(const ImageView<T>& view, ImageBuffer<T>& out) {
+    out.resize(view.width, view.height);
+    for (int y = 0; y < view.height; ++y) {
+        std::copy(view.row(y), view.row(y) + view.width, out.row(y));
     }
 }
 
-void RGBPyramid::build(const RGBImage& image, int numLevels) {
-    levels_.clear();
-    levels_.reserve(numLevels);
+void GaussianPyramid::build(const GrayView& image, int numLevels) {
+    buildLevels(image, numLevels, levels_, arena_);
     
-    levels_.push_back(image);
-    
-    for (int i = 1; i < numLevels; ++i) {
-        RGBImage downsampled;
-        downsample2x(levels_[i - 1], downsampled);
-        
-        if (downsampled.empty() || downsampled.width < 4 || downsampled.height < 4) {
-            break;
-        }
-        
-        levels_.push_back(std::move(downsampled));
-    }
+    LOGD("Built Gaussian pyramid with %d levels", static_cast<int>(levels_.size()));
+}
+
+const GrayView& GaussianPyramid::getLevel(int level) const {
+    return levels_[clamp(level, 0, static_cast<int>(levels_.size()) - 1)];
+}
+
+void GaussianPyramid::copyLevel(int level, GrayImage& out) const {
+    copyView(getLevel(level), out);
+}
+
+// RGB Pyramid implementation
+
+void RGBPyramid::build(const RGBView& image, int numLevels) {
+    buildLevels(image, numLevels, levels_, arena_);
 }
 
-const RGBImage& RGBPyramid::getLevel(int level) const {
+const RGBView& RGBPyramid::getLevel(int level) const {
     return levels_[clamp(level, 0, static_cast<int>(levels_.size()) - 1)];
 }
 
+void RGBPyramid::copyLevel(int level, RGBImage& out) const {
+    copyView(getLevel(level), out);
+}
+
 // Laplacian Pyramid implementation
 
-void LaplacianPyramid::upsample2x(const GrayImage& src, GrayImage& dst, int targetW, int targetH) {
+void LaplacianPyramid::upsample2x(const GrayView& src, GrayImage& dst, int targetW, int targetH) {
     dst = GrayImage(targetW, targetH);
     
-    for (int y = 0; y < targetH; ++y) {
-        float* dstRow = dst.row(y);
-        float srcY = static_cast<float>(y) / 2.0f;
-        int sy0 = static_cast<int>(srcY);
-        int sy1 = std::min(sy0 + 1, src.height - 1);
-        float fy = srcY - sy0;
-        
-        for (int x = 0; x < targetW; ++x) {
-            float srcX = static_cast<float>(x) / 2.0f;
-            int sx0 = static_cast<int>(srcX);
-            int sx1 = std::min(sx0 + 1, src.width - 1);
-            float fx = srcX - sx0;
-            
-            // Bilinear interpolation
-            float v00 = src.at(sx0, sy0);
-            float v10 = src.at(sx1, sy0);
-            float v01 = src.at(sx0, sy1);
-            float v11 = src.at(sx1, sy1);
+    ThreadPool::instance().parallelForRows(0, targetH, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            float* dstRow = dst.row(y);
+            float srcY = static_cast<float>(y) / 2.0f;
+            int sy0 = static_cast<int>(srcY);
+            int sy1 = std::min(sy0 + 1, src.height - 1);
+            float fy = srcY - sy0;
             
-            float top = v00 * (1.0f - fx) + v10 * fx;
-            float bot = v01 * (1.0f - fx) + v11 * fx;
-            
-            dstRow[x] = top * (1.0f - fy) + bot * fy;
+            for (int x = 0; x < targetW; ++x) {
+                float srcX = static_cast<float>(x) / 2.0f;
+                int sx0 = static_cast<int>(srcX);
+                int sx1 = std::min(sx0 + 1, src.width - 1);
+                float fx = srcX - sx0;
+                
+                // Bilinear interpolation
+                float v00 = src.at(sx0, sy0);
+                float v10 = src.at(sx1, sy0);
+                float v01 = src.at(sx0, sy1);
+                float v11 = src.at(sx1, sy1);
+                
+                float top = v00 * (1.0f - fx) + v10 * fx;
+                float bot = v01 * (1.0f - fx) + v11 * fx;
+                
+                dstRow[x] = top * (1.0f - fy) + bot * fy;
+            }
         }
-    }
+    });
 }
 
 void LaplacianPyramid::build(const GrayImage& image, int numLevels) {
@@ -297,8 +345,8 @@ void LaplacianPyramid::build(const GrayImage& image, int numLevels) {
     
     // Compute Laplacian at each level (difference between level and upsampled next level)
     for (int i = 0; i < actualLevels - 1; ++i) {
-        const GrayImage& current = gauss.getLevel(i);
-        const GrayImage& next = gauss.getLevel(i + 1);
+        const GrayView& current = gauss.getLevel(i);
+        const GrayView& next = gauss.getLevel(i + 1);
         
         GrayImage upsampled;
         upsample2x(next, upsampled, current.width, current.height);
@@ -318,7 +366,7 @@ void LaplacianPyramid::build(const GrayImage& image, int numLevels) {
     }
     
     // Store residual (lowest frequency)
-    residual_ = gauss.getLevel(actualLevels - 1);
+    gauss.copyLevel(actualLevels - 1, residual_);
 }
 
 void LaplacianPyramid::reconstruct(GrayImage& output) const {
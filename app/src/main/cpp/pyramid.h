@@ -1,37 +1,95 @@
 /**
  * pyramid.h - Gaussian pyramid construction
  * 
- * Builds multi-scale image pyramids for coarse-to-fine alignment.
+ * Builds multi-scale image pyramids for coarse-to-fine alignment and
+ * multi-band blending.
  */
 
 #ifndef ULTRADETAIL_PYRAMID_H
 #define ULTRADETAIL_PYRAMID_H
 
 #include "common.h"
+#include <functional>
 #include <vector>
 
 namespace ultradetail {
 
+/**
+ * Blur with the 5-tap binomial kernel [1 4 6 4 1] / 16 and keep every other
+ * row and column
+ * 
+ * Filtering and decimation happen in one row-parallel pass that evaluates
+ * the kernel only at the kept positions: the vertical taps are blended for
+ * even source rows, the horizontal taps at even columns. Borders are
+ * clamped. The output is max(1, width / 2) x max(1, height / 2).
+ * 
+ * @param src Source image
+ * @param dst First output pixel
+ * @param dstStride Output row stride in pixels
+ */
+void gaussianDownsample2x(const GrayView& src, float* dst, int dstStride);
+void gaussianDownsample2x(const RGBView& src, RGBPixel* dst, int dstStride);
+
+/**
+ * Same, into a buffer resized to the output size
+ */
+void gaussianDownsample2x(const GrayView& src, GrayImage& dst);
+void gaussianDownsample2x(const RGBView& src, RGBImage& dst);
+
+/**
+ * Source of image rows for buildCoarsestLevel: fill band (resized to the
+ * image width x count) with rows [y, y + count)
+ */
+using RowBandReader = std::function<void(int y, int count, GrayImage& band)>;
+
+/**
+ * Coarsest level of a Gaussian pyramid, without holding the source image
+ * 
+ * Same pixels as the last level of GaussianPyramid::build(image, numLevels).
+ * Source rows are pulled bandRows at a time (consecutive bands overlap by
+ * four rows) and each intermediate level keeps only the five rows its next
+ * level reads, so the working set is about (bandRows + 5) source rows plus
+ * the output. Runs on the calling thread.
+ * 
+ * @param width Source width
+ * @param height Source height
+ * @param numLevels Number of pyramid levels (including base)
+ * @param read Source rows
+ * @param out Coarsest level
+ * @param bandRows Source rows per read (at least 5)
+ */
+void buildCoarsestLevel(int width, int height, int numLevels, const RowBandReader& read,
+                        GrayImage& out, int bandRows = 32);
+
 /**
  * Gaussian pyramid for grayscale images
+ * 
+ * Level 0 borrows the source pixels; the coarser levels are stored back to
+ * back in one arena that is reused when the pyramid is rebuilt.
  */
 class GaussianPyramid {
 public:
     /**
      * Build pyramid from grayscale image
      * 
-     * @param image Source grayscale image
+     * @param image Source grayscale image (must outlive the pyramid or the next build)
      * @param numLevels Number of pyramid levels (including base)
      */
-    void build(const GrayImage& image, int numLevels = MAX_PYRAMID_LEVELS);
+    void build(const GrayView& image, int numLevels = MAX_PYRAMID_LEVELS);
+    void build(GrayImage&& image, int numLevels = MAX_PYRAMID_LEVELS) = delete;
     
     /**
      * Get pyramid level
      * 
      * @param level Level index (0 = original resolution)
-     * @return Reference to image at that level
+     * @return View of the image at that level
      */
-    const GrayImage& getLevel(int level) const;
+    const GrayView& getLevel(int level) const;
+    
+    /**
+     * Copy a pyramid level into an owned image
+     */
+    void copyLevel(int level, GrayImage& out) const;
     
     /**
      * Get number of levels
@@ -51,32 +109,30 @@ public:
     /**
      * Clear pyramid data
      */
-    void clear() { levels_.clear(); }
+    void clear() { levels_.clear(); arena_.clear(); arena_.shrink_to_fit(); }
 
 private:
-    std::vector<GrayImage> levels_;
-    
-    /**
-     * Downsample image by factor of 2 with Gaussian blur
-     */
-    static void downsample2x(const GrayImage& src, GrayImage& dst);
+    std::vector<GrayView> levels_;
+    std::vector<float> arena_;
 };
 
 /**
- * Gaussian pyramid for RGB images
+ * Gaussian pyramid for RGB images (same storage as GaussianPyramid)
  */
 class RGBPyramid {
 public:
-    void build(const RGBImage& image, int numLevels = MAX_PYRAMID_LEVELS);
-    const RGBImage& getLevel(int level) const;
+    void build(const RGBView& image, int numLevels = MAX_PYRAMID_LEVELS);
+    void build(RGBImage&& image, int numLevels = MAX_PYRAMID_LEVELS) = delete;
+    const RGBView& getLevel(int level) const;
+    void copyLevel(int level, RGBImage& out) const;
     int numLevels() const { return static_cast<int>(levels_.size()); }
     int widthAt(int level) const { return levels_[level].width; }
     int heightAt(int level) const { return levels_[level].height; }
-    void clear() { levels_.clear(); }
+    void clear() { levels_.clear(); arena_.clear(); arena_.shrink_to_fit(); }
 
 private:
-    std::vector<RGBImage> levels_;
-    static void downsample2x(const RGBImage& src, RGBImage& dst);
+    std::vector<RGBView> levels_;
+    std::vector<RGBPixel> arena_;
 };
 
 /**
@@ -111,7 +167,7 @@ private:
     std::vector<GrayImage> details_;
     GrayImage residual_;
     
-    static void upsample2x(const GrayImage& src, GrayImage& dst, int targetW, int targetH);
+    static void upsample2x(const GrayView& src, GrayImage& dst, int targetW, int targetH);
 };
 
 } // namespace ultradetail
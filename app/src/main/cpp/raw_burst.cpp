@@ -0,0 +1,543 @@
+/**
+ * raw_burst.cpp - Bayer-domain burst merge implementation
+ */
+
+#include "raw_burst.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#undef LOG_TAG
+#define LOG_TAG "RawBurst"
+
+namespace ultradetail {
+
+// Color of each 2x2 position, index (x & 1) + 2 * (y & 1)
+static const int kBayerColors[4][4] = {
+    {0, 1, 1, 2},   // RGGB
+    {1, 0, 2, 1},   // GRBG
+    {1, 2, 0, 1},   // GBRG
+    {2, 1, 1, 0}    // BGGR
+};
+
+int bayerColorAt(BayerPattern pattern, int x, int y) {
+    return kBayerColors[static_cast<int>(pattern)][(x & 1) + 2 * (y & 1)];
+}
+
+static int32_t readInt32(const uint8_t* p) {
+    int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static int64_t readInt64(const uint8_t* p) {
+    int64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ * Bytes of sample data in one row of the plane, or 0 for an unsupported format
+ */
+static size_t rowDataBytes(const RawCacheHeader& header) {
+    switch (header.rawFormat) {
+        case RAW_FORMAT_RAW_SENSOR: return static_cast<size_t>(header.width) * 2;
+        case RAW_FORMAT_RAW10:      return static_cast<size_t>(header.width) * 5 / 4;
+        case RAW_FORMAT_RAW12:      return static_cast<size_t>(header.width) * 3 / 2;
+        default:                    return 0;
+    }
+}
+
+RawCacheFile::RawCacheFile() : mapping_(nullptr), mappingSize_(0), plane_(nullptr) {}
+
+RawCacheFile::~RawCacheFile() {
+    close();
+}
+
+bool RawCacheFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE("Cannot open %s", path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < RAWC_HEADER_SIZE) {
+        LOGE("%s is too small for a RAWC header", path.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    const size_t fileSize = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        LOGE("Cannot map %s", path.c_str());
+        return false;
+    }
+    mapping_ = mapping;
+    mappingSize_ = fileSize;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(mapping_);
+    RawCacheHeader header;
+    header.version = readInt32(bytes + 4);
+    header.width = readInt32(bytes + 8);
+    header.height = readInt32(bytes + 12);
+    header.rowStride = readInt32(bytes + 16);
+    header.pixelStride = readInt32(bytes + 20);
+    header.rawFormat = readInt32(bytes + 24);
+    int pattern = readInt32(bytes + 28);
+    header.whiteLevel = readInt32(bytes + 32);
+    header.timestampNs = readInt64(bytes + 36);
+    if (header.version >= 2) {
+        for (int i = 0; i < 4; ++i) {
+            header.blackLevel[i] = readInt32(bytes + 44 + 4 * i);
+        }
+    }
+
+    const char* problem = nullptr;
+    if (static_cast<uint32_t>(readInt32(bytes)) != RAWC_MAGIC) {
+        problem = "bad magic";
+    } else if (header.version < 1 || header.version > 2) {
+        problem = "unknown version";
+    } else if (header.width <= 0 || header.height <= 0 ||
+               (header.width & 1) || (header.height & 1)) {
+        problem = "bad dimensions";
+    } else if (pattern < 0 || pattern > 3) {
+        problem = "unsupported color filter arrangement";
+    } else if (rowDataBytes(header) == 0 ||
+               (header.rawFormat == RAW_FORMAT_RAW_SENSOR && header.pixelStride != 2) ||
+               (header.rawFormat == RAW_FORMAT_RAW10 && (header.width & 3))) {
+        problem = "unsupported sample format";
+    } else if (static_cast<size_t>(header.rowStride) < rowDataBytes(header)) {
+        problem = "row stride too small";
+    } else if (header.rawFormat == RAW_FORMAT_RAW_SENSOR && (header.rowStride & 1)) {
+        // 16-bit rows are read in place, so each must start 2-byte aligned
+        problem = "odd row stride for 16-bit samples";
+    } else if (RAWC_HEADER_SIZE + static_cast<size_t>(header.rowStride) * (header.height - 1) +
+               rowDataBytes(header) > fileSize) {
+        problem = "truncated plane";
+    } else {
+        int maxBlack = *std::max_element(header.blackLevel, header.blackLevel + 4);
+        if (header.whiteLevel <= maxBlack) {
+            problem = "white level not above black level";
+        }
+    }
+    if (problem) {
+        LOGE("%s: %s", path.c_str(), problem);
+        close();
+        return false;
+    }
+
+    header.pattern = static_cast<BayerPattern>(pattern);
+    header_ = header;
+    plane_ = bytes + RAWC_HEADER_SIZE;
+
+    if (header.version < 2) {
+        LOGW("%s: version 1 file has no black level, assuming 0", path.c_str());
+    }
+    return true;
+}
+
+void RawCacheFile::close() {
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    plane_ = nullptr;
+    header_ = RawCacheHeader();
+}
+
+const uint16_t* RawCacheFile::samples(int y, int x, int count, uint16_t* scratch) const {
+    const uint8_t* row = plane_ + static_cast<size_t>(y) * header_.rowStride;
+
+    switch (header_.rawFormat) {
+        case RAW_FORMAT_RAW_SENSOR:
+            // In place: the mapping and header size are even and open() rejects odd strides
+            return reinterpret_cast<const uint16_t*>(row) + x;
+
+        case RAW_FORMAT_RAW10:
+            // Four high bytes, then one byte holding the four 2-bit remainders
+            for (int i = 0; i < count; ++i) {
+                int s = x + i;
+                const uint8_t* group = row + (s >> 2) * 5;
+                int k = s & 3;
+                scratch[i] = static_cast<uint16_t>((group[k] << 2) | ((group[4] >> (2 * k)) & 0x3));
+            }
+            return scratch;
+
+        default:
+            // RAW12: two high bytes, then one byte holding the two 4-bit remainders
+            for (int i = 0; i < count; ++i) {
+                int s = x + i;
+                const uint8_t* group = row + (s >> 1) * 3;
+                int k = s & 1;
+                scratch[i] = static_cast<uint16_t>((group[k] << 4) | ((group[2] >> (4 * k)) & 0xF));
+            }
+            return scratch;
+    }
+}
+
+/**
+ * Black level and 1 / (white - black) per 2x2 position of one frame
+ */
+struct RawLevels {
+    float black[4];
+    float scale[4];
+
+    explicit RawLevels(const RawCacheHeader& header) {
+        for (int i = 0; i < 4; ++i) {
+            black[i] = static_cast<float>(header.blackLevel[i]);
+            scale[i] = 1.0f / static_cast<float>(header.whiteLevel - header.blackLevel[i]);
+        }
+    }
+
+    float normalize(uint16_t v, int position) const {
+        return (static_cast<float>(v) - black[position]) * scale[position];
+    }
+};
+
+/**
+ * 2x2 positions of the two green samples
+ */
+static void greenPositions(BayerPattern pattern, int& first, int& second) {
+    if (bayerColorAt(pattern, 0, 0) == 1) {
+        first = 0;
+        second = 3;
+    } else {
+        first = 1;
+        second = 2;
+    }
+}
+
+/**
+ * Half-resolution proxy: mean of the two normalized greens of each quad
+ */
+static void buildGreenProxy(const RawCacheFile& file, GrayImage& proxy) {
+    const RawCacheHeader& header = file.header();
+    const RawLevels levels(header);
+    const int width = header.width;
+    int greenA, greenB;
+    greenPositions(header.pattern, greenA, greenB);
+
+    proxy.resize(width / 2, header.height / 2);
+
+    ThreadPool::instance().parallelForRows(0, proxy.height, [&](int q0, int q1) {
+        std::vector<uint16_t> scratch(2 * static_cast<size_t>(width));
+        for (int qy = q0; qy < q1; ++qy) {
+            const uint16_t* rows[2] = {
+                file.samples(2 * qy, 0, width, scratch.data()),
+                file.samples(2 * qy + 1, 0, width, scratch.data() + width)
+            };
+            float* out = proxy.row(qy);
+            for (int qx = 0; qx < proxy.width; ++qx) {
+                float a = levels.normalize(rows[greenA >> 1][2 * qx + (greenA & 1)], greenA);
+                float b = levels.normalize(rows[greenB >> 1][2 * qx + (greenB & 1)], greenB);
+                out[qx] = 0.5f * (a + b);
+            }
+        }
+    });
+}
+
+bool mergeRawBurst(const std::vector<std::string>& paths, const RawMergeParams& params,
+                   RawMergeResult& result) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    result = RawMergeResult();
+
+    const int numFrames = static_cast<int>(paths.size());
+    if (numFrames == 0) {
+        LOGE("No RAW frames to merge");
+        return false;
+    }
+
+    std::vector<std::unique_ptr<RawCacheFile>> files;
+    files.reserve(numFrames);
+    for (const std::string& path : paths) {
+        files.push_back(std::unique_ptr<RawCacheFile>(new RawCacheFile()));
+        if (!files.back()->open(path)) {
+            return false;
+        }
+        const RawCacheHeader& first = files.front()->header();
+        const RawCacheHeader& header = files.back()->header();
+        if (header.width != first.width || header.height != first.height ||
+            header.pattern != first.pattern) {
+            LOGE("%s does not match the first frame (%dx%d)", path.c_str(), first.width, first.height);
+            return false;
+        }
+    }
+
+    const int referenceIndex = (params.referenceIndex >= 0 && params.referenceIndex < numFrames)
+        ? params.referenceIndex : numFrames / 2;
+    const RawCacheFile& reference = *files[referenceIndex];
+    const BayerPattern pattern = reference.header().pattern;
+    const int width = reference.width();
+    const int height = reference.height();
+    const int quadWidth = width / 2;
+    const int quadHeight = height / 2;
+
+    LOGI("Merging %d RAW frames %dx%d (format 0x%x, pattern %d), reference %d",
+         numFrames, width, height, reference.header().rawFormat,
+         static_cast<int>(pattern), referenceIndex);
+
+    // Align one frame at a time against the reference proxy
+    std::vector<FrameAlignment> alignments(numFrames);
+    float motionSum = 0.0f;
+    int alignedFrames = 0;
+    {
+        // The aligner borrows the reference proxy, so frames use their own buffer
+        GrayImage referenceProxy, proxy;
+        buildGreenProxy(reference, referenceProxy);
+        TileAligner aligner(params.alignment);
+        aligner.setReference(referenceProxy);
+
+        for (int i = 0; i < numFrames; ++i) {
+            if (i == referenceIndex) continue;
+            buildGreenProxy(*files[i], proxy);
+            alignments[i] = aligner.align(proxy);
+            if (alignments[i].isValid) {
+                motionSum += alignments[i].averageMotion;
+                alignedFrames++;
+            } else {
+                LOGW("Frame %d: alignment failed, skipped", i);
+            }
+        }
+    }
+
+    const RawLevels referenceLevels(reference.header());
+    std::vector<RawLevels> frameLevels;
+    frameLevels.reserve(numFrames);
+    for (const auto& file : files) {
+        frameLevels.emplace_back(file->header());
+    }
+    int greenA, greenB;
+    greenPositions(pattern, greenA, greenB);
+    const int tileSize = params.alignment.tileSize;
+
+    result.mosaic.resize(width, height);
+
+    // Each quad row is merged independently: the reference with weight 1,
+    // every aligned frame shifted by its tile's quad displacement
+    ThreadPool::instance().parallelForRows(0, quadHeight, [&](int q0, int q1) {
+        std::vector<float> accum(2 * static_cast<size_t>(width));
+        std::vector<float> weightSum(quadWidth);
+        std::vector<float> refGreen(quadWidth);
+        std::vector<float> invThreshold2(quadWidth);
+        std::vector<uint16_t> scratch(4 * static_cast<size_t>(width));
+        uint16_t* refScratch = scratch.data();
+        uint16_t* frameScratch = scratch.data() + 2 * width;
+
+        for (int qy = q0; qy < q1; ++qy) {
+            const uint16_t* refRows[2] = {
+                reference.samples(2 * qy, 0, width, refScratch),
+                reference.samples(2 * qy + 1, 0, width, refScratch + width)
+            };
+
+            for (int qx = 0; qx < quadWidth; ++qx) {
+                for (int p = 0; p < 4; ++p) {
+                    accum[(p >> 1) * width + 2 * qx + (p & 1)] =
+                        referenceLevels.normalize(refRows[p >> 1][2 * qx + (p & 1)], p);
+                }
+                float g = 0.5f * (accum[(greenA >> 1) * width + 2 * qx + (greenA & 1)] +
+                                  accum[(greenB >> 1) * width + 2 * qx + (greenB & 1)]);
+                float variance = params.noiseRead + params.noiseShot * std::max(g, 0.0f);
+                refGreen[qx] = g;
+                invThreshold2[qx] = 1.0f / (params.robustness * params.robustness * variance);
+                weightSum[qx] = 1.0f;
+            }
+
+            for (int f = 0; f < numFrames; ++f) {
+                if (f == referenceIndex || !alignments[f].isValid) continue;
+
+                const MotionField& motion = alignments[f].motionField;
+                const RawLevels& levels = frameLevels[f];
+                const int ty = std::min(qy / tileSize, motion.height - 1);
+
+                for (int tx = 0; tx < motion.width; ++tx) {
+                    const MotionVector& mv = motion.at(tx, ty);
+                    // The aligner matches reference quad q with frame quad q + motion
+                    const int sy = qy + mv.dy;
+                    if (sy < 0 || sy >= quadHeight) continue;
+
+                    // Destination quads of this tile whose source lies inside the frame
+                    const int qa = std::max(tx * tileSize, -mv.dx);
+                    const int qb = std::min(std::min((tx + 1) * tileSize, quadWidth), quadWidth - mv.dx);
+                    if (qa >= qb) continue;
+
+                    const int count = 2 * (qb - qa);
+                    const int sx = 2 * (qa + mv.dx);
+                    const uint16_t* rows[2] = {
+                        files[f]->samples(2 * sy, sx, count, frameScratch),
+                        files[f]->samples(2 * sy + 1, sx, count, frameScratch + width)
+                    };
+
+                    for (int qx = qa; qx < qb; ++qx) {
+                        const int i = 2 * (qx - qa);
+                        float v[4] = {
+                            levels.normalize(rows[0][i], 0),
+                            levels.normalize(rows[0][i + 1], 1),
+                            levels.normalize(rows[1][i], 2),
+                            levels.normalize(rows[1][i + 1], 3)
+                        };
+
+                        // Tukey biweight on the green difference
+                        float diff = 0.5f * (v[greenA] + v[greenB]) - refGreen[qx];
+                        float t = diff * diff * invThreshold2[qx];
+                        if (t >= 1.0f) continue;
+                        float w = (1.0f - t) * (1.0f - t);
+
+                        accum[2 * qx] += w * v[0];
+                        accum[2 * qx + 1] += w * v[1];
+                        accum[width + 2 * qx] += w * v[2];
+                        accum[width + 2 * qx + 1] += w * v[3];
+                        weightSum[qx] += w;
+                    }
+                }
+            }
+
+            for (int r = 0; r < 2; ++r) {
+                uint16_t* out = result.mosaic.row(2 * qy + r);
+                const float* acc = accum.data() + r * width;
+                for (int x = 0; x < width; ++x) {
+                    float v = acc[x] / weightSum[x >> 1];
+                    out[x] = static_cast<uint16_t>(clamp(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+                }
+            }
+        }
+    });
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.pattern = pattern;
+    result.referenceIndex = referenceIndex;
+    result.framesMerged = 1 + alignedFrames;
+    result.averageMotion = alignedFrames > 0 ? motionSum / alignedFrames : 0.0f;
+    result.processingTimeMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+    result.success = true;
+
+    LOGI("RAW merge complete: %d/%d frames, avg motion %.2f, %.1f ms",
+         result.framesMerged, numFrames, result.averageMotion, result.processingTimeMs);
+    return true;
+}
+
+void estimateRawWhiteBalance(const RawImage16& mosaic, BayerPattern pattern, float gains[3]) {
+    // Every 4th quad row is plenty; clipped samples carry no color
+    const uint16_t clipLevel = 62000;
+    double sum[3] = {0.0, 0.0, 0.0};
+    size_t count[3] = {0, 0, 0};
+
+    for (int y = 0; y < mosaic.height; y += (y & 1) ? 7 : 1) {
+        const uint16_t* row = mosaic.row(y);
+        for (int x = 0; x < mosaic.width; ++x) {
+            if (row[x] >= clipLevel) continue;
+            int c = bayerColorAt(pattern, x, y);
+            sum[c] += row[x];
+            count[c]++;
+        }
+    }
+
+    double mean[3];
+    for (int c = 0; c < 3; ++c) {
+        mean[c] = count[c] > 0 ? sum[c] / count[c] : 0.0;
+    }
+    gains[1] = 1.0f;
+    gains[0] = mean[0] > 0.0 ? clamp(static_cast<float>(mean[1] / mean[0]), 0.25f, 8.0f) : 1.0f;
+    gains[2] = mean[2] > 0.0 ? clamp(static_cast<float>(mean[1] / mean[2]), 0.25f, 8.0f) : 1.0f;
+}
+
+/**
+ * Mirror an index into [0, size) without changing its parity
+ */
+static inline int reflectIndex(int i, int size) {
+    if (i < 0) i = -i;
+    if (i >= size) i = 2 * (size - 1) - i;
+    return clamp(i, 0, size - 1);
+}
+
+void demosaicToArgb(const RawImage16& mosaic, BayerPattern pattern,
+                    const RawDemosaicParams& params, uint8_t* output, int outputStride,
+                    const ArgbPackOptions& options) {
+    const int width = mosaic.width;
+    const int height = mosaic.height;
+
+    float gains[3] = {params.gains[0], params.gains[1], params.gains[2]};
+    if (params.autoWhiteBalance) {
+        estimateRawWhiteBalance(mosaic, pattern, gains);
+    }
+    LOGD("Demosaic %dx%d, white balance %.3f/%.3f/%.3f", width, height, gains[0], gains[1], gains[2]);
+
+    const float norm = 1.0f / 65535.0f;
+    const float gainR = gains[0] * norm;
+    const float gainG = gains[1] * norm;
+    const float gainB = gains[2] * norm;
+
+    ThreadPool::instance().parallelForRows(0, height, [&](int y0, int y1) {
+        std::vector<RGBPixel> rgb(width);
+
+        for (int y = y0; y < y1; ++y) {
+            const uint16_t* rows[5];
+            for (int k = 0; k < 5; ++k) {
+                rows[k] = mosaic.row(reflectIndex(y + k - 2, height));
+            }
+
+            for (int x = 0; x < width; ++x) {
+                int xs[5];
+                for (int k = 0; k < 5; ++k) {
+                    xs[k] = reflectIndex(x + k - 2, width);
+                }
+                auto s = [&](int dy, int dx) -> float {
+                    return static_cast<float>(rows[2 + dy][xs[2 + dx]]);
+                };
+
+                const float c = s(0, 0);
+                const float cross = s(-1, 0) + s(1, 0) + s(0, -1) + s(0, 1);
+                const float diagonal = s(-1, -1) + s(-1, 1) + s(1, -1) + s(1, 1);
+                const float vertical2 = s(-2, 0) + s(2, 0);
+                const float horizontal2 = s(0, -2) + s(0, 2);
+                const int color = bayerColorAt(pattern, x, y);
+
+                float r, g, b;
+                if (color == 1) {
+                    // Green site: one chroma in the row, the other in the column
+                    float fromRow = (5.0f * c + 4.0f * (s(0, -1) + s(0, 1)) - diagonal -
+                                     horizontal2 + 0.5f * vertical2) * 0.125f;
+                    float fromColumn = (5.0f * c + 4.0f * (s(-1, 0) + s(1, 0)) - diagonal -
+                                        vertical2 + 0.5f * horizontal2) * 0.125f;
+                    g = c;
+                    if (bayerColorAt(pattern, x + 1, y) == 0) {
+                        r = fromRow;
+                        b = fromColumn;
+                    } else {
+                        r = fromColumn;
+                        b = fromRow;
+                    }
+                } else {
+                    // Red or blue site: green from the cross, the other chroma from the diagonals
+                    g = (4.0f * c + 2.0f * cross - vertical2 - horizontal2) * 0.125f;
+                    float other = (6.0f * c + 2.0f * diagonal - 1.5f * (vertical2 + horizontal2)) * 0.125f;
+                    if (color == 0) {
+                        r = c;
+                        b = other;
+                    } else {
+                        r = other;
+                        b = c;
+                    }
+                }
+
+                rgb[x] = RGBPixel(r * gainR, g * gainG, b * gainB);
+            }
+
+            rgbFloatRowToArgb(rgb.data(), width, y, output + static_cast<size_t>(y) * outputStride, options);
+        }
+    });
+}
+
+} // namespace ultradetail
@@ -0,0 +1,200 @@
+/**
+ * raw_burst.h - Bayer-domain burst merge over the RAWC cache files
+ *
+ * RawBurstCaptureController writes every selected RAW frame to a cache file
+ * with a 64-byte 'RAWC' header followed by the sensor plane. This module
+ * memory-maps those files, aligns each frame to the reference on a
+ * half-resolution green proxy, and merges the frames directly in the CFA
+ * domain into a 16-bit mosaic (2 bytes per sample). Demosaicing happens once,
+ * row by row, straight into the output bitmap, so no full-size float RGB
+ * frame is ever held and the lossy ISP YUV path is bypassed.
+ */
+
+#ifndef ULTRADETAIL_RAW_BURST_H
+#define ULTRADETAIL_RAW_BURST_H
+
+#include "common.h"
+#include "alignment.h"
+#include "yuv_converter.h"
+#include <string>
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * RAWC file layout (little-endian, see RawBurstCaptureController.writeRawCache)
+ */
+constexpr uint32_t RAWC_MAGIC = 0x52415743;  // 'RAWC'
+constexpr size_t RAWC_HEADER_SIZE = 64;
+
+/**
+ * Sensor plane formats (android.graphics.ImageFormat)
+ */
+constexpr int RAW_FORMAT_RAW_SENSOR = 0x20;  // 16 bits per sample
+constexpr int RAW_FORMAT_RAW10 = 0x25;       // 4 samples in 5 bytes
+constexpr int RAW_FORMAT_RAW12 = 0x26;       // 2 samples in 3 bytes
+
+/**
+ * Color filter arrangement (CameraCharacteristics.SENSOR_INFO_COLOR_FILTER_ARRANGEMENT)
+ */
+enum class BayerPattern {
+    RGGB = 0,
+    GRBG = 1,
+    GBRG = 2,
+    BGGR = 3
+};
+
+/**
+ * Color (0 = R, 1 = G, 2 = B) of the CFA sample at (x, y)
+ */
+int bayerColorAt(BayerPattern pattern, int x, int y);
+
+/**
+ * Parsed RAWC header
+ */
+struct RawCacheHeader {
+    int version;
+    int width;
+    int height;
+    int rowStride;          // Bytes between rows of the plane
+    int pixelStride;        // Bytes between samples (0 for packed formats)
+    int rawFormat;
+    BayerPattern pattern;
+    int whiteLevel;
+    int64_t timestampNs;
+    int blackLevel[4];      // Per 2x2 position, index (x & 1) + 2 * (y & 1); 0 in version 1 files
+
+    RawCacheHeader()
+        : version(0), width(0), height(0), rowStride(0), pixelStride(0), rawFormat(0),
+          pattern(BayerPattern::RGGB), whiteLevel(0), timestampNs(0), blackLevel{0, 0, 0, 0} {}
+};
+
+/**
+ * Read-only memory mapping of one RAWC cache file
+ *
+ * RAW_SENSOR rows are read in place from the mapping; RAW10/RAW12 rows are
+ * unpacked on request. Safe to read from several threads at once.
+ */
+class RawCacheFile {
+public:
+    RawCacheFile();
+    ~RawCacheFile();
+
+    RawCacheFile(const RawCacheFile&) = delete;
+    RawCacheFile& operator=(const RawCacheFile&) = delete;
+
+    /**
+     * Map a cache file and validate its header
+     *
+     * @return false (logged) if the file is missing, truncated or unsupported
+     */
+    bool open(const std::string& path);
+
+    void close();
+
+    bool isOpen() const { return mapping_ != nullptr; }
+    const RawCacheHeader& header() const { return header_; }
+    int width() const { return header_.width; }
+    int height() const { return header_.height; }
+
+    /**
+     * Samples [x, x + count) of row y as 16-bit values
+     *
+     * @param scratch At least count values; used when the row must be unpacked
+     * @return Pointer to the samples (into the mapping or into scratch)
+     */
+    const uint16_t* samples(int y, int x, int count, uint16_t* scratch) const;
+
+private:
+    void* mapping_;
+    size_t mappingSize_;
+    const uint8_t* plane_;
+    RawCacheHeader header_;
+};
+
+/**
+ * Merged CFA mosaic: black level removed, white level scaled to 65535
+ */
+using RawImage16 = ImageBuffer<uint16_t>;
+
+/**
+ * RAW burst merge parameters
+ */
+struct RawMergeParams {
+    int referenceIndex = -1;        // -1: middle frame
+    AlignmentParams alignment;      // Tile alignment on the half-resolution proxy
+    float noiseShot = 4e-4f;        // Noise variance per unit signal (normalized)
+    float noiseRead = 4e-6f;        // Noise variance at black (normalized)
+    float robustness = 3.0f;        // Rejection threshold in noise standard deviations
+
+    RawMergeParams() {
+        alignment.tileSize = 16;    // 32x32 sensor pixels
+    }
+};
+
+/**
+ * RAW burst merge result
+ */
+struct RawMergeResult {
+    RawImage16 mosaic;              // Merged CFA samples, sensor resolution
+    BayerPattern pattern;
+    int referenceIndex;
+    int framesMerged;               // Reference plus successfully aligned frames
+    float averageMotion;            // Mean proxy-pixel motion of the aligned frames
+    float processingTimeMs;
+    bool success;
+
+    RawMergeResult()
+        : pattern(BayerPattern::RGGB), referenceIndex(0), framesMerged(0),
+          averageMotion(0.0f), processingTimeMs(0.0f), success(false) {}
+};
+
+/**
+ * Merge a burst of RAWC cache files in the CFA domain
+ *
+ * Frames are aligned one at a time, so only two proxies are resident during
+ * alignment. Each frame is shifted by whole 2x2 quads (which keeps the CFA
+ * phase) and blended per quad with a robustness weight that rejects samples
+ * whose green differs from the reference by more than the expected noise.
+ *
+ * @param paths Cache files of one burst (same size and layout)
+ * @param params Merge parameters
+ * @param result Receives the merged mosaic
+ * @return false (logged) if the files cannot be read or do not match
+ */
+bool mergeRawBurst(const std::vector<std::string>& paths, const RawMergeParams& params,
+                   RawMergeResult& result);
+
+/**
+ * White balance applied while demosaicing
+ */
+struct RawDemosaicParams {
+    float gains[3];         // R, G, B multipliers
+    bool autoWhiteBalance;  // Derive gains from the mosaic (gray world) instead
+
+    RawDemosaicParams() : gains{1.0f, 1.0f, 1.0f}, autoWhiteBalance(true) {}
+};
+
+/**
+ * Gray-world white balance gains of a mosaic (green gain 1)
+ */
+void estimateRawWhiteBalance(const RawImage16& mosaic, BayerPattern pattern, float gains[3]);
+
+/**
+ * Demosaic a mosaic into 8-bit RGBA pixels
+ *
+ * Uses the gradient-corrected bilinear kernels of Malvar, He and Cutler.
+ * Rows are demosaiced and packed in parallel without an intermediate RGB
+ * image. The output is white-balanced camera RGB; pack with options.srgb to
+ * apply the display transfer curve.
+ *
+ * @param output Destination, mosaic size, 4 bytes per pixel
+ * @param outputStride Destination row stride in bytes
+ */
+void demosaicToArgb(const RawImage16& mosaic, BayerPattern pattern,
+                    const RawDemosaicParams& params, uint8_t* output, int outputStride,
+                    const ArgbPackOptions& options = ArgbPackOptions());
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_RAW_BURST_H
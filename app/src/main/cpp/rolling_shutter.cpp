@@ -5,7 +5,6 @@
  */
 
 #include "rolling_shutter.h"
-#include "neon_utils.h"
 #include <cmath>
 #include <algorithm>
 
@@ -0,0 +1,788 @@
+/**
+ * simd.h - Portable SIMD vector types for ARM and x86
+ *
+ * A small layer of fixed-width vector types (f32x4, f32x8, u8x16, u16x8,
+ * u32x4) with loads, stores, widening / narrowing, fused multiply-add,
+ * min / max, compare-select, absolute difference, non-finite replacement,
+ * lane reversal and 4x4 transposes. The backend is chosen at compile time:
+ *
+ *   NEON       USE_NEON (arm64-v8a, armeabi-v7a)
+ *   SSE4.1     __SSE4_1__ (x86_64 Android ABI, x86 hosts with -msse4.1)
+ *   SSE2       __SSE2__ (any other x86_64 build)
+ *   scalar     everything else, or forced with -DULTRADETAIL_SIMD_SCALAR
+ *
+ * f32x8 is a native AVX register when the translation unit is built with
+ * AVX2 + FMA and a pair of f32x4 otherwise, so width-8 kernels compile on
+ * every backend. All definitions live in an inline namespace named after
+ * the backend: a translation unit built with extra ISA flags
+ * (simd_kernels_avx2.cpp) never shares inline symbols with the rest.
+ *
+ * Row kernels built on these types are dispatched at runtime through
+ * rowKernels(), which takes kernels from the AVX2 build on x86 CPUs that
+ * support it.
+ */
+
+#ifndef ULTRADETAIL_SIMD_H
+#define ULTRADETAIL_SIMD_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#if !defined(ULTRADETAIL_SIMD_SCALAR)
+#if defined(USE_NEON)
+#define ULTRADETAIL_SIMD_NEON 1
+#elif defined(__SSE2__)
+#define ULTRADETAIL_SIMD_SSE 1
+#else
+#define ULTRADETAIL_SIMD_SCALAR 1
+#endif
+#endif
+
+#if defined(ULTRADETAIL_SIMD_SSE) && defined(__AVX2__) && defined(__FMA__)
+#define ULTRADETAIL_SIMD_AVX2 1
+#endif
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+#include <arm_neon.h>
+#define ULTRADETAIL_SIMD_ABI neon
+#elif defined(ULTRADETAIL_SIMD_AVX2)
+#include <immintrin.h>
+#define ULTRADETAIL_SIMD_ABI avx2
+#elif defined(ULTRADETAIL_SIMD_SSE) && defined(__SSE4_1__)
+#include <smmintrin.h>
+#define ULTRADETAIL_SIMD_ABI sse41
+#elif defined(ULTRADETAIL_SIMD_SSE)
+#include <emmintrin.h>
+#define ULTRADETAIL_SIMD_ABI sse2
+#else
+#define ULTRADETAIL_SIMD_ABI scalar
+#endif
+
+namespace ultradetail {
+namespace simd {
+inline namespace ULTRADETAIL_SIMD_ABI {
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+constexpr const char* kBackendName = "neon";
+#elif defined(ULTRADETAIL_SIMD_AVX2)
+constexpr const char* kBackendName = "avx2";
+#elif defined(ULTRADETAIL_SIMD_SSE) && defined(__SSE4_1__)
+constexpr const char* kBackendName = "sse4.1";
+#elif defined(ULTRADETAIL_SIMD_SSE)
+constexpr const char* kBackendName = "sse2";
+#else
+constexpr const char* kBackendName = "scalar";
+#endif
+
+// ==================== f32x4 ====================
+
+/**
+ * Four floats
+ *
+ * min / max return b in lanes where a is NaN (b is expected to be a
+ * number), on every backend. fma may or may not round the product
+ * separately, depending on the target. Division is exact except on ARMv7,
+ * where it multiplies by a refined reciprocal (within a few ulp).
+ */
+struct f32x4 {
+    static constexpr int kLanes = 4;
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+    float32x4_t v;
+    static f32x4 load(const float* p) { return {vld1q_f32(p)}; }
+    void store(float* p) const { vst1q_f32(p, v); }
+    static f32x4 splat(float s) { return {vdupq_n_f32(s)}; }
+#elif defined(ULTRADETAIL_SIMD_SSE)
+    __m128 v;
+    static f32x4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    static f32x4 splat(float s) { return {_mm_set1_ps(s)}; }
+#else
+    float v[4];
+    static f32x4 load(const float* p) { f32x4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    void store(float* p) const { std::memcpy(p, v, sizeof(v)); }
+    static f32x4 splat(float s) { return {{s, s, s, s}}; }
+#endif
+
+    static f32x4 zero() { return splat(0.0f); }
+};
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+
+inline f32x4 operator+(f32x4 a, f32x4 b) { return {vaddq_f32(a.v, b.v)}; }
+inline f32x4 operator-(f32x4 a, f32x4 b) { return {vsubq_f32(a.v, b.v)}; }
+inline f32x4 operator*(f32x4 a, f32x4 b) { return {vmulq_f32(a.v, b.v)}; }
+
+inline f32x4 operator/(f32x4 a, f32x4 b) {
+#if defined(__aarch64__)
+    return {vdivq_f32(a.v, b.v)};
+#else
+    // ARMv7 has no vector divide: a * (1 / b), reciprocal estimate plus two Newton steps
+    float32x4_t r = vrecpeq_f32(b.v);
+    r = vmulq_f32(r, vrecpsq_f32(b.v, r));
+    r = vmulq_f32(r, vrecpsq_f32(b.v, r));
+    return {vmulq_f32(a.v, r)};
+#endif
+}
+
+/** a * b + c */
+inline f32x4 fma(f32x4 a, f32x4 b, f32x4 c) {
+#if defined(__aarch64__)
+    return {vfmaq_f32(c.v, a.v, b.v)};
+#else
+    return {vmlaq_f32(c.v, a.v, b.v)};
+#endif
+}
+
+// vminq / vmaxq propagate NaN: route NaN lanes of a to b explicitly
+inline f32x4 min(f32x4 a, f32x4 b) {
+    return {vbslq_f32(vceqq_f32(a.v, a.v), vminq_f32(a.v, b.v), b.v)};
+}
+
+inline f32x4 max(f32x4 a, f32x4 b) {
+    return {vbslq_f32(vceqq_f32(a.v, a.v), vmaxq_f32(a.v, b.v), b.v)};
+}
+
+/** Per lane: a <= b ? ifTrue : ifFalse */
+inline f32x4 selectLessEqual(f32x4 a, f32x4 b, f32x4 ifTrue, f32x4 ifFalse) {
+    return {vbslq_f32(vcleq_f32(a.v, b.v), ifTrue.v, ifFalse.v)};
+}
+
+inline f32x4 absDiff(f32x4 a, f32x4 b) { return {vabdq_f32(a.v, b.v)}; }
+
+inline f32x4 sqrt(f32x4 a) {
+#if defined(__aarch64__)
+    return {vsqrtq_f32(a.v)};
+#else
+    // ARMv7 has no vector square root: a * rsqrt(a), two Newton steps, 0 at 0
+    float32x4_t e = vrsqrteq_f32(a.v);
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a.v, e), e));
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(a.v, e), e));
+    uint32x4_t positive = vcgtq_f32(a.v, vdupq_n_f32(0.0f));
+    return {vbslq_f32(positive, vmulq_f32(a.v, e), vdupq_n_f32(0.0f))};
+#endif
+}
+
+inline float horizontalSum(f32x4 a) {
+#if defined(__aarch64__)
+    return vaddvq_f32(a.v);
+#else
+    float32x2_t s = vadd_f32(vget_low_f32(a.v), vget_high_f32(a.v));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+#endif
+}
+
+/** NaN / Inf lanes of a replaced by fallback (bit test, safe under -ffast-math) */
+inline f32x4 replaceNonFinite(f32x4 a, f32x4 fallback) {
+    const uint32x4_t exponent = vdupq_n_u32(0x7f800000u);
+    uint32x4_t special = vceqq_u32(vandq_u32(vreinterpretq_u32_f32(a.v), exponent), exponent);
+    return {vbslq_f32(special, fallback.v, a.v)};
+}
+
+/** Lanes in reverse order */
+inline f32x4 reverse(f32x4 a) {
+    float32x4_t r = vrev64q_f32(a.v);
+    return {vcombine_f32(vget_high_f32(r), vget_low_f32(r))};
+}
+
+/** Rows r0..r3 of a 4x4 block -> its columns */
+inline void transpose4x4(f32x4& r0, f32x4& r1, f32x4& r2, f32x4& r3) {
+    float32x4x2_t t01 = vtrnq_f32(r0.v, r1.v);
+    float32x4x2_t t23 = vtrnq_f32(r2.v, r3.v);
+    r0.v = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+    r1.v = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+    r2.v = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+    r3.v = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+/** p[0..7] -> even elements, odd elements */
+inline void loadDeinterleaved2(const float* p, f32x4& even, f32x4& odd) {
+    float32x4x2_t t = vld2q_f32(p);
+    even.v = t.val[0];
+    odd.v = t.val[1];
+}
+
+inline void storeInterleaved2(float* p, f32x4 a, f32x4 b) {
+    float32x4x2_t t;
+    t.val[0] = a.v;
+    t.val[1] = b.v;
+    vst2q_f32(p, t);
+}
+
+/** p[0..11] as 4 triples (e.g. RGBPixel) -> first, second, third components */
+inline void loadDeinterleaved3(const float* p, f32x4& a, f32x4& b, f32x4& c) {
+    float32x4x3_t t = vld3q_f32(p);
+    a.v = t.val[0];
+    b.v = t.val[1];
+    c.v = t.val[2];
+}
+
+inline void storeInterleaved3(float* p, f32x4 a, f32x4 b, f32x4 c) {
+    float32x4x3_t t;
+    t.val[0] = a.v;
+    t.val[1] = b.v;
+    t.val[2] = c.v;
+    vst3q_f32(p, t);
+}
+
+#elif defined(ULTRADETAIL_SIMD_SSE)
+
+inline f32x4 operator+(f32x4 a, f32x4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline f32x4 operator-(f32x4 a, f32x4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline f32x4 operator*(f32x4 a, f32x4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline f32x4 operator/(f32x4 a, f32x4 b) { return {_mm_div_ps(a.v, b.v)}; }
+
+/** a * b + c */
+inline f32x4 fma(f32x4 a, f32x4 b, f32x4 c) {
+#if defined(__FMA__)
+    return {_mm_fmadd_ps(a.v, b.v, c.v)};
+#else
+    return {_mm_add_ps(_mm_mul_ps(a.v, b.v), c.v)};
+#endif
+}
+
+// minps / maxps return the second operand when either is NaN
+inline f32x4 min(f32x4 a, f32x4 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline f32x4 max(f32x4 a, f32x4 b) { return {_mm_max_ps(a.v, b.v)}; }
+
+/** Per lane: a <= b ? ifTrue : ifFalse */
+inline f32x4 selectLessEqual(f32x4 a, f32x4 b, f32x4 ifTrue, f32x4 ifFalse) {
+    __m128 mask = _mm_cmple_ps(a.v, b.v);
+    return {_mm_or_ps(_mm_and_ps(mask, ifTrue.v), _mm_andnot_ps(mask, ifFalse.v))};
+}
+
+inline f32x4 absDiff(f32x4 a, f32x4 b) {
+    return {_mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(a.v, b.v))};
+}
+
+inline f32x4 sqrt(f32x4 a) { return {_mm_sqrt_ps(a.v)}; }
+
+inline float horizontalSum(f32x4 a) {
+    __m128 s = _mm_add_ps(a.v, _mm_movehl_ps(a.v, a.v));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(s);
+}
+
+/** NaN / Inf lanes of a replaced by fallback (bit test, safe under -ffast-math) */
+inline f32x4 replaceNonFinite(f32x4 a, f32x4 fallback) {
+    const __m128i exponent = _mm_set1_epi32(0x7f800000);
+    __m128 special = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(a.v), exponent), exponent));
+    return {_mm_or_ps(_mm_andnot_ps(special, a.v), _mm_and_ps(special, fallback.v))};
+}
+
+/** Lanes in reverse order */
+inline f32x4 reverse(f32x4 a) { return {_mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(0, 1, 2, 3))}; }
+
+/** Rows r0..r3 of a 4x4 block -> its columns */
+inline void transpose4x4(f32x4& r0, f32x4& r1, f32x4& r2, f32x4& r3) {
+    _MM_TRANSPOSE4_PS(r0.v, r1.v, r2.v, r3.v);
+}
+
+/** p[0..7] -> even elements, odd elements */
+inline void loadDeinterleaved2(const float* p, f32x4& even, f32x4& odd) {
+    __m128 lo = _mm_loadu_ps(p);
+    __m128 hi = _mm_loadu_ps(p + 4);
+    even.v = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+    odd.v = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+inline void storeInterleaved2(float* p, f32x4 a, f32x4 b) {
+    _mm_storeu_ps(p, _mm_unpacklo_ps(a.v, b.v));
+    _mm_storeu_ps(p + 4, _mm_unpackhi_ps(a.v, b.v));
+}
+
+/** p[0..11] as 4 triples (e.g. RGBPixel) -> first, second, third components */
+inline void loadDeinterleaved3(const float* p, f32x4& a, f32x4& b, f32x4& c) {
+    __m128 x = _mm_loadu_ps(p);         // a0 b0 c0 a1
+    __m128 y = _mm_loadu_ps(p + 4);     // b1 c1 a2 b2
+    __m128 z = _mm_loadu_ps(p + 8);     // c2 a3 b3 c3
+    __m128 t0 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 2, 2));    // a2 a2 a3 a3
+    __m128 t1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(2, 1, 3, 0));    // b1 b2 a3 b3
+    a.v = _mm_shuffle_ps(x, t0, _MM_SHUFFLE(2, 0, 3, 0));         // a0 a1 a2 a3
+    b.v = _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 1, 1)), t1,
+                         _MM_SHUFFLE(3, 1, 2, 0));                // b0 b1 b2 b3
+    c.v = _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 1, 2, 2)),
+                         _mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 3, 0, 0)),
+                         _MM_SHUFFLE(2, 0, 2, 0));                // c0 c1 c2 c3
+}
+
+inline void storeInterleaved3(float* p, f32x4 a, f32x4 b, f32x4 c) {
+    __m128 ab0 = _mm_unpacklo_ps(a.v, b.v);                          // a0 b0 a1 b1
+    __m128 ab1 = _mm_unpackhi_ps(a.v, b.v);                          // a2 b2 a3 b3
+    __m128 t0 = _mm_shuffle_ps(c.v, ab0, _MM_SHUFFLE(2, 2, 0, 0));   // c0 c0 a1 a1
+    __m128 t1 = _mm_shuffle_ps(ab0, c.v, _MM_SHUFFLE(1, 1, 3, 3));   // b1 b1 c1 c1
+    __m128 t2 = _mm_shuffle_ps(c.v, ab1, _MM_SHUFFLE(3, 2, 3, 2));   // c2 c3 a3 b3
+    _mm_storeu_ps(p, _mm_shuffle_ps(ab0, t0, _MM_SHUFFLE(2, 0, 1, 0)));      // a0 b0 c0 a1
+    _mm_storeu_ps(p + 4, _mm_shuffle_ps(t1, ab1, _MM_SHUFFLE(1, 0, 2, 0)));  // b1 c1 a2 b2
+    _mm_storeu_ps(p + 8, _mm_shuffle_ps(t2, t2, _MM_SHUFFLE(1, 3, 2, 0)));   // c2 a3 b3 c3
+}
+
+#else
+
+inline f32x4 operator+(f32x4 a, f32x4 b) { return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}}; }
+inline f32x4 operator-(f32x4 a, f32x4 b) { return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}}; }
+inline f32x4 operator*(f32x4 a, f32x4 b) { return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}}; }
+inline f32x4 operator/(f32x4 a, f32x4 b) { return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}}; }
+
+/** a * b + c */
+inline f32x4 fma(f32x4 a, f32x4 b, f32x4 c) { return a * b + c; }
+
+inline f32x4 min(f32x4 a, f32x4 b) {
+    f32x4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+
+inline f32x4 max(f32x4 a, f32x4 b) {
+    f32x4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    return r;
+}
+
+/** Per lane: a <= b ? ifTrue : ifFalse */
+inline f32x4 selectLessEqual(f32x4 a, f32x4 b, f32x4 ifTrue, f32x4 ifFalse) {
+    f32x4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] <= b.v[i] ? ifTrue.v[i] : ifFalse.v[i];
+    return r;
+}
+
+inline f32x4 absDiff(f32x4 a, f32x4 b) {
+    f32x4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = std::fabs(a.v[i] - b.v[i]);
+    return r;
+}
+
+inline f32x4 sqrt(f32x4 a) {
+    f32x4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = std::sqrt(a.v[i]);
+    return r;
+}
+
+inline float horizontalSum(f32x4 a) { return (a.v[0] + a.v[2]) + (a.v[1] + a.v[3]); }
+
+/** NaN / Inf lanes of a replaced by fallback (bit test, safe under -ffast-math) */
+inline f32x4 replaceNonFinite(f32x4 a, f32x4 fallback) {
+    f32x4 r;
+    for (int i = 0; i < 4; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, &a.v[i], sizeof(bits));
+        r.v[i] = (bits & 0x7f800000u) == 0x7f800000u ? fallback.v[i] : a.v[i];
+    }
+    return r;
+}
+
+/** Lanes in reverse order */
+inline f32x4 reverse(f32x4 a) { return {{a.v[3], a.v[2], a.v[1], a.v[0]}}; }
+
+/** Rows r0..r3 of a 4x4 block -> its columns */
+inline void transpose4x4(f32x4& r0, f32x4& r1, f32x4& r2, f32x4& r3) {
+    f32x4* rows[4] = {&r0, &r1, &r2, &r3};
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i + 1; j < 4; ++j) {
+            std::swap(rows[i]->v[j], rows[j]->v[i]);
+        }
+    }
+}
+
+/** p[0..7] -> even elements, odd elements */
+inline void loadDeinterleaved2(const float* p, f32x4& even, f32x4& odd) {
+    for (int i = 0; i < 4; ++i) {
+        even.v[i] = p[2 * i];
+        odd.v[i] = p[2 * i + 1];
+    }
+}
+
+inline void storeInterleaved2(float* p, f32x4 a, f32x4 b) {
+    for (int i = 0; i < 4; ++i) {
+        p[2 * i] = a.v[i];
+        p[2 * i + 1] = b.v[i];
+    }
+}
+
+/** p[0..11] as 4 triples (e.g. RGBPixel) -> first, second, third components */
+inline void loadDeinterleaved3(const float* p, f32x4& a, f32x4& b, f32x4& c) {
+    for (int i = 0; i < 4; ++i) {
+        a.v[i] = p[3 * i];
+        b.v[i] = p[3 * i + 1];
+        c.v[i] = p[3 * i + 2];
+    }
+}
+
+inline void storeInterleaved3(float* p, f32x4 a, f32x4 b, f32x4 c) {
+    for (int i = 0; i < 4; ++i) {
+        p[3 * i] = a.v[i];
+        p[3 * i + 1] = b.v[i];
+        p[3 * i + 2] = c.v[i];
+    }
+}
+
+#endif
+
+/** min(max(a, lo), hi); NaN lanes become lo */
+inline f32x4 clamp(f32x4 a, f32x4 lo, f32x4 hi) { return min(max(a, lo), hi); }
+
+// ==================== f32x8 ====================
+
+/**
+ * Eight floats: one AVX register, or a pair of f32x4
+ */
+#if defined(ULTRADETAIL_SIMD_AVX2)
+
+struct f32x8 {
+    static constexpr int kLanes = 8;
+
+    __m256 v;
+    static f32x8 load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    static f32x8 splat(float s) { return {_mm256_set1_ps(s)}; }
+    static f32x8 zero() { return {_mm256_setzero_ps()}; }
+};
+
+inline f32x8 operator+(f32x8 a, f32x8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline f32x8 operator-(f32x8 a, f32x8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline f32x8 operator*(f32x8 a, f32x8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline f32x8 operator/(f32x8 a, f32x8 b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline f32x8 fma(f32x8 a, f32x8 b, f32x8 c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+inline f32x8 min(f32x8 a, f32x8 b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline f32x8 max(f32x8 a, f32x8 b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline f32x8 sqrt(f32x8 a) { return {_mm256_sqrt_ps(a.v)}; }
+
+inline f32x8 absDiff(f32x8 a, f32x8 b) {
+    return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(a.v, b.v))};
+}
+
+inline float horizontalSum(f32x8 a) {
+    return horizontalSum(f32x4{_mm_add_ps(_mm256_castps256_ps128(a.v), _mm256_extractf128_ps(a.v, 1))});
+}
+
+/** p[0..15] -> even elements, odd elements */
+inline void loadDeinterleaved2(const float* p, f32x8& even, f32x8& odd) {
+    __m256 lo = _mm256_loadu_ps(p);
+    __m256 hi = _mm256_loadu_ps(p + 8);
+    // Shuffles work per 128-bit half: reorder the 64-bit quarters afterwards
+    __m256 e = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+    __m256 o = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+    even.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(e), _MM_SHUFFLE(3, 1, 2, 0)));
+    odd.v = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(o), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+#else
+
+struct f32x8 {
+    static constexpr int kLanes = 8;
+
+    f32x4 lo, hi;
+    static f32x8 load(const float* p) { return {f32x4::load(p), f32x4::load(p + 4)}; }
+    void store(float* p) const { lo.store(p); hi.store(p + 4); }
+    static f32x8 splat(float s) { return {f32x4::splat(s), f32x4::splat(s)}; }
+    static f32x8 zero() { return splat(0.0f); }
+};
+
+inline f32x8 operator+(f32x8 a, f32x8 b) { return {a.lo + b.lo, a.hi + b.hi}; }
+inline f32x8 operator-(f32x8 a, f32x8 b) { return {a.lo - b.lo, a.hi - b.hi}; }
+inline f32x8 operator*(f32x8 a, f32x8 b) { return {a.lo * b.lo, a.hi * b.hi}; }
+inline f32x8 operator/(f32x8 a, f32x8 b) { return {a.lo / b.lo, a.hi / b.hi}; }
+inline f32x8 fma(f32x8 a, f32x8 b, f32x8 c) { return {fma(a.lo, b.lo, c.lo), fma(a.hi, b.hi, c.hi)}; }
+inline f32x8 min(f32x8 a, f32x8 b) { return {min(a.lo, b.lo), min(a.hi, b.hi)}; }
+inline f32x8 max(f32x8 a, f32x8 b) { return {max(a.lo, b.lo), max(a.hi, b.hi)}; }
+inline f32x8 sqrt(f32x8 a) { return {sqrt(a.lo), sqrt(a.hi)}; }
+inline f32x8 absDiff(f32x8 a, f32x8 b) { return {absDiff(a.lo, b.lo), absDiff(a.hi, b.hi)}; }
+inline float horizontalSum(f32x8 a) { return horizontalSum(a.lo + a.hi); }
+
+/** p[0..15] -> even elements, odd elements */
+inline void loadDeinterleaved2(const float* p, f32x8& even, f32x8& odd) {
+    loadDeinterleaved2(p, even.lo, odd.lo);
+    loadDeinterleaved2(p + 8, even.hi, odd.hi);
+}
+
+#endif
+
+// ==================== Integer vectors ====================
+
+/**
+ * Sixteen bytes
+ */
+struct u8x16 {
+    static constexpr int kLanes = 16;
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+    uint8x16_t v;
+    static u8x16 load(const uint8_t* p) { return {vld1q_u8(p)}; }
+    void store(uint8_t* p) const { vst1q_u8(p, v); }
+    static u8x16 splat(uint8_t s) { return {vdupq_n_u8(s)}; }
+#elif defined(ULTRADETAIL_SIMD_SSE)
+    __m128i v;
+    static u8x16 load(const uint8_t* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+    void store(uint8_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static u8x16 splat(uint8_t s) { return {_mm_set1_epi8(static_cast<char>(s))}; }
+#else
+    uint8_t v[16];
+    static u8x16 load(const uint8_t* p) { u8x16 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    void store(uint8_t* p) const { std::memcpy(p, v, sizeof(v)); }
+    static u8x16 splat(uint8_t s) { u8x16 r; std::memset(r.v, s, sizeof(r.v)); return r; }
+#endif
+};
+
+/**
+ * Eight 16-bit unsigned integers
+ */
+struct u16x8 {
+    static constexpr int kLanes = 8;
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+    uint16x8_t v;
+    static u16x8 load(const uint16_t* p) { return {vld1q_u16(p)}; }
+    void store(uint16_t* p) const { vst1q_u16(p, v); }
+    static u16x8 splat(uint16_t s) { return {vdupq_n_u16(s)}; }
+    /** Exactly 8 bytes at p, zero-extended */
+    static u16x8 loadU8(const uint8_t* p) { return {vmovl_u8(vld1_u8(p))}; }
+#elif defined(ULTRADETAIL_SIMD_SSE)
+    __m128i v;
+    static u16x8 load(const uint16_t* p) { return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}; }
+    void store(uint16_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static u16x8 splat(uint16_t s) { return {_mm_set1_epi16(static_cast<short>(s))}; }
+    /** Exactly 8 bytes at p, zero-extended */
+    static u16x8 loadU8(const uint8_t* p) {
+        __m128i b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+#if defined(__SSE4_1__)
+        return {_mm_cvtepu8_epi16(b)};
+#else
+        return {_mm_unpacklo_epi8(b, _mm_setzero_si128())};
+#endif
+    }
+#else
+    uint16_t v[8];
+    static u16x8 load(const uint16_t* p) { u16x8 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    void store(uint16_t* p) const { std::memcpy(p, v, sizeof(v)); }
+    static u16x8 splat(uint16_t s) { return {{s, s, s, s, s, s, s, s}}; }
+    /** Exactly 8 bytes at p, zero-extended */
+    static u16x8 loadU8(const uint8_t* p) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = p[i]; return r; }
+#endif
+};
+
+/**
+ * Four 32-bit unsigned integers
+ */
+struct u32x4 {
+    static constexpr int kLanes = 4;
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+    uint32x4_t v;
+    void store(uint32_t* p) const { vst1q_u32(p, v); }
+    static u32x4 splat(uint32_t s) { return {vdupq_n_u32(s)}; }
+#elif defined(ULTRADETAIL_SIMD_SSE)
+    __m128i v;
+    void store(uint32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static u32x4 splat(uint32_t s) { return {_mm_set1_epi32(static_cast<int>(s))}; }
+#else
+    uint32_t v[4];
+    void store(uint32_t* p) const { std::memcpy(p, v, sizeof(v)); }
+    static u32x4 splat(uint32_t s) { return {{s, s, s, s}}; }
+#endif
+};
+
+#if defined(ULTRADETAIL_SIMD_NEON)
+
+inline u8x16 absDiff(u8x16 a, u8x16 b) { return {vabdq_u8(a.v, b.v)}; }
+inline u8x16 min(u8x16 a, u8x16 b) { return {vminq_u8(a.v, b.v)}; }
+inline u8x16 max(u8x16 a, u8x16 b) { return {vmaxq_u8(a.v, b.v)}; }
+
+inline u16x8 widenLow(u8x16 a) { return {vmovl_u8(vget_low_u8(a.v))}; }
+inline u16x8 widenHigh(u8x16 a) { return {vmovl_u8(vget_high_u8(a.v))}; }
+
+/** Saturating narrow of lo (bytes 0-7) and hi (bytes 8-15) */
+inline u8x16 narrowSaturate(u16x8 lo, u16x8 hi) { return {vcombine_u8(vqmovn_u16(lo.v), vqmovn_u16(hi.v))}; }
+
+inline u16x8 operator+(u16x8 a, u16x8 b) { return {vaddq_u16(a.v, b.v)}; }
+inline u16x8 operator-(u16x8 a, u16x8 b) { return {vsubq_u16(a.v, b.v)}; }
+inline u16x8 absDiff(u16x8 a, u16x8 b) { return {vabdq_u16(a.v, b.v)}; }
+inline u16x8 min(u16x8 a, u16x8 b) { return {vminq_u16(a.v, b.v)}; }
+inline u16x8 max(u16x8 a, u16x8 b) { return {vmaxq_u16(a.v, b.v)}; }
+
+/** a0 a0 a2 a2 a4 a4 a6 a6 */
+inline u16x8 duplicateEven(u16x8 a) { return {vtrnq_u16(a.v, a.v).val[0]}; }
+
+/** a0 b0 a1 b1 a2 b2 a3 b3 */
+inline u16x8 interleaveLow(u16x8 a, u16x8 b) {
+#if defined(__aarch64__)
+    return {vzip1q_u16(a.v, b.v)};
+#else
+    return {vzipq_u16(a.v, b.v).val[0]};
+#endif
+}
+
+inline f32x4 toFloatLow(u16x8 a) { return {vcvtq_f32_u32(vmovl_u16(vget_low_u16(a.v)))}; }
+inline f32x4 toFloatHigh(u16x8 a) { return {vcvtq_f32_u32(vmovl_u16(vget_high_u16(a.v)))}; }
+
+/** Truncating conversion; lanes must be in [0, 2^31) */
+inline u32x4 toUint32(f32x4 a) { return {vcvtq_u32_f32(a.v)}; }
+
+inline u32x4 operator|(u32x4 a, u32x4 b) { return {vorrq_u32(a.v, b.v)}; }
+template<int kBits> inline u32x4 shiftLeft(u32x4 a) { return {vshlq_n_u32(a.v, kBits)}; }
+
+#elif defined(ULTRADETAIL_SIMD_SSE)
+
+inline u8x16 absDiff(u8x16 a, u8x16 b) { return {_mm_or_si128(_mm_subs_epu8(a.v, b.v), _mm_subs_epu8(b.v, a.v))}; }
+inline u8x16 min(u8x16 a, u8x16 b) { return {_mm_min_epu8(a.v, b.v)}; }
+inline u8x16 max(u8x16 a, u8x16 b) { return {_mm_max_epu8(a.v, b.v)}; }
+
+inline u16x8 widenLow(u8x16 a) { return {_mm_unpacklo_epi8(a.v, _mm_setzero_si128())}; }
+inline u16x8 widenHigh(u8x16 a) { return {_mm_unpackhi_epi8(a.v, _mm_setzero_si128())}; }
+
+inline u16x8 operator+(u16x8 a, u16x8 b) { return {_mm_add_epi16(a.v, b.v)}; }
+inline u16x8 operator-(u16x8 a, u16x8 b) { return {_mm_sub_epi16(a.v, b.v)}; }
+inline u16x8 absDiff(u16x8 a, u16x8 b) { return {_mm_or_si128(_mm_subs_epu16(a.v, b.v), _mm_subs_epu16(b.v, a.v))}; }
+
+#if defined(__SSE4_1__)
+inline u16x8 min(u16x8 a, u16x8 b) { return {_mm_min_epu16(a.v, b.v)}; }
+inline u16x8 max(u16x8 a, u16x8 b) { return {_mm_max_epu16(a.v, b.v)}; }
+#else
+inline u16x8 min(u16x8 a, u16x8 b) { return {_mm_sub_epi16(a.v, _mm_subs_epu16(a.v, b.v))}; }
+inline u16x8 max(u16x8 a, u16x8 b) { return {_mm_add_epi16(b.v, _mm_subs_epu16(a.v, b.v))}; }
+#endif
+
+/** Saturating narrow of lo (bytes 0-7) and hi (bytes 8-15) */
+inline u8x16 narrowSaturate(u16x8 lo, u16x8 hi) {
+    // packus saturates signed 16-bit input: clamp to 255 first
+    const u16x8 limit = u16x8::splat(255);
+    return {_mm_packus_epi16(min(lo, limit).v, min(hi, limit).v)};
+}
+
+/** a0 a0 a2 a2 a4 a4 a6 a6 */
+inline u16x8 duplicateEven(u16x8 a) {
+    return {_mm_shufflehi_epi16(_mm_shufflelo_epi16(a.v, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 2, 0, 0))};
+}
+
+/** a0 b0 a1 b1 a2 b2 a3 b3 */
+inline u16x8 interleaveLow(u16x8 a, u16x8 b) { return {_mm_unpacklo_epi16(a.v, b.v)}; }
+
+inline f32x4 toFloatLow(u16x8 a) { return {_mm_cvtepi32_ps(_mm_unpacklo_epi16(a.v, _mm_setzero_si128()))}; }
+inline f32x4 toFloatHigh(u16x8 a) { return {_mm_cvtepi32_ps(_mm_unpackhi_epi16(a.v, _mm_setzero_si128()))}; }
+
+/** Truncating conversion; lanes must be in [0, 2^31) */
+inline u32x4 toUint32(f32x4 a) { return {_mm_cvttps_epi32(a.v)}; }
+
+inline u32x4 operator|(u32x4 a, u32x4 b) { return {_mm_or_si128(a.v, b.v)}; }
+template<int kBits> inline u32x4 shiftLeft(u32x4 a) { return {_mm_slli_epi32(a.v, kBits)}; }
+
+#else
+
+inline u8x16 absDiff(u8x16 a, u8x16 b) {
+    u8x16 r;
+    for (int i = 0; i < 16; ++i) r.v[i] = static_cast<uint8_t>(a.v[i] > b.v[i] ? a.v[i] - b.v[i] : b.v[i] - a.v[i]);
+    return r;
+}
+
+inline u8x16 min(u8x16 a, u8x16 b) { u8x16 r; for (int i = 0; i < 16; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline u8x16 max(u8x16 a, u8x16 b) { u8x16 r; for (int i = 0; i < 16; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+
+inline u16x8 widenLow(u8x16 a) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i]; return r; }
+inline u16x8 widenHigh(u8x16 a) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i + 8]; return r; }
+
+/** Saturating narrow of lo (bytes 0-7) and hi (bytes 8-15) */
+inline u8x16 narrowSaturate(u16x8 lo, u16x8 hi) {
+    u8x16 r;
+    for (int i = 0; i < 8; ++i) {
+        r.v[i] = static_cast<uint8_t>(lo.v[i] < 255 ? lo.v[i] : 255);
+        r.v[i + 8] = static_cast<uint8_t>(hi.v[i] < 255 ? hi.v[i] : 255);
+    }
+    return r;
+}
+
+inline u16x8 operator+(u16x8 a, u16x8 b) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = static_cast<uint16_t>(a.v[i] + b.v[i]); return r; }
+inline u16x8 operator-(u16x8 a, u16x8 b) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = static_cast<uint16_t>(a.v[i] - b.v[i]); return r; }
+inline u16x8 min(u16x8 a, u16x8 b) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline u16x8 max(u16x8 a, u16x8 b) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+inline u16x8 absDiff(u16x8 a, u16x8 b) { return max(a, b) - min(a, b); }
+
+/** a0 a0 a2 a2 a4 a4 a6 a6 */
+inline u16x8 duplicateEven(u16x8 a) { u16x8 r; for (int i = 0; i < 8; ++i) r.v[i] = a.v[i & ~1]; return r; }
+
+/** a0 b0 a1 b1 a2 b2 a3 b3 */
+inline u16x8 interleaveLow(u16x8 a, u16x8 b) {
+    u16x8 r;
+    for (int i = 0; i < 4; ++i) {
+        r.v[2 * i] = a.v[i];
+        r.v[2 * i + 1] = b.v[i];
+    }
+    return r;
+}
+
+inline f32x4 toFloatLow(u16x8 a) { return {{float(a.v[0]), float(a.v[1]), float(a.v[2]), float(a.v[3])}}; }
+inline f32x4 toFloatHigh(u16x8 a) { return {{float(a.v[4]), float(a.v[5]), float(a.v[6]), float(a.v[7])}}; }
+
+/** Truncating conversion; lanes must be in [0, 2^31) */
+inline u32x4 toUint32(f32x4 a) {
+    u32x4 r;
+    for (int i = 0; i < 4; ++i) r.v[i] = static_cast<uint32_t>(a.v[i]);
+    return r;
+}
+
+inline u32x4 operator|(u32x4 a, u32x4 b) { return {{a.v[0] | b.v[0], a.v[1] | b.v[1], a.v[2] | b.v[2], a.v[3] | b.v[3]}}; }
+template<int kBits> inline u32x4 shiftLeft(u32x4 a) { return {{a.v[0] << kBits, a.v[1] << kBits, a.v[2] << kBits, a.v[3] << kBits}}; }
+
+#endif
+
+} // inline namespace ULTRADETAIL_SIMD_ABI
+
+// ==================== Runtime-dispatched row kernels ====================
+
+/**
+ * Float row kernels, one implementation per instruction set
+ *
+ * Counts are in floats. The baseline set is built with the compile-time
+ * backend above; on x86 the AVX2 + FMA build is selected at runtime when
+ * the CPU supports it, kernel by kernel where it is faster. Results agree with the scalar definitions up to
+ * float rounding (summation order, fused multiply-add).
+ */
+struct RowKernels {
+    const char* name;
+
+    /** sum |a[i] - b[i]| */
+    float (*sumAbsDiff)(const float* a, const float* b, int count);
+
+    /** sum (a[i] - b[i])^2 */
+    float (*sumSquaredDiff)(const float* a, const float* b, int count);
+
+    /**
+     * 3x3 Sobel responses of the middle row: gx[i], gy[i] are centered on
+     * column i of row1 and read columns i - 1 .. i + 1 of the three rows
+     */
+    void (*sobel3x3)(const float* row0, const float* row1, const float* row2,
+                     float* gx, float* gy, int count);
+
+    /** out[i] = sqrt(gx[i]^2 + gy[i]^2) */
+    void (*magnitude)(const float* gx, const float* gy, float* out, int count);
+
+    /** dst[i] = src[2 * i] */
+    void (*decimate2x)(const float* src, float* dst, int count);
+
+    /** dst[i] = sum_k weights[k] * src[i + k - 2]; reads src[-2 .. count + 1] */
+    void (*convolve5)(const float* src, const float weights[5], float* dst, int count);
+
+    /** dst[i] = sum_k weights[k] * rows[k][i] */
+    void (*blendRows5)(const float* const rows[5], const float weights[5], float* dst, int count);
+
+    /**
+     * convolve5 evaluated at even positions only:
+     * dst[i] = sum_k weights[k] * src[2 * i + k - 2]; reads src[-2 .. 2 * count + 1]
+     */
+    void (*convolve5Decimate2x)(const float* src, const float weights[5], float* dst, int count);
+};
+
+/**
+ * Kernels built for the compile-time backend
+ */
+const RowKernels& baselineRowKernels();
+
+/**
+ * Fastest kernels for the running CPU (selected once, then cached)
+ */
+const RowKernels& rowKernels();
+
+} // namespace simd
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_SIMD_H
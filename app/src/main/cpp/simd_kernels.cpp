@@ -0,0 +1,49 @@
+/**
+ * simd_kernels.cpp - Baseline row kernels and runtime kernel selection
+ */
+
+#include "simd_row_kernels.h"
+#include "common.h"
+
+#undef LOG_TAG
+#define LOG_TAG "SIMD"
+
+namespace ultradetail {
+namespace simd {
+
+const RowKernels& baselineRowKernels() {
+    return kRowKernels;
+}
+
+static const RowKernels* selectRowKernels() {
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(ULTRADETAIL_SIMD_SCALAR)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        if (const RowKernels* avx2 = avx2RowKernels()) {
+            // Chosen per kernel: the AVX2 Sobel makes eight unaligned 32-byte
+            // loads per step, which stall on 4K aliasing against the gradient
+            // rows at power-of-2 widths (0.9x of the plain loop against 1.2x
+            // for the baseline build in the SIMD_KERNELS benchmark)
+            static const RowKernels mixed = [avx2] {
+                RowKernels kernels = *avx2;
+                kernels.sobel3x3 = kRowKernels.sobel3x3;
+                return kernels;
+            }();
+            return &mixed;
+        }
+    }
+#endif
+    return &kRowKernels;
+}
+
+const RowKernels& rowKernels() {
+    static const RowKernels* selected = [] {
+        const RowKernels* kernels = selectRowKernels();
+        LOGI("Row kernels: %s", kernels->name);
+        return kernels;
+    }();
+    return *selected;
+}
+
+} // namespace simd
+} // namespace ultradetail
@@ -0,0 +1,38 @@
+/**
+ * simd_kernels_avx2.cpp - Row kernels built with AVX2 + FMA
+ *
+ * CMake compiles this file with -mavx2 -mfma on x86 ABIs only; nothing
+ * else in the library uses those flags. rowKernels() takes kernels from
+ * this build after checking the CPU, so it never runs on processors
+ * without AVX2.
+ */
+
+#include "simd.h"
+
+#if defined(ULTRADETAIL_SIMD_AVX2)
+
+#include "simd_row_kernels.h"
+
+namespace ultradetail {
+namespace simd {
+
+const RowKernels* avx2RowKernels() {
+    return &kRowKernels;
+}
+
+} // namespace simd
+} // namespace ultradetail
+
+#else
+
+namespace ultradetail {
+namespace simd {
+
+const RowKernels* avx2RowKernels() {
+    return nullptr;
+}
+
+} // namespace simd
+} // namespace ultradetail
+
+#endif
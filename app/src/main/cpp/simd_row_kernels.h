@@ -0,0 +1,175 @@
+/**
+ * simd_row_kernels.h - Row kernel bodies shared by every instruction-set build
+ *
+ * Included once by simd_kernels.cpp (compile-time backend) and once by
+ * simd_kernels_avx2.cpp (built with AVX2 + FMA). Each inclusion defines the
+ * kernels with internal linkage inside the backend's inline namespace, so
+ * the builds never share symbols. Written on f32x8, which is a pair of
+ * f32x4 outside the AVX2 build.
+ */
+
+#ifndef ULTRADETAIL_SIMD_ROW_KERNELS_H
+#define ULTRADETAIL_SIMD_ROW_KERNELS_H
+
+#include "simd.h"
+
+namespace ultradetail {
+namespace simd {
+
+/**
+ * AVX2 + FMA kernels, or nullptr when simd_kernels_avx2.cpp was built
+ * without those flags (non-x86 targets)
+ */
+const RowKernels* avx2RowKernels();
+
+inline namespace ULTRADETAIL_SIMD_ABI {
+
+static float sumAbsDiffRow(const float* a, const float* b, int count) {
+    f32x8 acc = f32x8::zero();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc = acc + absDiff(f32x8::load(a + i), f32x8::load(b + i));
+    }
+    float sum = horizontalSum(acc);
+    for (; i < count; ++i) {
+        sum += std::fabs(a[i] - b[i]);
+    }
+    return sum;
+}
+
+static float sumSquaredDiffRow(const float* a, const float* b, int count) {
+    f32x8 acc = f32x8::zero();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        f32x8 d = f32x8::load(a + i) - f32x8::load(b + i);
+        acc = fma(d, d, acc);
+    }
+    float sum = horizontalSum(acc);
+    for (; i < count; ++i) {
+        float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+static void sobel3x3Row(const float* row0, const float* row1, const float* row2,
+                        float* gx, float* gy, int count) {
+    const f32x8 two = f32x8::splat(2.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        f32x8 l0 = f32x8::load(row0 + i - 1), r0 = f32x8::load(row0 + i + 1);
+        f32x8 l1 = f32x8::load(row1 + i - 1), r1 = f32x8::load(row1 + i + 1);
+        f32x8 l2 = f32x8::load(row2 + i - 1), r2 = f32x8::load(row2 + i + 1);
+        f32x8 c0 = f32x8::load(row0 + i), c2 = f32x8::load(row2 + i);
+
+        // [-1 0 1; -2 0 2; -1 0 1] and its transpose
+        fma(two, r1 - l1, (r0 - l0) + (r2 - l2)).store(gx + i);
+        fma(two, c2 - c0, (l2 - l0) + (r2 - r0)).store(gy + i);
+    }
+    for (; i < count; ++i) {
+        gx[i] = 2.0f * (row1[i + 1] - row1[i - 1]) + ((row0[i + 1] - row0[i - 1]) + (row2[i + 1] - row2[i - 1]));
+        gy[i] = 2.0f * (row2[i] - row0[i]) + ((row2[i - 1] - row0[i - 1]) + (row2[i + 1] - row0[i + 1]));
+    }
+}
+
+static void magnitudeRow(const float* gx, const float* gy, float* out, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        f32x8 x = f32x8::load(gx + i);
+        f32x8 y = f32x8::load(gy + i);
+        sqrt(fma(x, x, y * y)).store(out + i);
+    }
+    for (; i < count; ++i) {
+        out[i] = std::sqrt(gx[i] * gx[i] + gy[i] * gy[i]);
+    }
+}
+
+static void decimate2xRow(const float* src, float* dst, int count) {
+    // Left to the compiler: its vectorized strided copy beats the paired
+    // deinterleave on SSE2 (about 0.5x of this loop) and ties it on AVX2
+    for (int i = 0; i < count; ++i) {
+        dst[i] = src[2 * i];
+    }
+}
+
+static void convolve5Row(const float* src, const float weights[5], float* dst, int count) {
+    const f32x8 w0 = f32x8::splat(weights[0]), w1 = f32x8::splat(weights[1]);
+    const f32x8 w2 = f32x8::splat(weights[2]), w3 = f32x8::splat(weights[3]);
+    const f32x8 w4 = f32x8::splat(weights[4]);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        f32x8 sum = w0 * f32x8::load(src + i - 2);
+        sum = fma(w1, f32x8::load(src + i - 1), sum);
+        sum = fma(w2, f32x8::load(src + i), sum);
+        sum = fma(w3, f32x8::load(src + i + 1), sum);
+        sum = fma(w4, f32x8::load(src + i + 2), sum);
+        sum.store(dst + i);
+    }
+    for (; i < count; ++i) {
+        float sum = 0.0f;
+        for (int k = 0; k < 5; ++k) {
+            sum += weights[k] * src[i + k - 2];
+        }
+        dst[i] = sum;
+    }
+}
+
+static void blendRows5Row(const float* const rows[5], const float weights[5], float* dst, int count) {
+    // Also left to the compiler, which vectorizes it at the build's width
+    // (FMA contracted on AVX2); the row pointers are copied so the stores
+    // through dst do not force a reload of each one per iteration
+    const float* r0 = rows[0];
+    const float* r1 = rows[1];
+    const float* r2 = rows[2];
+    const float* r3 = rows[3];
+    const float* r4 = rows[4];
+    const float w0 = weights[0], w1 = weights[1], w2 = weights[2], w3 = weights[3], w4 = weights[4];
+    for (int i = 0; i < count; ++i) {
+        dst[i] = w0 * r0[i] + w1 * r1[i] + w2 * r2[i] + w3 * r3[i] + w4 * r4[i];
+    }
+}
+
+static void convolve5Decimate2xRow(const float* src, const float weights[5], float* dst, int count) {
+    const f32x8 w0 = f32x8::splat(weights[0]), w1 = f32x8::splat(weights[1]);
+    const f32x8 w2 = f32x8::splat(weights[2]), w3 = f32x8::splat(weights[3]);
+    const f32x8 w4 = f32x8::splat(weights[4]);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Even/odd phases starting at src[2i - 2], src[2i] and src[2i + 2]
+        f32x8 e0, o0, e1, o1, e2, o2;
+        loadDeinterleaved2(src + 2 * i - 2, e0, o0);
+        loadDeinterleaved2(src + 2 * i, e1, o1);
+        loadDeinterleaved2(src + 2 * i + 2, e2, o2);
+        f32x8 sum = w0 * e0;
+        sum = fma(w1, o0, sum);
+        sum = fma(w2, e1, sum);
+        sum = fma(w3, o1, sum);
+        sum = fma(w4, e2, sum);
+        sum.store(dst + i);
+    }
+    for (; i < count; ++i) {
+        float sum = 0.0f;
+        for (int k = 0; k < 5; ++k) {
+            sum += weights[k] * src[2 * i + k - 2];
+        }
+        dst[i] = sum;
+    }
+}
+
+static const RowKernels kRowKernels = {
+    kBackendName,
+    sumAbsDiffRow,
+    sumSquaredDiffRow,
+    sobel3x3Row,
+    magnitudeRow,
+    decimate2xRow,
+    convolve5Row,
+    blendRows5Row,
+    convolve5Decimate2xRow
+};
+
+} // inline namespace ULTRADETAIL_SIMD_ABI
+} // namespace simd
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_SIMD_ROW_KERNELS_H
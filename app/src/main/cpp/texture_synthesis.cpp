@@ -5,7 +5,8 @@
  */
 
 #include "texture_synthesis.h"
-#include "neon_utils.h"
+#include "local_moments.h"
+#include "simd.h"
 #include <cmath>
 #include <algorithm>
 #include <random>
@@ -17,155 +18,22 @@ TextureSynthProcessor::TextureSynthProcessor(const TextureSynthParams& params)
     : params_(params) {
 }
 
-float TextureSynthProcessor::computeLocalVariance(
-    const RGBImage& image,
-    int x, int y,
-    int radius
-) {
-#ifdef USE_NEON
-    // NEON SIMD vectorized variance computation
-    float32x4_t sumRGB = vdupq_n_f32(0.0f);  // [sumR, sumG, sumB, 0]
-    float32x4_t sumRGB2 = vdupq_n_f32(0.0f); // [sumR2, sumG2, sumB2, 0]
-    int count = 0;
-    
-    for (int dy = -radius; dy <= radius; ++dy) {
-        int py = y + dy;
-        if (py < 0 || py >= image.height) continue;
-        
-        int dx = -radius;
-        // Process 4 pixels at a time with NEON
-        for (; dx <= radius - 3; dx += 4) {
-            int px = x + dx;
-            if (px < 0 || px + 3 >= image.width) {
-                // Scalar fallback for boundary
-                for (int i = 0; i < 4 && dx + i <= radius; ++i) {
-                    int px_i = x + dx + i;
-                    if (px_i >= 0 && px_i < image.width) {
-                        const RGBPixel& p = image.at(px_i, py);
-                        sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 0) + p.r, sumRGB, 0);
-                        sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 1) + p.g, sumRGB, 1);
-                        sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 2) + p.b, sumRGB, 2);
-                        sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 0) + p.r * p.r, sumRGB2, 0);
-                        sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 1) + p.g * p.g, sumRGB2, 1);
-                        sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 2) + p.b * p.b, sumRGB2, 2);
-                        count++;
-                    }
-                }
-                continue;
-            }
-            
-            // Load 4 RGB pixels
-            float32x4_t r = {image.at(px, py).r, image.at(px+1, py).r,
-                             image.at(px+2, py).r, image.at(px+3, py).r};
-            float32x4_t g = {image.at(px, py).g, image.at(px+1, py).g,
-                             image.at(px+2, py).g, image.at(px+3, py).g};
-            float32x4_t b = {image.at(px, py).b, image.at(px+1, py).b,
-                             image.at(px+2, py).b, image.at(px+3, py).b};
-            
-            // Accumulate sums (manual horizontal add for ARMv7 compatibility)
-            float32x2_t r_low = vget_low_f32(r);
-            float32x2_t r_high = vget_high_f32(r);
-            float sumR = vget_lane_f32(vpadd_f32(r_low, r_high), 0) + vget_lane_f32(vpadd_f32(r_low, r_high), 1);
-            
-            float32x2_t g_low = vget_low_f32(g);
-            float32x2_t g_high = vget_high_f32(g);
-            float sumG = vget_lane_f32(vpadd_f32(g_low, g_high), 0) + vget_lane_f32(vpadd_f32(g_low, g_high), 1);
-            
-            float32x2_t b_low = vget_low_f32(b);
-            float32x2_t b_high = vget_high_f32(b);
-            float sumB = vget_lane_f32(vpadd_f32(b_low, b_high), 0) + vget_lane_f32(vpadd_f32(b_low, b_high), 1);
-            
-            sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 0) + sumR, sumRGB, 0);
-            sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 1) + sumG, sumRGB, 1);
-            sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 2) + sumB, sumRGB, 2);
-            
-            // Accumulate squared sums
-            float32x4_t r2 = vmulq_f32(r, r);
-            float32x4_t g2 = vmulq_f32(g, g);
-            float32x4_t b2 = vmulq_f32(b, b);
-            
-            float32x2_t r2_low = vget_low_f32(r2);
-            float32x2_t r2_high = vget_high_f32(r2);
-            float sumR2 = vget_lane_f32(vpadd_f32(r2_low, r2_high), 0) + vget_lane_f32(vpadd_f32(r2_low, r2_high), 1);
-            
-            float32x2_t g2_low = vget_low_f32(g2);
-            float32x2_t g2_high = vget_high_f32(g2);
-            float sumG2 = vget_lane_f32(vpadd_f32(g2_low, g2_high), 0) + vget_lane_f32(vpadd_f32(g2_low, g2_high), 1);
-            
-            float32x2_t b2_low = vget_low_f32(b2);
-            float32x2_t b2_high = vget_high_f32(b2);
-            float sumB2 = vget_lane_f32(vpadd_f32(b2_low, b2_high), 0) + vget_lane_f32(vpadd_f32(b2_low, b2_high), 1);
-            
-            sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 0) + sumR2, sumRGB2, 0);
-            sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 1) + sumG2, sumRGB2, 1);
-            sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 2) + sumB2, sumRGB2, 2);
-            
-            count += 4;
-        }
-        
-        // Handle remaining pixels
-        for (; dx <= radius; ++dx) {
-            int px = x + dx;
-            if (px < 0 || px >= image.width) continue;
-            
-            const RGBPixel& p = image.at(px, py);
-            sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 0) + p.r, sumRGB, 0);
-            sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 1) + p.g, sumRGB, 1);
-            sumRGB = vsetq_lane_f32(vgetq_lane_f32(sumRGB, 2) + p.b, sumRGB, 2);
-            sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 0) + p.r * p.r, sumRGB2, 0);
-            sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 1) + p.g * p.g, sumRGB2, 1);
-            sumRGB2 = vsetq_lane_f32(vgetq_lane_f32(sumRGB2, 2) + p.b * p.b, sumRGB2, 2);
-            count++;
-        }
-    }
-    
-    if (count < 2) return 0;
-    
-    float invN = 1.0f / count;
-    float sumR = vgetq_lane_f32(sumRGB, 0);
-    float sumG = vgetq_lane_f32(sumRGB, 1);
-    float sumB = vgetq_lane_f32(sumRGB, 2);
-    float sumR2 = vgetq_lane_f32(sumRGB2, 0);
-    float sumG2 = vgetq_lane_f32(sumRGB2, 1);
-    float sumB2 = vgetq_lane_f32(sumRGB2, 2);
-    
-    float varR = sumR2 * invN - (sumR * invN) * (sumR * invN);
-    float varG = sumG2 * invN - (sumG * invN) * (sumG * invN);
-    float varB = sumB2 * invN - (sumB * invN) * (sumB * invN);
-    
-    return (varR + varG + varB) / 3.0f;
-#else
-    // Scalar fallback
-    float sumR = 0, sumG = 0, sumB = 0;
-    float sumR2 = 0, sumG2 = 0, sumB2 = 0;
-    int count = 0;
-    
-    for (int dy = -radius; dy <= radius; ++dy) {
-        int py = y + dy;
-        if (py < 0 || py >= image.height) continue;
-        
-        for (int dx = -radius; dx <= radius; ++dx) {
-            int px = x + dx;
-            if (px < 0 || px >= image.width) continue;
-            
-            const RGBPixel& p = image.at(px, py);
-            sumR += p.r; sumG += p.g; sumB += p.b;
-            sumR2 += p.r * p.r;
-            sumG2 += p.g * p.g;
-            sumB2 += p.b * p.b;
-            count++;
+/**
+ * Variance of each pixel's (2 * radius + 1)² window (clipped to the image),
+ * averaged over the three channels
+ */
+static void computeVarianceMap(const RGBImage& image, int radius, GrayImage& out) {
+    RGBImage channelVariance;
+    computeLocalMoments(image, radius, WindowBorder::CLIP, nullptr, &channelVariance);
+    
+    out.resize(image.width, image.height);
+    for (int y = 0; y < image.height; ++y) {
+        const RGBPixel* varRow = channelVariance.row(y);
+        float* outRow = out.row(y);
+        for (int x = 0; x < image.width; ++x) {
+            outRow[x] = (varRow[x].r + varRow[x].g + varRow[x].b) / 3.0f;
         }
     }
-    
-    if (count < 2) return 0;
-    
-    float invN = 1.0f / count;
-    float varR = sumR2 * invN - (sumR * invN) * (sumR * invN);
-    float varG = sumG2 * invN - (sumG * invN) * (sumG * invN);
-    float varB = sumB2 * invN - (sumB * invN) * (sumB * invN);
-    
-    return (varR + varG + varB) / 3.0f;
-#endif
 }
 
 float TextureSynthProcessor::computeEdgeMagnitude(
@@ -200,97 +68,30 @@ float TextureSynthProcessor::computePatchSSD(
     float ssd = 0;
     int count = 0;
     
-#ifdef USE_NEON
-    // NEON SIMD vectorized version - process 4 pixels at once
-    for (int dy = -half; dy <= half; ++dy) {
-        int py1 = y1 + dy, py2 = y2 + dy;
-        if (py1 < 0 || py1 >= image.height || py2 < 0 || py2 >= image.height) continue;
-        
-        int dx = -half;
-        // Process 4 pixels at a time with NEON
-        for (; dx <= half - 3; dx += 4) {
-            int px1 = x1 + dx, px2 = x2 + dx;
-            if (px1 < 0 || px1 + 3 >= image.width || px2 < 0 || px2 + 3 >= image.width) {
-                // Fallback to scalar for boundary pixels
-                for (int i = 0; i < 4 && dx + i <= half; ++i) {
-                    int px1_i = x1 + dx + i, px2_i = x2 + dx + i;
-                    if (px1_i >= 0 && px1_i < image.width && px2_i >= 0 && px2_i < image.width) {
-                        const RGBPixel& p1 = image.at(px1_i, py1);
-                        const RGBPixel& p2 = image.at(px2_i, py2);
-                        float dr = p1.r - p2.r, dg = p1.g - p2.g, db = p1.b - p2.b;
-                        ssd += dr * dr + dg * dg + db * db;
-                        count++;
-                    }
-                }
-                continue;
-            }
-            
-            // Load 4 RGB pixels from each patch
-            float32x4_t r1 = {image.at(px1, py1).r, image.at(px1+1, py1).r, 
-                              image.at(px1+2, py1).r, image.at(px1+3, py1).r};
-            float32x4_t g1 = {image.at(px1, py1).g, image.at(px1+1, py1).g,
-                              image.at(px1+2, py1).g, image.at(px1+3, py1).g};
-            float32x4_t b1 = {image.at(px1, py1).b, image.at(px1+1, py1).b,
-                              image.at(px1+2, py1).b, image.at(px1+3, py1).b};
-            
-            float32x4_t r2 = {image.at(px2, py2).r, image.at(px2+1, py2).r,
-                              image.at(px2+2, py2).r, image.at(px2+3, py2).r};
-            float32x4_t g2 = {image.at(px2, py2).g, image.at(px2+1, py2).g,
-                              image.at(px2+2, py2).g, image.at(px2+3, py2).g};
-            float32x4_t b2 = {image.at(px2, py2).b, image.at(px2+1, py2).b,
-                              image.at(px2+2, py2).b, image.at(px2+3, py2).b};
-            
-            // Compute squared differences using NEON
-            ssd += neon::ssd_f32x4(r1, r2);
-            ssd += neon::ssd_f32x4(g1, g2);
-            ssd += neon::ssd_f32x4(b1, b2);
-            count += 4;
-        }
-        
-        // Handle remaining pixels with scalar code
-        for (; dx <= half; ++dx) {
-            int px1 = x1 + dx, px2 = x2 + dx;
-            if (px1 < 0 || px1 >= image.width || px2 < 0 || px2 >= image.width) continue;
-            
-            const RGBPixel& p1 = image.at(px1, py1);
-            const RGBPixel& p2 = image.at(px2, py2);
-            
-            float dr = p1.r - p2.r;
-            float dg = p1.g - p2.g;
-            float db = p1.b - p2.b;
-            
-            ssd += dr * dr + dg * dg + db * db;
-            count++;
-        }
-    }
-#else
-    // Scalar fallback for non-NEON platforms
+    // Columns inside the image for both patches form one contiguous run;
+    // RGBPixel rows are packed floats, so a run is 3 floats per pixel
+    const int dx0 = std::max({-half, -x1, -x2});
+    const int dx1 = std::min({half, image.width - 1 - x1, image.width - 1 - x2});
+    if (dx1 < dx0) return 1e10f;
+    const int runPixels = dx1 - dx0 + 1;
+    const simd::RowKernels& kernels = simd::rowKernels();
+    
     for (int dy = -half; dy <= half; ++dy) {
         int py1 = y1 + dy, py2 = y2 + dy;
         if (py1 < 0 || py1 >= image.height || py2 < 0 || py2 >= image.height) continue;
         
-        for (int dx = -half; dx <= half; ++dx) {
-            int px1 = x1 + dx, px2 = x2 + dx;
-            if (px1 < 0 || px1 >= image.width || px2 < 0 || px2 >= image.width) continue;
-            
-            const RGBPixel& p1 = image.at(px1, py1);
-            const RGBPixel& p2 = image.at(px2, py2);
-            
-            float dr = p1.r - p2.r;
-            float dg = p1.g - p2.g;
-            float db = p1.b - p2.b;
-            
-            ssd += dr * dr + dg * dg + db * db;
-            count++;
-        }
+        ssd += kernels.sumSquaredDiff(reinterpret_cast<const float*>(image.row(py1) + x1 + dx0),
+                                      reinterpret_cast<const float*>(image.row(py2) + x2 + dx0),
+                                      3 * runPixels);
+        count += runPixels;
     }
-#endif
     
     return count > 0 ? ssd / count : 1e10f;
 }
 
 TexturePatch TextureSynthProcessor::findBestPatch(
     const RGBImage& image,
+    const GrayImage& varianceMap,
     int targetX, int targetY,
     const RGBPixel& targetColor,
     float targetVariance
@@ -344,7 +145,7 @@ TexturePatch TextureSynthProcessor::findBestPatch(
         int sy = candidate.second;
         
         // Check variance similarity
-        float srcVariance = computeLocalVariance(image, sx, sy, half);
+        float srcVariance = varianceMap.at(sx, sy);
         if (srcVariance < params_.varianceThreshold) continue;
         
         // Color similarity
@@ -425,6 +226,8 @@ DetailMap TextureSynthProcessor::computeDetailMap(const RGBImage& input) {
     map.resize(input.width, input.height);
     
     int radius = params_.patchSize / 2;
+    computeVarianceMap(input, radius, map.variance);
+    
     int pixelsNeedingSynthesis = 0;
     int totalPixels = input.width * input.height;
     
@@ -434,9 +237,7 @@ DetailMap TextureSynthProcessor::computeDetailMap(const RGBImage& input) {
     
     for (int y = 0; y < input.height; ++y) {
         for (int x = 0; x < input.width; ++x) {
-            // Compute local variance
-            float var = computeLocalVariance(input, x, y, radius);
-            map.variance.at(x, y) = var;
+            float var = map.variance.at(x, y);
             
             // Compute edge magnitude
             float edge = computeEdgeMagnitude(input, x, y);
@@ -564,7 +365,7 @@ TextureSynthResult TextureSynthProcessor::synthesizeGuided(
             // Find best matching patch with more texture
             float targetVar = detailMap.variance.at(x, y);
             TexturePatch bestPatch = findBestPatch(
-                input, x, y,
+                input, detailMap.variance, x, y,
                 input.at(x, y),
                 targetVar
             );
@@ -632,16 +433,17 @@ RGBImage TextureSynthProcessor::transferTexture(
     
     int half = params_.patchSize / 2;
     
+    GrayImage srcVariance, tgtVariance;
+    computeVarianceMap(source, half, srcVariance);
+    computeVarianceMap(target, half, tgtVariance);
+    
     for (int y = half; y < target.height - half; ++y) {
         for (int x = half; x < target.width - half; ++x) {
             float m = mask.at(x, y);
             if (m < 0.01f) continue;
             
             // Extract high-frequency detail from source
-            float srcVar = computeLocalVariance(source, x, y, half);
-            float tgtVar = computeLocalVariance(target, x, y, half);
-            
-            if (srcVar > tgtVar) {
+            if (srcVariance.at(x, y) > tgtVariance.at(x, y)) {
                 // Transfer detail
                 const RGBPixel& src = source.at(x, y);
                 RGBPixel& tgt = result.at(x, y);
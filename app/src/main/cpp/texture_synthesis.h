@@ -156,9 +156,12 @@ private:
     
     /**
      * Find best matching patch in search region
+     * 
+     * @param varianceMap Local variance of image at the patch radius (DetailMap::variance)
      */
     TexturePatch findBestPatch(
         const RGBImage& image,
+        const GrayImage& varianceMap,
         int targetX, int targetY,
         const RGBPixel& targetColor,
         float targetVariance
@@ -174,15 +177,6 @@ private:
         int patchSize
     );
     
-    /**
-     * Compute local variance at a point
-     */
-    float computeLocalVariance(
-        const RGBImage& image,
-        int x, int y,
-        int radius
-    );
-    
     /**
      * Blend synthesized patch into output
      */
@@ -193,7 +193,6 @@ TiledTextureSynthProcessor::TiledTextureSynthProcessor(const TileSynthConfig& co
     : config_(config)
     , gpuAvailable_(false)
     , gpuContext_(nullptr)
-    , shutdown_(false)
     , tilesProcessedCPU_(0)
     , tilesProcessedGPU_(0) {
     
@@ -230,41 +229,8 @@ void TiledTextureSynthProcessor::initializeCPUWorkers() {
         );
     }
     
-    // Create thread pool
-    cpuThreads_.reserve(numThreads);
-    for (int i = 0; i < numThreads; ++i) {
-        cpuThreads_.emplace_back([this, i]() {
-            LOGD("CPU thread %d started", i);
-            
-            while (!shutdown_.load()) {
-                std::function<void()> task;
-                
-                {
-                    std::unique_lock<std::mutex> lock(queueMutex_);
-                    queueCV_.wait(lock, [this]() {
-                        return shutdown_.load() || !taskQueue_.empty();
-                    });
-                    
-                    if (shutdown_.load() && taskQueue_.empty()) {
-                        break;
-                    }
-                    
-                    if (!taskQueue_.empty()) {
-                        task = std::move(taskQueue_.front());
-                        taskQueue_.pop();
-                    }
-                }
-                
-                if (task) {
-                    task();
-                }
-            }
-            
-            LOGD("CPU thread %d stopped", i);
-        });
-    }
-    
-    LOGD("CPU thread pool initialized with %d threads", numThreads);
+    LOGD("CPU tile workers initialized: %d (shared pool has %d threads)",
+         numThreads, ThreadPool::instance().concurrency());
 }
 
 bool TiledTextureSynthProcessor::initializeGPU() {
@@ -275,22 +241,12 @@ bool TiledTextureSynthProcessor::initializeGPU() {
 }
 
 void TiledTextureSynthProcessor::shutdown() {
-    if (shutdown_.load()) return;
+    if (cpuWorkers_.empty()) return;
     
     LOGD("TiledTextureSynthProcessor: Shutting down...");
     
-    // Signal shutdown
-    shutdown_.store(true);
-    queueCV_.notify_all();
-    
-    // Wait for threads to finish
-    for (auto& thread : cpuThreads_) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
-    
-    cpuThreads_.clear();
+    // Tiles run on the shared pool and are always joined in processTilesParallel,
+    // so only the per-worker synthesis state needs releasing here
     cpuWorkers_.clear();
     
     LOGD("TiledTextureSynthProcessor: Shutdown complete");
@@ -360,37 +316,48 @@ std::vector<TextureTileResult> TiledTextureSynthProcessor::processTilesParallel(
 ) {
     const auto& tiles = layout.getTiles();
     std::vector<TextureTileResult> results(tiles.size());
-    std::vector<std::future<TextureTileResult>> futures;
-    futures.reserve(tiles.size());
-    
-    // Submit all tiles as tasks
-    for (size_t i = 0; i < tiles.size(); ++i) {
-        const TextureTileRegion& region = tiles[i];
+    const int numTiles = static_cast<int>(tiles.size());
+    
+    // Each CPU worker owns its synthesis state, so at most one task per worker is in
+    // flight. A worker's task processes one tile and then requeues itself for the
+    // next unclaimed tile; tiles of uneven cost are balanced by the shared pool.
+    TaskGroup group;
+    std::atomic<int> nextTile(0);
+    std::atomic<int> completed(0);
+    
+    std::function<void(int)> runNextTile = [&](int workerIdx) {
+        int i = nextTile.fetch_add(1);
+        if (i >= numTiles) return;
         
+        const TextureTileRegion& region = tiles[i];
         if (region.useGPU && gpuAvailable_) {
             // GPU tile - process directly (for now, fallback to CPU)
             // Phase 2.3-2.5 will implement actual GPU processing
-            futures.push_back(std::async(std::launch::async, [this, &input, region]() {
-                return processTileCPU(input, region);  // Temporary fallback
-            }));
+            results[i] = processTileCPU(input, region, workerIdx);  // Temporary fallback
         } else {
-            // CPU tile - submit to thread pool
-            futures.push_back(std::async(std::launch::async, [this, &input, region]() {
-                return processTileCPU(input, region);
-            }));
+            results[i] = processTileCPU(input, region, workerIdx);
         }
-    }
-    
-    // Collect results with progress reporting
-    int completed = 0;
-    for (size_t i = 0; i < futures.size(); ++i) {
-        results[i] = futures[i].get();
         completed++;
         
-        // Report progress on every tile for responsive UI feedback
-        if (config_.progressCallback) {
-            config_.progressCallback(completed, (int)futures.size(), 0.0f);
+        group.run([&runNextTile, workerIdx]() { runNextTile(workerIdx); });
+    };
+    
+    int numRunners = std::min(static_cast<int>(cpuWorkers_.size()), numTiles);
+    for (int w = 0; w < numRunners; ++w) {
+        group.run([&runNextTile, w]() { runNextTile(w); });
+    }
+    
+    // Report progress on every tile for responsive UI feedback. Progress is only
+    // reported from this (calling) thread; waiting also helps process tiles.
+    int lastReported = 0;
+    bool done = false;
+    while (!done) {
+        done = group.waitFor(std::chrono::milliseconds(20));
+        int current = completed.load();
+        if (current > lastReported && config_.progressCallback) {
+            config_.progressCallback(current, numTiles, 0.0f);
         }
+        lastReported = current;
     }
     
     return results;
@@ -398,10 +365,10 @@ std::vector<TextureTileResult> TiledTextureSynthProcessor::processTilesParallel(
 
 TextureTileResult TiledTextureSynthProcessor::processTileCPU(
     const RGBImage& input,
-    const TextureTileRegion& region
+    const TextureTileRegion& region,
+    int workerIdx
 ) {
-    // Select worker (round-robin based on tile index)
-    int workerIdx = region.tileIndex % cpuWorkers_.size();
+    // The caller guarantees exclusive use of this worker for the duration of the tile
     TextureTileResult result = cpuWorkers_[workerIdx]->processTile(input, region);
     
     if (result.success) {
@@ -413,12 +380,13 @@ TextureTileResult TiledTextureSynthProcessor::processTileCPU(
 
 TextureTileResult TiledTextureSynthProcessor::processTileGPU(
     const RGBImage& input,
-    const TextureTileRegion& region
+    const TextureTileRegion& region,
+    int workerIdx
 ) {
     // Phase 2.3-2.5: GPU tile processing will be implemented here
     // For now, fallback to CPU
     LOGD("GPU tile processing not yet implemented, using CPU fallback");
-    return processTileCPU(input, region);
+    return processTileCPU(input, region, workerIdx);
 }
 
 RGBImage TiledTextureSynthProcessor::blendTiles(
@@ -11,12 +11,8 @@
 #define ULTRADETAIL_TEXTURE_SYNTHESIS_TILED_H
 
 #include "texture_synthesis.h"
-#include <thread>
-#include <mutex>
-#include <condition_variable>
-#include <queue>
+#include "thread_pool.h"
 #include <atomic>
-#include <future>
 
 namespace ultradetail {
 
@@ -53,7 +49,7 @@ struct TileSynthConfig {
     int tileSize = 512;              // Base tile size (core region)
     int overlap = 96;                // Overlap between tiles for blending (increased for smoother transitions)
     bool useGPU = true;              // Enable GPU processing
-    int numCPUThreads = 4;           // CPU worker threads
+    int numCPUThreads = 4;           // Max concurrent CPU tiles (run on the shared pool)
     int numGPUStreams = 2;           // Concurrent GPU command streams
     TileScheduleMode mode = TileScheduleMode::ALTERNATING;
     TextureSynthParams synthParams;  // Base synthesis parameters
@@ -185,7 +181,7 @@ public:
     
 private:
     /**
-     * Initialize CPU thread pool
+     * Initialize per-thread CPU tile workers
      */
     void initializeCPUWorkers();
     
@@ -208,14 +204,14 @@ private:
     );
     
     /**
-     * Process a single tile on CPU
+     * Process a single tile on CPU using the given (exclusively held) worker
      */
-    TextureTileResult processTileCPU(const RGBImage& input, const TextureTileRegion& region);
+    TextureTileResult processTileCPU(const RGBImage& input, const TextureTileRegion& region, int workerIdx);
     
     /**
-     * Process a single tile on GPU
+     * Process a single tile on GPU (CPU fallback uses the given worker)
      */
-    TextureTileResult processTileGPU(const RGBImage& input, const TextureTileRegion& region);
+    TextureTileResult processTileGPU(const RGBImage& input, const TextureTileRegion& region, int workerIdx);
     
     /**
      * Blend tiles into final output
@@ -240,13 +236,8 @@ private:
     TileSynthConfig config_;
     bool gpuAvailable_;
     
-    // CPU thread pool
+    // CPU tile workers (tiles execute on the shared ThreadPool)
     std::vector<std::unique_ptr<CPUTileWorker>> cpuWorkers_;
-    std::vector<std::thread> cpuThreads_;
-    std::queue<std::function<void()>> taskQueue_;
-    std::mutex queueMutex_;
-    std::condition_variable queueCV_;
-    std::atomic<bool> shutdown_;
     
     // GPU resources (placeholder for Phase 2.3-2.5)
     void* gpuContext_;  // Will be GLContext or similar
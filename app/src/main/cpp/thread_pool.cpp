@@ -0,0 +1,309 @@
+/**
+ * thread_pool.cpp - Work-stealing thread pool implementation
+ */
+
+#include "thread_pool.h"
+
+#undef LOG_TAG
+#define LOG_TAG "ThreadPool"
+
+namespace ultradetail {
+
+// Pool and worker index of the calling thread (set for pool workers only)
+static thread_local ThreadPool* t_workerPool = nullptr;
+static thread_local int t_workerIndex = -1;
+
+// Pool installed by ScopedPool on the calling thread
+static thread_local ThreadPool* t_scopedPool = nullptr;
+
+ThreadPool& ThreadPool::instance() {
+    if (t_scopedPool) return *t_scopedPool;
+    if (t_workerPool) return *t_workerPool;
+    
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::ThreadPool(int numWorkers)
+    : queuedTasks_(0), nextQueue_(0), shutdown_(false) {
+
+    if (numWorkers < 0) {
+        numWorkers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+
+    queues_.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    workers_.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+
+    LOGI("ThreadPool initialized with %d workers", numWorkers);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        shutdown_.store(true);
+    }
+    sleepCV_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+int ThreadPool::currentWorkerIndex() const {
+    return t_workerPool == this ? t_workerIndex : -1;
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (queues_.empty()) {
+        // Inline pool: no workers to hand the task to
+        task();
+        return;
+    }
+    
+    int index = currentWorkerIndex();
+    if (index < 0) {
+        index = static_cast<int>(nextQueue_.fetch_add(1) % queues_.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    queuedTasks_.fetch_add(1);
+
+    // Take the sleep mutex so a worker between its empty check and wait cannot miss this
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    sleepCV_.notify_one();
+}
+
+bool ThreadPool::popTask(int preferredQueue, std::function<void()>& task) {
+    if (queuedTasks_.load() == 0) return false;
+
+    const int numQueues = static_cast<int>(queues_.size());
+
+    // Own queue first, newest task (LIFO keeps the working set warm)
+    if (preferredQueue >= 0) {
+        WorkerQueue& own = *queues_[preferredQueue];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queuedTasks_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Steal the oldest task from another queue (FIFO takes the largest remaining work)
+    int start = preferredQueue >= 0 ? preferredQueue + 1 : static_cast<int>(nextQueue_.load() % numQueues);
+    for (int k = 0; k < numQueues; ++k) {
+        int victim = (start + k) % numQueues;
+        if (victim == preferredQueue) continue;
+
+        WorkerQueue& queue = *queues_[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queuedTasks_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::runPendingTask() {
+    std::function<void()> task;
+    if (!popTask(currentWorkerIndex(), task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(int index) {
+    t_workerPool = this;
+    t_workerIndex = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (popTask(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCV_.wait(lock, [this]() {
+            return shutdown_.load() || queuedTasks_.load() > 0;
+        });
+        if (shutdown_.load() && queuedTasks_.load() == 0) {
+            break;
+        }
+    }
+}
+
+void ThreadPool::parallelForChunks(int begin, int end, int grain,
+                                   const std::function<void(int, int)>& chunk) {
+    if (end <= begin) return;
+    grain = std::max(1, grain);
+
+    const int numChunks = (end - begin + grain - 1) / grain;
+    if (numChunks == 1) {
+        chunk(begin, end);
+        return;
+    }
+
+    std::atomic<int> next(begin);
+    auto runChunks = [&]() {
+        while (true) {
+            int b = next.fetch_add(grain);
+            if (b >= end) break;
+            chunk(b, std::min(b + grain, end));
+        }
+    };
+
+    // Helpers pull chunks dynamically; the caller runs the loop too
+    TaskGroup group(*this);
+    int helpers = std::min(numWorkers(), numChunks - 1);
+    for (int i = 0; i < helpers; ++i) {
+        group.run(runChunks);
+    }
+    runChunks();
+    group.wait();
+}
+
+// ScopedPool implementation
+
+ScopedPool::ScopedPool(ThreadPool& pool)
+    : previous_(t_scopedPool) {
+    t_scopedPool = &pool;
+}
+
+ScopedPool::~ScopedPool() {
+    t_scopedPool = previous_;
+}
+
+// TaskGroup implementation
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool_(pool), pending_(0) {
+}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    pending_.fetch_add(1);
+    pool_.submit([this, task = std::move(task)]() {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOGE("TaskGroup: task threw: %s", e.what());
+        } catch (...) {
+            LOGE("TaskGroup: task threw a non-standard exception");
+        }
+
+        // Notify under the lock so the group cannot be destroyed mid-notify
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.fetch_sub(1);
+        doneCV_.notify_all();
+    });
+}
+
+void TaskGroup::wait() {
+    while (pending_.load() > 0) {
+        if (pool_.runPendingTask()) continue;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCV_.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+            return pending_.load() == 0;
+        });
+    }
+
+    // Synchronize with the final notifier before the group can be destroyed
+    std::lock_guard<std::mutex> lock(mutex_);
+}
+
+bool TaskGroup::waitFor(std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (pending_.load() > 0) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        if (pool_.runPendingTask()) continue;
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCV_.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+            return pending_.load() == 0;
+        });
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return true;
+}
+
+// SerialTaskQueue implementation
+
+SerialTaskQueue::SerialTaskQueue(ThreadPool& pool)
+    : draining_(false), group_(pool) {
+}
+
+SerialTaskQueue::~SerialTaskQueue() {
+    wait();
+}
+
+void SerialTaskQueue::post(std::function<void()> task) {
+    bool startDrain = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        if (!draining_) {
+            draining_ = true;
+            startDrain = true;
+        }
+    }
+    // Submit outside the lock: an inline pool runs the drain right here
+    if (startDrain) {
+        group_.run([this]() { drain(); });
+    }
+}
+
+void SerialTaskQueue::drain() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty()) {
+                draining_ = false;
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        // A throwing task must not stop the drain, or later tasks would never run
+        try {
+            task();
+        } catch (const std::exception& e) {
+            LOGE("SerialTaskQueue: task threw: %s", e.what());
+        } catch (...) {
+            LOGE("SerialTaskQueue: task threw a non-standard exception");
+        }
+    }
+}
+
+void SerialTaskQueue::wait() {
+    group_.wait();
+}
+
+} // namespace ultradetail
@@ -0,0 +1,230 @@
+/**
+ * thread_pool.h - Process-wide work-stealing thread pool
+ *
+ * A single set of persistent worker threads shared by every native processor,
+ * so no module creates threads per call. Each worker owns a task deque: it
+ * pops its own tasks LIFO (cache-warm) and steals from other workers FIFO
+ * when idle, which balances tiles of uneven cost across cores.
+ *
+ * Threads that wait on a TaskGroup or a parallelFor help execute queued tasks
+ * instead of blocking, so nested parallel sections cannot deadlock.
+ */
+
+#ifndef ULTRADETAIL_THREAD_POOL_H
+#define ULTRADETAIL_THREAD_POOL_H
+
+#include "common.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ultradetail {
+
+/**
+ * Work-stealing thread pool
+ *
+ * Use ThreadPool::instance() to access the shared pool. Tasks must not call
+ * JNI functions: pool threads are not attached to the JVM.
+ */
+class ThreadPool {
+public:
+    /**
+     * Get the pool for the calling thread: the pool a worker belongs to, or
+     * one installed with ScopedPool, otherwise the process-wide pool
+     * (created on first use)
+     */
+    static ThreadPool& instance();
+
+    /**
+     * Create a pool with the given number of worker threads
+     *
+     * @param numWorkers Worker threads (negative = hardware_concurrency - 1, min 1;
+     *                   0 = no workers, all work runs inline on the caller)
+     */
+    explicit ThreadPool(int numWorkers = -1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Number of worker threads
+     */
+    int numWorkers() const { return static_cast<int>(workers_.size()); }
+
+    /**
+     * Threads that can execute work concurrently (workers + the waiting caller)
+     */
+    int concurrency() const { return numWorkers() + 1; }
+
+    /**
+     * Queue a task. From a worker thread it goes to that worker's own deque,
+     * otherwise it is distributed round-robin.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * Execute one queued task on the calling thread, if any is available
+     *
+     * @return true if a task was executed
+     */
+    bool runPendingTask();
+
+    /**
+     * Index of the calling thread among this pool's workers, or -1
+     */
+    int currentWorkerIndex() const;
+
+    /**
+     * Parallel loop over [begin, end), calling body(i) for each index
+     *
+     * Indices are handed out dynamically in chunks of grain, so iterations of
+     * uneven cost are load-balanced. Blocks until all iterations are done;
+     * the calling thread participates.
+     */
+    template<typename Body>
+    void parallelFor(int begin, int end, Body&& body, int grain = 1) {
+        parallelForChunks(begin, end, grain, [&body](int b, int e) {
+            for (int i = b; i < e; ++i) body(i);
+        });
+    }
+
+    /**
+     * Parallel loop over row bands of [begin, end), calling body(y0, y1)
+     *
+     * @param grain Rows per band (0 = choose automatically, ~4 bands per thread)
+     */
+    template<typename Body>
+    void parallelForRows(int begin, int end, Body&& body, int grain = 0) {
+        if (grain <= 0) {
+            grain = std::max(1, (end - begin) / (concurrency() * 4));
+        }
+        parallelForChunks(begin, end, grain, std::function<void(int, int)>(std::forward<Body>(body)));
+    }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::atomic<int> queuedTasks_;
+    std::atomic<unsigned> nextQueue_;
+    std::atomic<bool> shutdown_;
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCV_;
+
+    void workerLoop(int index);
+    bool popTask(int preferredQueue, std::function<void()>& task);
+
+    void parallelForChunks(int begin, int end, int grain,
+                           const std::function<void(int, int)>& chunk);
+};
+
+/**
+ * Make a pool the current one (ThreadPool::instance()) for the calling thread
+ *
+ * Used to confine nested parallel loops to a specific pool, e.g. when
+ * measuring scaling with a fixed number of threads.
+ */
+class ScopedPool {
+public:
+    explicit ScopedPool(ThreadPool& pool);
+    ~ScopedPool();
+
+    ScopedPool(const ScopedPool&) = delete;
+    ScopedPool& operator=(const ScopedPool&) = delete;
+
+private:
+    ThreadPool* previous_;
+};
+
+/**
+ * Group of tasks that can be waited on together
+ *
+ * Waiting helps execute queued pool tasks. The destructor waits for any
+ * outstanding tasks, so captured references stay valid.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::instance());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * Queue a task as part of this group
+     */
+    void run(std::function<void()> task);
+
+    /**
+     * Block (while helping) until every task in the group has finished
+     */
+    void wait();
+
+    /**
+     * Help or wait for up to timeout
+     *
+     * @return true if all tasks in the group have finished
+     */
+    bool waitFor(std::chrono::milliseconds timeout);
+
+    /**
+     * Number of unfinished tasks
+     */
+    int pending() const { return pending_.load(); }
+
+private:
+    ThreadPool& pool_;
+    std::atomic<int> pending_;
+    std::mutex mutex_;
+    std::condition_variable doneCV_;
+};
+
+/**
+ * Runs tasks one at a time, in submission order, on a pool
+ *
+ * At most one pool task drains the queue at any moment, so posted tasks never
+ * overlap each other but do run concurrently with the thread that posts them.
+ * Used for work that must stay ordered, such as ingesting burst frames while
+ * later frames are still being captured.
+ */
+class SerialTaskQueue {
+public:
+    explicit SerialTaskQueue(ThreadPool& pool = ThreadPool::instance());
+    ~SerialTaskQueue();
+
+    SerialTaskQueue(const SerialTaskQueue&) = delete;
+    SerialTaskQueue& operator=(const SerialTaskQueue&) = delete;
+
+    /**
+     * Queue a task behind every task posted before it
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * Block (while helping) until every posted task has finished
+     */
+    void wait();
+
+private:
+    void drain();
+
+    std::mutex mutex_;
+    std::deque<std::function<void()>> tasks_;
+    bool draining_;
+    TaskGroup group_;       // Declared last: waits for the drain before members go away
+};
+
+} // namespace ultradetail
+
+#endif // ULTRADETAIL_THREAD_POOL_H
@@ -5,15 +5,15 @@
  */
 
 #include "tiled_pipeline.h"
-#include "neon_utils.h"
 #include "deghost_enhance.h"
-#include <android/log.h>
+#include "thread_pool.h"
+#include "pyramid.h"
 #include <chrono>
 #include <cmath>
 #include <algorithm>
-#include <thread>
-#include <mutex>
 #include <atomic>
+#include <mutex>
+#include <array>
 #include <vector>
 
 // Use logging macros from common.h
@@ -88,12 +88,382 @@ static inline RGBPixel deringClampRGB(const RGBPixel& value,
     );
 }
 
+/**
+ * Deterministic per-frame sub-pixel jitter added to the alignment shift
+ * 
+ * Helps when alignment is too precise (integer-aligned). Uses the golden
+ * ratio for an even sub-pixel sampling distribution, scaled to +-0.15 px.
+ */
+static inline void frameJitter(int frameIdx, float& offsetX, float& offsetY) {
+    const float phi = 1.618033988749895f;
+    offsetX = std::fmod(frameIdx * phi, 1.0f) - 0.5f;  // Range [-0.5, 0.5]
+    offsetY = std::fmod(frameIdx * phi * phi, 1.0f) - 0.5f;
+    offsetX *= 0.3f;  // Scale down to subtle sub-pixel jitter
+    offsetY *= 0.3f;
+}
+
+/**
+ * Mitchell-Netravali filter (B=1/3, C=1/3) for gap filling, scaled by 6
+ */
+static inline float gapFillWeight(float t) {
+    t = std::abs(t);
+    if (t < 1.0f) {
+        return (12.0f - 9.0f * (1.0f/3.0f) - 6.0f * (1.0f/3.0f)) * t * t * t
+             + (-18.0f + 12.0f * (1.0f/3.0f) + 6.0f * (1.0f/3.0f)) * t * t
+             + (6.0f - 2.0f * (1.0f/3.0f));
+    } else if (t < 2.0f) {
+        return (-(1.0f/3.0f) - 6.0f * (1.0f/3.0f)) * t * t * t
+             + (6.0f * (1.0f/3.0f) + 30.0f * (1.0f/3.0f)) * t * t
+             + (-12.0f * (1.0f/3.0f) - 48.0f * (1.0f/3.0f)) * t
+             + (8.0f * (1.0f/3.0f) + 24.0f * (1.0f/3.0f));
+    }
+    return 0.0f;
+}
+
+/**
+ * Fill an MFSR gap with the bicubic-upscaled reference frame
+ * 
+ * This is the approach used by Google's Handheld Super-Res - gaps are filled
+ * with upscaled reference frame data rather than neighbor averaging.
+ * 
+ * @return false if no reference pixel is in reach (out is left unchanged)
+ */
+static bool fillGapFromReference(const RGBImage& refCrop, int x, int y, int scaleFactor, RGBPixel& out) {
+    // Map HR position back to LR reference frame
+    float srcX = static_cast<float>(x) / scaleFactor;
+    float srcY = static_cast<float>(y) / scaleFactor;
+    
+    // Bicubic interpolation from reference frame
+    int x0 = static_cast<int>(std::floor(srcX)) - 1;
+    int y0 = static_cast<int>(std::floor(srcY)) - 1;
+    
+    float sumR = 0, sumG = 0, sumB = 0, sumW = 0;
+    
+    for (int ky = 0; ky < 4; ++ky) {
+        int py = y0 + ky;
+        if (py < 0 || py >= refCrop.height) continue;
+        
+        float wy = gapFillWeight(srcY - py) / 6.0f;  // Normalize
+        
+        for (int kx = 0; kx < 4; ++kx) {
+            int px = x0 + kx;
+            if (px < 0 || px >= refCrop.width) continue;
+            
+            float wx = gapFillWeight(srcX - px) / 6.0f;
+            float w = wx * wy;
+            
+            const RGBPixel& p = refCrop.at(px, py);
+            sumR += p.r * w;
+            sumG += p.g * w;
+            sumB += p.b * w;
+            sumW += w;
+        }
+    }
+    
+    if (sumW <= 0.0f) {
+        return false;
+    }
+    
+    out.r = clamp(sumR / sumW, 0.0f, 1.0f);
+    out.g = clamp(sumG / sumW, 0.0f, 1.0f);
+    out.b = clamp(sumB / sumW, 0.0f, 1.0f);
+    return true;
+}
+
+/**
+ * Normalize an accumulated sample with the de-ringing clamp
+ * 
+ * Limits output to the local min/max of the contributing input samples,
+ * which prevents ringing (halos) around high-contrast edges.
+ */
+static inline void resolveAccumulated(float r, float g, float b, float weight,
+                                      const RGBPixel& localMin, const RGBPixel& localMax,
+                                      RGBPixel& out) {
+    float invW = 1.0f / weight;
+    out = deringClampRGB(RGBPixel(r * invW, g * invW, b * invW), localMin, localMax);
+    
+    // Final clamp to valid range
+    out.r = clamp(out.r, 0.0f, 1.0f);
+    out.g = clamp(out.g, 0.0f, 1.0f);
+    out.b = clamp(out.b, 0.0f, 1.0f);
+}
+
+/**
+ * Weighted sum and de-ringing bounds of the samples gathered for one output pixel
+ */
+struct SampleAccumulator {
+    float r = 0.0f, g = 0.0f, b = 0.0f, weight = 0.0f;
+    RGBPixel localMin = RGBPixel(1.0f, 1.0f, 1.0f);
+    RGBPixel localMax = RGBPixel(0.0f, 0.0f, 0.0f);
+    
+    inline void add(const RGBPixel& pixel, float w) {
+        r += pixel.r * w;
+        g += pixel.g * w;
+        b += pixel.b * w;
+        weight += w;
+        
+        localMin.r = std::min(localMin.r, pixel.r);
+        localMin.g = std::min(localMin.g, pixel.g);
+        localMin.b = std::min(localMin.b, pixel.b);
+        localMax.r = std::max(localMax.r, pixel.r);
+        localMax.g = std::max(localMax.g, pixel.g);
+        localMax.b = std::max(localMax.b, pixel.b);
+    }
+};
+
+/**
+ * Input samples along one axis whose splat footprint covers an output coordinate
+ */
+struct SplatTaps {
+    int count;
+    int src[4];                 // Input column / row, increasing (scatter order)
+    float weight[4];            // Mitchell weight along this axis
+};
+
+/**
+ * Candidate input range [s0, s1] whose splats can reach outputs [p0, p1]
+ * 
+ * A sample lands at dst = (s - d + offset) * scale and its 4x4 footprint
+ * starts at floor(dst) - 1, so it reaches output p iff dst is in [p - 2, p + 2).
+ * Inverting that with flow bounds [minD, maxD] gives the range (widened by a
+ * small epsilon against rounding; callers apply the exact test).
+ */
+static inline void splatCandidateRange(int p0, int p1, float scale, float offset,
+                                       float minD, float maxD, int limit, int& s0, int& s1) {
+    const float eps = 1e-3f;
+    s0 = std::max(0, static_cast<int>(std::ceil((p0 - 2) / scale - offset + minD - eps)));
+    s1 = std::min(limit - 1, static_cast<int>(std::floor((p1 + 2) / scale - offset + maxD + eps)));
+}
+
+/**
+ * Taps of output coordinate p for samples in [s0, s1] moved by a single shift
+ * 
+ * Destinations, bounds and footprint tests are evaluated exactly as the
+ * scatter kernel does, so weights match bit for bit.
+ */
+static inline void buildSplatTaps(int p, float shift, float offset, int scaleFactor,
+                                  int s0, int s1, int outLimit, SplatTaps& taps) {
+    taps.count = 0;
+    for (int s = s0; s <= s1 && taps.count < 4; ++s) {
+        float dst = (s - shift + offset) * scaleFactor;
+        if (dst < 0 || dst >= outLimit - 1) continue;
+        int foot = static_cast<int>(std::floor(dst)) - 1;
+        if (p < foot || p > foot + 3) continue;
+        taps.src[taps.count] = s;
+        taps.weight[taps.count] = mitchellWeight(dst - p);
+        taps.count++;
+    }
+}
+
+// Post-processing parameters
+// Fix #6: Tuned bilateral filter parameters for less aggressive smoothing
+// Previous values (spatialSigma=1.5, rangeSigma=0.08) were too aggressive,
+// causing over-smoothing and loss of detail. New values preserve more texture.
+static constexpr int BILATERAL_RADIUS = 2;         // Small radius for subtle smoothing
+static constexpr float BILATERAL_SPATIAL_SIGMA = 2.5f;  // Wider spatial kernel (was 1.5)
+static constexpr float BILATERAL_RANGE_SIGMA = 0.15f;   // More tolerant of color variation (was 0.08)
+
+// USM parameters tuned for MFSR output
+static constexpr float USM_AMOUNT = 0.5f;      // Sharpening strength (0.3-0.7 typical)
+static constexpr float USM_THRESHOLD = 0.02f;  // Edge threshold to avoid noise amplification
+static constexpr int USM_RADIUS = 1;           // Small radius for fine detail
+
+/**
+ * Edge-preserving smoothing of one row to remove blotchy artifacts
+ * Uses a simplified bilateral filter approach similar to Google's HDR+
+ * 
+ * @param rows Normalized rows y-2..y+2
+ * @param out Smoothed row y (border columns are copied through)
+ */
+static void bilateralSmoothRow(const RGBPixel* const rows[2 * BILATERAL_RADIUS + 1],
+                               RGBPixel* out, int width) {
+    static const auto spatialWeights = []() {
+        std::array<float, (2 * BILATERAL_RADIUS + 1) * (2 * BILATERAL_RADIUS + 1)> w{};
+        for (int dy = -BILATERAL_RADIUS; dy <= BILATERAL_RADIUS; ++dy) {
+            for (int dx = -BILATERAL_RADIUS; dx <= BILATERAL_RADIUS; ++dx) {
+                float spatialDist = std::sqrt(static_cast<float>(dx*dx + dy*dy));
+                w[(dy + BILATERAL_RADIUS) * (2 * BILATERAL_RADIUS + 1) + dx + BILATERAL_RADIUS] =
+                    std::exp(-spatialDist * spatialDist /
+                             (2.0f * BILATERAL_SPATIAL_SIGMA * BILATERAL_SPATIAL_SIGMA));
+            }
+        }
+        return w;
+    }();
+    const float rangeDenom = 2.0f * BILATERAL_RANGE_SIGMA * BILATERAL_RANGE_SIGMA;
+    const RGBPixel* centerRow = rows[BILATERAL_RADIUS];
+    
+    for (int x = 0; x < width; ++x) {
+        if (x < BILATERAL_RADIUS || x >= width - BILATERAL_RADIUS) {
+            out[x] = centerRow[x];
+            continue;
+        }
+        
+        const RGBPixel& center = centerRow[x];
+        float sumR = 0, sumG = 0, sumB = 0, sumW = 0;
+        
+        for (int dy = -BILATERAL_RADIUS; dy <= BILATERAL_RADIUS; ++dy) {
+            const RGBPixel* row = rows[dy + BILATERAL_RADIUS];
+            const float* spatialRow = &spatialWeights[(dy + BILATERAL_RADIUS) * (2 * BILATERAL_RADIUS + 1)];
+            for (int dx = -BILATERAL_RADIUS; dx <= BILATERAL_RADIUS; ++dx) {
+                const RGBPixel& neighbor = row[x + dx];
+                
+                // Range weight (color similarity)
+                float colorDiff2 = (neighbor.r - center.r) * (neighbor.r - center.r) +
+                                   (neighbor.g - center.g) * (neighbor.g - center.g) +
+                                   (neighbor.b - center.b) * (neighbor.b - center.b);
+                float rangeW = std::exp(-colorDiff2 / rangeDenom);
+                
+                float w = spatialRow[dx + BILATERAL_RADIUS] * rangeW;
+                sumR += neighbor.r * w;
+                sumG += neighbor.g * w;
+                sumB += neighbor.b * w;
+                sumW += w;
+            }
+        }
+        
+        if (sumW > 0.0f) {
+            out[x] = RGBPixel(
+                clamp(sumR / sumW, 0.0f, 1.0f),
+                clamp(sumG / sumW, 0.0f, 1.0f),
+                clamp(sumB / sumW, 0.0f, 1.0f)
+            );
+        } else {
+            out[x] = center;
+        }
+    }
+}
+
+/**
+ * Unsharp Mask (USM) sharpening of one row to restore detail
+ * This is essential for MFSR output which tends to be soft due to averaging
+ * 
+ * @param rows Smoothed rows y-1..y+1
+ * @param out Sharpened row y (border columns are copied through)
+ */
+static void unsharpMaskRow(const RGBPixel* const rows[2 * USM_RADIUS + 1],
+                           RGBPixel* out, int width) {
+    const RGBPixel* centerRow = rows[USM_RADIUS];
+    
+    for (int x = 0; x < width; ++x) {
+        const RGBPixel& p = centerRow[x];
+        out[x] = p;
+        if (x < USM_RADIUS || x >= width - USM_RADIUS) continue;
+        
+        // Simple box blur for speed
+        float sumR = 0, sumG = 0, sumB = 0;
+        int count = 0;
+        for (int dy = -USM_RADIUS; dy <= USM_RADIUS; ++dy) {
+            const RGBPixel* row = rows[dy + USM_RADIUS];
+            for (int dx = -USM_RADIUS; dx <= USM_RADIUS; ++dx) {
+                sumR += row[x + dx].r;
+                sumG += row[x + dx].g;
+                sumB += row[x + dx].b;
+                count++;
+            }
+        }
+        
+        // Compute high-frequency detail (difference from blur)
+        float diffR = p.r - sumR / count;
+        float diffG = p.g - sumG / count;
+        float diffB = p.b - sumB / count;
+        
+        // Only sharpen if detail is above threshold (avoid noise)
+        float detailMag = std::sqrt(diffR*diffR + diffG*diffG + diffB*diffB);
+        if (detailMag > USM_THRESHOLD) {
+            out[x].r = clamp(p.r + USM_AMOUNT * diffR, 0.0f, 1.0f);
+            out[x].g = clamp(p.g + USM_AMOUNT * diffG, 0.0f, 1.0f);
+            out[x].b = clamp(p.b + USM_AMOUNT * diffB, 0.0f, 1.0f);
+        }
+    }
+}
+
+/**
+ * Row-streaming bilateral + USM post filter
+ * 
+ * Accepts normalized output rows in order and emits finished rows to the sink
+ * once their vertical halo is available. Only a few rows are kept resident:
+ * 2*BILATERAL_RADIUS+1 normalized rows and 2*USM_RADIUS+1 smoothed rows.
+ * Rows within the filter radius of the image border pass through unfiltered.
+ */
+class StreamingPostFilter {
+public:
+    StreamingPostFilter(int width, int height, const OutputRowSink& sink)
+        : width_(width), height_(height), sink_(sink),
+          normRing_(width, kNormRows), smoothRing_(width, kSmoothRows),
+          outRow_(width) {}
+    
+    void pushRow(const RGBPixel* row) {
+        std::copy(row, row + width_, normRing_.row(pushed_ % kNormRows));
+        pushed_++;
+        advance();
+    }
+    
+    void finish() {
+        advance();
+        if (emitted_ < height_) {
+            LOGW("StreamingPostFilter: only %d/%d rows emitted", emitted_, height_);
+        }
+    }
+
+private:
+    static constexpr int kNormRows = 2 * BILATERAL_RADIUS + 1;
+    static constexpr int kSmoothRows = 2 * USM_RADIUS + 1;
+    
+    int width_, height_;
+    const OutputRowSink& sink_;
+    RGBImage normRing_;
+    RGBImage smoothRing_;
+    std::vector<RGBPixel> outRow_;
+    int pushed_ = 0;
+    int smoothed_ = 0;
+    int emitted_ = 0;
+    
+    bool isBorder(int y, int radius) const {
+        return y < radius || y >= height_ - radius;
+    }
+    
+    void advance() {
+        while (smoothed_ < height_ &&
+               pushed_ > (isBorder(smoothed_, BILATERAL_RADIUS) ? smoothed_ : smoothed_ + BILATERAL_RADIUS)) {
+            int y = smoothed_;
+            RGBPixel* dst = smoothRing_.row(y % kSmoothRows);
+            if (isBorder(y, BILATERAL_RADIUS)) {
+                const RGBPixel* src = normRing_.row(y % kNormRows);
+                std::copy(src, src + width_, dst);
+            } else {
+                const RGBPixel* rows[kNormRows];
+                for (int k = 0; k < kNormRows; ++k) {
+                    rows[k] = normRing_.row((y - BILATERAL_RADIUS + k) % kNormRows);
+                }
+                bilateralSmoothRow(rows, dst, width_);
+            }
+            smoothed_++;
+            
+            while (emitted_ < smoothed_ &&
+                   smoothed_ > (isBorder(emitted_, USM_RADIUS) ? emitted_ : emitted_ + USM_RADIUS)) {
+                int e = emitted_;
+                if (isBorder(e, USM_RADIUS)) {
+                    sink_(e, smoothRing_.row(e % kSmoothRows), width_);
+                } else {
+                    const RGBPixel* rows[kSmoothRows];
+                    for (int k = 0; k < kSmoothRows; ++k) {
+                        rows[k] = smoothRing_.row((e - USM_RADIUS + k) % kSmoothRows);
+                    }
+                    unsharpMaskRow(rows, outRow_.data(), width_);
+                    sink_(e, outRow_.data(), width_);
+                }
+                emitted_++;
+            }
+        }
+    }
+};
+
 TiledMFSRPipeline::TiledMFSRPipeline(const TilePipelineConfig& config)
     : config_(config) {
     
     // Initialize processors based on alignment method
     if (config_.alignmentMethod == TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW) {
-        flowProcessor_ = std::make_unique<DenseOpticalFlow>(config_.flowParams);
+        // Dense flow processors are created per tile (see processTile)
         LOGI("TiledMFSRPipeline: Using dense optical flow alignment");
     } else {
         // Fix #5 & #1: Use hybrid aligner (gyro + phase correlation)
@@ -110,10 +480,15 @@ TiledMFSRPipeline::TiledMFSRPipeline(const TilePipelineConfig& config)
 }
 
 std::vector<TileRegion> TiledMFSRPipeline::computeTileGrid(int width, int height) const {
+    return computeTileGrid(width, height, config_.tileWidth, config_.tileHeight);
+}
+
+std::vector<TileRegion> TiledMFSRPipeline::computeTileGrid(int width, int height,
+                                                           int tileWidth, int tileHeight) const {
     std::vector<TileRegion> tiles;
     
-    int effectiveTileW = config_.tileWidth - config_.overlap;
-    int effectiveTileH = config_.tileHeight - config_.overlap;
+    int effectiveTileW = tileWidth - config_.overlap;
+    int effectiveTileH = tileHeight - config_.overlap;
     
     int numTilesX = (width + effectiveTileW - 1) / effectiveTileW;
     int numTilesY = (height + effectiveTileH - 1) / effectiveTileH;
@@ -127,8 +502,8 @@ std::vector<TileRegion> TiledMFSRPipeline::computeTileGrid(int width, int height
             // Input coordinates
             tile.x = tx * effectiveTileW;
             tile.y = ty * effectiveTileH;
-            tile.width = std::min(config_.tileWidth, width - tile.x);
-            tile.height = std::min(config_.tileHeight, height - tile.y);
+            tile.width = std::min(tileWidth, width - tile.x);
+            tile.height = std::min(tileHeight, height - tile.y);
             
             // Padding for overlap blending
             tile.padLeft = (tx > 0) ? config_.overlap / 2 : 0;
@@ -149,49 +524,126 @@ std::vector<TileRegion> TiledMFSRPipeline::computeTileGrid(int width, int height
     return tiles;
 }
 
-void TiledMFSRPipeline::extractTileCrop(
-    const RGBImage& source,
-    const TileRegion& tile,
-    RGBImage& crop
-) {
-    // Include padding for overlap
-    int startX = std::max(0, tile.x - tile.padLeft);
-    int startY = std::max(0, tile.y - tile.padTop);
-    int endX = std::min(source.width, tile.x + tile.width + tile.padRight);
-    int endY = std::min(source.height, tile.y + tile.height + tile.padBottom);
+size_t TiledMFSRPipeline::estimateTileBytes(int tileWidth, int tileHeight, int numFrames) const {
+    // Crops include up to overlap/2 padding on each side
+    const size_t cropW = static_cast<size_t>(tileWidth + config_.overlap);
+    const size_t cropH = static_cast<size_t>(tileHeight + config_.overlap);
+    const size_t cropPixels = cropW * cropH;
+    const size_t outPixels = static_cast<size_t>(tileWidth) * tileHeight *
+                             config_.scaleFactor * config_.scaleFactor;
+    const size_t frames = static_cast<size_t>(numFrames);
+    
+    // RGB and gray crops of every frame
+    size_t bytes = frames * cropPixels * (sizeof(RGBPixel) + sizeof(float));
     
-    int cropWidth = endX - startX;
-    int cropHeight = endY - startY;
+    if (config_.alignmentMethod == TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW) {
+        // Per-pixel flow for every frame, plus reference pyramid and gradients
+        bytes += frames * cropPixels * sizeof(FlowVector);
+        bytes += cropPixels * 8 * sizeof(float);
+    } else {
+        // Reference spectra (one per 128px cell, or one window) plus correlation scratch
+        const size_t spectrumBytes = 128 * (128 / 2 + 1) * sizeof(std::complex<float>);
+        const size_t cells = ((cropW + 127) / 128) * ((cropH + 127) / 128);
+        bytes += (cells + 3) * spectrumBytes;
+        // Per-sample robustness planes of the accumulation kernels
+        bytes += frames * cropPixels * sizeof(float);
+    }
     
-    crop.resize(cropWidth, cropHeight);
+    if (config_.accumulationMethod == TilePipelineConfig::AccumulationMethod::SCATTER) {
+        bytes += outPixels * 10 * sizeof(float);  // High-res accumulator with min/max
+    }
     
-    for (int y = 0; y < cropHeight; ++y) {
-        const RGBPixel* srcRow = source.row(startY + y);
-        RGBPixel* dstRow = crop.row(y);
-        std::copy(srcRow + startX, srcRow + startX + cropWidth, dstRow);
+    // The upscaled tile itself
+    bytes += outPixels * sizeof(RGBPixel);
+    return bytes;
+}
+
+MemoryPlan TiledMFSRPipeline::planMemory(int width, int height, int numFrames) const {
+    const int scale = config_.scaleFactor;
+    const size_t outWidth = static_cast<size_t>(width) * scale;
+    const int maxThreads = ThreadPool::instance().concurrency();
+    const int minTile = std::max(kMinTileSize, 2 * config_.overlap);
+    
+    MemoryPlan plan;
+    plan.budgetBytes = config_.maxMemoryMB * 1024 * 1024;
+    
+    int tileW = config_.tileWidth;
+    int tileH = config_.tileHeight;
+    size_t rowResultBytes = 0;
+    
+    for (;;) {
+        // Same column count as computeTileGrid
+        const int stepW = std::max(1, tileW - config_.overlap);
+        const size_t tilesPerRow = (width + stepW - 1) / stepW;
+        const size_t outTileBytes = static_cast<size_t>(tileW) * scale * tileH * scale * sizeof(RGBPixel);
+        const size_t bandHeight = std::min(static_cast<size_t>(height) * scale, static_cast<size_t>(tileH) * scale);
+        rowResultBytes = tilesPerRow * outTileBytes;
+        
+        plan.tileWidth = tileW;
+        plan.tileHeight = tileH;
+        plan.tileBytes = estimateTileBytes(tileW, tileH, numFrames);
+        // Band and its weights, plus the post filter's row rings
+        plan.fixedBytes = outWidth * bandHeight * (sizeof(RGBPixel) + sizeof(float)) +
+                          outWidth * 9 * sizeof(RGBPixel);
+        
+        if (plan.budgetBytes == 0) {
+            plan.lookaheadRows = 2;
+            plan.resultBytes = plan.lookaheadRows * rowResultBytes;
+            plan.maxConcurrentTiles = maxThreads;
+            plan.withinBudget = true;
+            return plan;
+        }
+        
+        // Prefer concurrency over lookahead, and both over shrinking tiles
+        int bestConcurrent = 0;
+        for (int lookahead = 2; lookahead >= 1; --lookahead) {
+            size_t resultBytes = lookahead * rowResultBytes;
+            size_t committed = plan.fixedBytes + resultBytes;
+            if (committed >= plan.budgetBytes) continue;
+            
+            size_t fit = (plan.budgetBytes - committed) / std::max<size_t>(plan.tileBytes, 1);
+            int concurrent = static_cast<int>(std::min<size_t>(fit, maxThreads));
+            if (concurrent > bestConcurrent) {
+                bestConcurrent = concurrent;
+                plan.lookaheadRows = lookahead;
+                plan.resultBytes = resultBytes;
+                plan.maxConcurrentTiles = concurrent;
+            }
+        }
+        if (bestConcurrent >= 1) {
+            plan.withinBudget = true;
+            return plan;
+        }
+        
+        if (tileW <= minTile && tileH <= minTile) {
+            break;
+        }
+        tileW = std::max(std::min(minTile, tileW), tileW / 2);
+        tileH = std::max(std::min(minTile, tileH), tileH / 2);
     }
+    
+    // Nothing fits: run the smallest plan serially and report it
+    plan.lookaheadRows = 1;
+    plan.maxConcurrentTiles = 1;
+    plan.resultBytes = rowResultBytes;
+    plan.withinBudget = false;
+    return plan;
 }
 
 void TiledMFSRPipeline::extractTileCrop(
-    const GrayImage& source,
+    const FrameSource& source,
     const TileRegion& tile,
-    GrayImage& crop
+    RGBImage& crop,
+    GrayImage& grayCrop
 ) {
+    // Include padding for overlap
     int startX = std::max(0, tile.x - tile.padLeft);
     int startY = std::max(0, tile.y - tile.padTop);
-    int endX = std::min(source.width, tile.x + tile.width + tile.padRight);
-    int endY = std::min(source.height, tile.y + tile.height + tile.padBottom);
-    
-    int cropWidth = endX - startX;
-    int cropHeight = endY - startY;
-    
-    crop.resize(cropWidth, cropHeight);
+    int endX = std::min(source.width(), tile.x + tile.width + tile.padRight);
+    int endY = std::min(source.height(), tile.y + tile.height + tile.padBottom);
     
-    for (int y = 0; y < cropHeight; ++y) {
-        const float* srcRow = source.row(startY + y);
-        float* dstRow = crop.row(y);
-        std::copy(srcRow + startX, srcRow + startX + cropWidth, dstRow);
-    }
+    // One conversion pass produces both crops
+    source.read(startX, startY, endX - startX, endY - startY, &crop, &grayCrop);
 }
 
 float TiledMFSRPipeline::computeRobustnessWeight(
@@ -278,14 +730,16 @@ void TiledMFSRPipeline::blendTileToOutput(
     const RGBImage& tile,
     const TileRegion& region,
     RGBImage& output,
-    ImageBuffer<float>& weightMap
+    ImageBuffer<float>& weightMap,
+    int bandY
 ) {
     int scaledOverlap = config_.overlap * config_.scaleFactor;
+    int bandEnd = bandY + output.height;
     
-    for (int y = 0; y < tile.height && region.outY + y < output.height; ++y) {
+    for (int y = 0; y < tile.height && region.outY + y < bandEnd; ++y) {
         for (int x = 0; x < tile.width && region.outX + x < output.width; ++x) {
             int outX = region.outX + x;
-            int outY = region.outY + y;
+            int outY = region.outY + y - bandY;
             
             float blendWeight = computeBlendWeight(x, y, tile.width, tile.height, scaledOverlap);
             
@@ -302,53 +756,175 @@ void TiledMFSRPipeline::blendTileToOutput(
     }
 }
 
+// Sparse block matching of estimateGlobalMotion: one block per sample step
+// in both directions, searched over +-searchRadius
+static const int kMotionSampleStep = 32;
+static const int kMotionBlockSize = 16;
+static const int kMotionSearchRadius = 16;
+
+/**
+ * Block-match the samples of one sample row
+ * 
+ * @param reference Reference rows [y, y + kMotionBlockSize)
+ * @param frame Frame rows [y - kMotionSearchRadius, y + kMotionBlockSize + kMotionSearchRadius)
+ */
+static void matchMotionRow(const GrayView& reference, const GrayView& frame,
+                           float& totalMotion, int& sampleCount) {
+    const int blockSize = kMotionBlockSize;
+    const int searchRadius = kMotionSearchRadius;
+    
+    for (int x = blockSize; x < reference.width - blockSize - searchRadius; x += kMotionSampleStep) {
+        // Simple block matching
+        float bestSAD = std::numeric_limits<float>::max();
+        int bestDx = 0, bestDy = 0;
+        
+        for (int dy = -searchRadius; dy <= searchRadius; dy += 2) {
+            for (int dx = -searchRadius; dx <= searchRadius; dx += 2) {
+                float sad = 0.0f;
+                for (int by = 0; by < blockSize; by += 2) {
+                    for (int bx = 0; bx < blockSize; bx += 2) {
+                        float diff = reference.at(x + bx, by) - 
+                                    frame.at(x + bx + dx, by + dy + searchRadius);
+                        sad += std::abs(diff);
+                    }
+                }
+                if (sad < bestSAD) {
+                    bestSAD = sad;
+                    bestDx = dx;
+                    bestDy = dy;
+                }
+            }
+        }
+        
+        totalMotion += std::sqrt(static_cast<float>(bestDx * bestDx + bestDy * bestDy));
+        sampleCount++;
+    }
+}
+
 float TiledMFSRPipeline::estimateGlobalMotion(
-    const GrayImage& reference,
-    const GrayImage& frame
+    const FrameSource& reference,
+    const FrameSource& frame
 ) {
-    // Quick global motion estimate using sparse sampling
-    const int sampleStep = 32;
-    const int blockSize = 16;
-    const int searchRadius = 16;
+    const int width = reference.width();
+    const int frameRows = kMotionBlockSize + 2 * kMotionSearchRadius;
+    
+    // Only the rows around one sample row are converted at a time
+    GrayImage referenceBand, frameBand;
+    ScopedMemory bandMemory(memoryTracker_,
+                            static_cast<size_t>(width) * (kMotionBlockSize + frameRows) * sizeof(float));
     
     float totalMotion = 0.0f;
     int sampleCount = 0;
     
-    for (int y = blockSize; y < reference.height - blockSize - searchRadius; y += sampleStep) {
-        for (int x = blockSize; x < reference.width - blockSize - searchRadius; x += sampleStep) {
-            // Simple block matching
-            float bestSAD = std::numeric_limits<float>::max();
-            int bestDx = 0, bestDy = 0;
-            
-            for (int dy = -searchRadius; dy <= searchRadius; dy += 2) {
-                for (int dx = -searchRadius; dx <= searchRadius; dx += 2) {
-                    float sad = 0.0f;
-                    for (int by = 0; by < blockSize; by += 2) {
-                        for (int bx = 0; bx < blockSize; bx += 2) {
-                            float diff = reference.at(x + bx, y + by) - 
-                                        frame.at(x + bx + dx, y + by + dy);
-                            sad += std::abs(diff);
-                        }
-                    }
-                    if (sad < bestSAD) {
-                        bestSAD = sad;
-                        bestDx = dx;
-                        bestDy = dy;
-                    }
-                }
-            }
-            
-            totalMotion += std::sqrt(static_cast<float>(bestDx * bestDx + bestDy * bestDy));
-            sampleCount++;
-        }
+    for (int y = kMotionBlockSize; y < reference.height() - kMotionBlockSize - kMotionSearchRadius;
+         y += kMotionSampleStep) {
+        reference.read(0, y, width, kMotionBlockSize, nullptr, &referenceBand);
+        frame.read(0, y - kMotionSearchRadius, width, frameRows, nullptr, &frameBand);
+        matchMotionRow(referenceBand, frameBand, totalMotion, sampleCount);
     }
     
     return sampleCount > 0 ? totalMotion / sampleCount : 0.0f;
 }
 
+bool TiledMFSRPipeline::usesMotionPriors() const {
+    return config_.useGlobalAlignmentPrior &&
+           config_.alignmentMethod != TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW;
+}
+
+// Source rows converted at a time while building the coarse level
+static const int kCoarseLumaBandRows = 32;
+
+void TiledMFSRPipeline::buildCoarseLuma(const FrameSource& frame, GrayImage& coarse) const {
+    const int width = frame.width();
+    buildCoarsestLevel(width, frame.height(), std::max(1, config_.globalAlignmentLevel + 1),
+                       [&frame, width](int y, int count, GrayImage& band) {
+                           frame.read(0, y, width, count, nullptr, &band);
+                       },
+                       coarse, kCoarseLumaBandRows);
+}
+
+void TiledMFSRPipeline::readGlobalWindow(const FrameSource& frame, GrayImage& window) const {
+    int x, y, size;
+    hybridAligner_->globalWindow(frame.width(), frame.height(), x, y, size);
+    if (size > 0) {
+        frame.read(x, y, size, size, nullptr, &window);
+    } else {
+        window = GrayImage();
+    }
+}
+
+size_t TiledMFSRPipeline::globalPriorScratchBytes(int width, int height) const {
+    // Coarse level, fine window, source band and one blended row plus five
+    // rows per intermediate level (under five source rows in total)
+    const int level = std::max(0, config_.globalAlignmentLevel);
+    int x, y, size;
+    hybridAligner_->globalWindow(width, height, x, y, size);
+    const size_t coarsePixels = static_cast<size_t>(std::max(1, width >> level)) * std::max(1, height >> level);
+    const size_t streamPixels = static_cast<size_t>(width) * (kCoarseLumaBandRows + 6);
+    return (coarsePixels + static_cast<size_t>(size) * size + streamPixels) * sizeof(float);
+}
+
+std::vector<FrameMotionPrior> TiledMFSRPipeline::estimateFrameMotionPriors(
+    const std::vector<const FrameSource*>& frames,
+    int referenceIndex,
+    const std::vector<GyroHomography>* gyroHomographies
+) {
+    const int numFrames = static_cast<int>(frames.size());
+    std::vector<FrameMotionPrior> priors(numFrames);
+    
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    // Only the coarse level and the fine window of a frame are held, both
+    // read straight from its source; the reference spectra are shared
+    const int width = frames[referenceIndex]->width();
+    const int height = frames[referenceIndex]->height();
+    const size_t scratchBytes = globalPriorScratchBytes(width, height);
+    
+    GlobalAlignmentReference globalReference;
+    {
+        ScopedMemory scratchMemory(memoryTracker_, scratchBytes);
+        GrayImage referenceWindow, referenceCoarse;
+        readGlobalWindow(*frames[referenceIndex], referenceWindow);
+        buildCoarseLuma(*frames[referenceIndex], referenceCoarse);
+        globalReference = hybridAligner_->prepareGlobalReference(width, height, referenceWindow, referenceCoarse);
+    }
+    
+    priors[referenceIndex].confidence = 1.0f;
+    priors[referenceIndex].isValid = true;
+    
+    ThreadPool::instance().parallelFor(0, numFrames, [&](int i) {
+        if (i == referenceIndex) return;
+        
+        const GyroHomography* gyroPtr = nullptr;
+        if (gyroHomographies && config_.useGyroInit && i < static_cast<int>(gyroHomographies->size()) &&
+            (*gyroHomographies)[i].isValid) {
+            gyroPtr = &(*gyroHomographies)[i];
+        }
+        
+        ScopedMemory scratchMemory(memoryTracker_, scratchBytes);
+        GrayImage targetWindow, targetCoarse;
+        readGlobalWindow(*frames[i], targetWindow);
+        buildCoarseLuma(*frames[i], targetCoarse);
+        
+        priors[i] = hybridAligner_->estimateGlobalMotion(globalReference, targetWindow, targetCoarse, gyroPtr);
+    });
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    float elapsedMs = std::chrono::duration<float, std::milli>(endTime - startTime).count();
+    
+    for (int i = 0; i < numFrames; ++i) {
+        if (i == referenceIndex) continue;
+        LOGI("Frame %d global prior: (%.2f, %.2f), conf=%.2f",
+             i, priors[i].shiftX, priors[i].shiftY, priors[i].confidence);
+    }
+    LOGI("Global alignment pre-pass: %d frames in %.1f ms (level %d)",
+         numFrames - 1, elapsedMs, config_.globalAlignmentLevel);
+    
+    return priors;
+}
+
 FallbackReason TiledMFSRPipeline::checkFallbackConditions(
-    const std::vector<RGBImage>& frames,
-    const std::vector<GrayImage>& grayFrames,
+    const std::vector<const FrameSource*>& frames,
     int referenceIndex
 ) {
     if (frames.size() < 2) {
@@ -357,17 +933,13 @@ FallbackReason TiledMFSRPipeline::checkFallbackConditions(
     }
     
     // Check for excessive motion
-    // Increased threshold significantly: hand-held phones typically have 20-100+ pixel shifts
-    // between burst frames. The hybrid aligner (phase correlation + gyro) can handle large
-    // motions, so we only reject truly extreme cases (e.g., scene change or severe blur).
-    // Previous value of 50px was too conservative and caused fallback on normal hand-held shots.
-    const float maxAllowedMotion = 200.0f;  // pixels - allow significant hand motion
+    const float maxAllowedMotion = kMaxGlobalMotion;
     float maxMotion = 0.0f;
     
-    for (size_t i = 0; i < grayFrames.size(); ++i) {
+    for (size_t i = 0; i < frames.size(); ++i) {
         if (static_cast<int>(i) == referenceIndex) continue;
         
-        float motion = estimateGlobalMotion(grayFrames[referenceIndex], grayFrames[i]);
+        float motion = estimateGlobalMotion(*frames[referenceIndex], *frames[i]);
         maxMotion = std::max(maxMotion, motion);
         LOGI("Frame %zu motion: %.1f pixels", i, motion);
         
@@ -382,6 +954,44 @@ FallbackReason TiledMFSRPipeline::checkFallbackConditions(
     return FallbackReason::NONE;
 }
 
+void TiledMFSRPipeline::fallbackUpscaleRow(
+    const RGBImage& referenceFrame,
+    int y,
+    RGBPixel* outRow
+) {
+    int outWidth = referenceFrame.width * config_.scaleFactor;
+    
+    float srcY = static_cast<float>(y) / config_.scaleFactor;
+    int y0 = static_cast<int>(srcY);
+    float fy = srcY - y0;
+    
+    // Bilinear for simplicity (bicubic would be better)
+    int y1 = std::min(y0 + 1, referenceFrame.height - 1);
+    y0 = std::min(y0, referenceFrame.height - 1);
+    
+    for (int x = 0; x < outWidth; ++x) {
+        float srcX = static_cast<float>(x) / config_.scaleFactor;
+        int x0 = static_cast<int>(srcX);
+        float fx = srcX - x0;
+        
+        int x1 = std::min(x0 + 1, referenceFrame.width - 1);
+        x0 = std::min(x0, referenceFrame.width - 1);
+        
+        const RGBPixel& p00 = referenceFrame.at(x0, y0);
+        const RGBPixel& p10 = referenceFrame.at(x1, y0);
+        const RGBPixel& p01 = referenceFrame.at(x0, y1);
+        const RGBPixel& p11 = referenceFrame.at(x1, y1);
+        
+        RGBPixel& out = outRow[x];
+        out.r = p00.r * (1-fx) * (1-fy) + p10.r * fx * (1-fy) +
+                p01.r * (1-fx) * fy + p11.r * fx * fy;
+        out.g = p00.g * (1-fx) * (1-fy) + p10.g * fx * (1-fy) +
+                p01.g * (1-fx) * fy + p11.g * fx * fy;
+        out.b = p00.b * (1-fx) * (1-fy) + p10.b * fx * (1-fy) +
+                p01.b * (1-fx) * fy + p11.b * fx * fy;
+    }
+}
+
 void TiledMFSRPipeline::fallbackUpscale(
     const RGBImage& referenceFrame,
     PipelineResult& result
@@ -398,47 +1008,44 @@ void TiledMFSRPipeline::fallbackUpscale(
     result.outputHeight = outHeight;
     result.usedFallback = true;
     
-    // Bicubic interpolation
     for (int y = 0; y < outHeight; ++y) {
-        float srcY = static_cast<float>(y) / config_.scaleFactor;
-        int y0 = static_cast<int>(srcY);
-        float fy = srcY - y0;
-        
-        for (int x = 0; x < outWidth; ++x) {
-            float srcX = static_cast<float>(x) / config_.scaleFactor;
-            int x0 = static_cast<int>(srcX);
-            float fx = srcX - x0;
-            
-            // Bilinear for simplicity (bicubic would be better)
-            int x1 = std::min(x0 + 1, referenceFrame.width - 1);
-            int y1 = std::min(y0 + 1, referenceFrame.height - 1);
-            x0 = std::min(x0, referenceFrame.width - 1);
-            y0 = std::min(y0, referenceFrame.height - 1);
-            
-            const RGBPixel& p00 = referenceFrame.at(x0, y0);
-            const RGBPixel& p10 = referenceFrame.at(x1, y0);
-            const RGBPixel& p01 = referenceFrame.at(x0, y1);
-            const RGBPixel& p11 = referenceFrame.at(x1, y1);
-            
-            RGBPixel& out = result.outputImage.at(x, y);
-            out.r = p00.r * (1-fx) * (1-fy) + p10.r * fx * (1-fy) +
-                    p01.r * (1-fx) * fy + p11.r * fx * fy;
-            out.g = p00.g * (1-fx) * (1-fy) + p10.g * fx * (1-fy) +
-                    p01.g * (1-fx) * fy + p11.g * fx * fy;
-            out.b = p00.b * (1-fx) * (1-fy) + p10.b * fx * (1-fy) +
-                    p01.b * (1-fx) * fy + p11.b * fx * fy;
-        }
+        fallbackUpscaleRow(referenceFrame, y, result.outputImage.row(y));
+    }
+    
+    result.success = true;
+}
+
+void TiledMFSRPipeline::fallbackUpscale(
+    const RGBImage& referenceFrame,
+    const OutputRowSink& sink,
+    PipelineResult& result
+) {
+    LOGI("Performing streaming fallback bicubic upscale");
+    
+    int outWidth = referenceFrame.width * config_.scaleFactor;
+    int outHeight = referenceFrame.height * config_.scaleFactor;
+    
+    result.inputWidth = referenceFrame.width;
+    result.inputHeight = referenceFrame.height;
+    result.outputWidth = outWidth;
+    result.outputHeight = outHeight;
+    result.usedFallback = true;
+    
+    std::vector<RGBPixel> row(outWidth);
+    for (int y = 0; y < outHeight; ++y) {
+        fallbackUpscaleRow(referenceFrame, y, row.data());
+        sink(y, row.data(), outWidth);
     }
     
     result.success = true;
 }
 
 void TiledMFSRPipeline::processTile(
-    const std::vector<RGBImage>& frames,
-    const std::vector<GrayImage>& grayFrames,
+    const std::vector<const FrameSource*>& frames,
     const TileRegion& tile,
     int referenceIndex,
     const std::vector<GyroHomography>* gyroHomographies,
+    const std::vector<FrameMotionPrior>* motionPriors,
     TileResult& result
 ) {
     const int numFrames = static_cast<int>(frames.size());
@@ -448,25 +1055,52 @@ void TiledMFSRPipeline::processTile(
     std::vector<GrayImage> grayTileCrops(numFrames);
     
     for (int i = 0; i < numFrames; ++i) {
-        extractTileCrop(frames[i], tile, tileCrops[i]);
-        extractTileCrop(grayFrames[i], tile, grayTileCrops[i]);
+        extractTileCrop(*frames[i], tile, tileCrops[i], grayTileCrops[i]);
+    }
+    
+    size_t cropBytes = 0;
+    for (int i = 0; i < numFrames; ++i) {
+        cropBytes += imageBytes(tileCrops[i]) + imageBytes(grayTileCrops[i]);
     }
+    ScopedMemory cropMemory(memoryTracker_, cropBytes);
     
     // Step 2: Compute alignment for this tile
     // Fix #5 & #1: Use hybrid alignment (gyro + phase correlation) instead of dense optical flow
-    std::vector<FlowField> tileFlows(numFrames);
+    // Motion is kept in compact form (translation / block grid); only dense
+    // optical flow stores per-pixel vectors
+    std::vector<MotionModel> tileMotion(numFrames);
     float totalFlow = 0.0f;
     int validFlows = 0;
     
+    // Dense flow keeps per-reference state, so each tile owns an instance. The
+    // tile's analysis cache builds the reference pyramid, gradients and structure
+    // tensors once for all targets, and each target's pyramid once.
+    std::unique_ptr<DenseOpticalFlow> tileFlowProcessor;
+    std::unique_ptr<FrameAnalysisCache> tileAnalysis;
+    if (config_.alignmentMethod == TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW) {
+        tileAnalysis = std::make_unique<FrameAnalysisCache>(config_.flowParams.pyramidLevels);
+        for (const GrayImage& crop : grayTileCrops) {
+            tileAnalysis->addFrame(crop);
+        }
+        tileFlowProcessor = std::make_unique<DenseOpticalFlow>(config_.flowParams);
+        tileFlowProcessor->setReference(*tileAnalysis, referenceIndex);
+    }
+    
+    // Likewise the reference spectra for prior refinement are computed once per tile
+    TileAlignmentReference tileReference;
+    if (config_.alignmentMethod != TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW && motionPriors) {
+        tileReference = hybridAligner_->prepareTileReference(
+            grayTileCrops[referenceIndex], config_.useLocalRefinement
+        );
+    }
+    
     for (int i = 0; i < numFrames; ++i) {
+        const int cropWidth = tileCrops[i].width;
+        const int cropHeight = tileCrops[i].height;
+        
         if (i == referenceIndex) {
             // Reference has zero flow
-            tileFlows[i].resize(tileCrops[i].width, tileCrops[i].height);
-            for (int y = 0; y < tileFlows[i].height; ++y) {
-                for (int x = 0; x < tileFlows[i].width; ++x) {
-                    tileFlows[i].at(x, y) = FlowVector(0, 0, 1.0f);
-                }
-            }
+            tileMotion[i] = MotionModel::translation(cropWidth, cropHeight, FlowVector(0, 0, 1.0f));
             continue;
         }
         
@@ -480,76 +1114,90 @@ void TiledMFSRPipeline::processTile(
             }
         }
         
-        // Choose alignment method based on configuration
-        // Use mutex to protect shared alignment resources during multi-threaded processing
-        FlowField computedFlow;
-        bool flowValid = false;
-        float flowMagnitude = 0.0f;
-        
-        {
-            std::lock_guard<std::mutex> lock(alignmentMutex_);
+        // Choose alignment method based on configuration. Aligners are reentrant, so
+        // tiles on different pool threads align concurrently without locking.
+        if (config_.alignmentMethod == TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW) {
+            // Original dense Lucas-Kanade optical flow
+            DenseFlowResult flowResult = tileFlowProcessor->computeFlow(*tileAnalysis, i, gyroInit);
+            tileAnalysis->release(i);
             
-            if (config_.alignmentMethod == TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW) {
-                // Original dense Lucas-Kanade optical flow
-                flowProcessor_->setReference(grayTileCrops[referenceIndex]);
-                DenseFlowResult flowResult = flowProcessor_->computeFlow(grayTileCrops[i], gyroInit);
-                
-                if (flowResult.isValid) {
-                    computedFlow = std::move(flowResult.flowField);
-                    flowMagnitude = flowResult.averageFlow;
-                    flowValid = true;
-                }
+            if (flowResult.isValid) {
+                tileMotion[i] = MotionModel::dense(std::move(flowResult.flowField));
+                totalFlow += flowResult.averageFlow;
+                validFlows++;
             } else {
-                // Fix #5 & #1: Hybrid alignment (gyro + phase correlation)
-                // Much faster and more robust for global translations
-                computedFlow = hybridAligner_->computeAlignment(
-                    grayTileCrops[referenceIndex],
-                    grayTileCrops[i],
-                    gyroPtr,
-                    config_.useLocalRefinement
-                );
-                flowValid = true;
+                // Zero flow fallback
+                tileMotion[i] = MotionModel::translation(cropWidth, cropHeight, FlowVector(0, 0, 0.5f));
             }
+            continue;
         }
         
-        if (flowValid) {
-            tileFlows[i] = std::move(computedFlow);
-            
-            if (config_.alignmentMethod == TilePipelineConfig::AlignmentMethod::DENSE_OPTICAL_FLOW) {
-                totalFlow += flowMagnitude;
-                validFlows++;
-            } else {
-                // Compute average flow for statistics
-                float sumFlow = 0.0f;
-                int count = 0;
-                for (int y = 0; y < tileFlows[i].height; y += 4) {
-                    for (int x = 0; x < tileFlows[i].width; x += 4) {
-                        const FlowVector& fv = tileFlows[i].at(x, y);
-                        sumFlow += fv.magnitude();
-                        count++;
-                    }
-                }
-                if (count > 0) {
-                    totalFlow += sumFlow / count;
-                    validFlows++;
-                }
-            }
+        if (motionPriors && i < static_cast<int>(motionPriors->size())) {
+            // Global motion was estimated once per frame; only refine it locally
+            tileMotion[i] = hybridAligner_->computeMotionWithPrior(
+                tileReference,
+                grayTileCrops[i],
+                (*motionPriors)[i],
+                config_.useLocalRefinement
+            );
         } else {
-            // Zero flow fallback
-            tileFlows[i].resize(tileCrops[i].width, tileCrops[i].height);
-            for (int y = 0; y < tileFlows[i].height; ++y) {
-                for (int x = 0; x < tileFlows[i].width; ++x) {
-                    tileFlows[i].at(x, y) = FlowVector(0, 0, 0.5f);
-                }
-            }
+            // Fix #5 & #1: Hybrid alignment (gyro + phase correlation)
+            // Much faster and more robust for global translations
+            tileMotion[i] = hybridAligner_->computeMotion(
+                grayTileCrops[referenceIndex],
+                grayTileCrops[i],
+                gyroPtr,
+                config_.useLocalRefinement
+            );
         }
+        
+        totalFlow += tileMotion[i].averageMagnitude();
+        validFlows++;
     }
     
     result.averageFlow = validFlows > 0 ? totalFlow / validFlows : 0.0f;
     
-    // Step 3: Classical MFSR accumulation
+    size_t motionBytes = 0;
+    for (const MotionModel& motion : tileMotion) {
+        motionBytes += motion.memoryBytes();
+    }
+    ScopedMemory motionMemory(memoryTracker_, motionBytes);
+    
+    // Step 3 & 4: Classical MFSR accumulation, normalization and gap filling
     int outWidth = tile.width * config_.scaleFactor;
     int outHeight = tile.height * config_.scaleFactor;
+    result.outputTile.resize(outWidth, outHeight);
+    
+    // The tile result stays live until the caller blends and releases it
+    memoryTracker_.allocate(imageBytes(result.outputTile));
+    
+    // Every frame moved by one translation: separable polyphase weights
+    bool allTranslations = std::all_of(tileMotion.begin(), tileMotion.end(),
+                                       [](const MotionModel& m) { return m.isTranslation(); });
+    
+    int validPixels;
+    if (allTranslations) {
+        validPixels = accumulateUniformShift(tileCrops, tileMotion, referenceIndex, result.outputTile);
+    } else if (config_.accumulationMethod == TilePipelineConfig::AccumulationMethod::GATHER) {
+        validPixels = accumulateGather(tileCrops, tileMotion, referenceIndex, result.outputTile);
+    } else {
+        validPixels = accumulateScatter(tileCrops, tileMotion, referenceIndex, result.outputTile);
+    }
+    
+    result.coverage = static_cast<float>(validPixels) / (outWidth * outHeight);
+    result.framesContributed = numFrames;
+    result.success = result.coverage > 0.5f;
+}
+
+int TiledMFSRPipeline::accumulateScatter(
+    const std::vector<RGBImage>& tileCrops,
+    const std::vector<MotionModel>& tileMotion,
+    int referenceIndex,
+    RGBImage& output
+) {
+    const int numFrames = static_cast<int>(tileCrops.size());
+    const int outWidth = output.width;
+    const int outHeight = output.height;
     
     // Accumulator for high-res grid with min/max tracking for de-ringing
     struct AccumPixel {
@@ -570,6 +1218,7 @@ void TiledMFSRPipeline::processTile(
         }
     };
     ImageBuffer<AccumPixel> accumulator(outWidth, outHeight);
+    ScopedMemory accumulatorMemory(memoryTracker_, imageBytes(accumulator));
     
     // Reference frame for robustness comparison
     const RGBImage& refCrop = tileCrops[referenceIndex];
@@ -580,21 +1229,15 @@ void TiledMFSRPipeline::processTile(
     // 2. Natural hand motion variation between frames
     for (int frameIdx = 0; frameIdx < numFrames; ++frameIdx) {
         const RGBImage& crop = tileCrops[frameIdx];
-        const FlowField& flow = tileFlows[frameIdx];
+        const MotionModel& motion = tileMotion[frameIdx];
         
-        // Add deterministic sub-pixel offset per frame to ensure diversity
-        // This helps when alignment is too precise (integer-aligned)
-        // Uses golden ratio for optimal sub-pixel sampling distribution
-        const float phi = 1.618033988749895f;
-        float frameOffsetX = std::fmod(frameIdx * phi, 1.0f) - 0.5f;  // Range [-0.5, 0.5]
-        float frameOffsetY = std::fmod(frameIdx * phi * phi, 1.0f) - 0.5f;
-        frameOffsetX *= 0.3f;  // Scale down to subtle sub-pixel jitter
-        frameOffsetY *= 0.3f;
+        float frameOffsetX, frameOffsetY;
+        frameJitter(frameIdx, frameOffsetX, frameOffsetY);
         
         for (int y = 0; y < crop.height; ++y) {
             for (int x = 0; x < crop.width; ++x) {
                 const RGBPixel& pixel = crop.at(x, y);
-                const FlowVector& fv = flow.at(x, y);
+                const FlowVector fv = motion.at(x, y);
                 
                 // Skip invalid pixels
                 if (!std::isfinite(pixel.r) || !std::isfinite(pixel.g) || !std::isfinite(pixel.b)) {
@@ -656,108 +1299,387 @@ void TiledMFSRPipeline::processTile(
         }
     }
     
-    // Step 4: Normalize and fill gaps
-    result.outputTile.resize(outWidth, outHeight);
+    // Normalize and fill gaps
     int validPixels = 0;
     
     for (int y = 0; y < outHeight; ++y) {
         for (int x = 0; x < outWidth; ++x) {
             const AccumPixel& acc = accumulator.at(x, y);
-            RGBPixel& out = result.outputTile.at(x, y);
+            RGBPixel& out = output.at(x, y);
             
             if (acc.weight > 0.0f) {
-                float invW = 1.0f / acc.weight;
-                float rawR = acc.r * invW;
-                float rawG = acc.g * invW;
-                float rawB = acc.b * invW;
-                
-                // De-ringing clamp: limit output to local min/max of input samples
-                // This prevents Lanczos-3 ringing (halos) around high-contrast edges
-                out.r = clamp(rawR, acc.minR, acc.maxR);
-                out.g = clamp(rawG, acc.minG, acc.maxG);
-                out.b = clamp(rawB, acc.minB, acc.maxB);
-                
-                // Final clamp to valid range
-                out.r = clamp(out.r, 0.0f, 1.0f);
-                out.g = clamp(out.g, 0.0f, 1.0f);
-                out.b = clamp(out.b, 0.0f, 1.0f);
-                
+                resolveAccumulated(acc.r, acc.g, acc.b, acc.weight,
+                                   RGBPixel(acc.minR, acc.minG, acc.minB),
+                                   RGBPixel(acc.maxR, acc.maxG, acc.maxB), out);
                 validPixels++;
             } else {
-                // Gap - will be filled by interpolation
                 out.r = out.g = out.b = 0.0f;
+                if (fillGapFromReference(refCrop, x, y, config_.scaleFactor, out)) {
+                    validPixels++;
+                }
             }
         }
     }
     
-    // Fill gaps using bicubic interpolation from reference frame
-    // This is the approach used by Google's Handheld Super-Res - gaps are filled
-    // with upscaled reference frame data rather than neighbor averaging
-    auto bicubicWeight = [](float t) -> float {
-        // Mitchell-Netravali filter (B=1/3, C=1/3) - good balance of blur/ringing
-        t = std::abs(t);
-        if (t < 1.0f) {
-            return (12.0f - 9.0f * (1.0f/3.0f) - 6.0f * (1.0f/3.0f)) * t * t * t
-                 + (-18.0f + 12.0f * (1.0f/3.0f) + 6.0f * (1.0f/3.0f)) * t * t
-                 + (6.0f - 2.0f * (1.0f/3.0f));
-        } else if (t < 2.0f) {
-            return (-(1.0f/3.0f) - 6.0f * (1.0f/3.0f)) * t * t * t
-                 + (6.0f * (1.0f/3.0f) + 30.0f * (1.0f/3.0f)) * t * t
-                 + (-12.0f * (1.0f/3.0f) - 48.0f * (1.0f/3.0f)) * t
-                 + (8.0f * (1.0f/3.0f) + 24.0f * (1.0f/3.0f));
-        }
-        return 0.0f;
+    return validPixels;
+}
+
+int TiledMFSRPipeline::accumulateUniformShift(
+    const std::vector<RGBImage>& tileCrops,
+    const std::vector<MotionModel>& tileMotion,
+    int referenceIndex,
+    RGBImage& output
+) {
+    const int numFrames = static_cast<int>(tileCrops.size());
+    const int outWidth = output.width;
+    const int outHeight = output.height;
+    const float scale = static_cast<float>(config_.scaleFactor);
+    const RGBImage& refCrop = tileCrops[referenceIndex];
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // With one shift per frame every sample lands at the same sub-pixel phase
+    // (per scale step), so the splat weights are separable and depend only on
+    // the output column / row: tabulate them once per frame. The robustness
+    // weight still depends on the sample; invalid samples get 0.
+    struct ShiftFrame {
+        std::vector<SplatTaps> colTaps;     // Per output column
+        std::vector<SplatTaps> rowTaps;     // Per output row
+        ImageBuffer<float> robust;          // Per input sample
     };
+    std::vector<ShiftFrame> shiftFrames(numFrames);
     
-    // Fill gaps with bicubic-upscaled reference frame
-    for (int y = 0; y < outHeight; ++y) {
-        for (int x = 0; x < outWidth; ++x) {
-            if (accumulator.at(x, y).weight > 0.0f) continue;
-            
-            // Map HR position back to LR reference frame
-            float srcX = static_cast<float>(x) / config_.scaleFactor;
-            float srcY = static_cast<float>(y) / config_.scaleFactor;
-            
-            // Bicubic interpolation from reference frame
-            int x0 = static_cast<int>(std::floor(srcX)) - 1;
-            int y0 = static_cast<int>(std::floor(srcY)) - 1;
+    pool.parallelFor(0, numFrames, [&](int f) {
+        const RGBImage& crop = tileCrops[f];
+        const FlowVector& shift = tileMotion[f].shift();
+        ShiftFrame& sf = shiftFrames[f];
+        
+        float offsetX, offsetY;
+        frameJitter(f, offsetX, offsetY);
+        
+        sf.colTaps.resize(outWidth);
+        for (int px = 0; px < outWidth; ++px) {
+            int s0, s1;
+            splatCandidateRange(px, px, scale, offsetX, shift.dx, shift.dx, crop.width, s0, s1);
+            buildSplatTaps(px, shift.dx, offsetX, config_.scaleFactor, s0, s1, outWidth, sf.colTaps[px]);
+        }
+        sf.rowTaps.resize(outHeight);
+        for (int py = 0; py < outHeight; ++py) {
+            int s0, s1;
+            splatCandidateRange(py, py, scale, offsetY, shift.dy, shift.dy, crop.height, s0, s1);
+            buildSplatTaps(py, shift.dy, offsetY, config_.scaleFactor, s0, s1, outHeight, sf.rowTaps[py]);
+        }
+        
+        sf.robust.resize(crop.width, crop.height);
+        for (int y = 0; y < crop.height; ++y) {
+            const RGBPixel* cropRow = crop.row(y);
+            float* robustRow = sf.robust.row(y);
             
-            float sumR = 0, sumG = 0, sumB = 0, sumW = 0;
+            for (int x = 0; x < crop.width; ++x) {
+                const RGBPixel& pixel = cropRow[x];
+                if (!std::isfinite(pixel.r) || !std::isfinite(pixel.g) || !std::isfinite(pixel.b)) {
+                    robustRow[x] = 0.0f;
+                } else if (f != referenceIndex && x < refCrop.width && y < refCrop.height) {
+                    robustRow[x] = computeRobustnessWeight(pixel, refCrop.at(x, y), shift.confidence);
+                } else {
+                    robustRow[x] = 1.0f;
+                }
+            }
+        }
+    });
+    
+    size_t tableBytes = 0;
+    for (const ShiftFrame& sf : shiftFrames) {
+        tableBytes += imageBytes(sf.robust) +
+                      (sf.colTaps.capacity() + sf.rowTaps.capacity()) * sizeof(SplatTaps);
+    }
+    ScopedMemory tableMemory(memoryTracker_, tableBytes);
+    
+    std::atomic<int> validPixels(0);
+    
+    pool.parallelForRows(0, outHeight, [&](int rowBegin, int rowEnd) {
+        int bandValid = 0;
+        
+        for (int py = rowBegin; py < rowEnd; ++py) {
+            RGBPixel* outRow = output.row(py);
             
-            for (int ky = 0; ky < 4; ++ky) {
-                int py = y0 + ky;
-                if (py < 0 || py >= refCrop.height) continue;
-                
-                float wy = bicubicWeight(srcY - py) / 6.0f;  // Normalize
+            for (int px = 0; px < outWidth; ++px) {
+                SampleAccumulator acc;
                 
-                for (int kx = 0; kx < 4; ++kx) {
-                    int px = x0 + kx;
-                    if (px < 0 || px >= refCrop.width) continue;
+                // Same summation order as the scatter kernel (frame, row, column)
+                for (int f = 0; f < numFrames; ++f) {
+                    const ShiftFrame& sf = shiftFrames[f];
+                    const SplatTaps& rowTaps = sf.rowTaps[py];
+                    const SplatTaps& colTaps = sf.colTaps[px];
+                    const float confidence = tileMotion[f].shift().confidence;
                     
-                    float wx = bicubicWeight(srcX - px) / 6.0f;
-                    float w = wx * wy;
-                    
-                    const RGBPixel& p = refCrop.at(px, py);
-                    sumR += p.r * w;
-                    sumG += p.g * w;
-                    sumB += p.b * w;
-                    sumW += w;
+                    for (int ty = 0; ty < rowTaps.count; ++ty) {
+                        const int y = rowTaps.src[ty];
+                        const float wy = rowTaps.weight[ty];
+                        const RGBPixel* cropRow = tileCrops[f].row(y);
+                        const float* robustRow = sf.robust.row(y);
+                        
+                        for (int tx = 0; tx < colTaps.count; ++tx) {
+                            const int x = colTaps.src[tx];
+                            float w = colTaps.weight[tx] * wy * confidence * robustRow[x];
+                            if (w <= 0.0f) continue;
+                            acc.add(cropRow[x], w);
+                        }
+                    }
+                }
+                
+                RGBPixel& out = outRow[px];
+                if (acc.weight > 0.0f) {
+                    resolveAccumulated(acc.r, acc.g, acc.b, acc.weight, acc.localMin, acc.localMax, out);
+                    bandValid++;
+                } else {
+                    out.r = out.g = out.b = 0.0f;
+                    if (fillGapFromReference(refCrop, px, py, config_.scaleFactor, out)) {
+                        bandValid++;
+                    }
                 }
             }
+        }
+        
+        validPixels += bandValid;
+    });
+    
+    return validPixels.load();
+}
+
+int TiledMFSRPipeline::accumulateGather(
+    const std::vector<RGBImage>& tileCrops,
+    const std::vector<MotionModel>& tileMotion,
+    int referenceIndex,
+    RGBImage& output
+) {
+    const int numFrames = static_cast<int>(tileCrops.size());
+    const int outWidth = output.width;
+    const int outHeight = output.height;
+    const float scale = static_cast<float>(config_.scaleFactor);
+    const RGBImage& refCrop = tileCrops[referenceIndex];
+    ThreadPool& pool = ThreadPool::instance();
+    
+    // Flow bounds over each whole crop bound the candidate window of any block
+    struct FrameBounds {
+        float minDx, maxDx, minDy, maxDy;
+    };
+    std::vector<FrameBounds> frameBounds(numFrames);
+    std::vector<float> frameOffsetX(numFrames), frameOffsetY(numFrames);
+    
+    for (int f = 0; f < numFrames; ++f) {
+        const RGBImage& crop = tileCrops[f];
+        FrameBounds& fb = frameBounds[f];
+        frameJitter(f, frameOffsetX[f], frameOffsetY[f]);
+        tileMotion[f].bounds(0, 0, crop.width - 1, crop.height - 1, fb.minDx, fb.maxDx, fb.minDy, fb.maxDy);
+    }
+    
+    auto candidateRange = [scale](int p0, int p1, float offset, float minD, float maxD,
+                                  int limit, int& s0, int& s1) {
+        splatCandidateRange(p0, p1, scale, offset, minD, maxD, limit, s0, s1);
+    };
+    
+    // Output blocks are small enough that flow bounds over their candidate
+    // region stay tight (uniform or piecewise-constant tile motion)
+    static const int kBlockSize = 16;
+    const int kNoFootprint = std::numeric_limits<int>::min() / 2;
+    std::atomic<int> validPixels(0);
+    
+    pool.parallelForRows(0, outHeight, [&](int rowBegin, int rowEnd) {
+        // Per-frame state for the current output block. Sample state is evaluated
+        // from the motion model for the block's candidate window only, so nothing
+        // input-sized is stored. Samples the scatter kernel skips (invalid pixels,
+        // destinations out of bounds) get a footprint origin no output matches.
+        struct FrameWindow {
+            int x0, x1, y0, y1, stride;         // Candidate input rect for the block
+            float minDx, maxDx, minDy, maxDy;   // Flow bounds inside it
+            bool uniform;                       // Single shift: use the separable taps
+            SplatTaps colTaps[kBlockSize];
+            SplatTaps rowTaps[kBlockSize];
+            std::vector<float> confidence;      // Per window sample
+            std::vector<float> robust;
+            std::vector<float> dstX, dstY;      // Destination in the high-res grid
+            std::vector<int> footX, footY;      // Top-left of the 4x4 footprint
+        };
+        std::vector<FrameWindow> windows(numFrames);
+        int bandValid = 0;
+        
+        for (int by = rowBegin; by < rowEnd; by += kBlockSize) {
+            const int byEnd = std::min(by + kBlockSize, rowEnd);
             
-            if (sumW > 0.0f) {
-                RGBPixel& out = result.outputTile.at(x, y);
-                out.r = clamp(sumR / sumW, 0.0f, 1.0f);
-                out.g = clamp(sumG / sumW, 0.0f, 1.0f);
-                out.b = clamp(sumB / sumW, 0.0f, 1.0f);
-                validPixels++;
+            for (int bx = 0; bx < outWidth; bx += kBlockSize) {
+                const int bxEnd = std::min(bx + kBlockSize, outWidth);
+                
+                for (int f = 0; f < numFrames; ++f) {
+                    const FrameBounds& fb = frameBounds[f];
+                    const MotionModel& motion = tileMotion[f];
+                    const RGBImage& crop = tileCrops[f];
+                    FrameWindow& win = windows[f];
+                    
+                    // Candidate rect from the crop-wide flow bounds, then tightened to
+                    // the flow bounds found inside it (still covers every contributor)
+                    candidateRange(bx, bxEnd - 1, frameOffsetX[f], fb.minDx, fb.maxDx, crop.width, win.x0, win.x1);
+                    candidateRange(by, byEnd - 1, frameOffsetY[f], fb.minDy, fb.maxDy, crop.height, win.y0, win.y1);
+                    if (win.x0 > win.x1 || win.y0 > win.y1) {
+                        // No sample of this frame reaches the block
+                        win.uniform = true;
+                        std::fill(std::begin(win.colTaps), std::end(win.colTaps), SplatTaps{0, {}, {}});
+                        std::fill(std::begin(win.rowTaps), std::end(win.rowTaps), SplatTaps{0, {}, {}});
+                        continue;
+                    }
+                    motion.bounds(win.x0, win.y0, win.x1, win.y1, win.minDx, win.maxDx, win.minDy, win.maxDy);
+                    win.uniform = win.minDx == win.maxDx && win.minDy == win.maxDy;
+                    win.stride = win.x1 - win.x0 + 1;
+                    
+                    const size_t windowSize = static_cast<size_t>(win.stride) * (win.y1 - win.y0 + 1);
+                    win.confidence.resize(windowSize);
+                    win.robust.resize(windowSize);
+                    if (!win.uniform) {
+                        win.dstX.resize(windowSize);
+                        win.dstY.resize(windowSize);
+                        win.footX.resize(windowSize);
+                        win.footY.resize(windowSize);
+                    }
+                    
+                    for (int y = win.y0; y <= win.y1; ++y) {
+                        const RGBPixel* cropRow = crop.row(y);
+                        size_t i = static_cast<size_t>(y - win.y0) * win.stride;
+                        
+                        for (int x = win.x0; x <= win.x1; ++x, ++i) {
+                            const RGBPixel& pixel = cropRow[x];
+                            const FlowVector fv = motion.at(x, y);
+                            win.confidence[i] = fv.confidence;
+                            
+                            bool valid = std::isfinite(pixel.r) && std::isfinite(pixel.g) && std::isfinite(pixel.b);
+                            if (!valid) {
+                                win.robust[i] = 0.0f;
+                            } else if (f != referenceIndex && x < refCrop.width && y < refCrop.height) {
+                                win.robust[i] = computeRobustnessWeight(pixel, refCrop.at(x, y), fv.confidence);
+                            } else {
+                                win.robust[i] = 1.0f;
+                            }
+                            
+                            if (win.uniform) continue;
+                            
+                            float dstX = (x - fv.dx + frameOffsetX[f]) * config_.scaleFactor;
+                            float dstY = (y - fv.dy + frameOffsetY[f]) * config_.scaleFactor;
+                            win.dstX[i] = dstX;
+                            win.dstY[i] = dstY;
+                            win.footX[i] = kNoFootprint;
+                            win.footY[i] = kNoFootprint;
+                            if (valid && dstX >= 0 && dstX < outWidth - 1 && dstY >= 0 && dstY < outHeight - 1) {
+                                win.footX[i] = static_cast<int>(std::floor(dstX)) - 1;
+                                win.footY[i] = static_cast<int>(std::floor(dstY)) - 1;
+                            }
+                        }
+                    }
+                    
+                    // A single shift makes weights separable: precompute the taps per
+                    // output column and row (bit-identical to the per-sample weights)
+                    if (win.uniform) {
+                        for (int px = bx; px < bxEnd; ++px) {
+                            int s0, s1;
+                            candidateRange(px, px, frameOffsetX[f], win.minDx, win.maxDx, crop.width, s0, s1);
+                            buildSplatTaps(px, win.minDx, frameOffsetX[f], config_.scaleFactor,
+                                           std::max(s0, win.x0), std::min(s1, win.x1), outWidth,
+                                           win.colTaps[px - bx]);
+                        }
+                        for (int py = by; py < byEnd; ++py) {
+                            int s0, s1;
+                            candidateRange(py, py, frameOffsetY[f], win.minDy, win.maxDy, crop.height, s0, s1);
+                            buildSplatTaps(py, win.minDy, frameOffsetY[f], config_.scaleFactor,
+                                           std::max(s0, win.y0), std::min(s1, win.y1), outHeight,
+                                           win.rowTaps[py - by]);
+                        }
+                    }
+                }
+                
+                for (int py = by; py < byEnd; ++py) {
+                    RGBPixel* outRow = output.row(py);
+                    
+                    for (int px = bx; px < bxEnd; ++px) {
+                        SampleAccumulator acc;
+                        
+                        // Frames, then input rows, then columns: the same order in which
+                        // the scatter kernel adds to this pixel, so sums are identical
+                        for (int f = 0; f < numFrames; ++f) {
+                            const FrameWindow& win = windows[f];
+                            const RGBImage& crop = tileCrops[f];
+                            
+                            if (win.uniform) {
+                                const SplatTaps& rowTaps = win.rowTaps[py - by];
+                                const SplatTaps& colTaps = win.colTaps[px - bx];
+                                
+                                for (int ty = 0; ty < rowTaps.count; ++ty) {
+                                    const int y = rowTaps.src[ty];
+                                    const float wy = rowTaps.weight[ty];
+                                    const RGBPixel* cropRow = crop.row(y);
+                                    const size_t rowOffset = static_cast<size_t>(y - win.y0) * win.stride - win.x0;
+                                    const float* confRow = win.confidence.data() + rowOffset;
+                                    const float* robustRow = win.robust.data() + rowOffset;
+                                    
+                                    for (int tx = 0; tx < colTaps.count; ++tx) {
+                                        const int x = colTaps.src[tx];
+                                        float w = colTaps.weight[tx] * wy * confRow[x] * robustRow[x];
+                                        if (w <= 0.0f) continue;
+                                        acc.add(cropRow[x], w);
+                                    }
+                                }
+                                continue;
+                            }
+                            
+                            int sx0, sx1, sy0, sy1;
+                            candidateRange(px, px, frameOffsetX[f], win.minDx, win.maxDx, crop.width, sx0, sx1);
+                            candidateRange(py, py, frameOffsetY[f], win.minDy, win.maxDy, crop.height, sy0, sy1);
+                            sx0 = std::max(sx0, win.x0);
+                            sx1 = std::min(sx1, win.x1);
+                            sy0 = std::max(sy0, win.y0);
+                            sy1 = std::min(sy1, win.y1);
+                            
+                            for (int y = sy0; y <= sy1; ++y) {
+                                const RGBPixel* cropRow = crop.row(y);
+                                const size_t rowOffset = static_cast<size_t>(y - win.y0) * win.stride - win.x0;
+                                const float* confRow = win.confidence.data() + rowOffset;
+                                const float* robustRow = win.robust.data() + rowOffset;
+                                const float* dstXRow = win.dstX.data() + rowOffset;
+                                const float* dstYRow = win.dstY.data() + rowOffset;
+                                const int* footXRow = win.footX.data() + rowOffset;
+                                const int* footYRow = win.footY.data() + rowOffset;
+                                
+                                for (int x = sx0; x <= sx1; ++x) {
+                                    // Inside this sample's 4x4 footprint?
+                                    if (static_cast<unsigned>(px - footXRow[x]) > 3u ||
+                                        static_cast<unsigned>(py - footYRow[x]) > 3u) {
+                                        continue;
+                                    }
+                                    
+                                    float wy = mitchellWeight(dstYRow[x] - py);
+                                    float wx = mitchellWeight(dstXRow[x] - px);
+                                    float w = wx * wy * confRow[x] * robustRow[x];
+                                    if (w <= 0.0f) continue;
+                                    acc.add(cropRow[x], w);
+                                }
+                            }
+                        }
+                        
+                        RGBPixel& out = outRow[px];
+                        if (acc.weight > 0.0f) {
+                            resolveAccumulated(acc.r, acc.g, acc.b, acc.weight, acc.localMin, acc.localMax, out);
+                            bandValid++;
+                        } else {
+                            out.r = out.g = out.b = 0.0f;
+                            if (fillGapFromReference(refCrop, px, py, config_.scaleFactor, out)) {
+                                bandValid++;
+                            }
+                        }
+                    }
+                }
             }
         }
-    }
+        
+        validPixels += bandValid;
+    });
     
-    result.coverage = static_cast<float>(validPixels) / (outWidth * outHeight);
-    result.framesContributed = numFrames;
-    result.success = result.coverage > 0.5f;
+    return validPixels.load();
 }
 
 void TiledMFSRPipeline::process(
@@ -768,294 +1690,290 @@ void TiledMFSRPipeline::process(
     PipelineResult& result,
     TilePipelineProgress progressCallback
 ) {
-    auto startTime = std::chrono::high_resolution_clock::now();
-    
     if (frames.empty()) {
         LOGE("No frames provided");
         result.success = false;
         return;
     }
     
-    int width = frames[0].width;
-    int height = frames[0].height;
+    // Materialize the full output by streaming rows into result.outputImage
+    int outWidth = frames[0].width * config_.scaleFactor;
+    int outHeight = frames[0].height * config_.scaleFactor;
+    result.outputImage.resize(outWidth, outHeight);
+    
+    RGBImage& output = result.outputImage;
+    processStreaming(
+        frames, grayFrames, referenceIndex, gyroHomographies,
+        [&output](int y, const RGBPixel* row, int width) {
+            std::copy(row, row + width, output.row(y));
+        },
+        result,
+        progressCallback
+    );
+}
+
+void TiledMFSRPipeline::processStreaming(
+    const std::vector<RGBImage>& frames,
+    const std::vector<GrayImage>& grayFrames,
+    int referenceIndex,
+    const std::vector<GyroHomography>* gyroHomographies,
+    const OutputRowSink& sink,
+    PipelineResult& result,
+    TilePipelineProgress progressCallback
+) {
+    if (frames.size() != grayFrames.size()) {
+        LOGE("Frame count mismatch: %zu RGB, %zu gray", frames.size(), grayFrames.size());
+        result.success = false;
+        return;
+    }
+    
+    std::vector<ImageFrameSource> imageSources;
+    imageSources.reserve(frames.size());
+    std::vector<const FrameSource*> sources;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        imageSources.emplace_back(frames[i], grayFrames[i]);
+        sources.push_back(&imageSources.back());
+    }
+    
+    processStreaming(sources, referenceIndex, gyroHomographies, sink, result, progressCallback);
+}
+
+void TiledMFSRPipeline::processStreaming(
+    const std::vector<const FrameSource*>& frames,
+    int referenceIndex,
+    const std::vector<GyroHomography>* gyroHomographies,
+    const OutputRowSink& sink,
+    PipelineResult& result,
+    TilePipelineProgress progressCallback
+) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    if (frames.empty() || !sink) {
+        LOGE("No frames or output sink provided");
+        result.success = false;
+        return;
+    }
+    
+    int width = frames[0]->width();
+    int height = frames[0]->height();
+    
+    memoryTracker_.reset();
+    result.memoryBudgetBytes = config_.maxMemoryMB * 1024 * 1024;
     
     LOGI("Starting tiled MFSR pipeline: %dx%d, %zu frames, scale=%d",
          width, height, frames.size(), config_.scaleFactor);
     
     // Check fallback conditions
-    FallbackReason fallback = checkFallbackConditions(frames, grayFrames, referenceIndex);
+    FallbackReason fallback = checkFallbackConditions(frames, referenceIndex);
     if (fallback != FallbackReason::NONE) {
         LOGW("Falling back to single-frame upscale: reason=%d", static_cast<int>(fallback));
         result.fallbackReason = fallback;
-        fallbackUpscale(frames[referenceIndex], result);
+        RGBImage scratch;
+        fallbackUpscale(frames[referenceIndex]->fullRGB(scratch), sink, result);
         return;
     }
     
-    // Compute tile grid
-    std::vector<TileRegion> tiles = computeTileGrid(width, height);
+    // Global alignment pre-pass: one estimate per frame instead of one per tile and frame
+    std::vector<FrameMotionPrior> motionPriors;
+    if (usesMotionPriors()) {
+        motionPriors = estimateFrameMotionPriors(frames, referenceIndex, gyroHomographies);
+    }
+    
+    processTiles(frames, referenceIndex, gyroHomographies,
+                 motionPriors.empty() ? nullptr : &motionPriors,
+                 sink, result, progressCallback, startTime);
+}
+
+void TiledMFSRPipeline::processTiles(
+    const std::vector<const FrameSource*>& frames,
+    int referenceIndex,
+    const std::vector<GyroHomography>* gyroHomographies,
+    const std::vector<FrameMotionPrior>* motionPriorsPtr,
+    const OutputRowSink& sink,
+    PipelineResult& result,
+    TilePipelineProgress progressCallback,
+    std::chrono::high_resolution_clock::time_point startTime
+) {
+    int width = frames[0]->width();
+    int height = frames[0]->height();
+    
+    // Fit tile size and concurrency to the memory budget
+    MemoryPlan plan = planMemory(width, height, static_cast<int>(frames.size()));
+    if (!plan.withinBudget) {
+        LOGW("Memory budget %zu MB cannot be met: estimated %.1f MB with %dx%d tiles, running serially",
+             config_.maxMemoryMB, plan.estimatedPeakBytes() / (1024.0f * 1024.0f),
+             plan.tileWidth, plan.tileHeight);
+    }
+    LOGI("Memory plan: tile=%dx%d, %d concurrent, lookahead=%d, estimated %.1f MB (budget %zu MB)",
+         plan.tileWidth, plan.tileHeight, plan.maxConcurrentTiles, plan.lookaheadRows,
+         plan.estimatedPeakBytes() / (1024.0f * 1024.0f), config_.maxMemoryMB);
+    
+    // Compute tile grid (row-major)
+    std::vector<TileRegion> tiles = computeTileGrid(width, height, plan.tileWidth, plan.tileHeight);
     int totalTiles = static_cast<int>(tiles.size());
     
-    LOGI("Processing %d tiles", totalTiles);
+    int tilesPerRow = 0;
+    while (tilesPerRow < totalTiles && tiles[tilesPerRow].y == tiles[0].y) {
+        tilesPerRow++;
+    }
+    int tileRows = tilesPerRow > 0 ? totalTiles / tilesPerRow : 0;
     
-    // Allocate output image and weight map
     int outWidth = width * config_.scaleFactor;
     int outHeight = height * config_.scaleFactor;
     
-    result.outputImage.resize(outWidth, outHeight);
-    ImageBuffer<float> weightMap(outWidth, outHeight);
+    // Accumulation band: one tile row of output plus the overlap carried into the next row
+    int bandHeight = std::min(outHeight, plan.tileHeight * config_.scaleFactor);
+    RGBImage band(outWidth, bandHeight);
+    ImageBuffer<float> bandWeight(outWidth, bandHeight);
+    band.fill(RGBPixel(0, 0, 0));
+    bandWeight.fill(0.0f);
+    int bandY = 0;
+    
+    StreamingPostFilter postFilter(outWidth, outHeight, sink);
+    ScopedMemory bandMemory(memoryTracker_, imageBytes(band) + imageBytes(bandWeight) +
+                                            outWidth * 9 * sizeof(RGBPixel));
+    size_t peakResident = currentResidentBytes();
+    
+    // Process tiles on the shared thread pool. Each tile row is its own task
+    // group; tiles are launched in row-major order, at most maxConcurrentTiles
+    // at a time and at most lookaheadRows rows ahead of the row being finalized,
+    // which bounds the working set to the memory plan.
+    ThreadPool& pool = ThreadPool::instance();
+    const int lookaheadRows = plan.lookaheadRows;
+    LOGI("Processing %d tiles (%d rows) using %d threads", totalTiles, tileRows,
+         std::min(pool.concurrency(), plan.maxConcurrentTiles));
     
-    // Initialize to zero
-    for (int y = 0; y < outHeight; ++y) {
-        for (int x = 0; x < outWidth; ++x) {
-            result.outputImage.at(x, y) = RGBPixel(0, 0, 0);
-            weightMap.at(x, y) = 0.0f;
-        }
-    }
-    
-    // Process tiles in parallel using multiple CPU threads
-    // This significantly speeds up processing on multi-core devices
-    const int numThreads = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
-    LOGI("Processing %d tiles using %d threads", totalTiles, numThreads);
-    
-    // Pre-allocate tile results to avoid race conditions
     std::vector<TileResult> tileResults(totalTiles);
+    std::vector<std::unique_ptr<TaskGroup>> rowGroups(tileRows);
+    for (int r = 0; r < tileRows; ++r) {
+        rowGroups[r] = std::make_unique<TaskGroup>(pool);
+    }
     std::atomic<int> tilesCompleted(0);
     
-    // Worker function for processing tiles
-    // NOTE: Do NOT call progressCallback from worker threads - they are not attached to JVM
-    // and calling JNI functions (like NewStringUTF) will crash the app
-    auto processTileWorker = [&](int startIdx, int endIdx) {
-        for (int i = startIdx; i < endIdx; ++i) {
-            auto tileStart = std::chrono::high_resolution_clock::now();
-            
-            processTile(frames, grayFrames, tiles[i], referenceIndex, gyroHomographies, tileResults[i]);
-            
-            auto tileEnd = std::chrono::high_resolution_clock::now();
-            float tileMs = std::chrono::duration<float, std::milli>(tileEnd - tileStart).count();
-            
-            int completed = ++tilesCompleted;
-            LOGD("Tile %d/%d processed in %.1f ms (thread)", completed, totalTiles, tileMs);
+    std::mutex launchMutex;
+    int nextTile = 0;
+    int launchLimit = std::min(lookaheadRows, tileRows) * tilesPerRow;
+    int tilesInFlight = 0;
+    
+    // NOTE: Do NOT call progressCallback or the sink from pool tasks - pool threads are not
+    // attached to the JVM and calling JNI functions (like NewStringUTF) will crash the app
+    // A finishing tile launches its successor before its own task completes, so a
+    // row's group cannot drain while tiles of that row are still waiting for a slot.
+    std::function<void(int)> runTile;
+    auto launchTiles = [&](bool finishedTile) {
+        std::vector<int> launch;
+        {
+            std::lock_guard<std::mutex> lock(launchMutex);
+            if (finishedTile) tilesInFlight--;
+            while (tilesInFlight < plan.maxConcurrentTiles && nextTile < launchLimit) {
+                launch.push_back(nextTile++);
+                tilesInFlight++;
+            }
+        }
+        // Submit outside the lock: an inline pool runs the task right here
+        for (int i : launch) {
+            rowGroups[i / tilesPerRow]->run([&runTile, i]() { runTile(i); });
         }
     };
-    
-    // Distribute tiles across threads
-    std::vector<std::thread> threads;
-    int tilesPerThread = (totalTiles + numThreads - 1) / numThreads;
-    
-    for (int t = 0; t < numThreads; ++t) {
-        int startIdx = t * tilesPerThread;
-        int endIdx = std::min(startIdx + tilesPerThread, totalTiles);
-        if (startIdx < totalTiles) {
-            threads.emplace_back(processTileWorker, startIdx, endIdx);
+    runTile = [&](int i) {
+        auto tileStart = std::chrono::high_resolution_clock::now();
+        try {
+            processTile(frames, tiles[i], referenceIndex, gyroHomographies,
+                        motionPriorsPtr, tileResults[i]);
+        } catch (const std::exception& e) {
+            // Leave the result unsuccessful but keep the slot accounting intact
+            LOGE("Tile %d threw: %s", i, e.what());
         }
-    }
-    
-    // Poll for progress updates (safe way to report progress from JNI thread)
-    // Loop until all tiles are completed
-    int lastReported = 0;
-    while (tilesCompleted < totalTiles) {
-        // Sleep briefly to avoid busy waiting
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        auto tileEnd = std::chrono::high_resolution_clock::now();
+        float tileMs = std::chrono::duration<float, std::milli>(tileEnd - tileStart).count();
         
-        int current = tilesCompleted.load();
-        if (current > lastReported) {
-            if (progressCallback) {
-                float progress = static_cast<float>(current) / totalTiles;
-                // Map to 0.1 - 0.8 range
-                float overallProgress = 0.1f + (progress * 0.7f);
-                progressCallback(current, totalTiles, "Processing MFSR tiles", overallProgress);
-            }
-            lastReported = current;
-        }
-    }
-    
-    // Wait for all threads to complete (clean up)
-    for (auto& thread : threads) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
+        int completed = ++tilesCompleted;
+        LOGD("Tile %d/%d processed in %.1f ms (pool)", completed, totalTiles, tileMs);
+        
+        launchTiles(true);
+    };
     
-    // Report progress after all tiles are processed (safe - we're on the JNI-attached thread)
-    if (progressCallback) {
-        progressCallback(totalTiles, totalTiles, "Blending tiles", 0.80f);
-    }
+    launchTiles(false);
     
-    // Blend results sequentially (must be done after all tiles are processed)
-    // This is thread-safe since we're the only thread now
     float finalTotalFlow = 0.0f;
     int finalSuccessfulTiles = 0;
     int finalFailedTiles = 0;
+    int lastReported = 0;
     
-    for (int i = 0; i < totalTiles; ++i) {
-        if (tileResults[i].success) {
-            blendTileToOutput(tileResults[i].outputTile, tiles[i], result.outputImage, weightMap);
-            finalTotalFlow += tileResults[i].averageFlow;
-            finalSuccessfulTiles++;
-        } else {
-            finalFailedTiles++;
-            LOGW("Tile %d failed, coverage=%.1f%%", i, tileResults[i].coverage * 100);
-        }
-    }
-    
-    result.tilesFailed = finalFailedTiles;
-    
-    LOGI("Parallel processing complete: %d/%d tiles successful", finalSuccessfulTiles, totalTiles);
-    
-    // Normalize output by weight map
-    for (int y = 0; y < outHeight; ++y) {
-        for (int x = 0; x < outWidth; ++x) {
-            float w = weightMap.at(x, y);
-            if (w > 0.0f) {
-                RGBPixel& p = result.outputImage.at(x, y);
-                p.r = clamp(p.r / w, 0.0f, 1.0f);
-                p.g = clamp(p.g / w, 0.0f, 1.0f);
-                p.b = clamp(p.b / w, 0.0f, 1.0f);
+    for (int r = 0; r < tileRows; ++r) {
+        // Wait for this tile row, reporting progress from the calling (JNI-attached) thread.
+        // Waiting helps run queued tiles, so the caller contributes a core as well.
+        while (!rowGroups[r]->waitFor(std::chrono::milliseconds(50))) {
+            int current = tilesCompleted.load();
+            if (current > lastReported && progressCallback) {
+                float progress = static_cast<float>(current) / totalTiles;
+                progressCallback(current, totalTiles, "Processing MFSR tiles", 0.1f + progress * 0.85f);
             }
+            lastReported = std::max(lastReported, current);
+            peakResident = std::max(peakResident, currentResidentBytes());
         }
-    }
-    
-    // Post-processing: Edge-preserving smoothing to remove blotchy artifacts
-    // Uses a simplified bilateral filter approach similar to Google's HDR+
-    if (progressCallback) {
-        progressCallback(totalTiles, totalTiles, "Smoothing artifacts", 0.90f);
-    }
-    
-    // Create a copy for filtering
-    // Fix #6: Tuned bilateral filter parameters for less aggressive smoothing
-    // Previous values (spatialSigma=1.5, rangeSigma=0.08) were too aggressive,
-    // causing over-smoothing and loss of detail. New values preserve more texture.
-    RGBImage smoothed(outWidth, outHeight);
-    const int filterRadius = 2;  // Small radius for subtle smoothing
-    const float spatialSigma = 2.5f;   // Wider spatial kernel (was 1.5)
-    const float rangeSigma = 0.15f;    // More tolerant of color variation (was 0.08)
-    
-    int lastProgressRow = 0;
-    const int progressInterval = outHeight / 20;  // Update every 5%
-    
-    for (int y = filterRadius; y < outHeight - filterRadius; ++y) {
-        // Report progress during smoothing (90-95%)
-        if (progressCallback && (y - lastProgressRow) >= progressInterval) {
-            float smoothProgress = 0.90f + 0.05f * (static_cast<float>(y) / outHeight);
-            progressCallback(totalTiles, totalTiles, "Smoothing", smoothProgress);
-            lastProgressRow = y;
-        }
+        rowGroups[r].reset();
         
-        for (int x = filterRadius; x < outWidth - filterRadius; ++x) {
-            const RGBPixel& center = result.outputImage.at(x, y);
-            
-            float sumR = 0, sumG = 0, sumB = 0, sumW = 0;
-            
-            for (int dy = -filterRadius; dy <= filterRadius; ++dy) {
-                for (int dx = -filterRadius; dx <= filterRadius; ++dx) {
-                    const RGBPixel& neighbor = result.outputImage.at(x + dx, y + dy);
-                    
-                    // Spatial weight (Gaussian)
-                    float spatialDist = std::sqrt(static_cast<float>(dx*dx + dy*dy));
-                    float spatialW = std::exp(-spatialDist * spatialDist / (2.0f * spatialSigma * spatialSigma));
-                    
-                    // Range weight (color similarity)
-                    float colorDiff = std::sqrt(
-                        (neighbor.r - center.r) * (neighbor.r - center.r) +
-                        (neighbor.g - center.g) * (neighbor.g - center.g) +
-                        (neighbor.b - center.b) * (neighbor.b - center.b)
-                    );
-                    float rangeW = std::exp(-colorDiff * colorDiff / (2.0f * rangeSigma * rangeSigma));
-                    
-                    float w = spatialW * rangeW;
-                    sumR += neighbor.r * w;
-                    sumG += neighbor.g * w;
-                    sumB += neighbor.b * w;
-                    sumW += w;
-                }
-            }
-            
-            if (sumW > 0.0f) {
-                smoothed.at(x, y) = RGBPixel(
-                    clamp(sumR / sumW, 0.0f, 1.0f),
-                    clamp(sumG / sumW, 0.0f, 1.0f),
-                    clamp(sumB / sumW, 0.0f, 1.0f)
-                );
+        // Blend the finished row into the band and release tile memory
+        for (int i = r * tilesPerRow; i < (r + 1) * tilesPerRow; ++i) {
+            if (tileResults[i].success) {
+                blendTileToOutput(tileResults[i].outputTile, tiles[i], band, bandWeight, bandY);
+                finalTotalFlow += tileResults[i].averageFlow;
+                finalSuccessfulTiles++;
             } else {
-                smoothed.at(x, y) = center;
+                finalFailedTiles++;
+                LOGW("Tile %d failed, coverage=%.1f%%", i, tileResults[i].coverage * 100);
             }
-        }
-    }
-    
-    // Copy smoothed result back (excluding border)
-    for (int y = filterRadius; y < outHeight - filterRadius; ++y) {
-        for (int x = filterRadius; x < outWidth - filterRadius; ++x) {
-            result.outputImage.at(x, y) = smoothed.at(x, y);
-        }
-    }
-    
-    // Post-processing: Unsharp Mask (USM) sharpening to restore detail
-    // This is essential for MFSR output which tends to be soft due to averaging
-    if (progressCallback) {
-        progressCallback(totalTiles, totalTiles, "Sharpening", 0.95f);
-    }
-    
-    // USM parameters tuned for MFSR output
-    const float usmAmount = 0.5f;      // Sharpening strength (0.3-0.7 typical)
-    const float usmThreshold = 0.02f;  // Edge threshold to avoid noise amplification
-    const int usmRadius = 1;           // Small radius for fine detail
-    
-    // Create blurred version for USM (simple box blur for speed)
-    RGBImage blurred(outWidth, outHeight);
-    lastProgressRow = 0;
-    for (int y = usmRadius; y < outHeight - usmRadius; ++y) {
-        // Report progress during blur pass (95-97%)
-        if (progressCallback && (y - lastProgressRow) >= progressInterval) {
-            float blurProgress = 0.95f + 0.02f * (static_cast<float>(y) / outHeight);
-            progressCallback(totalTiles, totalTiles, "Sharpening", blurProgress);
-            lastProgressRow = y;
+            memoryTracker_.release(imageBytes(tileResults[i].outputTile));
+            tileResults[i] = TileResult();
         }
         
-        for (int x = usmRadius; x < outWidth - usmRadius; ++x) {
-            float sumR = 0, sumG = 0, sumB = 0;
-            int count = 0;
-            for (int dy = -usmRadius; dy <= usmRadius; ++dy) {
-                for (int dx = -usmRadius; dx <= usmRadius; ++dx) {
-                    const RGBPixel& p = result.outputImage.at(x + dx, y + dy);
-                    sumR += p.r;
-                    sumG += p.g;
-                    sumB += p.b;
-                    count++;
+        // Rows above the next tile row will not receive further contributions
+        int rowEnd = (r + 1 < tileRows) ? tiles[(r + 1) * tilesPerRow].outY : outHeight;
+        rowEnd = std::min(rowEnd, outHeight);
+        
+        // Normalize finished rows by weight and hand them to the post filter
+        for (int y = bandY; y < rowEnd; ++y) {
+            RGBPixel* p = band.row(y - bandY);
+            const float* w = bandWeight.row(y - bandY);
+            for (int x = 0; x < outWidth; ++x) {
+                if (w[x] > 0.0f) {
+                    p[x].r = clamp(p[x].r / w[x], 0.0f, 1.0f);
+                    p[x].g = clamp(p[x].g / w[x], 0.0f, 1.0f);
+                    p[x].b = clamp(p[x].b / w[x], 0.0f, 1.0f);
                 }
             }
-            blurred.at(x, y) = RGBPixel(sumR / count, sumG / count, sumB / count);
+            postFilter.pushRow(p);
         }
-    }
-    
-    // Apply USM: sharpened = original + amount * (original - blurred)
-    lastProgressRow = 0;
-    for (int y = usmRadius; y < outHeight - usmRadius; ++y) {
-        // Report progress during USM apply (97-99%)
-        if (progressCallback && (y - lastProgressRow) >= progressInterval) {
-            float usmProgress = 0.97f + 0.02f * (static_cast<float>(y) / outHeight);
-            progressCallback(totalTiles, totalTiles, "Finalizing", usmProgress);
-            lastProgressRow = y;
+        
+        // Slide the band so the overlap rows become its top
+        int consumed = rowEnd - bandY;
+        int carried = bandHeight - consumed;
+        if (consumed > 0 && carried > 0) {
+            std::copy(band.row(consumed), band.row(0) + band.size(), band.row(0));
+            std::copy(bandWeight.row(consumed), bandWeight.row(0) + bandWeight.size(), bandWeight.row(0));
         }
+        std::fill(band.row(std::max(carried, 0)), band.row(0) + band.size(), RGBPixel(0, 0, 0));
+        std::fill(bandWeight.row(std::max(carried, 0)), bandWeight.row(0) + bandWeight.size(), 0.0f);
+        bandY = rowEnd;
         
-        for (int x = usmRadius; x < outWidth - usmRadius; ++x) {
-            RGBPixel& p = result.outputImage.at(x, y);
-            const RGBPixel& b = blurred.at(x, y);
-            
-            // Compute high-frequency detail (difference from blur)
-            float diffR = p.r - b.r;
-            float diffG = p.g - b.g;
-            float diffB = p.b - b.b;
-            
-            // Only sharpen if detail is above threshold (avoid noise)
-            float detailMag = std::sqrt(diffR*diffR + diffG*diffG + diffB*diffB);
-            if (detailMag > usmThreshold) {
-                p.r = clamp(p.r + usmAmount * diffR, 0.0f, 1.0f);
-                p.g = clamp(p.g + usmAmount * diffG, 0.0f, 1.0f);
-                p.b = clamp(p.b + usmAmount * diffB, 0.0f, 1.0f);
+        // Row r's results are released; keep the lookahead window full
+        if (r + lookaheadRows < tileRows) {
+            {
+                std::lock_guard<std::mutex> lock(launchMutex);
+                launchLimit = (r + lookaheadRows + 1) * tilesPerRow;
             }
+            launchTiles(false);
         }
     }
     
+    // Flush the remaining halo rows through smoothing and sharpening
+    postFilter.finish();
+    
+    result.tilesFailed = finalFailedTiles;
+    
+    LOGI("Parallel processing complete: %d/%d tiles successful", finalSuccessfulTiles, totalTiles);
+    
     // DISABLED: Laplacian pyramid sharpening causes OOM on full 71MP output
     // The unsharp mask above already provides adequate sharpening
     // Multi-scale pyramid on 9728x7296 image creates ~300MB+ of temporary buffers
@@ -1086,14 +2004,265 @@ void TiledMFSRPipeline::process(
     result.tilesProcessed = finalSuccessfulTiles;
     result.averageFlow = finalSuccessfulTiles > 0 ? finalTotalFlow / finalSuccessfulTiles : 0.0f;
     result.processingTimeMs = static_cast<float>(duration.count());
+    result.peakWorkingSetBytes = memoryTracker_.peak();
+    result.peakResidentBytes = std::max(peakResident, currentResidentBytes());
+    result.memoryBudgetMet = result.memoryBudgetBytes == 0 ||
+                             result.peakWorkingSetBytes <= result.memoryBudgetBytes;
     result.success = finalSuccessfulTiles > 0;
     
     LOGI("MFSR complete: %d/%d tiles, avgFlow=%.2f, time=%.1fs",
          finalSuccessfulTiles, totalTiles, result.averageFlow, result.processingTimeMs / 1000.0f);
+    LOGI("Memory: peak working set %.1f MB (budget %zu MB%s), peak resident %.1f MB",
+         result.peakWorkingSetBytes / (1024.0f * 1024.0f), config_.maxMemoryMB,
+         result.memoryBudgetMet ? "" : ", exceeded",
+         result.peakResidentBytes / (1024.0f * 1024.0f));
     
     if (progressCallback) {
         progressCallback(totalTiles, totalTiles, "MFSR complete", 1.0f);
     }
 }
 
+bool TiledMFSRPipeline::beginBurst(int expectedFrames, int referenceIndex) {
+    if (burstOpen_) {
+        LOGE("beginBurst: a burst is already open");
+        return false;
+    }
+    if (expectedFrames < 2 || referenceIndex >= expectedFrames) {
+        LOGE("beginBurst: invalid burst (%d frames, reference %d)", expectedFrames, referenceIndex);
+        return false;
+    }
+    
+    burstOpen_ = true;
+    burstExpected_ = expectedFrames;
+    burstPushed_ = 0;
+    burstReference_ = referenceIndex >= 0 ? referenceIndex : expectedFrames / 2;
+    burstReferenceReady_ = false;
+    burstFrames_.clear();
+    burstFrames_.resize(expectedFrames);
+    burstPriors_.assign(expectedFrames, FrameMotionPrior());
+    burstWaiting_.clear();
+    burstQueue_ = std::make_unique<SerialTaskQueue>(ThreadPool::instance());
+    
+    LOGI("Incremental burst started: %d frames expected, reference %d",
+         expectedFrames, burstReference_);
+    return true;
+}
+
+bool TiledMFSRPipeline::pushFrame(const YUVFrame& frame, const GyroHomography* gyroHomography) {
+    if (!burstOpen_) {
+        LOGE("pushFrame: no burst is open");
+        return false;
+    }
+    if (burstPushed_ >= burstExpected_) {
+        LOGE("pushFrame: burst already has %d frames", burstExpected_);
+        return false;
+    }
+    if (!frame.yPlane || !frame.uPlane || !frame.vPlane) {
+        LOGE("pushFrame: missing plane");
+        return false;
+    }
+    if (burstPushed_ > 0) {
+        const StoredYUVFrame& first = burstFrames_[0]->yuv;
+        if (frame.width != first.width() || frame.height != first.height()) {
+            LOGE("pushFrame: frame is %dx%d, burst is %dx%d",
+                 frame.width, frame.height, first.width(), first.height());
+            return false;
+        }
+    } else {
+        // The frame size is known now: keep the burst in RAM only if it fits
+        size_t burstBytes = StoredYUVFrame::storageBytes(frame.width, frame.height) * burstExpected_;
+        size_t residentBudget = config_.maxResidentFramesMB > 0
+            ? config_.maxResidentFramesMB * 1024 * 1024
+            : availableSystemBytes() / 2;
+        burstSpill_ = residentBudget > 0 && burstBytes > residentBudget;
+        LOGI("Burst frames: %.1f MB for %d frames, resident budget %.1f MB -> %s",
+             burstBytes / (1024.0f * 1024.0f), burstExpected_,
+             residentBudget / (1024.0f * 1024.0f), burstSpill_ ? "spill files" : "RAM");
+    }
+    
+    // Copy on the caller's thread so the camera image can be released right away
+    auto stored = std::make_unique<BurstFrame>();
+    if (!stored->yuv.assign(frame, burstSpill_)) {
+        LOGE("pushFrame: cannot store frame %d", burstPushed_);
+        return false;
+    }
+    if (gyroHomography) {
+        stored->gyro = *gyroHomography;
+    }
+    int index = burstPushed_++;
+    burstFrames_[index] = std::move(stored);
+    
+    burstQueue_->post([this, index]() { ingestBurstFrame(index); });
+    return true;
+}
+
+void TiledMFSRPipeline::ingestBurstFrame(int index) {
+    if (index == burstReference_) {
+        setBurstReference(index);
+    } else if (burstReferenceReady_) {
+        analyzeBurstFrame(index);
+    } else {
+        burstWaiting_.push_back(index);
+    }
+}
+
+void TiledMFSRPipeline::setBurstReference(int index) {
+    burstReference_ = index;
+    
+    // Shake estimates read the stored reference band by band, so only the
+    // global alignment spectra are kept for it
+    const StoredYUVFrame& reference = burstFrames_[index]->yuv;
+    if (usesMotionPriors()) {
+        ScopedMemory scratchMemory(memoryTracker_, globalPriorScratchBytes(reference.width(), reference.height()));
+        GrayImage referenceWindow, referenceCoarse;
+        readGlobalWindow(reference, referenceWindow);
+        buildCoarseLuma(reference, referenceCoarse);
+        burstGlobalReference_ = hybridAligner_->prepareGlobalReference(
+            reference.width(), reference.height(), referenceWindow, referenceCoarse);
+    }
+    
+    burstPriors_[index].confidence = 1.0f;
+    burstPriors_[index].isValid = true;
+    burstReferenceReady_ = true;
+    
+    for (int waiting : burstWaiting_) {
+        analyzeBurstFrame(waiting);
+    }
+    burstWaiting_.clear();
+}
+
+void TiledMFSRPipeline::analyzeBurstFrame(int index) {
+    BurstFrame& frame = *burstFrames_[index];
+    
+    frame.globalMotion = estimateGlobalMotion(burstFrames_[burstReference_]->yuv, frame.yuv);
+    
+    if (usesMotionPriors()) {
+        const GyroHomography* gyroPtr = config_.useGyroInit && frame.gyro.isValid ? &frame.gyro : nullptr;
+        ScopedMemory scratchMemory(memoryTracker_, globalPriorScratchBytes(frame.yuv.width(), frame.yuv.height()));
+        GrayImage targetWindow, targetCoarse;
+        readGlobalWindow(frame.yuv, targetWindow);
+        buildCoarseLuma(frame.yuv, targetCoarse);
+        burstPriors_[index] = hybridAligner_->estimateGlobalMotion(
+            burstGlobalReference_, targetWindow, targetCoarse, gyroPtr);
+    }
+    
+    LOGD("Burst frame %d analyzed during capture: motion=%.1f, prior=(%.2f, %.2f)",
+         index, frame.globalMotion, burstPriors_[index].shiftX, burstPriors_[index].shiftY);
+}
+
+void TiledMFSRPipeline::abortBurst() {
+    if (burstOpen_) {
+        LOGW("Incremental burst aborted after %d/%d frames", burstPushed_, burstExpected_);
+        closeBurst();
+    }
+}
+
+void TiledMFSRPipeline::getBurstFrameSize(int& width, int& height) const {
+    // Frame 0 is never modified after it was pushed, so reading it here is safe
+    if (burstOpen_ && burstPushed_ > 0) {
+        width = burstFrames_[0]->yuv.width();
+        height = burstFrames_[0]->yuv.height();
+    } else {
+        width = 0;
+        height = 0;
+    }
+}
+
+void TiledMFSRPipeline::closeBurst() {
+    burstQueue_.reset();
+    burstOpen_ = false;
+    burstExpected_ = 0;
+    burstPushed_ = 0;
+    burstReference_ = -1;
+    burstReferenceReady_ = false;
+    burstSpill_ = false;
+    burstFrames_.clear();
+    burstPriors_.clear();
+    burstWaiting_.clear();
+    burstGlobalReference_ = GlobalAlignmentReference();
+}
+
+int TiledMFSRPipeline::finish(
+    const OutputRowSink& sink,
+    PipelineResult& result,
+    TilePipelineProgress progressCallback
+) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
+    if (!burstOpen_) {
+        LOGE("finish: no burst is open");
+        result.success = false;
+        return -1;
+    }
+    
+    // Usually only the last frame (or none) is still being analyzed here
+    burstQueue_->wait();
+    
+    const int numFrames = burstPushed_;
+    if (numFrames < 2 || !sink) {
+        LOGE("finish: %d frames pushed%s", numFrames, sink ? "" : ", no output sink");
+        result.success = false;
+        int reference = burstReference_;
+        closeBurst();
+        return reference;
+    }
+    
+    // The burst ended early without its reference: fall back to the middle pushed frame
+    if (!burstReferenceReady_) {
+        int reference = numFrames / 2;
+        LOGW("Reference frame %d never arrived (%d/%d pushed), using frame %d",
+             burstReference_, numFrames, burstExpected_, reference);
+        burstWaiting_.erase(std::remove(burstWaiting_.begin(), burstWaiting_.end(), reference),
+                            burstWaiting_.end());
+        setBurstReference(reference);
+    }
+    const int referenceIndex = burstReference_;
+    burstGlobalReference_ = GlobalAlignmentReference();
+    
+    // Stored frames are sources themselves: tiles read their blocks directly
+    std::vector<const FrameSource*> frames;
+    std::vector<GyroHomography> gyroHomographies;
+    bool anyGyro = false;
+    size_t spilledBytes = 0;
+    for (int i = 0; i < numFrames; ++i) {
+        const BurstFrame& frame = *burstFrames_[i];
+        frames.push_back(&frame.yuv);
+        gyroHomographies.push_back(frame.gyro);
+        anyGyro = anyGyro || frame.gyro.isValid;
+        if (frame.yuv.isSpilled()) spilledBytes += frame.yuv.sizeBytes();
+    }
+    
+    memoryTracker_.reset();
+    result.memoryBudgetBytes = config_.maxMemoryMB * 1024 * 1024;
+    
+    LOGI("Finishing incremental burst: %dx%d, %d frames, reference %d, scale=%d",
+         frames[0]->width(), frames[0]->height(), numFrames, referenceIndex, config_.scaleFactor);
+    
+    // Same rule as checkFallbackConditions, on the motion measured during capture
+    float maxMotion = 0.0f;
+    for (int i = 0; i < numFrames; ++i) {
+        if (i != referenceIndex) maxMotion = std::max(maxMotion, burstFrames_[i]->globalMotion);
+    }
+    
+    if (maxMotion > kMaxGlobalMotion) {
+        LOGW("Excessive motion detected: %.1f pixels (max allowed: %.1f), single-frame upscale",
+             maxMotion, kMaxGlobalMotion);
+        result.fallbackReason = FallbackReason::EXCESSIVE_MOTION;
+        RGBImage scratch;
+        fallbackUpscale(frames[referenceIndex]->fullRGB(scratch), sink, result);
+    } else {
+        std::vector<FrameMotionPrior> motionPriors;
+        if (usesMotionPriors()) {
+            motionPriors.assign(burstPriors_.begin(), burstPriors_.begin() + numFrames);
+        }
+        processTiles(frames, referenceIndex, anyGyro ? &gyroHomographies : nullptr,
+                     motionPriors.empty() ? nullptr : &motionPriors,
+                     sink, result, progressCallback, startTime);
+    }
+    result.spilledFrameBytes = spilledBytes;
+    
+    closeBurst();
+    return referenceIndex;
+}
+
 } // namespace ultradetail
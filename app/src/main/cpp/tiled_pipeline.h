@@ -2,7 +2,8 @@
  * tiled_pipeline.h - Tile-Based Processing Pipeline
  * 
  * Implements a memory-safe tile-by-tile processing strategy for the
- * entire MFSR pipeline. This ensures RAM usage stays constant (~200MB)
+ * entire MFSR pipeline. The working set is planned against
+ * TilePipelineConfig::maxMemoryMB (tile size, concurrent tiles, lookahead)
  * regardless of image size, preventing Android from killing the app.
  * 
  * Pipeline per tile:
@@ -19,11 +20,16 @@
 #include "common.h"
 #include "optical_flow.h"
 #include "phase_correlation.h"
+#include "motion_model.h"
+#include "memory_budget.h"
+#include "frame_store.h"
+#include "frame_source.h"
 #include "mfsr.h"
+#include "thread_pool.h"
+#include <chrono>
 #include <vector>
 #include <functional>
 #include <memory>
-#include <mutex>
 
 namespace ultradetail {
 
@@ -58,7 +64,17 @@ struct TilePipelineConfig {
     float robustnessThreshold = 0.8f;  // Base threshold - actual threshold is adaptive: base * (0.5 + 0.5 * flowConfidence)
     
     // Memory limits
-    size_t maxMemoryMB = 200;     // Target max memory per tile
+    // Working-set budget of the pipeline (tile crops, motion, accumulators, live tile
+    // results and the output band). Caller-owned input frames and a materialized
+    // output image are not included. Concurrency, lookahead and finally the tile
+    // size are reduced until the estimate fits (0 = unlimited).
+    size_t maxMemoryMB = 200;
+    
+    // Frames pushed to an incremental burst stay in RAM while the whole burst
+    // fits this budget; beyond it they go to memory-mapped spill files in the
+    // spill directory (see setSpillDirectory). 0 = half of the memory the
+    // system reports available when the first frame arrives.
+    size_t maxResidentFramesMB = 0;
     
     // Processing options
     bool useGyroInit = true;      // Use gyro for flow initialization
@@ -73,6 +89,18 @@ struct TilePipelineConfig {
     AlignmentMethod alignmentMethod = AlignmentMethod::HYBRID;  // Default to hybrid for best quality/speed
     bool useLocalRefinement = true;   // Use tile-based phase correlation for local refinement
     
+    // MFSR accumulation kernel (both produce identical output)
+    enum class AccumulationMethod {
+        SCATTER,    // Splat each input sample into a 4x4 footprint of a high-res accumulator
+        GATHER      // Gather covering samples per output pixel (row-parallel, no accumulator)
+    };
+    AccumulationMethod accumulationMethod = AccumulationMethod::GATHER;
+    
+    // Global alignment pre-pass: per-frame motion is estimated once on a downsampled
+    // pyramid level and tiles only refine it locally (HYBRID / PHASE_CORRELATION)
+    bool useGlobalAlignmentPrior = true;
+    int globalAlignmentLevel = 2;     // Pyramid level for the coarse global estimate (0 = full res)
+    
     TilePipelineConfig() {
         mfsrParams.scaleFactor = scaleFactor;
         // Optimized for speed while maintaining quality
@@ -99,6 +127,28 @@ struct TileRegion {
                    outX(0), outY(0), outWidth(0), outHeight(0) {}
 };
 
+/**
+ * Working-set plan for a pipeline run (see TiledMFSRPipeline::planMemory)
+ */
+struct MemoryPlan {
+    int tileWidth, tileHeight;    // Tile size to use (may be smaller than configured)
+    int maxConcurrentTiles;       // Tiles processed at the same time
+    int lookaheadRows;            // Tile rows scheduled ahead of the row being finalized
+    size_t tileBytes;             // Estimated working set of one tile being processed
+    size_t resultBytes;           // Estimated live tile results (lookahead window)
+    size_t fixedBytes;            // Output band and post-filter rings
+    size_t budgetBytes;           // Budget from maxMemoryMB (0 = unlimited)
+    bool withinBudget;            // Whether the estimate fits the budget
+    
+    MemoryPlan() : tileWidth(0), tileHeight(0), maxConcurrentTiles(1), lookaheadRows(1),
+                   tileBytes(0), resultBytes(0), fixedBytes(0), budgetBytes(0),
+                   withinBudget(true) {}
+    
+    size_t estimatedPeakBytes() const {
+        return fixedBytes + resultBytes + tileBytes * static_cast<size_t>(maxConcurrentTiles);
+    }
+};
+
 /**
  * Tile processing result
  */
@@ -118,6 +168,13 @@ struct TileResult {
  */
 using TilePipelineProgress = std::function<void(int, int, const char*, float)>;
 
+/**
+ * Streaming output sink for tiled pipeline
+ * Receives finished output rows in top-to-bottom order on the calling thread.
+ * Parameters: output row index, row pixels, row width
+ */
+using OutputRowSink = std::function<void(int, const RGBPixel*, int)>;
+
 /**
  * Fallback reason when MFSR fails
  */
@@ -143,6 +200,11 @@ struct PipelineResult {
     float processingTimeMs;       // Total processing time
     FallbackReason fallbackReason; // If fallback was used
     bool usedFallback;            // Whether fallback was triggered
+    size_t memoryBudgetBytes;     // Working-set budget (0 = unlimited)
+    size_t peakWorkingSetBytes;   // Measured peak of tracked pipeline buffers
+    size_t peakResidentBytes;     // Peak process resident set sampled during the run
+    bool memoryBudgetMet;         // peakWorkingSetBytes stayed within the budget
+    size_t spilledFrameBytes;     // Burst frames held in spill files instead of RAM
     bool success;
     
     PipelineResult() : inputWidth(0), inputHeight(0), 
@@ -150,7 +212,10 @@ struct PipelineResult {
                        tilesProcessed(0), tilesFailed(0),
                        averageFlow(0), processingTimeMs(0),
                        fallbackReason(FallbackReason::NONE),
-                       usedFallback(false), success(false) {}
+                       usedFallback(false),
+                       memoryBudgetBytes(0), peakWorkingSetBytes(0),
+                       peakResidentBytes(0), memoryBudgetMet(true),
+                       spilledFrameBytes(0), success(false) {}
 };
 
 /**
@@ -187,6 +252,110 @@ public:
         TilePipelineProgress progressCallback = nullptr
     );
     
+    /**
+     * Process burst frames and stream the upscaled image to a row sink
+     * 
+     * Tiles are processed in row-major order. As soon as a tile row is complete
+     * it is blended, normalized, smoothed and sharpened (with a small row halo)
+     * and the finished output rows are handed to the sink. Peak memory scales
+     * with the tile row height instead of the output size; result.outputImage
+     * is left empty.
+     * 
+     * @param frames Input RGB frames (already converted from YUV)
+     * @param grayFrames Grayscale versions for flow computation
+     * @param referenceIndex Index of reference frame
+     * @param gyroHomographies Optional gyro-based homographies for flow init
+     * @param sink Receives each finished output row exactly once, in order
+     * @param result Output pipeline result (statistics and dimensions only)
+     * @param progressCallback Optional progress callback
+     */
+    void processStreaming(
+        const std::vector<RGBImage>& frames,
+        const std::vector<GrayImage>& grayFrames,
+        int referenceIndex,
+        const std::vector<GyroHomography>* gyroHomographies,
+        const OutputRowSink& sink,
+        PipelineResult& result,
+        TilePipelineProgress progressCallback = nullptr
+    );
+    
+    /**
+     * Process burst frames pulled on demand from frame sources
+     * 
+     * Same as above, but tile crops are converted from the sources as each
+     * tile is processed, so no full-size float copy of the burst is needed.
+     * Whole-frame luma is only materialized transiently for the global
+     * motion check and alignment pre-pass.
+     * 
+     * @param frames Burst frame sources (must outlive the call)
+     */
+    void processStreaming(
+        const std::vector<const FrameSource*>& frames,
+        int referenceIndex,
+        const std::vector<GyroHomography>* gyroHomographies,
+        const OutputRowSink& sink,
+        PipelineResult& result,
+        TilePipelineProgress progressCallback = nullptr
+    );
+    
+    /**
+     * Start an incremental YUV burst
+     * 
+     * Frames are then handed over with pushFrame() while the camera is still
+     * capturing. Each one is copied and, on the shared pool, converted to luma
+     * and checked for shake and global motion against the reference, so
+     * finish() only has the tile stage left. Copies are stored tile-major, in
+     * spill files when the burst exceeds maxResidentFramesMB.
+     * 
+     * @param expectedFrames Number of frames the caller intends to push (>= 2)
+     * @param referenceIndex Reference frame index (-1 = middle of the burst)
+     * @return false if a burst is already open or the arguments are invalid
+     */
+    bool beginBurst(int expectedFrames, int referenceIndex);
+    
+    /**
+     * Add the next frame of the open burst (planes are copied before returning)
+     * 
+     * @param frame YUV_420_888 planes
+     * @param gyroHomography Optional gyro homography of this frame (copied)
+     * @return false if no burst is open, the burst is full, the size differs
+     *         or the frame cannot be stored
+     */
+    bool pushFrame(const YUVFrame& frame, const GyroHomography* gyroHomography = nullptr);
+    
+    /**
+     * Wait for the per-frame analysis, then run the tile stage
+     * 
+     * Same output as processStreaming() over the pushed frames. If the burst
+     * ended before its reference was pushed, the middle pushed frame is used.
+     * Progress and the sink are only called from the calling thread.
+     * 
+     * @param sink Receives each finished output row exactly once, in order
+     * @param result Output pipeline result (statistics and dimensions only)
+     * @param progressCallback Optional progress callback
+     * @return Reference frame index used, or -1 if no burst was open
+     */
+    int finish(
+        const OutputRowSink& sink,
+        PipelineResult& result,
+        TilePipelineProgress progressCallback = nullptr
+    );
+    
+    /**
+     * Drop the open burst without processing it
+     */
+    void abortBurst();
+    
+    /**
+     * Frame size of the open burst (0 x 0 until the first frame is pushed)
+     */
+    void getBurstFrameSize(int& width, int& height) const;
+    
+    /**
+     * Get configuration
+     */
+    const TilePipelineConfig& getConfig() const { return config_; }
+    
     /**
      * Compute tile grid for given image dimensions
      * 
@@ -196,36 +365,72 @@ public:
      */
     std::vector<TileRegion> computeTileGrid(int width, int height) const;
     
+    /**
+     * Compute tile grid with an explicit tile size
+     */
+    std::vector<TileRegion> computeTileGrid(int width, int height, int tileWidth, int tileHeight) const;
+    
+    /**
+     * Plan tile size and concurrency so the estimated working set fits maxMemoryMB
+     * 
+     * Concurrent tiles are capped first, then the tile-row lookahead, then the
+     * tile size is halved (down to kMinTileSize). If even the smallest plan
+     * does not fit it is returned with withinBudget = false.
+     * 
+     * @param width Input width
+     * @param height Input height
+     * @param numFrames Burst size
+     */
+    MemoryPlan planMemory(int width, int height, int numFrames) const;
+    
     /**
      * Process a single tile
      * 
-     * @param frames Input RGB frames
-     * @param grayFrames Grayscale frames
+     * @param frames Burst frame sources
      * @param tile Tile region to process
      * @param referenceIndex Reference frame index
      * @param gyroHomographies Optional gyro homographies
+     * @param motionPriors Optional per-frame global motion (see estimateFrameMotionPriors)
      * @param result Output tile result
      */
     void processTile(
-        const std::vector<RGBImage>& frames,
-        const std::vector<GrayImage>& grayFrames,
+        const std::vector<const FrameSource*>& frames,
         const TileRegion& tile,
         int referenceIndex,
         const std::vector<GyroHomography>* gyroHomographies,
+        const std::vector<FrameMotionPrior>* motionPriors,
         TileResult& result
     );
     
+    /**
+     * Estimate the global motion of every frame once, before tiling
+     * 
+     * Frames are aligned on a downsampled pyramid level seeded by the gyro,
+     * in parallel on the shared pool. The reference gets a zero prior. Each
+     * frame's coarse level and fine window are read from its source in row
+     * bands, so no whole-frame luma is held; the scratch is counted in the
+     * memory tracker.
+     * 
+     * @param frames Burst frame sources
+     * @param referenceIndex Reference frame index
+     * @param gyroHomographies Optional gyro homographies
+     * @return One prior per frame
+     */
+    std::vector<FrameMotionPrior> estimateFrameMotionPriors(
+        const std::vector<const FrameSource*>& frames,
+        int referenceIndex,
+        const std::vector<GyroHomography>* gyroHomographies
+    );
+    
     /**
      * Check if MFSR should fall back to single-frame upscale
      * 
-     * @param frames Input frames
-     * @param grayFrames Grayscale frames
+     * @param frames Burst frame sources
      * @param referenceIndex Reference frame index
      * @return Fallback reason (NONE if MFSR should proceed)
      */
     FallbackReason checkFallbackConditions(
-        const std::vector<RGBImage>& frames,
-        const std::vector<GrayImage>& grayFrames,
+        const std::vector<const FrameSource*>& frames,
         int referenceIndex
     );
     
@@ -239,37 +444,187 @@ public:
         const RGBImage& referenceFrame,
         PipelineResult& result
     );
+    
+    /**
+     * Perform single-frame fallback upscale, streaming rows to a sink
+     * 
+     * @param referenceFrame Reference frame to upscale
+     * @param sink Receives each upscaled output row in order
+     * @param result Output result (dimensions only)
+     */
+    void fallbackUpscale(
+        const RGBImage& referenceFrame,
+        const OutputRowSink& sink,
+        PipelineResult& result
+    );
 
 private:
     TilePipelineConfig config_;
     
-    // Optical flow processor (reused across tiles) - used when alignmentMethod == DENSE_OPTICAL_FLOW
-    std::unique_ptr<DenseOpticalFlow> flowProcessor_;
+    // Smallest tile edge the memory planner shrinks to
+    static constexpr int kMinTileSize = 64;
+    
+    // Tracks the buffers owned by the current run (tiles may run concurrently)
+    MemoryTracker memoryTracker_;
     
-    // Hybrid aligner (Fix #5 & #1) - used when alignmentMethod == HYBRID or PHASE_CORRELATION
+    // Hybrid aligner (Fix #5 & #1) - used when alignmentMethod == HYBRID or PHASE_CORRELATION.
+    // Reentrant and shared by all tile workers.
     std::unique_ptr<HybridAligner> hybridAligner_;
     
     // MFSR processor (reused across tiles)
     std::unique_ptr<MultiFrameSR> mfsrProcessor_;
     
-    // Mutex to protect shared alignment resources during multi-threaded processing
-    mutable std::mutex alignmentMutex_;
+    // Incremental burst state (beginBurst / pushFrame / finish). Slots are
+    // filled by pushFrame and only touched by the ingestion queue afterwards,
+    // until finish() has waited for it.
+    struct BurstFrame {
+        StoredYUVFrame yuv;             // Tile-major copy, resident or spilled
+        GyroHomography gyro;            // isValid = false when none was pushed
+        float globalMotion = 0.0f;      // Shake estimate against the reference
+    };
+    bool burstOpen_ = false;
+    int burstExpected_ = 0;
+    int burstPushed_ = 0;
+    int burstReference_ = -1;
+    bool burstReferenceReady_ = false;
+    bool burstSpill_ = false;                       // Frames go to spill files
+    std::vector<std::unique_ptr<BurstFrame>> burstFrames_;
+    std::vector<FrameMotionPrior> burstPriors_;
+    std::vector<int> burstWaiting_;                 // Frames waiting for the reference
+    GlobalAlignmentReference burstGlobalReference_;
+    std::unique_ptr<SerialTaskQueue> burstQueue_;
+    
+    // Largest global motion (pixels) before MFSR falls back to a single-frame upscale.
+    // Hand-held phones typically shift 20-100+ pixels between burst frames and the
+    // hybrid aligner (phase correlation + gyro) handles that, so only truly extreme
+    // cases (scene change, severe blur) are rejected. 50px fell back on normal shots.
+    static constexpr float kMaxGlobalMotion = 200.0f;
     
     /**
-     * Extract tile crop from image with padding
+     * Whether the global alignment pre-pass runs for this configuration
      */
-    void extractTileCrop(
-        const RGBImage& source,
-        const TileRegion& tile,
-        RGBImage& crop
+    bool usesMotionPriors() const;
+    
+    /**
+     * Coarse pyramid level used by the global alignment pre-pass, built from
+     * row bands of the source
+     */
+    void buildCoarseLuma(const FrameSource& frame, GrayImage& coarse) const;
+    
+    /**
+     * Full resolution luma of the window the global estimate correlates
+     * (empty if the frame is too small)
+     */
+    void readGlobalWindow(const FrameSource& frame, GrayImage& window) const;
+    
+    /**
+     * Working set of one frame in the global alignment pre-pass
+     */
+    size_t globalPriorScratchBytes(int width, int height) const;
+    
+    /**
+     * Background step for one pushed frame: analyze it or wait for the reference
+     */
+    void ingestBurstFrame(int index);
+    
+    /**
+     * Prepare the reference of the open burst and analyze the frames waiting for it
+     */
+    void setBurstReference(int index);
+    
+    /**
+     * Shake estimate and global motion prior of one pushed frame
+     */
+    void analyzeBurstFrame(int index);
+    
+    /**
+     * Release all incremental burst state
+     */
+    void closeBurst();
+    
+    /**
+     * Tile stage of processStreaming: plan, process tiles and stream rows
+     * 
+     * @param motionPriors Global alignment priors, or nullptr
+     * @param startTime Start of the run, for result.processingTimeMs
+     */
+    void processTiles(
+        const std::vector<const FrameSource*>& frames,
+        int referenceIndex,
+        const std::vector<GyroHomography>* gyroHomographies,
+        const std::vector<FrameMotionPrior>* motionPriors,
+        const OutputRowSink& sink,
+        PipelineResult& result,
+        TilePipelineProgress progressCallback,
+        std::chrono::high_resolution_clock::time_point startTime
     );
     
+    /**
+     * Extract RGB and luma tile crops with padding from a frame source
+     */
     void extractTileCrop(
-        const GrayImage& source,
+        const FrameSource& source,
         const TileRegion& tile,
-        GrayImage& crop
+        RGBImage& crop,
+        GrayImage& grayCrop
+    );
+    
+    /**
+     * MFSR accumulation by splatting every input sample into a 4x4
+     * Mitchell-Netravali footprint, then normalization and gap filling
+     * 
+     * @param tileCrops Tile crops of all frames
+     * @param tileMotion Alignment of each crop to the reference
+     * @param referenceIndex Reference frame index
+     * @param output Upscaled tile (pre-sized)
+     * @return Number of output pixels with data
+     */
+    int accumulateScatter(
+        const std::vector<RGBImage>& tileCrops,
+        const std::vector<MotionModel>& tileMotion,
+        int referenceIndex,
+        RGBImage& output
+    );
+    
+    /**
+     * Gather formulation of accumulateScatter with identical output
+     * 
+     * Each output pixel inverts the mapping to find the input samples whose
+     * footprint covers it and sums them in scatter order, so weights, sums and
+     * the de-ringing min/max match bit for bit. Output rows are independent
+     * and run in parallel on the pool; no high-res accumulator is allocated.
+     * Sample state is evaluated from the motion models per output block, so
+     * nothing input-sized is stored either.
+     */
+    int accumulateGather(
+        const std::vector<RGBImage>& tileCrops,
+        const std::vector<MotionModel>& tileMotion,
+        int referenceIndex,
+        RGBImage& output
+    );
+    
+    /**
+     * MFSR accumulation for tiles aligned by one translation per frame
+     * 
+     * Every sample of a frame shares the same sub-pixel phase, so splat weights
+     * are separable and tabulated once per output column and row (polyphase
+     * taps) instead of evaluating the Mitchell kernel 32 times per sample.
+     * Output matches accumulateScatter with uniform flow fields bit for bit.
+     * 
+     * @param tileMotion Alignment of each crop (all TRANSLATION models)
+     */
+    int accumulateUniformShift(
+        const std::vector<RGBImage>& tileCrops,
+        const std::vector<MotionModel>& tileMotion,
+        int referenceIndex,
+        RGBImage& output
     );
     
+    /**
+     * Estimated working set of one tile being processed
+     */
+    size_t estimateTileBytes(int tileWidth, int tileHeight, int numFrames) const;
+    
     /**
      * Compute robustness weight for a pixel
      */
@@ -280,13 +635,25 @@ private:
     );
     
     /**
-     * Blend tile into output image with overlap handling
+     * Blend tile into output band with overlap handling
+     * 
+     * @param bandY Output row that corresponds to row 0 of the band
      */
     void blendTileToOutput(
         const RGBImage& tile,
         const TileRegion& region,
         RGBImage& output,
-        ImageBuffer<float>& weightMap
+        ImageBuffer<float>& weightMap,
+        int bandY
+    );
+    
+    /**
+     * Bilinear upscale of one output row of the reference frame
+     */
+    void fallbackUpscaleRow(
+        const RGBImage& referenceFrame,
+        int y,
+        RGBPixel* outRow
     );
     
     /**
@@ -295,11 +662,12 @@ private:
     float computeBlendWeight(int x, int y, int width, int height, int overlap);
     
     /**
-     * Estimate global motion to check for excessive shake
+     * Estimate global motion to check for excessive shake, converting only
+     * the rows around one sample row at a time (counted in the memory tracker)
      */
     float estimateGlobalMotion(
-        const GrayImage& reference,
-        const GrayImage& frame
+        const FrameSource& reference,
+        const FrameSource& frame
     );
 };
 
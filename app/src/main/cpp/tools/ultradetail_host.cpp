@@ -0,0 +1,125 @@
+/**
+ * ultradetail_host.cpp - Command line driver for host (Linux) builds
+ *
+ * Runs the core library without a device, so it can be profiled (perf,
+ * VTune) and built with sanitizers (-DULTRADETAIL_SANITIZE=ON):
+ *
+ *   ultradetail_host bench <id>
+ *       Run a native benchmark (NativeMFSRPipeline.BENCHMARK_* ids) and
+ *       print its report.
+ *
+ *   ultradetail_host raw-merge [--ref N] <out.ppm> <cache file>...
+ *       Merge RAWC cache files pulled from the device (the app cache
+ *       dir's ultradetail_rawcache_*.raw) and write the demosaiced,
+ *       sRGB-encoded result as a binary PPM.
+ *
+ * Logs go to stderr; pass --quiet before the command to keep warnings and
+ * errors only.
+ */
+
+#include "native_benchmark.h"
+#include "raw_burst.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#undef LOG_TAG
+#define LOG_TAG "UltraDetailHost"
+
+using namespace ultradetail;
+
+static int usage() {
+    fprintf(stderr,
+            "usage: ultradetail_host [--quiet] bench <id>\n"
+            "       ultradetail_host [--quiet] raw-merge [--ref N] <out.ppm> <cache file>...\n");
+    return 2;
+}
+
+static int runBench(int argc, char** argv) {
+    if (argc != 1) return usage();
+
+    BenchmarkReport report = runBenchmark(static_cast<BenchmarkId>(atoi(argv[0])));
+    if (report.title.empty()) {
+        fprintf(stderr, "Unknown benchmark id %s\n", argv[0]);
+        return 1;
+    }
+    fputs(report.format().c_str(), stdout);
+    return 0;
+}
+
+/**
+ * Write 8-bit RGBA pixels as a binary PPM (alpha dropped)
+ */
+static bool writePPM(const std::string& path, const std::vector<uint8_t>& rgba, int width, int height) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        LOGE("Cannot open %s for writing", path.c_str());
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+    std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+    bool ok = true;
+    for (int y = 0; y < height && ok; ++y) {
+        const uint8_t* src = rgba.data() + static_cast<size_t>(y) * width * 4;
+        for (int x = 0; x < width; ++x) {
+            row[3 * x] = src[4 * x];
+            row[3 * x + 1] = src[4 * x + 1];
+            row[3 * x + 2] = src[4 * x + 2];
+        }
+        ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+    }
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        LOGE("Failed writing %s", path.c_str());
+    }
+    return ok;
+}
+
+static int runRawMerge(int argc, char** argv) {
+    RawMergeParams params;
+    int arg = 0;
+    if (arg + 1 < argc && strcmp(argv[arg], "--ref") == 0) {
+        params.referenceIndex = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (argc - arg < 2) return usage();
+
+    const std::string outputPath = argv[arg++];
+    std::vector<std::string> paths(argv + arg, argv + argc);
+
+    RawMergeResult result;
+    if (!mergeRawBurst(paths, params, result) || !result.success) {
+        return 1;
+    }
+
+    const int width = result.mosaic.width;
+    const int height = result.mosaic.height;
+    std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+    ArgbPackOptions options;
+    options.srgb = true;
+    demosaicToArgb(result.mosaic, result.pattern, RawDemosaicParams(), rgba.data(), width * 4, options);
+
+    LOGI("Merged %d of %zu frames (reference %d) in %.1f ms -> %s",
+         result.framesMerged, paths.size(), result.referenceIndex, result.processingTimeMs,
+         outputPath.c_str());
+    return writePPM(outputPath, rgba, width, height) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    setLogSink(LogSink::STDERR);
+
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "--quiet") == 0) {
+        setMinLogLevel(LogLevel::WARN);
+        ++arg;
+    }
+    if (arg >= argc) return usage();
+
+    const std::string command = argv[arg++];
+    if (command == "bench") return runBench(argc - arg, argv + arg);
+    if (command == "raw-merge") return runRawMerge(argc - arg, argv + arg);
+    return usage();
+}
@@ -18,6 +18,9 @@
 #include "texture_synthesis.h"
 #include "texture_synthesis_tiled.h"
 #include "exposure_fusion.h"
+#include "native_benchmark.h"
+#include "image_session.h"
+#include "raw_burst.h"
 
 using namespace ultradetail;
 
@@ -43,6 +46,295 @@ struct JNIProgressCallback {
     }
 };
 
+/**
+ * Input bitmaps locked for the lifetime of the object and exposed as RGBA8 views
+ *
+ * Lets the pipeline read tile crops straight from Bitmap memory instead of
+ * float copies of every frame. All bitmaps must be RGBA_8888 and the same size.
+ */
+class LockedBitmapFrames {
+public:
+    explicit LockedBitmapFrames(JNIEnv* env) : env_(env) {}
+
+    ~LockedBitmapFrames() {
+        for (jobject bitmap : bitmaps_) {
+            AndroidBitmap_unlockPixels(env_, bitmap);
+            env_->DeleteLocalRef(bitmap);
+        }
+    }
+
+    LockedBitmapFrames(const LockedBitmapFrames&) = delete;
+    LockedBitmapFrames& operator=(const LockedBitmapFrames&) = delete;
+
+    /**
+     * Lock every bitmap in the array
+     *
+     * @return false (logged) if a bitmap cannot be locked or does not match
+     */
+    bool lock(jobjectArray bitmaps, int width, int height) {
+        int count = env_->GetArrayLength(bitmaps);
+        for (int i = 0; i < count; ++i) {
+            jobject bitmap = env_->GetObjectArrayElement(bitmaps, i);
+
+            AndroidBitmapInfo info;
+            if (AndroidBitmap_getInfo(env_, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS ||
+                info.format != ANDROID_BITMAP_FORMAT_RGBA_8888 ||
+                static_cast<int>(info.width) != width || static_cast<int>(info.height) != height) {
+                LOGE("Bitmap %d is not a %dx%d RGBA_8888 bitmap", i, width, height);
+                env_->DeleteLocalRef(bitmap);
+                return false;
+            }
+
+            void* pixels;
+            if (AndroidBitmap_lockPixels(env_, bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
+                LOGE("Failed to lock bitmap %d", i);
+                env_->DeleteLocalRef(bitmap);
+                return false;
+            }
+
+            bitmaps_.push_back(bitmap);
+            views_.emplace_back(static_cast<const RGBA8Pixel*>(pixels), width, height, info.stride);
+        }
+        return true;
+    }
+
+    const std::vector<RGBA8View>& views() const { return views_; }
+
+private:
+    JNIEnv* env_;
+    std::vector<jobject> bitmaps_;
+    std::vector<RGBA8View> views_;
+};
+
+/**
+ * Tiled texture synthesis progress forwarded to a Java TileSynthProgressCallback
+ *
+ * Progress may be reported from worker threads, which are attached to the
+ * VM for the call. callback must be a global reference that outlives the
+ * synthesis.
+ */
+static TextureSynthProgressCallback makeTileSynthProgress(JNIEnv* env, jobject callback, jmethodID onProgress) {
+    JavaVM* jvm = nullptr;
+    env->GetJavaVM(&jvm);
+    
+    return [jvm, callback, onProgress](int completed, int total, float avgDetail) {
+        JNIEnv* callbackEnv = nullptr;
+        bool needsDetach = false;
+        
+        jint getEnvResult = jvm->GetEnv((void**)&callbackEnv, JNI_VERSION_1_6);
+        if (getEnvResult == JNI_EDETACHED) {
+            if (jvm->AttachCurrentThread(&callbackEnv, nullptr) == JNI_OK) {
+                needsDetach = true;
+            } else {
+                LOGE("TiledTextureSynth: Failed to attach thread for callback");
+                return;
+            }
+        } else if (getEnvResult != JNI_OK) {
+            LOGE("TiledTextureSynth: Failed to get JNI env for callback");
+            return;
+        }
+        
+        // Log every 10 tiles for debugging
+        if (completed % 10 == 0 || completed == total) {
+            LOGD("TiledTextureSynth: Progress callback: %d/%d tiles", completed, total);
+        }
+        
+        // Call the Java callback - pass completed, total, and split CPU/GPU (for now all CPU)
+        callbackEnv->CallVoidMethod(callback, onProgress, completed, total, completed, 0);
+        
+        // Check for Java exceptions
+        if (callbackEnv->ExceptionCheck()) {
+            LOGE("TiledTextureSynth: Exception in Java callback");
+            callbackEnv->ExceptionDescribe();
+            callbackEnv->ExceptionClear();
+        }
+        
+        if (needsDetach) {
+            jvm->DetachCurrentThread();
+        }
+    };
+}
+
+/**
+ * Sanitize a burst result and pack it into the output bitmap
+ *
+ * @return 0 on success, -4 to -7 if the bitmap cannot be used
+ */
+static jint writeBurstResult(JNIEnv* env, BurstProcessingResult& result, jobject outputBitmap) {
+    AndroidBitmapInfo bitmapInfo;
+    if (AndroidBitmap_getInfo(env, outputBitmap, &bitmapInfo) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        LOGE("Failed to get bitmap info");
+        return -4;
+    }
+    
+    if (bitmapInfo.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        LOGE("Output bitmap must be ARGB_8888");
+        return -5;
+    }
+    
+    void* bitmapPixels;
+    if (AndroidBitmap_lockPixels(env, outputBitmap, &bitmapPixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        LOGE("Failed to lock bitmap pixels");
+        return -6;
+    }
+    
+    // Verify merged image has valid data
+    LOGD("Merged image: %dx%d, bitmap: %dx%d stride=%d, MFSR=%s",
+         result.mergedImage.width, result.mergedImage.height,
+         bitmapInfo.width, bitmapInfo.height, bitmapInfo.stride,
+         result.mfsrApplied ? "applied" : "not applied");
+    
+    // Check if bitmap size matches result size
+    if (result.mergedImage.width != static_cast<int>(bitmapInfo.width) ||
+        result.mergedImage.height != static_cast<int>(bitmapInfo.height)) {
+        LOGW("Bitmap size mismatch: result=%dx%d, bitmap=%dx%d",
+             result.mergedImage.width, result.mergedImage.height,
+             bitmapInfo.width, bitmapInfo.height);
+        // If MFSR was applied but bitmap is wrong size, this is an error
+        // The caller should have allocated the correct size
+        if (result.mfsrApplied) {
+            AndroidBitmap_unlockPixels(env, outputBitmap);
+            LOGE("Output bitmap size doesn't match MFSR output");
+            return -7;
+        }
+    }
+    
+    // Compute and log image statistics for diagnostics
+    // This uses severity-based logging: HEALTHY=INFO, minor issues=WARN, serious=ERROR
+    ImageStats stats = computeImageStats(result.mergedImage);
+    stats.log("Merged image");
+    
+    // Handle invalid values - this is a SAFETY NET, not a fix
+    // Non-zero counts here indicate upstream bugs that should be investigated
+    if (!stats.isHealthy()) {
+        // Log as ERROR because this indicates a bug in the pipeline
+        LOGE("PIPELINE BUG: Merged image contains %d NaN + %d Inf values (%.4f%% invalid)",
+             stats.nanCount, stats.infCount, stats.invalidPercentage());
+        LOGE("This is a bug that should be fixed upstream. Sanitizing as safety measure...");
+        
+        int sanitized = sanitizeRGBImage(result.mergedImage);
+        LOGW("Sanitized %d pixels (replaced NaN/Inf with black, clamped to [0,1])", sanitized);
+        
+        // Verify sanitization worked
+        ImageStats postStats = computeImageStats(result.mergedImage);
+        if (postStats.isHealthy()) {
+            LOGI("Post-sanitization: image is now numerically healthy");
+        } else {
+            LOGE("Post-sanitization: STILL UNHEALTHY - this should not happen!");
+        }
+    }
+    
+#if ULTRADETAIL_DEBUG
+    // Sample a few pixels for debugging (only in debug builds)
+    if (result.mergedImage.width > 0 && result.mergedImage.height > 0) {
+        int cx = result.mergedImage.width / 2;
+        int cy = result.mergedImage.height / 2;
+        const RGBPixel& centerPx = result.mergedImage.at(cx, cy);
+        LOGD_DEBUG("Center pixel (%d,%d): R=%.3f G=%.3f B=%.3f",
+             cx, cy, centerPx.r, centerPx.g, centerPx.b);
+    }
+#endif
+    
+    // Convert float RGB to RGBA bitmap
+    rgbFloatToArgb(result.mergedImage, static_cast<uint8_t*>(bitmapPixels), bitmapInfo.stride);
+    
+    AndroidBitmap_unlockPixels(env, outputBitmap);
+    
+    // Final status log with acceptance criteria
+    bool passesAcceptance = stats.isHealthy();
+    LOGI("Processing complete: %.1f ms, MFSR=%s, Acceptance=%s", 
+         result.processingTimeMs,
+         result.mfsrApplied ? "applied" : "not applied",
+         passesAcceptance ? "PASS" : "FAIL (NaN/Inf detected)");
+    
+    return 0;
+}
+
+/**
+ * Tiled pipeline progress forwarded to a Java MFSRProgressCallback
+ *
+ * Only valid on the calling thread (the pipeline reports from there).
+ */
+static TilePipelineProgress makePipelineProgress(JNIEnv* env, jobject callback) {
+    if (callback == nullptr) {
+        return nullptr;
+    }
+    jclass callbackClass = env->GetObjectClass(callback);
+    jmethodID onProgress = env->GetMethodID(callbackClass, "onProgress", "(IILjava/lang/String;F)V");
+    env->DeleteLocalRef(callbackClass);
+    if (onProgress == nullptr) {
+        return nullptr;
+    }
+    
+    return [env, callback, onProgress](int tile, int total, const char* msg, float progress) {
+        jstring jMsg = env->NewStringUTF(msg);
+        env->CallVoidMethod(callback, onProgress, tile, total, jMsg, progress);
+        env->DeleteLocalRef(jMsg);
+    };
+}
+
+/**
+ * Lock the output bitmap and run a streaming pipeline call that writes its rows into it
+ *
+ * @param width Expected output width
+ * @param height Expected output height
+ * @param run Runs the pipeline with a sink that packs each finished row into the bitmap
+ * @return 0, or -6 / -7 / -8 if the bitmap cannot be used
+ */
+static jint streamIntoBitmap(JNIEnv* env, jobject outputBitmap, int width, int height,
+                             const std::function<void(const OutputRowSink&)>& run) {
+    AndroidBitmapInfo outInfo;
+    if (AndroidBitmap_getInfo(env, outputBitmap, &outInfo) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        LOGE("Failed to get output bitmap info");
+        return -6;
+    }
+    
+    if (outInfo.width != static_cast<uint32_t>(width) ||
+        outInfo.height != static_cast<uint32_t>(height)) {
+        LOGE("Output bitmap size mismatch: expected %dx%d, got %dx%d",
+             width, height, outInfo.width, outInfo.height);
+        return -7;
+    }
+    
+    void* outPixels;
+    if (AndroidBitmap_lockPixels(env, outputBitmap, &outPixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        LOGE("Failed to lock output bitmap");
+        return -8;
+    }
+    
+    uint8_t* dst = static_cast<uint8_t*>(outPixels);
+    run([&](int y, const RGBPixel* src, int rowWidth) {
+        rgbFloatRowToArgb(src, rowWidth, y, dst + y * outInfo.stride);
+    });
+    
+    AndroidBitmap_unlockPixels(env, outputBitmap);
+    return 0;
+}
+
+/**
+ * Describe one frame's YUV_420_888 planes held in direct ByteBuffers
+ *
+ * @return false (logged) if a buffer is not direct
+ */
+static bool yuvFrameFromBuffers(JNIEnv* env, jobject yBuffer, jobject uBuffer, jobject vBuffer,
+                                jint yRowStride, jint uvRowStride, jint uvPixelStride,
+                                jint width, jint height, YUVFrame& frame) {
+    frame.yPlane = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuffer));
+    frame.uPlane = static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuffer));
+    frame.vPlane = static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuffer));
+    frame.yRowStride = yRowStride;
+    frame.uvRowStride = uvRowStride;
+    frame.uvPixelStride = uvPixelStride;
+    frame.width = width;
+    frame.height = height;
+    
+    if (!frame.yPlane || !frame.uPlane || !frame.vPlane) {
+        LOGE("YUV planes must be direct ByteBuffers");
+        return false;
+    }
+    return true;
+}
+
 extern "C" {
 
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
@@ -220,94 +512,7 @@ Java_com_imagedit_app_ultradetail_NativeBurstProcessor_nativeProcessYUV(
         return -3;
     }
     
-    // Copy result to output bitmap
-    AndroidBitmapInfo bitmapInfo;
-    if (AndroidBitmap_getInfo(env, outputBitmap, &bitmapInfo) != ANDROID_BITMAP_RESULT_SUCCESS) {
-        LOGE("Failed to get bitmap info");
-        return -4;
-    }
-    
-    if (bitmapInfo.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
-        LOGE("Output bitmap must be ARGB_8888");
-        return -5;
-    }
-    
-    void* bitmapPixels;
-    if (AndroidBitmap_lockPixels(env, outputBitmap, &bitmapPixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
-        LOGE("Failed to lock bitmap pixels");
-        return -6;
-    }
-    
-    // Verify merged image has valid data
-    LOGD("Merged image: %dx%d, bitmap: %dx%d stride=%d, MFSR=%s",
-         result.mergedImage.width, result.mergedImage.height,
-         bitmapInfo.width, bitmapInfo.height, bitmapInfo.stride,
-         result.mfsrApplied ? "applied" : "not applied");
-    
-    // Check if bitmap size matches result size
-    if (result.mergedImage.width != static_cast<int>(bitmapInfo.width) ||
-        result.mergedImage.height != static_cast<int>(bitmapInfo.height)) {
-        LOGW("Bitmap size mismatch: result=%dx%d, bitmap=%dx%d",
-             result.mergedImage.width, result.mergedImage.height,
-             bitmapInfo.width, bitmapInfo.height);
-        // If MFSR was applied but bitmap is wrong size, this is an error
-        // The caller should have allocated the correct size
-        if (result.mfsrApplied) {
-            AndroidBitmap_unlockPixels(env, outputBitmap);
-            LOGE("Output bitmap size doesn't match MFSR output");
-            return -7;
-        }
-    }
-    
-    // Compute and log image statistics for diagnostics
-    // This uses severity-based logging: HEALTHY=INFO, minor issues=WARN, serious=ERROR
-    ImageStats stats = computeImageStats(result.mergedImage);
-    stats.log("Merged image");
-    
-    // Handle invalid values - this is a SAFETY NET, not a fix
-    // Non-zero counts here indicate upstream bugs that should be investigated
-    if (!stats.isHealthy()) {
-        // Log as ERROR because this indicates a bug in the pipeline
-        LOGE("PIPELINE BUG: Merged image contains %d NaN + %d Inf values (%.4f%% invalid)",
-             stats.nanCount, stats.infCount, stats.invalidPercentage());
-        LOGE("This is a bug that should be fixed upstream. Sanitizing as safety measure...");
-        
-        int sanitized = sanitizeRGBImage(result.mergedImage);
-        LOGW("Sanitized %d pixels (replaced NaN/Inf with black, clamped to [0,1])", sanitized);
-        
-        // Verify sanitization worked
-        ImageStats postStats = computeImageStats(result.mergedImage);
-        if (postStats.isHealthy()) {
-            LOGI("Post-sanitization: image is now numerically healthy");
-        } else {
-            LOGE("Post-sanitization: STILL UNHEALTHY - this should not happen!");
-        }
-    }
-    
-#if ULTRADETAIL_DEBUG
-    // Sample a few pixels for debugging (only in debug builds)
-    if (result.mergedImage.width > 0 && result.mergedImage.height > 0) {
-        int cx = result.mergedImage.width / 2;
-        int cy = result.mergedImage.height / 2;
-        const RGBPixel& centerPx = result.mergedImage.at(cx, cy);
-        LOGD_DEBUG("Center pixel (%d,%d): R=%.3f G=%.3f B=%.3f",
-             cx, cy, centerPx.r, centerPx.g, centerPx.b);
-    }
-#endif
-    
-    // Convert float RGB to RGBA bitmap
-    rgbFloatToArgb(result.mergedImage, static_cast<uint8_t*>(bitmapPixels), bitmapInfo.stride);
-    
-    AndroidBitmap_unlockPixels(env, outputBitmap);
-    
-    // Final status log with acceptance criteria
-    bool passesAcceptance = stats.isHealthy();
-    LOGI("Processing complete: %.1f ms, MFSR=%s, Acceptance=%s", 
-         result.processingTimeMs,
-         result.mfsrApplied ? "applied" : "not applied",
-         passesAcceptance ? "PASS" : "FAIL (NaN/Inf detected)");
-    
-    return 0;
+    return writeBurstResult(env, result, outputBitmap);
 }
 
 /**
@@ -514,7 +719,8 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeCreate(
     jint scaleFactor,
     jint robustnessMethod,
     jfloat robustnessThreshold,
-    jboolean useGyroInit
+    jboolean useGyroInit,
+    jint maxMemoryMB
 ) {
     TilePipelineConfig config;
     config.tileWidth = tileWidth;
@@ -524,14 +730,15 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeCreate(
     config.robustness = static_cast<TilePipelineConfig::RobustnessMethod>(robustnessMethod);
     config.robustnessThreshold = robustnessThreshold;
     config.useGyroInit = useGyroInit;
+    config.maxMemoryMB = static_cast<size_t>(std::max(0, static_cast<int>(maxMemoryMB)));
     
     // Update MFSR params to match
     config.mfsrParams.scaleFactor = scaleFactor;
     
     auto* pipeline = new TiledMFSRPipeline(config);
     
-    LOGI("Created TiledMFSRPipeline: tile=%dx%d, overlap=%d, scale=%d",
-         tileWidth, tileHeight, overlap, scaleFactor);
+    LOGI("Created TiledMFSRPipeline: tile=%dx%d, overlap=%d, scale=%d, budget=%dMB",
+         tileWidth, tileHeight, overlap, scaleFactor, static_cast<int>(maxMemoryMB));
     
     return reinterpret_cast<jlong>(pipeline);
 }
@@ -550,6 +757,26 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeDestroy(
     LOGD("TiledMFSRPipeline destroyed");
 }
 
+/**
+ * Set the directory for burst frame spill files (the app cache dir)
+ * 
+ * @param path Directory path, or null to disable spilling
+ */
+JNIEXPORT void JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSetSpillDirectory(
+    JNIEnv* env,
+    jclass clazz,
+    jstring path
+) {
+    if (path == nullptr) {
+        setSpillDirectory(std::string());
+        return;
+    }
+    const char* pathChars = env->GetStringUTFChars(path, nullptr);
+    setSpillDirectory(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+}
+
 /**
  * Process RGB bitmaps through the MFSR pipeline
  * 
@@ -605,62 +832,40 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessBitmaps(
     LOGI("Processing %d frames (%dx%d, format=%d, stride=%d) through MFSR pipeline", 
          numFrames, width, height, bitmapInfo.format, bitmapInfo.stride);
     
-    // Convert bitmaps to RGBImage format
-    std::vector<RGBImage> frames(numFrames);
-    std::vector<GrayImage> grayFrames(numFrames);
+    // Keep the input bitmaps locked while processing; tiles convert their crops on demand
+    LockedBitmapFrames inputFrames(env);
+    if (!inputFrames.lock(inputBitmaps, width, height)) {
+        return -4;
+    }
     
-    for (int i = 0; i < numFrames; ++i) {
-        jobject bitmap = env->GetObjectArrayElement(inputBitmaps, i);
-        
-        void* pixels;
-        if (AndroidBitmap_lockPixels(env, bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
-            LOGE("Failed to lock bitmap %d", i);
-            return -4;
-        }
-        
-        frames[i].resize(width, height);
-        grayFrames[i].resize(width, height);
-        
-        uint8_t* src = static_cast<uint8_t*>(pixels);
-        
-        // Debug: log first pixel of first frame
-        if (i == 0) {
-            uint8_t* firstRow = src;
-            LOGI("Frame 0 first pixel bytes: [%d, %d, %d, %d]", 
-                 firstRow[0], firstRow[1], firstRow[2], firstRow[3]);
-        }
-        
-        for (int y = 0; y < height; ++y) {
-            uint8_t* row = src + y * bitmapInfo.stride;
-            for (int x = 0; x < width; ++x) {
-                int idx = x * 4;
-                // Android ARGB_8888 format: R, G, B, A (in memory order)
-                float r = row[idx + 0] / 255.0f;
-                float g = row[idx + 1] / 255.0f;
-                float b = row[idx + 2] / 255.0f;
-                
-                frames[i].at(x, y) = RGBPixel(r, g, b);
-                grayFrames[i].at(x, y) = 0.299f * r + 0.587f * g + 0.114f * b;
-            }
-        }
+    std::vector<RGBA8FrameSource> bitmapSources;
+    bitmapSources.reserve(numFrames);
+    for (const RGBA8View& view : inputFrames.views()) {
+        bitmapSources.emplace_back(view);
+    }
+    std::vector<const FrameSource*> frames;
+    for (const RGBA8FrameSource& source : bitmapSources) {
+        frames.push_back(&source);
+    }
+    
+    // Debug: first pixel and sampled average of the first frame
+    {
+        const RGBA8View& view = inputFrames.views()[0];
+        const RGBA8Pixel& first = view.at(0, 0);
+        LOGI("Frame 0 first pixel bytes: [%d, %d, %d, %d]", first.r, first.g, first.b, first.a);
         
-        // Debug: log average pixel value of first frame
-        if (i == 0) {
-            float avgR = 0, avgG = 0, avgB = 0;
-            for (int y = 0; y < height; y += 10) {
-                for (int x = 0; x < width; x += 10) {
-                    const RGBPixel& p = frames[i].at(x, y);
-                    avgR += p.r;
-                    avgG += p.g;
-                    avgB += p.b;
-                }
+        float avgR = 0, avgG = 0, avgB = 0;
+        for (int y = 0; y < height; y += 10) {
+            for (int x = 0; x < width; x += 10) {
+                const RGBA8Pixel& p = view.at(x, y);
+                avgR += p.r / 255.0f;
+                avgG += p.g / 255.0f;
+                avgB += p.b / 255.0f;
             }
-            int samples = (height / 10) * (width / 10);
-            LOGI("Frame 0 avg RGB (sampled): %.3f, %.3f, %.3f", 
-                 avgR / samples, avgG / samples, avgB / samples);
         }
-        
-        AndroidBitmap_unlockPixels(env, bitmap);
+        int samples = (height / 10) * (width / 10);
+        LOGI("Frame 0 avg RGB (sampled): %.3f, %.3f, %.3f", 
+             avgR / samples, avgG / samples, avgB / samples);
     }
     
     // Parse homographies if provided
@@ -691,37 +896,18 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessBitmaps(
                                           "(IILjava/lang/String;F)V");
     }
     
-    // Process
-    PipelineResult result;
-    pipeline->process(
-        frames, grayFrames, referenceIndex,
-        gyroHomographies.empty() ? nullptr : &gyroHomographies,
-        result,
-        [&](int tile, int total, const char* msg, float progress) {
-            if (callback && progressMethod) {
-                jstring jMsg = env->NewStringUTF(msg);
-                env->CallVoidMethod(callback, progressMethod, tile, total, jMsg, progress);
-                env->DeleteLocalRef(jMsg);
-            }
-        }
-    );
-    
-    if (!result.success) {
-        LOGE("MFSR processing failed");
-        return -5;
-    }
-    
-    // Copy result to output bitmap
+    // Lock output bitmap up front so finished rows can be streamed straight into it
     AndroidBitmapInfo outInfo;
     if (AndroidBitmap_getInfo(env, outputBitmap, &outInfo) != ANDROID_BITMAP_RESULT_SUCCESS) {
         LOGE("Failed to get output bitmap info");
         return -6;
     }
     
-    if (outInfo.width != static_cast<uint32_t>(result.outputWidth) ||
-        outInfo.height != static_cast<uint32_t>(result.outputHeight)) {
+    int scale = pipeline->getConfig().scaleFactor;
+    if (outInfo.width != static_cast<uint32_t>(width * scale) ||
+        outInfo.height != static_cast<uint32_t>(height * scale)) {
         LOGE("Output bitmap size mismatch: expected %dx%d, got %dx%d",
-             result.outputWidth, result.outputHeight, outInfo.width, outInfo.height);
+             width * scale, height * scale, outInfo.width, outInfo.height);
         return -7;
     }
     
@@ -733,36 +919,49 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessBitmaps(
     
     uint8_t* dst = static_cast<uint8_t*>(outPixels);
     
-    // Debug: compute output average before writing
+    // Debug: sampled output average while writing
     float outAvgR = 0, outAvgG = 0, outAvgB = 0;
     int outSamples = 0;
-    for (int y = 0; y < result.outputHeight; y += 20) {
-        for (int x = 0; x < result.outputWidth; x += 20) {
-            const RGBPixel& p = result.outputImage.at(x, y);
-            outAvgR += p.r;
-            outAvgG += p.g;
-            outAvgB += p.b;
-            outSamples++;
-        }
-    }
-    LOGI("Output avg RGB before write: %.3f, %.3f, %.3f", 
-         outAvgR / outSamples, outAvgG / outSamples, outAvgB / outSamples);
     
-    for (int y = 0; y < result.outputHeight; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < result.outputWidth; ++x) {
-            const RGBPixel& p = result.outputImage.at(x, y);
-            int idx = x * 4;
-            // Android ARGB_8888 format: R, G, B, A (in memory order)
-            row[idx + 0] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;  // Alpha
+    // Process
+    PipelineResult result;
+    pipeline->processStreaming(
+        frames, referenceIndex,
+        gyroHomographies.empty() ? nullptr : &gyroHomographies,
+        [&](int y, const RGBPixel* src, int rowWidth) {
+            uint8_t* row = dst + y * outInfo.stride;
+            rgbFloatRowToArgb(src, rowWidth, y, row);
+            if (y % 20 == 0) {
+                for (int x = 0; x < rowWidth; x += 20) {
+                    outAvgR += src[x].r;
+                    outAvgG += src[x].g;
+                    outAvgB += src[x].b;
+                    outSamples++;
+                }
+            }
+        },
+        result,
+        [&](int tile, int total, const char* msg, float progress) {
+            if (callback && progressMethod) {
+                jstring jMsg = env->NewStringUTF(msg);
+                env->CallVoidMethod(callback, progressMethod, tile, total, jMsg, progress);
+                env->DeleteLocalRef(jMsg);
+            }
         }
-    }
+    );
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
+    if (!result.success) {
+        LOGE("MFSR processing failed");
+        return -5;
+    }
+    
+    if (outSamples > 0) {
+        LOGI("Output avg RGB: %.3f, %.3f, %.3f",
+             outAvgR / outSamples, outAvgG / outSamples, outAvgB / outSamples);
+    }
+    
     LOGI("MFSR complete: %dx%d -> %dx%d, tiles=%d, time=%.1fs, fallback=%s",
          result.inputWidth, result.inputHeight,
          result.outputWidth, result.outputHeight,
@@ -860,58 +1059,33 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessBitmapsWithMas
              maskMin, maskMax, maskSum / maskLen);
     }
     
-    // Convert bitmaps to RGBImage format
-    std::vector<RGBImage> frames(numFrames);
-    std::vector<GrayImage> grayFrames(numFrames);
+    // Keep the input bitmaps (and the mask) pinned while processing; tiles
+    // convert their crops on demand
+    LockedBitmapFrames inputFrames(env);
+    if (!inputFrames.lock(inputBitmaps, width, height)) {
+        if (maskData) env->ReleaseFloatArrayElements(qualityMask, maskData, JNI_ABORT);
+        return -4;
+    }
     
-    for (int i = 0; i < numFrames; ++i) {
-        jobject bitmap = env->GetObjectArrayElement(inputBitmaps, i);
-        
-        void* pixels;
-        if (AndroidBitmap_lockPixels(env, bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
-            LOGE("Failed to lock bitmap %d", i);
-            if (maskData) env->ReleaseFloatArrayElements(qualityMask, maskData, JNI_ABORT);
-            return -4;
-        }
-        
-        frames[i].resize(width, height);
-        grayFrames[i].resize(width, height);
-        
-        uint8_t* src = static_cast<uint8_t*>(pixels);
-        
-        for (int y = 0; y < height; ++y) {
-            uint8_t* row = src + y * bitmapInfo.stride;
-            for (int x = 0; x < width; ++x) {
-                int idx = x * 4;
-                // Android ARGB_8888 format: R, G, B, A (in memory order)
-                float r = row[idx + 0] / 255.0f;
-                float g = row[idx + 1] / 255.0f;
-                float b = row[idx + 2] / 255.0f;
-                
-                // Apply quality mask weighting if available
-                // This pre-weights pixels based on alignment quality
-                float weight = 1.0f;
-                if (maskData && maskLen == width * height) {
-                    weight = maskData[y * width + x];
-                    // Blend between original and weighted: high quality = full color, low = attenuated
-                    // This helps the MFSR accumulator give less weight to misaligned regions
-                    float blendFactor = 0.3f + 0.7f * weight;  // Range: 0.3 to 1.0
-                    r *= blendFactor;
-                    g *= blendFactor;
-                    b *= blendFactor;
-                }
-                
-                frames[i].at(x, y) = RGBPixel(r, g, b);
-                grayFrames[i].at(x, y) = 0.299f * r + 0.587f * g + 0.114f * b;
-            }
-        }
-        
-        AndroidBitmap_unlockPixels(env, bitmap);
+    // Quality weighting: high quality keeps full color, low quality is
+    // attenuated (gain 0.3 to 1.0) so the MFSR accumulator gives less weight
+    // to misaligned regions
+    GrayView maskView;
+    if (maskData && maskLen == width * height) {
+        maskView = GrayView(maskData, width, height, width * sizeof(float));
     }
     
-    // Release quality mask
-    if (maskData) {
-        env->ReleaseFloatArrayElements(qualityMask, maskData, JNI_ABORT);
+    std::vector<RGBA8FrameSource> bitmapSources;
+    bitmapSources.reserve(numFrames);
+    for (const RGBA8View& view : inputFrames.views()) {
+        bitmapSources.emplace_back(view);
+        if (!maskView.empty()) {
+            bitmapSources.back().setQualityMask(maskView, 0.3f);
+        }
+    }
+    std::vector<const FrameSource*> frames;
+    for (const RGBA8FrameSource& source : bitmapSources) {
+        frames.push_back(&source);
     }
     
     // Parse homographies if provided
@@ -942,63 +1116,63 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessBitmapsWithMas
                                           "(IILjava/lang/String;F)V");
     }
     
-    // Process
-    PipelineResult result;
-    pipeline->process(
-        frames, grayFrames, referenceIndex,
-        gyroHomographies.empty() ? nullptr : &gyroHomographies,
-        result,
-        [&](int tile, int total, const char* msg, float progress) {
-            if (callback && progressMethod) {
-                jstring jMsg = env->NewStringUTF(msg);
-                env->CallVoidMethod(callback, progressMethod, tile, total, jMsg, progress);
-                env->DeleteLocalRef(jMsg);
-            }
-        }
-    );
-    
-    if (!result.success) {
-        LOGE("MFSR processing with quality mask failed");
-        return -5;
-    }
-    
-    // Copy result to output bitmap
+    // Lock output bitmap up front so finished rows can be streamed straight into it
     AndroidBitmapInfo outInfo;
     if (AndroidBitmap_getInfo(env, outputBitmap, &outInfo) != ANDROID_BITMAP_RESULT_SUCCESS) {
         LOGE("Failed to get output bitmap info");
+        if (maskData) env->ReleaseFloatArrayElements(qualityMask, maskData, JNI_ABORT);
         return -6;
     }
     
-    if (outInfo.width != static_cast<uint32_t>(result.outputWidth) ||
-        outInfo.height != static_cast<uint32_t>(result.outputHeight)) {
+    int scale = pipeline->getConfig().scaleFactor;
+    if (outInfo.width != static_cast<uint32_t>(width * scale) ||
+        outInfo.height != static_cast<uint32_t>(height * scale)) {
         LOGE("Output bitmap size mismatch: expected %dx%d, got %dx%d",
-             result.outputWidth, result.outputHeight, outInfo.width, outInfo.height);
+             width * scale, height * scale, outInfo.width, outInfo.height);
+        if (maskData) env->ReleaseFloatArrayElements(qualityMask, maskData, JNI_ABORT);
         return -7;
     }
     
     void* outPixels;
     if (AndroidBitmap_lockPixels(env, outputBitmap, &outPixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
         LOGE("Failed to lock output bitmap");
+        if (maskData) env->ReleaseFloatArrayElements(qualityMask, maskData, JNI_ABORT);
         return -8;
     }
     
     uint8_t* dst = static_cast<uint8_t*>(outPixels);
     
-    for (int y = 0; y < result.outputHeight; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < result.outputWidth; ++x) {
-            const RGBPixel& p = result.outputImage.at(x, y);
-            int idx = x * 4;
-            // Android ARGB_8888 format: R, G, B, A (in memory order)
-            row[idx + 0] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;  // Alpha
+    // Process
+    PipelineResult result;
+    pipeline->processStreaming(
+        frames, referenceIndex,
+        gyroHomographies.empty() ? nullptr : &gyroHomographies,
+        [&](int y, const RGBPixel* src, int rowWidth) {
+            uint8_t* row = dst + y * outInfo.stride;
+            rgbFloatRowToArgb(src, rowWidth, y, row);
+        },
+        result,
+        [&](int tile, int total, const char* msg, float progress) {
+            if (callback && progressMethod) {
+                jstring jMsg = env->NewStringUTF(msg);
+                env->CallVoidMethod(callback, progressMethod, tile, total, jMsg, progress);
+                env->DeleteLocalRef(jMsg);
+            }
         }
-    }
+    );
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
+    // Release quality mask
+    if (maskData) {
+        env->ReleaseFloatArrayElements(qualityMask, maskData, JNI_ABORT);
+    }
+    
+    if (!result.success) {
+        LOGE("MFSR processing with quality mask failed");
+        return -5;
+    }
+    
     LOGI("MFSR with quality mask complete: %dx%d -> %dx%d, tiles=%d, time=%.1fs",
          result.inputWidth, result.inputHeight,
          result.outputWidth, result.outputHeight,
@@ -1108,20 +1282,32 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessYUV(
         selectedRef = numFrames / 2;  // Fallback to middle
     }
     
-    // Convert YUV frames to RGB on-the-fly (one at a time to save memory)
-    std::vector<RGBImage> frames(numFrames);
-    std::vector<GrayImage> grayFrames(numFrames);
+    // Wrap the YUV planes; tiles convert their crops on demand, so no
+    // full-size float copy of the burst is made
+    std::vector<YUVFrameSource> yuvSources;
+    yuvSources.reserve(numFrames);
     
     for (int i = 0; i < numFrames; ++i) {
         jobject yBuf = env->GetObjectArrayElement(yPlanes, i);
         jobject uBuf = env->GetObjectArrayElement(uPlanes, i);
         jobject vBuf = env->GetObjectArrayElement(vPlanes, i);
         
-        uint8_t* yData = static_cast<uint8_t*>(env->GetDirectBufferAddress(yBuf));
-        uint8_t* uData = static_cast<uint8_t*>(env->GetDirectBufferAddress(uBuf));
-        uint8_t* vData = static_cast<uint8_t*>(env->GetDirectBufferAddress(vBuf));
+        YUVFrame frame;
+        frame.yPlane = static_cast<const uint8_t*>(env->GetDirectBufferAddress(yBuf));
+        frame.uPlane = static_cast<const uint8_t*>(env->GetDirectBufferAddress(uBuf));
+        frame.vPlane = static_cast<const uint8_t*>(env->GetDirectBufferAddress(vBuf));
+        frame.yRowStride = yStrides[i];
+        frame.uvRowStride = uvStrides[i];
+        frame.uvPixelStride = uvPixStrides[i];
+        frame.width = width;
+        frame.height = height;
+        
+        // The buffers stay reachable through the plane arrays for the whole call
+        env->DeleteLocalRef(yBuf);
+        env->DeleteLocalRef(uBuf);
+        env->DeleteLocalRef(vBuf);
         
-        if (!yData || !uData || !vData) {
+        if (!frame.yPlane || !frame.uPlane || !frame.vPlane) {
             LOGE("Failed to get buffer address for frame %d", i);
             env->ReleaseIntArrayElements(yRowStrides, yStrides, JNI_ABORT);
             env->ReleaseIntArrayElements(uvRowStrides, uvStrides, JNI_ABORT);
@@ -1129,38 +1315,12 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessYUV(
             return -3;
         }
         
-        frames[i].resize(width, height);
-        grayFrames[i].resize(width, height);
-        
-        int yRowStride = yStrides[i];
-        int uvRowStride = uvStrides[i];
-        int uvPixelStride = uvPixStrides[i];
-        
-        // YUV420 to RGB conversion
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                int yIdx = y * yRowStride + x;
-                int uvIdx = (y / 2) * uvRowStride + (x / 2) * uvPixelStride;
-                
-                int yVal = (yData[yIdx] & 0xFF) - 16;
-                int uVal = (uData[uvIdx] & 0xFF) - 128;
-                int vVal = (vData[uvIdx] & 0xFF) - 128;
-                
-                // BT.601 YUV to RGB
-                float r = (1.164f * yVal + 1.596f * vVal) / 255.0f;
-                float g = (1.164f * yVal - 0.813f * vVal - 0.391f * uVal) / 255.0f;
-                float b = (1.164f * yVal + 2.018f * uVal) / 255.0f;
-                
-                r = clamp(r, 0.0f, 1.0f);
-                g = clamp(g, 0.0f, 1.0f);
-                b = clamp(b, 0.0f, 1.0f);
-                
-                frames[i].at(x, y) = RGBPixel(r, g, b);
-                grayFrames[i].at(x, y) = 0.299f * r + 0.587f * g + 0.114f * b;
-            }
-        }
-        
-        LOGD("Converted frame %d YUV->RGB", i);
+        yuvSources.emplace_back(frame);
+    }
+    
+    std::vector<const FrameSource*> frames;
+    for (const YUVFrameSource& source : yuvSources) {
+        frames.push_back(&source);
     }
     
     env->ReleaseIntArrayElements(yRowStrides, yStrides, JNI_ABORT);
@@ -1187,74 +1347,25 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeProcessYUV(
         }
     }
     
-    // Setup progress callback
-    jmethodID progressMethod = nullptr;
-    if (callback != nullptr) {
-        jclass callbackClass = env->GetObjectClass(callback);
-        progressMethod = env->GetMethodID(callbackClass, "onProgress", 
-                                          "(IILjava/lang/String;F)V");
-    }
-    
-    // Process
+    // Finished rows are streamed straight into the locked output bitmap
+    int scale = pipeline->getConfig().scaleFactor;
     PipelineResult result;
-    pipeline->process(
-        frames, grayFrames, selectedRef,
-        gyroHomographies.empty() ? nullptr : &gyroHomographies,
-        result,
-        [&](int tile, int total, const char* msg, float progress) {
-            if (callback && progressMethod) {
-                jstring jMsg = env->NewStringUTF(msg);
-                env->CallVoidMethod(callback, progressMethod, tile, total, jMsg, progress);
-                env->DeleteLocalRef(jMsg);
-            }
-        }
-    );
-    
-    // Free frame memory as soon as possible
-    frames.clear();
-    grayFrames.clear();
+    jint status = streamIntoBitmap(env, outputBitmap, width * scale, height * scale,
+        [&](const OutputRowSink& sink) {
+            pipeline->processStreaming(
+                frames, selectedRef,
+                gyroHomographies.empty() ? nullptr : &gyroHomographies,
+                sink, result, makePipelineProgress(env, callback));
+        });
+    if (status != 0) {
+        return status;
+    }
     
     if (!result.success) {
         LOGE("MFSR processing failed");
         return -5;
     }
     
-    // Copy result to output bitmap
-    AndroidBitmapInfo outInfo;
-    if (AndroidBitmap_getInfo(env, outputBitmap, &outInfo) != ANDROID_BITMAP_RESULT_SUCCESS) {
-        LOGE("Failed to get output bitmap info");
-        return -6;
-    }
-    
-    if (outInfo.width != static_cast<uint32_t>(result.outputWidth) ||
-        outInfo.height != static_cast<uint32_t>(result.outputHeight)) {
-        LOGE("Output bitmap size mismatch: expected %dx%d, got %dx%d",
-             result.outputWidth, result.outputHeight, outInfo.width, outInfo.height);
-        return -7;
-    }
-    
-    void* outPixels;
-    if (AndroidBitmap_lockPixels(env, outputBitmap, &outPixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
-        LOGE("Failed to lock output bitmap");
-        return -8;
-    }
-    
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < result.outputHeight; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < result.outputWidth; ++x) {
-            const RGBPixel& p = result.outputImage.at(x, y);
-            int idx = x * 4;
-            // Android ARGB_8888 format: R, G, B, A (in memory order)
-            row[idx + 0] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;  // Alpha
-        }
-    }
-    
-    AndroidBitmap_unlockPixels(env, outputBitmap);
-    
     LOGI("MFSR (YUV) complete: %dx%d -> %dx%d, ref=%d, tiles=%d, time=%.1fs, fallback=%s",
          result.inputWidth, result.inputHeight,
          result.outputWidth, result.outputHeight,
@@ -1377,18 +1488,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeApplyFreqSeparation(
     processor.processRGB(input, output);
     
     // Copy to output bitmap
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = output.at(x, y);
-            int idx = x * 4;
-            row[idx + 0] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(output, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, inputBitmap);
     AndroidBitmap_unlockPixels(env, outputBitmap);
@@ -1473,18 +1573,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeApplyAnisotropicFilte
     processor.filterRGB(input, output);
     
     // Copy to output bitmap
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = output.at(x, y);
-            int idx = x * 4;
-            row[idx + 0] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(output, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, inputBitmap);
     AndroidBitmap_unlockPixels(env, outputBitmap);
@@ -1674,18 +1763,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeDrizzle(
     AndroidBitmap_getInfo(env, outputBitmap, &outInfo);
     AndroidBitmap_lockPixels(env, outputBitmap, &outPixels);
     
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < result.outputHeight; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < result.outputWidth; ++x) {
-            const RGBPixel& p = result.output.at(x, y);
-            int idx = x * 4;
-            row[idx] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(result.output, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
@@ -1785,18 +1863,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeCorrectRollingShutter
     }
     
     // Copy to output
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = result.corrected.at(x, y);
-            int idx = x * 4;
-            row[idx] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(result.corrected, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
@@ -1975,18 +2042,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeTextureSynthesis(
     }
     
     // Copy to output
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = result.synthesized.at(x, y);
-            int idx = x * 4;
-            row[idx] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(result.synthesized, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
@@ -2072,18 +2128,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeTextureTransfer(
     RGBImage result = processor.transferTexture(target, source, mask);
     
     // Copy to output
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = result.at(x, y);
-            int idx = x * 4;
-            row[idx] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(result, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
@@ -2326,18 +2371,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeTextureSynthesisTiled
     }
     
     // Copy to output
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = result.synthesized.at(x, y);
-            int idx = x * 4;
-            row[idx] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(result.synthesized, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
@@ -2438,50 +2472,9 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeTextureSynthesisTiled
     config.synthParams.blendWeight = 0.4f;
     config.synthParams.varianceThreshold = 0.003f;
     
-    // Store JNI env and callback for progress reporting
-    // Note: We need to use a thread-safe approach since callbacks may come from worker threads
-    JavaVM* jvm = nullptr;
-    env->GetJavaVM(&jvm);
-    
     // Set up progress callback that calls back to Java
     if (globalCallback != nullptr && onProgressMethod != nullptr) {
-        config.progressCallback = [jvm, globalCallback, onProgressMethod](int completed, int total, float avgDetail) {
-            JNIEnv* callbackEnv = nullptr;
-            bool needsDetach = false;
-            
-            jint getEnvResult = jvm->GetEnv((void**)&callbackEnv, JNI_VERSION_1_6);
-            if (getEnvResult == JNI_EDETACHED) {
-                if (jvm->AttachCurrentThread(&callbackEnv, nullptr) == JNI_OK) {
-                    needsDetach = true;
-                } else {
-                    LOGE("TiledTextureSynth: Failed to attach thread for callback");
-                    return;
-                }
-            } else if (getEnvResult != JNI_OK) {
-                LOGE("TiledTextureSynth: Failed to get JNI env for callback");
-                return;
-            }
-            
-            // Log every 10 tiles for debugging
-            if (completed % 10 == 0 || completed == total) {
-                LOGD("TiledTextureSynth: Progress callback: %d/%d tiles", completed, total);
-            }
-            
-            // Call the Java callback - pass completed, total, and split CPU/GPU (for now all CPU)
-            callbackEnv->CallVoidMethod(globalCallback, onProgressMethod, 
-                                        completed, total, completed, 0);
-            
-            // Check for Java exceptions
-            if (callbackEnv->ExceptionCheck()) {
-                LOGE("TiledTextureSynth: Exception in Java callback");
-                callbackEnv->ExceptionDescribe();
-                callbackEnv->ExceptionClear();
-            }
-            
-            if (needsDetach) {
-                jvm->DetachCurrentThread();
-            }
-        };
+        config.progressCallback = makeTileSynthProgress(env, globalCallback, onProgressMethod);
     } else {
         LOGW("TiledTextureSynth: No progress callback provided");
     }
@@ -2502,18 +2495,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeTextureSynthesisTiled
     }
     
     // Copy to output
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = result.synthesized.at(x, y);
-            int idx = x * 4;
-            row[idx] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(result.synthesized, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
@@ -2634,18 +2616,7 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeExposureFusion(
         return -5;
     }
     
-    uint8_t* dst = static_cast<uint8_t*>(outPixels);
-    for (int y = 0; y < height; ++y) {
-        uint8_t* row = dst + y * outInfo.stride;
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& p = result.fused.at(x, y);
-            int idx = x * 4;
-            row[idx] = static_cast<uint8_t>(clamp(p.r * 255.0f, 0.0f, 255.0f));
-            row[idx + 1] = static_cast<uint8_t>(clamp(p.g * 255.0f, 0.0f, 255.0f));
-            row[idx + 2] = static_cast<uint8_t>(clamp(p.b * 255.0f, 0.0f, 255.0f));
-            row[idx + 3] = 255;
-        }
-    }
+    rgbFloatToArgb(result.fused, static_cast<uint8_t*>(outPixels), outInfo.stride);
     
     AndroidBitmap_unlockPixels(env, outputBitmap);
     
@@ -2654,4 +2625,611 @@ Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeExposureFusion(
     return 0;
 }
 
+// ==================== Image Session ====================
+
+/**
+ * Lock an RGBA_8888 bitmap and describe it as a view
+ *
+ * @return false (logged) if the bitmap cannot be used; nothing is locked then
+ */
+static bool lockBitmapView(JNIEnv* env, jobject bitmap, RGBA8View& view, const char* what) {
+    AndroidBitmapInfo info;
+    void* pixels;
+    if (AndroidBitmap_getInfo(env, bitmap, &info) != ANDROID_BITMAP_RESULT_SUCCESS ||
+        info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        LOGE("ImageSession: %s must be an ARGB_8888 bitmap", what);
+        return false;
+    }
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) != ANDROID_BITMAP_RESULT_SUCCESS) {
+        LOGE("ImageSession: Failed to lock %s", what);
+        return false;
+    }
+    view = RGBA8View(static_cast<const RGBA8Pixel*>(pixels), info.width, info.height, info.stride);
+    return true;
+}
+
+/**
+ * Create an image session holding a float copy of a bitmap
+ *
+ * @param inputBitmap ARGB_8888 bitmap to load
+ * @return Session handle, or 0 on error
+ */
+JNIEXPORT jlong JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSessionCreate(
+    JNIEnv* env,
+    jclass clazz,
+    jobject inputBitmap
+) {
+    RGBA8View view;
+    if (!lockBitmapView(env, inputBitmap, view, "input bitmap")) {
+        return 0;
+    }
+    
+    auto* session = new ImageSession();
+    session->load(view);
+    AndroidBitmap_unlockPixels(env, inputBitmap);
+    
+    LOGI("ImageSession: Created %dx%d", session->width(), session->height());
+    return reinterpret_cast<jlong>(session);
+}
+
+/**
+ * Destroy an image session
+ */
+JNIEXPORT void JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSessionDestroy(
+    JNIEnv* env,
+    jclass clazz,
+    jlong handle
+) {
+    delete reinterpret_cast<ImageSession*>(handle);
+    LOGD("ImageSession destroyed");
+}
+
+/**
+ * Frequency separation on the session image (parameters as nativeApplyFreqSeparation)
+ *
+ * @return 0 on success, negative on error
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSessionApplyFreqSeparation(
+    JNIEnv* env,
+    jclass clazz,
+    jlong handle,
+    jfloat lowPassSigma,
+    jfloat highBoost,
+    jfloat edgeProtection,
+    jfloat blendStrength
+) {
+    auto* session = reinterpret_cast<ImageSession*>(handle);
+    if (!session || session->empty()) {
+        LOGE("ImageSession: Invalid session handle");
+        return -1;
+    }
+    
+    FreqSeparationParams params;
+    params.lowPassSigma = lowPassSigma;
+    params.highBoost = highBoost;
+    params.edgeProtection = edgeProtection;
+    params.blendStrength = blendStrength;
+    session->applyFreqSeparation(params);
+    
+    LOGI("ImageSession: FreqSep %dx%d (sigma=%.1f, boost=%.1f, edge=%.1f, blend=%.1f)",
+         session->width(), session->height(), lowPassSigma, highBoost, edgeProtection, blendStrength);
+    return 0;
+}
+
+/**
+ * Anisotropic filtering on the session image (parameters as nativeApplyAnisotropicFilter)
+ *
+ * @return 0 on success, negative on error
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSessionApplyAnisotropicFilter(
+    JNIEnv* env,
+    jclass clazz,
+    jlong handle,
+    jfloat kernelSigma,
+    jfloat elongation,
+    jfloat noiseThreshold
+) {
+    auto* session = reinterpret_cast<ImageSession*>(handle);
+    if (!session || session->empty()) {
+        LOGE("ImageSession: Invalid session handle");
+        return -1;
+    }
+    
+    AnisotropicMergeParams params;
+    params.kernelSigma = kernelSigma;
+    params.elongation = elongation;
+    params.noiseThreshold = noiseThreshold;
+    session->applyAnisotropicFilter(params);
+    
+    LOGI("ImageSession: AnisotropicFilter %dx%d (sigma=%.1f, elong=%.1f, noise=%.3f)",
+         session->width(), session->height(), kernelSigma, elongation, noiseThreshold);
+    return 0;
+}
+
+/**
+ * Reference detail transfer into the session image (rule as nativeReferenceDetailTransfer)
+ *
+ * @param referenceBitmap Sharpest original frame (ARGB_8888)
+ * @param blendStrength How much high frequency to transfer (0-1)
+ * @return Number of pixels that received detail, negative on error
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSessionReferenceDetailTransfer(
+    JNIEnv* env,
+    jclass clazz,
+    jlong handle,
+    jobject referenceBitmap,
+    jfloat blendStrength
+) {
+    auto* session = reinterpret_cast<ImageSession*>(handle);
+    if (!session || session->empty()) {
+        LOGE("ImageSession: Invalid session handle");
+        return -1;
+    }
+    
+    RGBA8View reference;
+    if (!lockBitmapView(env, referenceBitmap, reference, "reference bitmap")) {
+        return -2;
+    }
+    
+    int transferred = session->applyReferenceDetailTransfer(reference, blendStrength);
+    AndroidBitmap_unlockPixels(env, referenceBitmap);
+    return transferred;
+}
+
+/**
+ * Tiled texture synthesis on the session image (parameters as nativeTextureSynthesisTiledWithProgress)
+ *
+ * @param callback TileSynthProgressCallback, or null
+ * @return 0 on success, negative on error
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSessionTextureSynthesisTiled(
+    JNIEnv* env,
+    jclass clazz,
+    jlong handle,
+    jint tileSize,
+    jint overlap,
+    jboolean useGPU,
+    jint numCPUThreads,
+    jobject callback
+) {
+    auto* session = reinterpret_cast<ImageSession*>(handle);
+    if (!session || session->empty()) {
+        LOGE("ImageSession: Invalid session handle");
+        return -1;
+    }
+    
+    TileSynthConfig config;
+    config.tileSize = tileSize;
+    config.overlap = overlap;
+    config.useGPU = useGPU;
+    config.numCPUThreads = numCPUThreads;
+    config.mode = TileScheduleMode::ALTERNATING;
+    config.synthParams.patchSize = 7;
+    config.synthParams.searchRadius = 32;
+    config.synthParams.blendWeight = 0.4f;
+    config.synthParams.varianceThreshold = 0.003f;
+    
+    jobject globalCallback = nullptr;
+    if (callback != nullptr) {
+        jclass callbackClass = env->GetObjectClass(callback);
+        jmethodID onProgressMethod = env->GetMethodID(callbackClass, "onProgress", "(IIII)V");
+        if (onProgressMethod != nullptr) {
+            globalCallback = env->NewGlobalRef(callback);
+            config.progressCallback = makeTileSynthProgress(env, globalCallback, onProgressMethod);
+        }
+    }
+    
+    TextureSynthResult stats;
+    bool success = session->applyTextureSynthesis(config, &stats);
+    
+    if (globalCallback != nullptr) {
+        env->DeleteGlobalRef(globalCallback);
+    }
+    
+    if (!success) {
+        LOGE("ImageSession: Texture synthesis failed");
+        return -2;
+    }
+    
+    LOGI("ImageSession: TextureSynth %dx%d, patches=%d, avgDetail=%.3f",
+         session->width(), session->height(), stats.patchesProcessed, stats.avgDetailAdded);
+    return 0;
+}
+
+/**
+ * Pack the session image into a bitmap (the single 8-bit quantization of the chain)
+ *
+ * @param outputBitmap ARGB_8888 bitmap of the session size
+ * @param dither Apply ordered dither while quantizing
+ * @return 0 on success, negative on error
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeSessionExport(
+    JNIEnv* env,
+    jclass clazz,
+    jlong handle,
+    jobject outputBitmap,
+    jboolean dither
+) {
+    auto* session = reinterpret_cast<ImageSession*>(handle);
+    if (!session || session->empty()) {
+        LOGE("ImageSession: Invalid session handle");
+        return -1;
+    }
+    
+    RGBA8View output;
+    if (!lockBitmapView(env, outputBitmap, output, "output bitmap")) {
+        return -2;
+    }
+    if (output.width != session->width() || output.height != session->height()) {
+        LOGE("ImageSession: Output bitmap is %dx%d, session is %dx%d",
+             output.width, output.height, session->width(), session->height());
+        AndroidBitmap_unlockPixels(env, outputBitmap);
+        return -3;
+    }
+    
+    ArgbPackOptions options;
+    options.dither = dither;
+    session->exportTo(reinterpret_cast<uint8_t*>(const_cast<RGBA8Pixel*>(output.data)),
+                      static_cast<int>(output.strideBytes), options);
+    
+    AndroidBitmap_unlockPixels(env, outputBitmap);
+    return 0;
+}
+
+// ==================== Incremental Burst Ingestion ====================
+
+/**
+ * Start an incremental burst on the burst processor
+ *
+ * @param handle Processor handle
+ * @param expectedFrames Number of frames that will be pushed
+ * @return JNI_TRUE if the burst was opened
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_imagedit_app_ultradetail_NativeBurstProcessor_nativeBeginBurst(
+    JNIEnv* env,
+    jobject thiz,
+    jlong handle,
+    jint expectedFrames
+) {
+    auto* processor = reinterpret_cast<BurstProcessor*>(handle);
+    if (!processor) {
+        LOGE("Invalid processor handle");
+        return JNI_FALSE;
+    }
+    return processor->beginBurst(expectedFrames) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Push one captured frame into the open burst
+ *
+ * The planes are copied before returning, so the frame may be released
+ * right away; conversion and alignment continue in the background.
+ *
+ * @return 0 on success, negative on error
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeBurstProcessor_nativePushFrame(
+    JNIEnv* env,
+    jobject thiz,
+    jlong handle,
+    jobject yPlane,
+    jobject uPlane,
+    jobject vPlane,
+    jint yRowStride,
+    jint uvRowStride,
+    jint uvPixelStride,
+    jint width,
+    jint height
+) {
+    auto* processor = reinterpret_cast<BurstProcessor*>(handle);
+    if (!processor) {
+        LOGE("Invalid processor handle");
+        return -1;
+    }
+    
+    YUVFrame frame;
+    if (!yuvFrameFromBuffers(env, yPlane, uPlane, vPlane, yRowStride, uvRowStride, uvPixelStride,
+                             width, height, frame)) {
+        return -2;
+    }
+    return processor->pushFrame(frame) ? 0 : -3;
+}
+
+/**
+ * Merge the open burst into the output bitmap
+ *
+ * @param outputBitmap Output bitmap (ARGB_8888, merged or MFSR size)
+ * @param callback Progress callback
+ * @return 0 on success, same error codes as nativeProcessYUV
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeBurstProcessor_nativeFinishBurst(
+    JNIEnv* env,
+    jobject thiz,
+    jlong handle,
+    jobject outputBitmap,
+    jobject callback
+) {
+    auto* processor = reinterpret_cast<BurstProcessor*>(handle);
+    if (!processor) {
+        LOGE("Invalid processor handle");
+        return -1;
+    }
+    
+    JNIProgressCallback progressCallback{nullptr, nullptr, nullptr};
+    if (callback) {
+        progressCallback.env = env;
+        progressCallback.callback = callback;
+        jclass callbackClass = env->GetObjectClass(callback);
+        progressCallback.methodId = env->GetMethodID(callbackClass, "onProgress",
+                                                      "(IFLjava/lang/String;)V");
+    }
+    
+    BurstProcessingResult result;
+    processor->finish(result,
+        [&progressCallback](ProcessingStage stage, float progress, const char* msg) {
+            if (progressCallback.callback) {
+                progressCallback(stage, progress, msg);
+            }
+        }
+    );
+    
+    if (!result.success) {
+        LOGE("Processing failed: %s", result.errorMessage.c_str());
+        return -3;
+    }
+    
+    return writeBurstResult(env, result, outputBitmap);
+}
+
+/**
+ * Start an incremental burst on the MFSR pipeline
+ *
+ * @param handle Pipeline handle
+ * @param expectedFrames Number of frames that will be pushed
+ * @param referenceIndex Reference frame index (-1 = middle of the burst)
+ * @return JNI_TRUE if the burst was opened
+ */
+JNIEXPORT jboolean JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeBeginBurst(
+    JNIEnv* env,
+    jobject thiz,
+    jlong handle,
+    jint expectedFrames,
+    jint referenceIndex
+) {
+    auto* pipeline = reinterpret_cast<TiledMFSRPipeline*>(handle);
+    if (!pipeline) {
+        LOGE("Invalid pipeline handle");
+        return JNI_FALSE;
+    }
+    return pipeline->beginBurst(expectedFrames, referenceIndex) ? JNI_TRUE : JNI_FALSE;
+}
+
+/**
+ * Push one captured frame into the open MFSR burst (planes are copied)
+ *
+ * @param homography Flattened 3x3 gyro homography of this frame, or null
+ * @return 0 on success, negative on error
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativePushFrame(
+    JNIEnv* env,
+    jobject thiz,
+    jlong handle,
+    jobject yPlane,
+    jobject uPlane,
+    jobject vPlane,
+    jint yRowStride,
+    jint uvRowStride,
+    jint uvPixelStride,
+    jint width,
+    jint height,
+    jfloatArray homography
+) {
+    auto* pipeline = reinterpret_cast<TiledMFSRPipeline*>(handle);
+    if (!pipeline) {
+        LOGE("Invalid pipeline handle");
+        return -1;
+    }
+    
+    YUVFrame frame;
+    if (!yuvFrameFromBuffers(env, yPlane, uPlane, vPlane, yRowStride, uvRowStride, uvPixelStride,
+                             width, height, frame)) {
+        return -2;
+    }
+    
+    GyroHomography gyro;
+    if (homography != nullptr && env->GetArrayLength(homography) >= 9) {
+        env->GetFloatArrayRegion(homography, 0, 9, gyro.h);
+        gyro.isValid = true;
+    }
+    
+    return pipeline->pushFrame(frame, gyro.isValid ? &gyro : nullptr) ? 0 : -3;
+}
+
+/**
+ * Run the tile stage of the open MFSR burst into the output bitmap
+ *
+ * @param outputBitmap Pre-allocated output bitmap (scaled size)
+ * @param callback Progress callback object
+ * @return Reference index used on success, negative error code on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeFinishBurst(
+    JNIEnv* env,
+    jobject thiz,
+    jlong handle,
+    jobject outputBitmap,
+    jobject callback
+) {
+    auto* pipeline = reinterpret_cast<TiledMFSRPipeline*>(handle);
+    if (!pipeline) {
+        LOGE("Invalid pipeline handle");
+        return -1;
+    }
+    
+    int width = 0, height = 0;
+    pipeline->getBurstFrameSize(width, height);
+    int scale = pipeline->getConfig().scaleFactor;
+    
+    PipelineResult result;
+    int referenceIndex = -1;
+    jint status = streamIntoBitmap(env, outputBitmap, width * scale, height * scale,
+        [&](const OutputRowSink& sink) {
+            referenceIndex = pipeline->finish(sink, result, makePipelineProgress(env, callback));
+        });
+    if (status != 0) {
+        // The burst was not consumed; drop it so a new one can begin
+        pipeline->abortBurst();
+        return status;
+    }
+    
+    if (!result.success) {
+        LOGE("MFSR processing failed");
+        return -5;
+    }
+    
+    LOGI("MFSR (incremental YUV) complete: %dx%d -> %dx%d, ref=%d, tiles=%d, time=%.1fs, fallback=%s",
+         result.inputWidth, result.inputHeight,
+         result.outputWidth, result.outputHeight,
+         referenceIndex, result.tilesProcessed, result.processingTimeMs / 1000.0f,
+         result.usedFallback ? "yes" : "no");
+    
+    return referenceIndex;
+}
+
+// ==================== RAW Burst Merge ====================
+
+/**
+ * Read the frame size from a RAWC cache file header
+ *
+ * @param path Cache file written by RawBurstCaptureController
+ * @return [width, height], or null if the file is not a readable RAWC file
+ */
+JNIEXPORT jintArray JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeReadRawCacheSize(
+    JNIEnv* env,
+    jclass clazz,
+    jstring path
+) {
+    const char* pathChars = env->GetStringUTFChars(path, nullptr);
+    RawCacheFile file;
+    bool opened = file.open(pathChars);
+    env->ReleaseStringUTFChars(path, pathChars);
+    if (!opened) {
+        return nullptr;
+    }
+    
+    jint size[2] = { file.width(), file.height() };
+    jintArray result = env->NewIntArray(2);
+    env->SetIntArrayRegion(result, 0, 2, size);
+    return result;
+}
+
+/**
+ * Merge a RAW burst in the Bayer domain and demosaic it into a bitmap
+ *
+ * @param paths RAWC cache files of one burst
+ * @param referenceIndex Reference frame, -1 for the middle frame
+ * @param whiteBalance R, G, B gains, or null for gray-world white balance
+ * @param outputBitmap ARGB_8888 bitmap of the sensor size
+ * @param dither Apply ordered dither while quantizing
+ * @return Number of frames merged on success, negative error code on failure
+ */
+JNIEXPORT jint JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeMergeRawBurst(
+    JNIEnv* env,
+    jclass clazz,
+    jobjectArray paths,
+    jint referenceIndex,
+    jfloatArray whiteBalance,
+    jobject outputBitmap,
+    jboolean dither
+) {
+    int numPaths = env->GetArrayLength(paths);
+    std::vector<std::string> pathList;
+    pathList.reserve(numPaths);
+    for (int i = 0; i < numPaths; ++i) {
+        auto jpath = static_cast<jstring>(env->GetObjectArrayElement(paths, i));
+        const char* chars = env->GetStringUTFChars(jpath, nullptr);
+        pathList.emplace_back(chars);
+        env->ReleaseStringUTFChars(jpath, chars);
+        env->DeleteLocalRef(jpath);
+    }
+    
+    RawDemosaicParams demosaic;
+    if (whiteBalance != nullptr) {
+        if (env->GetArrayLength(whiteBalance) < 3) {
+            LOGE("RAW merge: white balance needs 3 gains");
+            return -1;
+        }
+        env->GetFloatArrayRegion(whiteBalance, 0, 3, demosaic.gains);
+        demosaic.autoWhiteBalance = false;
+    }
+    
+    RawMergeParams params;
+    params.referenceIndex = referenceIndex;
+    RawMergeResult result;
+    if (!mergeRawBurst(pathList, params, result)) {
+        return -2;
+    }
+    
+    RGBA8View output;
+    if (!lockBitmapView(env, outputBitmap, output, "output bitmap")) {
+        return -3;
+    }
+    if (output.width != result.mosaic.width || output.height != result.mosaic.height) {
+        LOGE("RAW merge: Output bitmap is %dx%d, frames are %dx%d",
+             output.width, output.height, result.mosaic.width, result.mosaic.height);
+        AndroidBitmap_unlockPixels(env, outputBitmap);
+        return -4;
+    }
+    
+    // The mosaic is linear: encode sRGB while packing
+    ArgbPackOptions options;
+    options.dither = dither;
+    options.srgb = true;
+    demosaicToArgb(result.mosaic, result.pattern, demosaic,
+                   reinterpret_cast<uint8_t*>(const_cast<RGBA8Pixel*>(output.data)),
+                   static_cast<int>(output.strideBytes), options);
+    
+    AndroidBitmap_unlockPixels(env, outputBitmap);
+    return result.framesMerged;
+}
+
+// ==================== Diagnostics: Benchmarks ====================
+
+/**
+ * Run a native micro-benchmark on synthetic data
+ * 
+ * Long-running (seconds); call from a background thread.
+ * 
+ * @param benchmarkId One of NativeMFSRPipeline.BENCHMARK_*
+ * @return Plain-text report, or empty string for an unknown id
+ */
+JNIEXPORT jstring JNICALL
+Java_com_imagedit_app_ultradetail_NativeMFSRPipeline_nativeRunBenchmark(
+    JNIEnv* env,
+    jclass clazz,
+    jint benchmarkId
+) {
+    BenchmarkReport report = runBenchmark(static_cast<BenchmarkId>(benchmarkId));
+    if (report.title.empty()) {
+        return env->NewStringUTF("");
+    }
+    
+    std::string text = report.format();
+    LOGI("Benchmark %d complete:\n%s", benchmarkId, text.c_str());
+    return env->NewStringUTF(text.c_str());
+}
+
 } // extern "C"
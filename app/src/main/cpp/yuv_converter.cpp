@@ -1,11 +1,17 @@
 /**
  * yuv_converter.cpp - YUV to RGB conversion implementation
  * 
- * Optimized YUV_420_888 to RGB conversion with NEON acceleration.
+ * Fused YUV_420_888 ingestion: Y and the subsampled U/V are read once and
+ * RGB and luma are produced in the same pass, 8 pixels at a time with
+ * widening loads (simd.h: NEON on ARM, SSE on x86), row bands in parallel.
  */
 
 #include "yuv_converter.h"
-#include "neon_utils.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
 
 namespace ultradetail {
 
@@ -14,6 +20,7 @@ namespace ultradetail {
 // R = 1.164 * (Y - 16) + 1.596 * (V - 128)
 // G = 1.164 * (Y - 16) - 0.813 * (V - 128) - 0.391 * (U - 128)
 // B = 1.164 * (Y - 16) + 2.018 * (U - 128)
+// The kernel folds the final / 255 into the coefficients.
 
 constexpr float YUV_Y_SCALE = 1.164f;  // 255/219 for limited range
 constexpr float YUV_Y_OFFSET = 16.0f;  // Y offset for limited range
@@ -22,204 +29,208 @@ constexpr float YUV_G_U = -0.391f;
 constexpr float YUV_G_V = -0.813f;
 constexpr float YUV_B_U = 2.018f;
 
-void yuvToRgbFloat(const YUVFrame& yuv, RGBImage& output) {
-    if (output.width != yuv.width || output.height != yuv.height) {
-        output = RGBImage(yuv.width, yuv.height);
+constexpr float K_Y = YUV_Y_SCALE / 255.0f;
+constexpr float K_R_V = YUV_R_V / 255.0f;
+constexpr float K_G_U = YUV_G_U / 255.0f;
+constexpr float K_G_V = YUV_G_V / 255.0f;
+constexpr float K_B_U = YUV_B_U / 255.0f;
+
+// ITU-R BT.601 luminance coefficients
+constexpr float LUM_R = 0.299f;
+constexpr float LUM_G = 0.587f;
+constexpr float LUM_B = 0.114f;
+
+/**
+ * Scalar conversion of one pixel (also the reference for the SIMD paths)
+ */
+template<bool kStoreRGB, bool kStoreLuma, bool kWeightedLuma>
+static inline void convertPixel(const uint8_t* yRow, const uint8_t* uRow, const uint8_t* vRow,
+                                int x, int uvPixelStride, RGBPixel* rgb, float* luma) {
+    const float ys = (static_cast<float>(yRow[x]) - YUV_Y_OFFSET) * K_Y;
+    
+    if (!kStoreRGB && !kWeightedLuma) {
+        *luma = clamp(ys, 0.0f, 1.0f);
+        return;
     }
     
-    const int width = yuv.width;
-    const int height = yuv.height;
+    const int uvIdx = (x / 2) * uvPixelStride;
+    const float u = static_cast<float>(uRow[uvIdx]) - 128.0f;
+    const float v = static_cast<float>(vRow[uvIdx]) - 128.0f;
     
-#ifdef USE_NEON
-    // NEON-optimized conversion with limited-range BT.601
-    const float32x4_t v_16 = vdupq_n_f32(16.0f);
-    const float32x4_t v_128 = vdupq_n_f32(128.0f);
-    const float32x4_t v_y_scale = vdupq_n_f32(YUV_Y_SCALE);
-    const float32x4_t v_r_v = vdupq_n_f32(YUV_R_V);
-    const float32x4_t v_g_u = vdupq_n_f32(YUV_G_U);
-    const float32x4_t v_g_v = vdupq_n_f32(YUV_G_V);
-    const float32x4_t v_b_u = vdupq_n_f32(YUV_B_U);
-    const float32x4_t v_255_inv = vdupq_n_f32(1.0f / 255.0f);
-    const float32x4_t v_zero = vdupq_n_f32(0.0f);
-    const float32x4_t v_one = vdupq_n_f32(1.0f);
+    const float r = clamp(ys + K_R_V * v, 0.0f, 1.0f);
+    const float g = clamp(ys + K_G_U * u + K_G_V * v, 0.0f, 1.0f);
+    const float b = clamp(ys + K_B_U * u, 0.0f, 1.0f);
     
-    for (int y = 0; y < height; ++y) {
-        const uint8_t* yRow = yuv.yPlane + y * yuv.yRowStride;
-        const uint8_t* uRow = yuv.uPlane + (y / 2) * yuv.uvRowStride;
-        const uint8_t* vRow = yuv.vPlane + (y / 2) * yuv.uvRowStride;
-        RGBPixel* outRow = output.row(y);
-        
-        int x = 0;
-        
-        // Process 4 pixels at a time
-        for (; x + 3 < width; x += 4) {
-            // Load Y values
-            uint8_t y0 = yRow[x];
-            uint8_t y1 = yRow[x + 1];
-            uint8_t y2 = yRow[x + 2];
-            uint8_t y3 = yRow[x + 3];
-            
-            float yVals[4] = {
-                static_cast<float>(y0),
-                static_cast<float>(y1),
-                static_cast<float>(y2),
-                static_cast<float>(y3)
-            };
-            float32x4_t vY = vld1q_f32(yVals);
-            
-            // Load UV values (subsampled 2x2)
-            int uvIdx0 = (x / 2) * yuv.uvPixelStride;
-            int uvIdx1 = ((x + 2) / 2) * yuv.uvPixelStride;
-            
-            float uVals[4] = {
-                static_cast<float>(uRow[uvIdx0]),
-                static_cast<float>(uRow[uvIdx0]),
-                static_cast<float>(uRow[uvIdx1]),
-                static_cast<float>(uRow[uvIdx1])
-            };
-            float vVals[4] = {
-                static_cast<float>(vRow[uvIdx0]),
-                static_cast<float>(vRow[uvIdx0]),
-                static_cast<float>(vRow[uvIdx1]),
-                static_cast<float>(vRow[uvIdx1])
-            };
-            
-            float32x4_t vU = vld1q_f32(uVals);
-            float32x4_t vV = vld1q_f32(vVals);
-            
-            // Apply limited-range offset: Y - 16, UV - 128
-            vY = vsubq_f32(vY, v_16);
-            vY = vmulq_f32(vY, v_y_scale);  // Scale Y by 1.164
-            vU = vsubq_f32(vU, v_128);
-            vV = vsubq_f32(vV, v_128);
-            
-            // Compute RGB using BT.601 limited-range coefficients
-            float32x4_t vR = vmlaq_f32(vY, vV, v_r_v);
-            float32x4_t vG = vmlaq_f32(vmlaq_f32(vY, vU, v_g_u), vV, v_g_v);
-            float32x4_t vB = vmlaq_f32(vY, vU, v_b_u);
-            
-            // Normalize to [0, 1] and clamp
-            vR = vmulq_f32(vR, v_255_inv);
-            vG = vmulq_f32(vG, v_255_inv);
-            vB = vmulq_f32(vB, v_255_inv);
-            
-            vR = vmaxq_f32(vminq_f32(vR, v_one), v_zero);
-            vG = vmaxq_f32(vminq_f32(vG, v_one), v_zero);
-            vB = vmaxq_f32(vminq_f32(vB, v_one), v_zero);
-            
-            // Store results
-            float rVals[4], gVals[4], bVals[4];
-            vst1q_f32(rVals, vR);
-            vst1q_f32(gVals, vG);
-            vst1q_f32(bVals, vB);
-            
-            for (int i = 0; i < 4; ++i) {
-                outRow[x + i] = RGBPixel(rVals[i], gVals[i], bVals[i]);
-            }
-        }
-        
-        // Handle remaining pixels with limited-range conversion
-        for (; x < width; ++x) {
-            float yVal = (static_cast<float>(yRow[x]) - YUV_Y_OFFSET) * YUV_Y_SCALE;
-            int uvIdx = (x / 2) * yuv.uvPixelStride;
-            float uVal = static_cast<float>(uRow[uvIdx]) - 128.0f;
-            float vVal = static_cast<float>(vRow[uvIdx]) - 128.0f;
-            
-            float r = (yVal + YUV_R_V * vVal) / 255.0f;
-            float g = (yVal + YUV_G_U * uVal + YUV_G_V * vVal) / 255.0f;
-            float b = (yVal + YUV_B_U * uVal) / 255.0f;
-            
-            outRow[x] = RGBPixel(
-                clamp(r, 0.0f, 1.0f),
-                clamp(g, 0.0f, 1.0f),
-                clamp(b, 0.0f, 1.0f)
-            );
-        }
+    if (kStoreRGB) {
+        *rgb = RGBPixel(r, g, b);
     }
-#else
-    // Scalar fallback with limited-range BT.601 conversion
-    for (int y = 0; y < height; ++y) {
-        const uint8_t* yRow = yuv.yPlane + y * yuv.yRowStride;
-        const uint8_t* uRow = yuv.uPlane + (y / 2) * yuv.uvRowStride;
-        const uint8_t* vRow = yuv.vPlane + (y / 2) * yuv.uvRowStride;
-        RGBPixel* outRow = output.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            // Apply limited-range offset and scale
-            float yVal = (static_cast<float>(yRow[x]) - YUV_Y_OFFSET) * YUV_Y_SCALE;
-            int uvIdx = (x / 2) * yuv.uvPixelStride;
-            float uVal = static_cast<float>(uRow[uvIdx]) - 128.0f;
-            float vVal = static_cast<float>(vRow[uvIdx]) - 128.0f;
-            
-            float r = (yVal + YUV_R_V * vVal) / 255.0f;
-            float g = (yVal + YUV_G_U * uVal + YUV_G_V * vVal) / 255.0f;
-            float b = (yVal + YUV_B_U * uVal) / 255.0f;
-            
-            outRow[x] = RGBPixel(
-                clamp(r, 0.0f, 1.0f),
-                clamp(g, 0.0f, 1.0f),
-                clamp(b, 0.0f, 1.0f)
-            );
-        }
+    if (kStoreLuma) {
+        *luma = kWeightedLuma ? LUM_R * r + LUM_G * g + LUM_B * b : clamp(ys, 0.0f, 1.0f);
     }
-#endif
 }
 
-void yuvToGray(const YUVFrame& yuv, GrayImage& output) {
-    if (output.width != yuv.width || output.height != yuv.height) {
-        output = GrayImage(yuv.width, yuv.height);
+/**
+ * Chroma of 8 pixels starting at even x, each sample duplicated (u0 u0 u1 u1 ...)
+ */
+static inline simd::u16x8 loadChroma8(const uint8_t* row, int x, int pixelStride) {
+    const uint8_t* p = row + (x / 2) * pixelStride;
+    if (pixelStride == 2) {
+        // Interleaved (NV12 / NV21): keep the even bytes
+        return simd::duplicateEven(simd::u16x8::loadU8(p));
+    }
+    uint8_t c[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    if (pixelStride == 1) {
+        std::memcpy(c, p, 4);
+        simd::u16x8 c16 = simd::u16x8::loadU8(c);
+        return simd::interleaveLow(c16, c16);
+    }
+    for (int i = 0; i < 4; ++i) {
+        c[2 * i] = c[2 * i + 1] = p[i * pixelStride];
     }
+    return simd::u16x8::loadU8(c);
+}
+
+/**
+ * Convert 8 pixels starting at even x
+ */
+template<bool kStoreRGB, bool kStoreLuma, bool kWeightedLuma>
+static inline void convertBlock8(const uint8_t* yRow, const uint8_t* uRow, const uint8_t* vRow,
+                                 int x, int uvPixelStride, RGBPixel* rgb, float* luma) {
+    using simd::f32x4;
+    const f32x4 vOffset = f32x4::splat(YUV_Y_OFFSET);
+    const f32x4 v128 = f32x4::splat(128.0f);
+    const f32x4 vZero = f32x4::zero();
+    const f32x4 vOne = f32x4::splat(1.0f);
+    const f32x4 vKY = f32x4::splat(K_Y);
     
-    const int width = yuv.width;
-    const int height = yuv.height;
+    // Widen 8 Y samples (and duplicated U / V) straight from u8
+    simd::u16x8 y16 = simd::u16x8::loadU8(yRow + x);
+    f32x4 ys[2] = {
+        (simd::toFloatLow(y16) - vOffset) * vKY,
+        (simd::toFloatHigh(y16) - vOffset) * vKY
+    };
     
-#ifdef USE_NEON
-    // Limited-range conversion: (Y - 16) * 1.164 / 255
-    const float32x4_t v_16 = vdupq_n_f32(16.0f);
-    const float32x4_t v_scale = vdupq_n_f32(YUV_Y_SCALE / 255.0f);  // 1.164 / 255
-    const float32x4_t v_zero = vdupq_n_f32(0.0f);
-    const float32x4_t v_one = vdupq_n_f32(1.0f);
+    if (!kStoreRGB && !kWeightedLuma) {
+        simd::clamp(ys[0], vZero, vOne).store(luma);
+        simd::clamp(ys[1], vZero, vOne).store(luma + 4);
+        return;
+    }
     
-    for (int y = 0; y < height; ++y) {
-        const uint8_t* yRow = yuv.yPlane + y * yuv.yRowStride;
-        float* outRow = output.row(y);
+    simd::u16x8 u16 = loadChroma8(uRow, x, uvPixelStride);
+    simd::u16x8 v16 = loadChroma8(vRow, x, uvPixelStride);
+    
+    for (int half = 0; half < 2; ++half) {
+        f32x4 u = (half == 0 ? simd::toFloatLow(u16) : simd::toFloatHigh(u16)) - v128;
+        f32x4 v = (half == 0 ? simd::toFloatLow(v16) : simd::toFloatHigh(v16)) - v128;
         
-        int x = 0;
-        for (; x + 7 < width; x += 8) {
-            float32x4_t v0 = neon::load_u8_to_f32_low(yRow + x);
-            float32x4_t v1 = neon::load_u8_to_f32_high(yRow + x);
-            
-            // Apply limited-range offset and scale
-            v0 = vsubq_f32(v0, v_16);
-            v1 = vsubq_f32(v1, v_16);
-            v0 = vmulq_f32(v0, v_scale);
-            v1 = vmulq_f32(v1, v_scale);
-            
-            // Clamp to [0, 1]
-            v0 = vmaxq_f32(vminq_f32(v0, v_one), v_zero);
-            v1 = vmaxq_f32(vminq_f32(v1, v_one), v_zero);
-            
-            vst1q_f32(outRow + x, v0);
-            vst1q_f32(outRow + x + 4, v1);
-        }
+        // Same operation order as convertPixel
+        f32x4 r = simd::clamp(ys[half] + f32x4::splat(K_R_V) * v, vZero, vOne);
+        f32x4 g = simd::clamp(ys[half] + f32x4::splat(K_G_U) * u + f32x4::splat(K_G_V) * v, vZero, vOne);
+        f32x4 b = simd::clamp(ys[half] + f32x4::splat(K_B_U) * u, vZero, vOne);
         
-        for (; x < width; ++x) {
-            float val = (static_cast<float>(yRow[x]) - YUV_Y_OFFSET) * YUV_Y_SCALE / 255.0f;
-            outRow[x] = clamp(val, 0.0f, 1.0f);
+        if (kStoreRGB) {
+            simd::storeInterleaved3(reinterpret_cast<float*>(rgb + half * 4), r, g, b);
+        }
+        if (kStoreLuma) {
+            f32x4 l = kWeightedLuma
+                ? f32x4::splat(LUM_R) * r + f32x4::splat(LUM_G) * g + f32x4::splat(LUM_B) * b
+                : simd::clamp(ys[half], vZero, vOne);
+            l.store(luma + half * 4);
         }
     }
-#else
-    // Scalar fallback with limited-range conversion
-    for (int y = 0; y < height; ++y) {
-        const uint8_t* yRow = yuv.yPlane + y * yuv.yRowStride;
-        float* outRow = output.row(y);
-        
-        for (int x = 0; x < width; ++x) {
-            float val = (static_cast<float>(yRow[x]) - YUV_Y_OFFSET) * YUV_Y_SCALE / 255.0f;
-            outRow[x] = clamp(val, 0.0f, 1.0f);
+}
+
+template<bool kStoreRGB, bool kStoreLuma, bool kWeightedLuma>
+static void convertRowSpan(const YUVFrame& yuv, int y, int x0, int count, RGBPixel* rgb, float* luma) {
+    const uint8_t* yRow = yuv.yPlane + y * yuv.yRowStride;
+    const uint8_t* uRow = yuv.uPlane + (y / 2) * yuv.uvRowStride;
+    const uint8_t* vRow = yuv.vPlane + (y / 2) * yuv.uvRowStride;
+    const int end = x0 + count;
+    
+    // Pixel x writes to rgb[x - x0] / luma[x - x0]
+    rgb -= x0;
+    luma -= x0;
+    
+    int x = x0;
+    // Blocks start on a chroma pair; the next pixel must exist so that the
+    // chroma loads stay inside the row
+    if ((x & 1) && x < end) {
+        convertPixel<kStoreRGB, kStoreLuma, kWeightedLuma>(yRow, uRow, vRow, x, yuv.uvPixelStride, rgb + x, luma + x);
+        ++x;
+    }
+    for (; x + 8 <= end && x + 8 < yuv.width; x += 8) {
+        convertBlock8<kStoreRGB, kStoreLuma, kWeightedLuma>(yRow, uRow, vRow, x, yuv.uvPixelStride, rgb + x, luma + x);
+    }
+    for (; x < end; ++x) {
+        convertPixel<kStoreRGB, kStoreLuma, kWeightedLuma>(yRow, uRow, vRow, x, yuv.uvPixelStride, rgb + x, luma + x);
+    }
+}
+
+void yuvRowToRgbLuma(const YUVFrame& yuv, int y, int x0, int count,
+                     RGBPixel* rgb, float* luma, YUVLuma lumaMode) {
+    const bool weighted = lumaMode == YUVLuma::RGB_WEIGHTED;
+    if (rgb && luma) {
+        if (weighted) convertRowSpan<true, true, true>(yuv, y, x0, count, rgb, luma);
+        else          convertRowSpan<true, true, false>(yuv, y, x0, count, rgb, luma);
+    } else if (rgb) {
+        convertRowSpan<true, false, false>(yuv, y, x0, count, rgb, luma);
+    } else if (luma) {
+        if (weighted) convertRowSpan<false, true, true>(yuv, y, x0, count, rgb, luma);
+        else          convertRowSpan<false, true, false>(yuv, y, x0, count, rgb, luma);
+    }
+}
+
+void yuvToRgbLuma(const YUVFrame& yuv, RGBImage* rgb, GrayImage* luma, YUVLuma lumaMode) {
+    if (rgb) rgb->resize(yuv.width, yuv.height);
+    if (luma) luma->resize(yuv.width, yuv.height);
+    
+    ThreadPool::instance().parallelForRows(0, yuv.height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            yuvRowToRgbLuma(yuv, y, 0, yuv.width,
+                            rgb ? rgb->row(y) : nullptr,
+                            luma ? luma->row(y) : nullptr,
+                            lumaMode);
         }
+    });
+}
+
+void yuvToRgbFloat(const YUVFrame& yuv, RGBImage& output) {
+    yuvToRgbLuma(yuv, &output, nullptr, YUVLuma::Y_PLANE);
+}
+
+void yuvToGray(const YUVFrame& yuv, GrayImage& output) {
+    yuvToRgbLuma(yuv, nullptr, &output, YUVLuma::Y_PLANE);
+}
+
+/**
+ * Copy rows of rowBytes bytes from a strided plane into a tight buffer
+ */
+static void copyPlane(const uint8_t* src, int srcStride, int rowBytes, int rows,
+                      std::vector<uint8_t>& dst) {
+    dst.resize(static_cast<size_t>(rowBytes) * rows);
+    for (int y = 0; y < rows; ++y) {
+        std::memcpy(dst.data() + static_cast<size_t>(y) * rowBytes,
+                    src + static_cast<size_t>(y) * srcStride, rowBytes);
     }
-#endif
+}
+
+void OwnedYUVFrame::assign(const YUVFrame& source) {
+    const int chromaWidth = (source.width + 1) / 2;
+    const int chromaHeight = (source.height + 1) / 2;
+    const int chromaRowBytes = (chromaWidth - 1) * source.uvPixelStride + 1;
+
+    // U and V may interleave in one buffer (NV12 / NV21); each copy keeps the
+    // other channel's bytes between samples so the pixel stride stays valid
+    copyPlane(source.yPlane, source.yRowStride, source.width, source.height, y_);
+    copyPlane(source.uPlane, source.uvRowStride, chromaRowBytes, chromaHeight, u_);
+    copyPlane(source.vPlane, source.uvRowStride, chromaRowBytes, chromaHeight, v_);
+
+    frame_ = source;
+    frame_.yPlane = y_.data();
+    frame_.uPlane = u_.data();
+    frame_.vPlane = v_.data();
+    frame_.yRowStride = source.width;
+    frame_.uvRowStride = chromaRowBytes;
 }
 
 ImageStats computeImageStats(const RGBImage& image) {
@@ -325,26 +336,116 @@ int sanitizeRGBImage(RGBImage& image) {
     return sanitizedCount;
 }
 
-void rgbFloatToArgb(const RGBImage& input, uint8_t* output, int outputStride) {
-    const int width = input.width;
-    const int height = input.height;
+// ==================== Float RGB -> RGBA_8888 packing ====================
+
+// 4x4 ordered (Bayer) dither thresholds in LSB, zero mean
+static const float kDitherMatrix[4][4] = {
+    { -0.46875f,  0.03125f, -0.34375f,  0.15625f },
+    {  0.28125f, -0.21875f,  0.40625f, -0.09375f },
+    { -0.28125f,  0.21875f, -0.40625f,  0.09375f },
+    {  0.46875f, -0.03125f,  0.34375f, -0.15625f }
+};
+
+constexpr int SRGB_LUT_SIZE = 8192;
+
+/**
+ * sRGB transfer curve sampled over linear [0, 1], scaled to [0, 255]
+ */
+static const float* srgbEncodeLut() {
+    static const std::vector<float> lut = [] {
+        std::vector<float> table(SRGB_LUT_SIZE);
+        for (int i = 0; i < SRGB_LUT_SIZE; ++i) {
+            float linear = static_cast<float>(i) / (SRGB_LUT_SIZE - 1);
+            float encoded = linear <= 0.0031308f
+                ? 12.92f * linear
+                : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+            table[i] = encoded * 255.0f;
+        }
+        return table;
+    }();
+    return lut.data();
+}
+
+/**
+ * Quantize a value already scaled to [0, 255] (plus rounding / dither offset);
+ * NaN packs as 0
+ */
+static inline uint32_t quantizeScaled(float v) {
+    if (!(v > 0.0f)) return 0;
+    return static_cast<uint32_t>(v < 255.0f ? v : 255.0f);
+}
+
+/**
+ * sRGB-encoded value in [0, 255] of a linear value; NaN encodes as 0
+ */
+static inline float srgbEncode(const float* lut, float v) {
+    v = v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f;
+    return lut[static_cast<int>(v * (SRGB_LUT_SIZE - 1) + 0.5f)];
+}
+
+template<bool kDither, bool kSRGB>
+static void packRow(const RGBPixel* src, int width, int y, uint8_t* dst) {
+    const float* dither = kDitherMatrix[y & 3];
+    uint32_t* out = reinterpret_cast<uint32_t*>(dst);
+    int x = 0;
     
-    for (int y = 0; y < height; ++y) {
-        const RGBPixel* inRow = input.row(y);
-        uint8_t* outRow = output + y * outputStride;
-        
-        for (int x = 0; x < width; ++x) {
-            const RGBPixel& px = inRow[x];
-            int idx = x * 4;
-            
-            // RGBA format (Android Bitmap RGBA_8888)
-            // floatToUint8 now handles NaN/Inf internally
-            outRow[idx + 0] = floatToUint8(px.r);
-            outRow[idx + 1] = floatToUint8(px.g);
-            outRow[idx + 2] = floatToUint8(px.b);
-            outRow[idx + 3] = 255;  // Alpha
+    if (!kSRGB) {
+        // 4 pixels per step: deinterleave, scale, clamp (NaN -> 0), truncate, pack r | g << 8 | b << 16 | a << 24
+        using simd::f32x4;
+        const f32x4 offset = kDither
+            ? f32x4::splat(0.5f) + f32x4::load(dither)
+            : f32x4::splat(0.5f);
+        const f32x4 scale = f32x4::splat(255.0f);
+        const f32x4 zero = f32x4::zero();
+        const simd::u32x4 alpha = simd::u32x4::splat(0xFF000000u);
+        for (; x + 4 <= width; x += 4) {
+            f32x4 rv, gv, bv;
+            simd::loadDeinterleaved3(reinterpret_cast<const float*>(src + x), rv, gv, bv);
+            simd::u32x4 r = simd::toUint32(simd::clamp(rv * scale + offset, zero, scale));
+            simd::u32x4 g = simd::toUint32(simd::clamp(gv * scale + offset, zero, scale));
+            simd::u32x4 b = simd::toUint32(simd::clamp(bv * scale + offset, zero, scale));
+            simd::u32x4 packed = (r | simd::shiftLeft<8>(g)) | (simd::shiftLeft<16>(b) | alpha);
+            packed.store(out + x);
         }
     }
+    
+    const float* lut = kSRGB ? srgbEncodeLut() : nullptr;
+    for (; x < width; ++x) {
+        const RGBPixel& px = src[x];
+        const float offset = 0.5f + (kDither ? dither[x & 3] : 0.0f);
+        float r, g, b;
+        if (kSRGB) {
+            r = srgbEncode(lut, px.r);
+            g = srgbEncode(lut, px.g);
+            b = srgbEncode(lut, px.b);
+        } else {
+            r = px.r * 255.0f;
+            g = px.g * 255.0f;
+            b = px.b * 255.0f;
+        }
+        out[x] = quantizeScaled(r + offset) |
+                 (quantizeScaled(g + offset) << 8) |
+                 (quantizeScaled(b + offset) << 16) |
+                 0xFF000000u;
+    }
+}
+
+void rgbFloatRowToArgb(const RGBPixel* src, int width, int y, uint8_t* dst, const ArgbPackOptions& options) {
+    if (options.dither) {
+        if (options.srgb) packRow<true, true>(src, width, y, dst);
+        else              packRow<true, false>(src, width, y, dst);
+    } else {
+        if (options.srgb) packRow<false, true>(src, width, y, dst);
+        else              packRow<false, false>(src, width, y, dst);
+    }
+}
+
+void rgbFloatToArgb(const RGBImage& input, uint8_t* output, int outputStride, const ArgbPackOptions& options) {
+    ThreadPool::instance().parallelForRows(0, input.height, [&](int y0, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            rgbFloatRowToArgb(input.row(y), input.width, y, output + static_cast<size_t>(y) * outputStride, options);
+        }
+    });
 }
 
 void rgbToLuminance(const RGBImage& rgb, GrayImage& output) {
@@ -355,17 +456,6 @@ void rgbToLuminance(const RGBImage& rgb, GrayImage& output) {
     const int width = rgb.width;
     const int height = rgb.height;
     
-    // ITU-R BT.601 luminance coefficients
-    constexpr float LUM_R = 0.299f;
-    constexpr float LUM_G = 0.587f;
-    constexpr float LUM_B = 0.114f;
-    
-#ifdef USE_NEON
-    const float32x4_t v_lum_r = vdupq_n_f32(LUM_R);
-    const float32x4_t v_lum_g = vdupq_n_f32(LUM_G);
-    const float32x4_t v_lum_b = vdupq_n_f32(LUM_B);
-#endif
-    
     for (int y = 0; y < height; ++y) {
         const RGBPixel* inRow = rgb.row(y);
         float* outRow = output.row(y);
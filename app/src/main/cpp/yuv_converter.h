@@ -2,13 +2,15 @@
  * yuv_converter.h - YUV to RGB conversion utilities
  * 
  * Handles conversion from YUV_420_888 format (CameraX output)
- * to float32 RGB for processing.
+ * to float32 RGB for processing. RGB and luma come out of a single fused
+ * pass over the planes (SIMD per row, parallel over row bands).
  */
 
 #ifndef ULTRADETAIL_YUV_CONVERTER_H
 #define ULTRADETAIL_YUV_CONVERTER_H
 
 #include "common.h"
+#include <vector>
 
 namespace ultradetail {
 
@@ -26,6 +28,63 @@ struct YUVFrame {
     int height;
 };
 
+/**
+ * YUV_420_888 frame that owns a copy of its planes
+ *
+ * Lets a frame outlive the camera image it came from, so conversion can run
+ * in the background after the image has been handed back. Rows are stored
+ * tightly (chroma keeps its pixel stride). Movable, not copyable.
+ */
+class OwnedYUVFrame {
+public:
+    OwnedYUVFrame() : frame_() {}
+    explicit OwnedYUVFrame(const YUVFrame& source) { assign(source); }
+
+    OwnedYUVFrame(OwnedYUVFrame&&) = default;
+    OwnedYUVFrame& operator=(OwnedYUVFrame&&) = default;
+    OwnedYUVFrame(const OwnedYUVFrame&) = delete;
+    OwnedYUVFrame& operator=(const OwnedYUVFrame&) = delete;
+
+    /**
+     * Copy the visible region of the source planes
+     */
+    void assign(const YUVFrame& source);
+
+    const YUVFrame& frame() const { return frame_; }
+    size_t sizeBytes() const { return y_.size() + u_.size() + v_.size(); }
+
+private:
+    std::vector<uint8_t> y_, u_, v_;
+    YUVFrame frame_;    // Points into the owned planes (vector moves keep the buffers)
+};
+
+/**
+ * Luma produced alongside RGB by the fused conversion
+ */
+enum class YUVLuma {
+    Y_PLANE,        // BT.601 limited-range Y expanded to [0, 1]
+    RGB_WEIGHTED    // Rec.601 weighted sum of the converted (clamped) RGB
+};
+
+/**
+ * Convert one row span [x0, x0 + count) of row y to RGB and / or luma
+ * 
+ * @param rgb Receives count RGB pixels, or nullptr
+ * @param luma Receives count luma values, or nullptr
+ */
+void yuvRowToRgbLuma(const YUVFrame& yuv, int y, int x0, int count,
+                     RGBPixel* rgb, float* luma, YUVLuma lumaMode);
+
+/**
+ * Convert a whole frame to RGB and / or luma in one pass over the planes
+ * 
+ * Row bands are converted in parallel on the shared thread pool.
+ * 
+ * @param rgb Output RGB image (resized), or nullptr
+ * @param luma Output luma image (resized), or nullptr
+ */
+void yuvToRgbLuma(const YUVFrame& yuv, RGBImage* rgb, GrayImage* luma, YUVLuma lumaMode);
+
 /**
  * Convert YUV_420_888 frame to float32 RGB image
  * 
@@ -42,14 +101,40 @@ void yuvToRgbFloat(const YUVFrame& yuv, RGBImage& output);
  */
 void yuvToGray(const YUVFrame& yuv, GrayImage& output);
 
+/**
+ * Options for packing float RGB into 8-bit bitmap pixels
+ */
+struct ArgbPackOptions {
+    bool dither;    // 4x4 ordered dither before quantization (hides banding in smooth gradients)
+    bool srgb;      // Input is linear light: apply the sRGB transfer curve while packing
+    
+    ArgbPackOptions() : dither(false), srgb(false) {}
+};
+
+/**
+ * Pack one row of float RGB into Android ARGB_8888 pixels (R, G, B, A in memory)
+ * 
+ * Values are clamped to [0, 1] and rounded; NaN packs as 0. Alpha is 255.
+ * 
+ * @param src Input row
+ * @param width Pixels in the row
+ * @param y Row index (selects the dither pattern row)
+ * @param dst Output row, 4 bytes per pixel
+ */
+void rgbFloatRowToArgb(const RGBPixel* src, int width, int y, uint8_t* dst,
+                       const ArgbPackOptions& options = ArgbPackOptions());
+
 /**
  * Convert float32 RGB image to uint8 ARGB bitmap format
  * 
+ * Rows are packed in parallel on the shared thread pool.
+ * 
  * @param input Input RGB image
  * @param output Output ARGB buffer (pre-allocated, 4 bytes per pixel)
  * @param outputStride Stride of output buffer in bytes
  */
-void rgbFloatToArgb(const RGBImage& input, uint8_t* output, int outputStride);
+void rgbFloatToArgb(const RGBImage& input, uint8_t* output, int outputStride,
+                    const ArgbPackOptions& options = ArgbPackOptions());
 
 /**
  * Convert grayscale float image to luminance
@@ -16,7 +16,8 @@ enum class MergeMethod(val value: Int) {
     AVERAGE(0),
     TRIMMED_MEAN(1),
     M_ESTIMATOR(2),
-    MEDIAN(3)
+    MEDIAN(3),
+    FREQUENCY_DOMAIN(4)
 }
 
 /**
@@ -137,6 +138,68 @@ class NativeBurstProcessor private constructor(
         )
     }
     
+    /**
+     * Start an incremental burst
+     * 
+     * Push each frame with [pushFrame] as soon as it is captured; conversion
+     * and alignment run in the background, so [finishBurst] only merges.
+     * 
+     * @param expectedFrames Number of frames that will be pushed
+     * @return true if the burst was opened
+     */
+    fun beginBurst(expectedFrames: Int): Boolean {
+        check(nativeHandle != 0L) { "Processor has been destroyed" }
+        return nativeBeginBurst(nativeHandle, expectedFrames)
+    }
+    
+    /**
+     * Add the next frame of the open burst
+     * 
+     * The planes are copied before this returns, so the frame can be released.
+     * 
+     * @return 0 on success, negative on error
+     */
+    fun pushFrame(
+        yPlane: ByteBuffer,
+        uPlane: ByteBuffer,
+        vPlane: ByteBuffer,
+        yRowStride: Int,
+        uvRowStride: Int,
+        uvPixelStride: Int,
+        width: Int,
+        height: Int
+    ): Int {
+        check(nativeHandle != 0L) { "Processor has been destroyed" }
+        return nativePushFrame(
+            nativeHandle, yPlane, uPlane, vPlane,
+            yRowStride, uvRowStride, uvPixelStride, width, height
+        )
+    }
+    
+    /**
+     * Merge the open burst into the output bitmap
+     * 
+     * @param outputBitmap Pre-allocated ARGB_8888 bitmap for output
+     * @param progressCallback Optional progress callback
+     * @return Result code (0 = success), same codes as [processYUV]
+     */
+    fun finishBurst(
+        outputBitmap: Bitmap,
+        progressCallback: ((ProcessingStage, Float, String) -> Unit)? = null
+    ): Int {
+        check(nativeHandle != 0L) { "Processor has been destroyed" }
+        
+        val callback = progressCallback?.let { cb ->
+            object : NativeProgressCallback {
+                override fun onProgress(stage: Int, progress: Float, message: String) {
+                    cb(ProcessingStage.fromValue(stage), progress, message)
+                }
+            }
+        }
+        
+        return nativeFinishBurst(nativeHandle, outputBitmap, callback)
+    }
+    
     /**
      * Get the detail mask from the last processing operation
      * 
@@ -222,6 +285,26 @@ class NativeBurstProcessor private constructor(
         callback: NativeProgressCallback?
     ): Int
     
+    private external fun nativeBeginBurst(handle: Long, expectedFrames: Int): Boolean
+    
+    private external fun nativePushFrame(
+        handle: Long,
+        yPlane: ByteBuffer,
+        uPlane: ByteBuffer,
+        vPlane: ByteBuffer,
+        yRowStride: Int,
+        uvRowStride: Int,
+        uvPixelStride: Int,
+        width: Int,
+        height: Int
+    ): Int
+    
+    private external fun nativeFinishBurst(
+        handle: Long,
+        outputBitmap: Bitmap,
+        callback: NativeProgressCallback?
+    ): Int
+    
     private external fun nativeGetDetailMask(
         handle: Long,
         outputMask: ByteArray,
@@ -8,6 +8,7 @@ package com.imagedit.app.ultradetail
 
 import android.graphics.Bitmap
 import android.util.Log
+import java.io.File
 import java.nio.ByteBuffer
 
 private const val TAG = "NativeMFSRPipeline"
@@ -31,7 +32,8 @@ data class NativeMFSRConfig(
     val scaleFactor: Int = 2,
     val robustness: MFSRRobustness = MFSRRobustness.HUBER,  // HUBER is gentler than TUKEY for low-diversity frames
     val robustnessThreshold: Float = 0.8f,  // Higher threshold allows more frame contribution
-    val useGyroInit: Boolean = true
+    val useGyroInit: Boolean = true,
+    val maxMemoryMB: Int = 200  // Native working-set budget; tiles shrink / serialize to fit
 )
 
 /**
@@ -212,6 +214,63 @@ class NativeMFSRPipeline private constructor(
         )
     }
     
+    /**
+     * Start an incremental YUV burst
+     * 
+     * Push each frame with [pushFrame] as soon as it is captured; its shake
+     * check and global alignment run in the background, so [finishBurst]
+     * only has the tile stage left. Auto-selecting the reference by gyro
+     * needs the whole burst, so the reference is fixed up front here.
+     * 
+     * @param expectedFrames Number of frames that will be pushed
+     * @param referenceIndex Reference frame index, or -1 for the middle frame
+     * @return true if the burst was opened
+     */
+    fun beginBurst(expectedFrames: Int, referenceIndex: Int = -1): Boolean {
+        check(nativeHandle != 0L) { "Pipeline has been destroyed" }
+        return nativeBeginBurst(nativeHandle, expectedFrames, referenceIndex)
+    }
+    
+    /**
+     * Add the next frame of the open burst
+     * 
+     * The planes are copied before this returns, so the frame can be released.
+     * 
+     * @param frame Captured YUV frame
+     * @param homography Optional gyro homography of this frame
+     * @return 0 on success, negative on error
+     */
+    fun pushFrame(frame: CapturedFrame, homography: Homography? = null): Int {
+        check(nativeHandle != 0L) { "Pipeline has been destroyed" }
+        return nativePushFrame(
+            nativeHandle,
+            frame.yPlane,
+            frame.uPlane,
+            frame.vPlane,
+            frame.yRowStride,
+            frame.uvRowStride,
+            frame.uvPixelStride,
+            frame.width,
+            frame.height,
+            homography?.let { homographiesToFloatArray(listOf(it)) }
+        )
+    }
+    
+    /**
+     * Run the open burst through the MFSR tile stage
+     * 
+     * @param outputBitmap Pre-allocated output bitmap (scaled size)
+     * @param progressCallback Optional progress callback
+     * @return Reference index used on success, negative error code on failure
+     */
+    fun finishBurst(
+        outputBitmap: Bitmap,
+        progressCallback: MFSRProgressCallback? = null
+    ): Int {
+        check(nativeHandle != 0L) { "Pipeline has been destroyed" }
+        return nativeFinishBurst(nativeHandle, outputBitmap, progressCallback)
+    }
+    
     /**
      * Compute total gyro rotation magnitude from samples
      */
@@ -309,6 +368,31 @@ class NativeMFSRPipeline private constructor(
         callback: MFSRProgressCallback?
     ): Int
     
+    private external fun nativeBeginBurst(
+        handle: Long,
+        expectedFrames: Int,
+        referenceIndex: Int
+    ): Boolean
+    
+    private external fun nativePushFrame(
+        handle: Long,
+        yPlane: ByteBuffer,
+        uPlane: ByteBuffer,
+        vPlane: ByteBuffer,
+        yRowStride: Int,
+        uvRowStride: Int,
+        uvPixelStride: Int,
+        width: Int,
+        height: Int,
+        homography: FloatArray?
+    ): Int
+    
+    private external fun nativeFinishBurst(
+        handle: Long,
+        outputBitmap: Bitmap,
+        callback: MFSRProgressCallback?
+    ): Int
+    
     private external fun nativeGetResultInfo(
         handle: Long,
         outputInfo: FloatArray
@@ -353,7 +437,8 @@ class NativeMFSRPipeline private constructor(
                 config.scaleFactor,
                 config.robustness.value,
                 config.robustnessThreshold,
-                config.useGyroInit
+                config.useGyroInit,
+                config.maxMemoryMB
             )
             
             Log.d(TAG, "Created NativeMFSRPipeline: tile=${config.tileWidth}x${config.tileHeight}, " +
@@ -370,12 +455,21 @@ class NativeMFSRPipeline private constructor(
             scaleFactor: Int,
             robustnessMethod: Int,
             robustnessThreshold: Float,
-            useGyroInit: Boolean
+            useGyroInit: Boolean,
+            maxMemoryMB: Int
         ): Long
         
         @JvmStatic
         private external fun nativeDestroy(handle: Long)
         
+        /**
+         * Directory for burst frame spill files (use the app cache dir).
+         * Incremental bursts larger than the resident frame budget are kept
+         * in memory-mapped files here instead of RAM; null disables spilling.
+         */
+        @JvmStatic
+        external fun nativeSetSpillDirectory(path: String?)
+        
         // ==================== Phase 1: Enhancement Functions ====================
         
         /**
@@ -610,6 +704,117 @@ class NativeMFSRPipeline private constructor(
             numCPUThreads: Int,
             callback: TileSynthProgressCallback?
         ): Int
+        
+        // ==================== Image Session ====================
+        
+        /**
+         * Create a native session holding a float copy of a bitmap (see NativeImageSession)
+         * @return Session handle, or 0 on error
+         */
+        @JvmStatic
+        external fun nativeSessionCreate(inputBitmap: Bitmap): Long
+        
+        @JvmStatic
+        external fun nativeSessionDestroy(handle: Long)
+        
+        @JvmStatic
+        external fun nativeSessionApplyFreqSeparation(
+            handle: Long,
+            lowPassSigma: Float,
+            highBoost: Float,
+            edgeProtection: Float,
+            blendStrength: Float
+        ): Int
+        
+        @JvmStatic
+        external fun nativeSessionApplyAnisotropicFilter(
+            handle: Long,
+            kernelSigma: Float,
+            elongation: Float,
+            noiseThreshold: Float
+        ): Int
+        
+        /**
+         * @return Number of pixels that received detail, negative on error
+         */
+        @JvmStatic
+        external fun nativeSessionReferenceDetailTransfer(
+            handle: Long,
+            referenceBitmap: Bitmap,
+            blendStrength: Float
+        ): Int
+        
+        @JvmStatic
+        external fun nativeSessionTextureSynthesisTiled(
+            handle: Long,
+            tileSize: Int,
+            overlap: Int,
+            useGPU: Boolean,
+            numCPUThreads: Int,
+            callback: TileSynthProgressCallback?
+        ): Int
+        
+        @JvmStatic
+        external fun nativeSessionExport(handle: Long, outputBitmap: Bitmap, dither: Boolean): Int
+        
+        // ==================== RAW Burst Merge ====================
+        
+        /**
+         * @return [width, height] of a RAWC cache file, or null if it cannot be read
+         */
+        @JvmStatic
+        external fun nativeReadRawCacheSize(path: String): IntArray?
+        
+        /**
+         * Merge RAWC cache files in the Bayer domain and demosaic into a bitmap
+         * (see [mergeRawBurst])
+         * 
+         * @return Number of frames merged, negative on error
+         */
+        @JvmStatic
+        external fun nativeMergeRawBurst(
+            paths: Array<String>,
+            referenceIndex: Int,
+            whiteBalance: FloatArray?,
+            outputBitmap: Bitmap,
+            dither: Boolean
+        ): Int
+        
+        // ==================== Diagnostics: Benchmarks ====================
+        
+        /** Tile alignment throughput vs. thread count (hybrid and dense flow) */
+        const val BENCHMARK_ALIGNMENT_SCALING = 0
+        
+        /** 2D FFT engine vs. textbook radix-2 at 64/128/256/512 */
+        const val BENCHMARK_FFT = 1
+        
+        /** Fused YUV -> RGB + luma ingestion vs. the per-pixel loop, in MP/s */
+        const val BENCHMARK_YUV_INGEST = 2
+        
+        /** Portable SIMD row kernels (compile-time and runtime-dispatched) vs. plain loops, in MP/s */
+        const val BENCHMARK_SIMD_KERNELS = 3
+        
+        /** Decimating Gaussian/RGB pyramid construction vs. blur-then-decimate, in MP/s */
+        const val BENCHMARK_PYRAMID = 4
+        
+        /** Sorting-network robust merge kernels vs. per-pixel sorting, in MP/s */
+        const val BENCHMARK_MERGE = 5
+        
+        /** Summed-area table local mean/variance vs. per-window sums at radius 2/4/8, in MP/s */
+        const val BENCHMARK_LOCAL_MOMENTS = 6
+        
+        /** Frequency-domain tile merge vs. trimmed mean + Wiener, in MP/s (PSNR in the log) */
+        const val BENCHMARK_FREQUENCY_MERGE = 7
+        
+        /**
+         * Run a native micro-benchmark on synthetic data.
+         * Takes several seconds; call from a background thread.
+         * 
+         * @param benchmarkId One of the BENCHMARK_* constants
+         * @return Plain-text report table (empty for an unknown id)
+         */
+        @JvmStatic
+        external fun nativeRunBenchmark(benchmarkId: Int): String
     }
 }
 
@@ -1071,3 +1276,152 @@ fun synthesizeTextureTiledWithProgress(
     )
     return result == 0
 }
+
+// ==================== Image Session ====================
+
+/**
+ * Native float working image for chained enhancement steps
+ * 
+ * Loads a bitmap once, runs enhancement steps in place on the float image,
+ * and quantizes to 8 bits a single time in [export]. This avoids one
+ * Bitmap round trip (and one 8-bit quantization) per step.
+ * 
+ * Not thread-safe; close() when done to free the native image.
+ */
+class NativeImageSession private constructor(
+    private var nativeHandle: Long
+) : AutoCloseable {
+    
+    fun applyFreqSeparation(params: FreqSeparationConfig = FreqSeparationConfig()): Boolean {
+        if (nativeHandle == 0L) return false
+        return NativeMFSRPipeline.nativeSessionApplyFreqSeparation(
+            nativeHandle,
+            params.lowPassSigma,
+            params.highBoost,
+            params.edgeProtection,
+            params.blendStrength
+        ) == 0
+    }
+    
+    fun applyAnisotropicFilter(params: AnisotropicFilterConfig = AnisotropicFilterConfig()): Boolean {
+        if (nativeHandle == 0L) return false
+        return NativeMFSRPipeline.nativeSessionApplyAnisotropicFilter(
+            nativeHandle,
+            params.kernelSigma,
+            params.elongation,
+            params.noiseThreshold
+        ) == 0
+    }
+    
+    /**
+     * Transfer high-frequency detail from the sharpest original frame
+     * (see [transferReferenceDetail])
+     */
+    fun transferReferenceDetail(reference: Bitmap, blendStrength: Float = 0.5f): Boolean {
+        if (nativeHandle == 0L) return false
+        return NativeMFSRPipeline.nativeSessionReferenceDetailTransfer(
+            nativeHandle, reference, blendStrength
+        ) >= 0
+    }
+    
+    fun synthesizeTextureTiled(
+        config: TileSynthConfig = TileSynthConfig(),
+        progressCallback: TileSynthProgressCallback? = null
+    ): Boolean {
+        if (nativeHandle == 0L) return false
+        return NativeMFSRPipeline.nativeSessionTextureSynthesisTiled(
+            nativeHandle,
+            config.tileSize,
+            config.overlap,
+            config.useGPU,
+            config.numCPUThreads,
+            progressCallback
+        ) == 0
+    }
+    
+    /**
+     * Write the working image into a bitmap of the session size
+     * 
+     * @param dither Ordered dither while quantizing (hides banding in gradients)
+     */
+    fun export(output: Bitmap, dither: Boolean = false): Boolean {
+        if (nativeHandle == 0L) return false
+        return NativeMFSRPipeline.nativeSessionExport(nativeHandle, output, dither) == 0
+    }
+    
+    override fun close() {
+        if (nativeHandle != 0L) {
+            NativeMFSRPipeline.nativeSessionDestroy(nativeHandle)
+            nativeHandle = 0L
+        }
+    }
+    
+    companion object {
+        /**
+         * Load a bitmap into a new session
+         * 
+         * @return Session, or null if the bitmap could not be loaded
+         */
+        fun create(input: Bitmap): NativeImageSession? {
+            if (!NativeMFSRPipeline.isAvailable()) return null
+            val handle = NativeMFSRPipeline.nativeSessionCreate(input)
+            if (handle == 0L) {
+                Log.e(TAG, "Failed to create native image session")
+                return null
+            }
+            return NativeImageSession(handle)
+        }
+    }
+}
+
+// ==================== RAW Burst Merge ====================
+
+/**
+ * Result of a RAW burst merge
+ */
+data class RawMergeResult(
+    val bitmap: Bitmap,                   // Demosaiced merge, sensor resolution
+    val framesMerged: Int                 // Reference plus the frames that aligned
+)
+
+/**
+ * Merge a RAW burst from the raw-cache files written by RawBurstCaptureController
+ * 
+ * Frames are memory-mapped, aligned on a half-resolution green proxy and
+ * merged in the Bayer domain; the merged mosaic is demosaiced once into the
+ * returned bitmap (sensor resolution, sRGB-encoded camera RGB). Long-running;
+ * call from a background thread.
+ * 
+ * @param files Raw-cache files of one burst
+ * @param referenceIndex Reference frame, -1 for the middle frame
+ * @param whiteBalance R, G, B gains, or null to estimate them from the scene
+ * @param dither Ordered dither while quantizing to 8 bits
+ * @return Merged bitmap and the number of frames it merged, or null on failure
+ */
+fun mergeRawBurst(
+    files: List<File>,
+    referenceIndex: Int = -1,
+    whiteBalance: FloatArray? = null,
+    dither: Boolean = true
+): RawMergeResult? {
+    if (files.isEmpty() || !NativeMFSRPipeline.isAvailable()) return null
+    
+    val size = NativeMFSRPipeline.nativeReadRawCacheSize(files[0].absolutePath) ?: return null
+    val output = Bitmap.createBitmap(size[0], size[1], Bitmap.Config.ARGB_8888)
+    
+    val merged = NativeMFSRPipeline.nativeMergeRawBurst(
+        files.map { it.absolutePath }.toTypedArray(),
+        referenceIndex,
+        whiteBalance,
+        output,
+        dither
+    )
+    if (merged <= 0) {
+        Log.e(TAG, "RAW burst merge failed: $merged")
+        output.recycle()
+        return null
+    }
+    
+    Log.d(TAG, "RAW burst merged: $merged/${files.size} frames, ${size[0]}x${size[1]}")
+    return RawMergeResult(output, merged)
+}
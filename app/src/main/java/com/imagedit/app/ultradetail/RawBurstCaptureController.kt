@@ -459,9 +459,11 @@ class RawBurstCaptureController(
         val img = frame.rawImage
         val plane = img.planes[0]
 
+        // Layout is parsed by raw_burst.cpp (RawCacheFile); keep the two in sync
+        val blackLevel = rawCapability.blackLevel
         val header = ByteBuffer.allocate(64).order(ByteOrder.LITTLE_ENDIAN)
         header.putInt(0x52415743) // 'RAWC'
-        header.putInt(1) // version
+        header.putInt(2) // version
         header.putInt(img.width)
         header.putInt(img.height)
         header.putInt(plane.rowStride)
@@ -470,9 +472,13 @@ class RawBurstCaptureController(
         header.putInt(rawCapability.bayerPattern)
         header.putInt(rawCapability.whiteLevel)
         header.putLong(frame.timestampNs)
-        header.putInt(0)
-        header.putInt(0)
-        header.flip()
+        // Black level per 2x2 position (x + 2 * y), then reserved
+        for (i in 0 until 4) {
+            header.putInt(blackLevel?.getOrNull(i) ?: 0)
+        }
+        // Write the whole 64 bytes (reserved tail stays zero) so the plane
+        // always starts at offset 64
+        header.rewind()
 
         FileOutputStream(outFile).use { fos ->
             fos.channel.write(header)
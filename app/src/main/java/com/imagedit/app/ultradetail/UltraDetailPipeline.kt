@@ -155,6 +155,8 @@ class UltraDetailPipeline(
                     UltraDetailPreset.BALANCED -> adaptiveTileSize / 12  // Balanced
                     UltraDetailPreset.MAX, UltraDetailPreset.ULTRA -> adaptiveTileSize / 8  // Quality overlap
                 }
+                // Full-resolution bursts that do not fit in RAM spill to the cache dir
+                NativeMFSRPipeline.nativeSetSpillDirectory(context.cacheDir.absolutePath)
                 mfsrPipeline = NativeMFSRPipeline.create(NativeMFSRConfig(
                     tileWidth = adaptiveTileSize,
                     tileHeight = adaptiveTileSize,
@@ -1191,66 +1193,72 @@ class UltraDetailPipeline(
             )
             
             try {
-                // Step 0: Reference-based detail transfer (NEW - Topaz Gigapixel inspired)
-                // Use the sharpest original frame to transfer high-frequency detail to upscaled output
-                _state.value = PipelineState.ProcessingBurst(
-                    ProcessingStage.MERGING_FRAMES, 0.82f, "Transferring fine details from reference..."
-                )
-                Log.i(TAG, "║ Stage 3.5-pre: Reference-based detail transfer...")
-                val sharpestFrame = correctedFrames[workingRefIndex].bitmap
-                val refTransferOutput = Bitmap.createBitmap(outputWidth, outputHeight, Bitmap.Config.ARGB_8888)
-                
-                // Transfer high-frequency detail from sharpest frame
-                // This extracts Laplacian (edges/texture) from reference and blends into upscaled output
-                val refBlendStrength = when (preset) {
-                    UltraDetailPreset.FAST -> 0.3f
-                    UltraDetailPreset.BALANCED -> 0.4f
-                    UltraDetailPreset.MAX, UltraDetailPreset.ULTRA -> 0.5f
-                }
-                
-                if (transferReferenceDetail(enhancedBitmap, sharpestFrame, refTransferOutput, refBlendStrength)) {
-                    if (enhancedBitmap !== outputBitmap) enhancedBitmap.recycle()
-                    enhancedBitmap = refTransferOutput
-                    Log.d(TAG, "║   - Reference detail transfer applied (blend=$refBlendStrength)")
-                } else {
-                    refTransferOutput.recycle()
-                    Log.w(TAG, "║   - Reference detail transfer failed, skipping")
+                // Steps 0-2 run on one native float session: the image is loaded
+                // once and quantized to 8 bits once, instead of per step
+                val session = NativeImageSession.create(enhancedBitmap)
+                if (session == null) {
+                    Log.w(TAG, "║   - Native image session unavailable, skipping steps 0-2")
                 }
-                
-                // Step 1: Frequency separation with adaptive sharpening
-                Log.i(TAG, "║ Stage 3.5a: Frequency separation...")
-                val freqOutput = Bitmap.createBitmap(outputWidth, outputHeight, Bitmap.Config.ARGB_8888)
-                val freqConfig = FreqSeparationConfig(
-                    lowPassSigma = 2.0f,
-                    highBoost = 1.3f,
-                    edgeProtection = 0.8f
-                )
-                
-                if (NativeMFSRPipeline.applyFreqSeparation(enhancedBitmap, freqOutput, freqConfig)) {
-                    if (enhancedBitmap !== outputBitmap) enhancedBitmap.recycle()
-                    enhancedBitmap = freqOutput
-                    Log.d(TAG, "║   - Frequency separation applied")
-                } else {
-                    freqOutput.recycle()
-                    Log.w(TAG, "║   - Frequency separation failed, skipping")
-                }
-                
-                // Step 2: Anisotropic edge-aware filtering
-                Log.i(TAG, "║ Stage 3.5b: Anisotropic filtering...")
-                val anisoOutput = Bitmap.createBitmap(outputWidth, outputHeight, Bitmap.Config.ARGB_8888)
-                val anisoConfig = AnisotropicFilterConfig(
-                    kernelSigma = 1.5f,
-                    elongation = 2.5f,
-                    noiseThreshold = 0.015f
-                )
-                
-                if (NativeMFSRPipeline.applyAnisotropicFilter(enhancedBitmap, anisoOutput, anisoConfig)) {
-                    if (enhancedBitmap !== outputBitmap) enhancedBitmap.recycle()
-                    enhancedBitmap = anisoOutput
-                    Log.d(TAG, "║   - Anisotropic filtering applied")
-                } else {
-                    anisoOutput.recycle()
-                    Log.w(TAG, "║   - Anisotropic filtering failed, skipping")
+                session?.use { working ->
+                    // Step 0: Reference-based detail transfer (NEW - Topaz Gigapixel inspired)
+                    // Use the sharpest original frame to transfer high-frequency detail to upscaled output
+                    _state.value = PipelineState.ProcessingBurst(
+                        ProcessingStage.MERGING_FRAMES, 0.82f, "Transferring fine details from reference..."
+                    )
+                    Log.i(TAG, "║ Stage 3.5-pre: Reference-based detail transfer...")
+                    val sharpestFrame = correctedFrames[workingRefIndex].bitmap
+                    
+                    // Transfer high-frequency detail from sharpest frame
+                    // This extracts Laplacian (edges/texture) from reference and blends into upscaled output
+                    val refBlendStrength = when (preset) {
+                        UltraDetailPreset.FAST -> 0.3f
+                        UltraDetailPreset.BALANCED -> 0.4f
+                        UltraDetailPreset.MAX, UltraDetailPreset.ULTRA -> 0.5f
+                    }
+                    
+                    if (working.transferReferenceDetail(sharpestFrame, refBlendStrength)) {
+                        Log.d(TAG, "║   - Reference detail transfer applied (blend=$refBlendStrength)")
+                    } else {
+                        Log.w(TAG, "║   - Reference detail transfer failed, skipping")
+                    }
+                    
+                    // Step 1: Frequency separation with adaptive sharpening
+                    Log.i(TAG, "║ Stage 3.5a: Frequency separation...")
+                    val freqConfig = FreqSeparationConfig(
+                        lowPassSigma = 2.0f,
+                        highBoost = 1.3f,
+                        edgeProtection = 0.8f
+                    )
+                    
+                    if (working.applyFreqSeparation(freqConfig)) {
+                        Log.d(TAG, "║   - Frequency separation applied")
+                    } else {
+                        Log.w(TAG, "║   - Frequency separation failed, skipping")
+                    }
+                    
+                    // Step 2: Anisotropic edge-aware filtering
+                    Log.i(TAG, "║ Stage 3.5b: Anisotropic filtering...")
+                    val anisoConfig = AnisotropicFilterConfig(
+                        kernelSigma = 1.5f,
+                        elongation = 2.5f,
+                        noiseThreshold = 0.015f
+                    )
+                    
+                    if (working.applyAnisotropicFilter(anisoConfig)) {
+                        Log.d(TAG, "║   - Anisotropic filtering applied")
+                    } else {
+                        Log.w(TAG, "║   - Anisotropic filtering failed, skipping")
+                    }
+                    
+                    // Single 8-bit export of the session result
+                    val sessionOutput = Bitmap.createBitmap(outputWidth, outputHeight, Bitmap.Config.ARGB_8888)
+                    if (working.export(sessionOutput, dither = true)) {
+                        if (enhancedBitmap !== outputBitmap) enhancedBitmap.recycle()
+                        enhancedBitmap = sessionOutput
+                    } else {
+                        sessionOutput.recycle()
+                        Log.w(TAG, "║   - Session export failed, keeping input")
+                    }
                 }
                 
                 // Step 3: Drizzle sub-pixel enhancement (if we have multiple aligned frames)
@@ -420,15 +420,38 @@ class UltraDetailViewModel @Inject constructor(
         
         _uiState.value = _uiState.value.copy(
             isCapturing = false,
-            rawBurstUris = result.dngUris
+            isProcessing = true,
+            processingStage = UiProcessingStage.ALIGNING,
+            processingStartTimeMs = System.currentTimeMillis(),
+            rawBurstUris = result.dngUris,
+            statusMessage = "Merging RAW burst..."
         )
         
-        // TODO: Process raw-cache files through native pipeline
-        // For now, just show DNGs saved message
-        _uiState.value = _uiState.value.copy(
-            statusMessage = "RAW burst saved (${result.dngUris.size} DNGs). Processing coming soon...",
-            error = null
-        )
+        // Merge the raw-cache files in the Bayer domain (DNGs are kept either way)
+        val startTime = System.currentTimeMillis()
+        val merged = withContext(Dispatchers.Default) {
+            mergeRawBurst(result.rawCacheFiles)
+        }
+        val elapsed = System.currentTimeMillis() - startTime
+        
+        _uiState.value = if (merged != null) {
+            _uiState.value.copy(
+                isProcessing = false,
+                processingStage = UiProcessingStage.IDLE,
+                resultBitmap = merged.bitmap,
+                processingTimeMs = elapsed,
+                framesUsed = merged.framesMerged,
+                statusMessage = "RAW merge complete! ${elapsed}ms (${result.dngUris.size} DNGs saved)",
+                error = null
+            )
+        } else {
+            _uiState.value.copy(
+                isProcessing = false,
+                processingStage = UiProcessingStage.IDLE,
+                statusMessage = "RAW burst saved (${result.dngUris.size} DNGs), merge unavailable",
+                error = null
+            )
+        }
     }
     
     /**